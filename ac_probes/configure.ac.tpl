@@ -540,6 +540,7 @@ AM_CONDITIONAL([WANT_PROBES_UNIX], test "$probes_unix" = yes)
 AM_CONDITIONAL([WANT_PROBES_LINUX], test "$probes_linux" = yes)
 AM_CONDITIONAL([WANT_PROBES_SOLARIS], test "$probes_solaris" = yes)
 
+AM_CONDITIONAL([WANT_DEBUG], test "$debug" = yes)
 AM_CONDITIONAL([WANT_SCE], test "$sce" = yes)
 AM_CONDITIONAL([WANT_UTIL_OSCAP], test "$util_oscap" = yes)
 AM_CONDITIONAL([WANT_UTIL_SCAP_AS_RPM], test "$util_scap_as_rpm" = yes)
@@ -564,6 +565,7 @@ AC_CONFIG_FILES([Makefile
 		src/source/Makefile
                  tests/Makefile
                  tests/API/Makefile
+                 tests/bench/Makefile
 
                  swig/Makefile
 		swig/perl/Makefile
@@ -578,6 +580,8 @@ AC_CONFIG_FILES([Makefile
                  tests/API/OVAL/Makefile
 		tests/API/OVAL/glob_to_regex/Makefile
 		tests/oscap_string/Makefile
+		tests/intern/Makefile
+		tests/debug/Makefile
                  tests/API/OVAL/unittests/Makefile
 		 tests/API/OVAL/validate/Makefile
 		 tests/API/OVAL/report_variable_values/Makefile
@@ -130,13 +130,18 @@ bool cpe_session_add_cpe_dict_source(struct cpe_session *session, struct oscap_s
 	return oscap_list_add(session->dicts, dict);
 }
 
-bool cpe_session_add_cpe_autodetect_source(struct cpe_session *session, struct oscap_source *source)
+bool cpe_session_import_cpe_autodetect_source(struct oscap_source *source, struct cpe_dict_model **dict, struct cpe_lang_model **lang_model)
 {
+	*dict = NULL;
+	*lang_model = NULL;
+
 	oscap_document_type_t doc_type = oscap_source_get_scap_type(source);
 	if (doc_type == OSCAP_DOCUMENT_CPE_DICTIONARY) {
-		return cpe_session_add_cpe_dict_source(session, source);
+		*dict = cpe_dict_model_import_source(source);
+		return *dict != NULL;
 	} else if (doc_type == OSCAP_DOCUMENT_CPE_LANGUAGE) {
-		return cpe_session_add_cpe_lang_model_source(session, source);
+		*lang_model = cpe_lang_model_import_source(source);
+		return *lang_model != NULL;
 	} else {
 		oscap_seterr(OSCAP_EFAMILY_OSCAP, "File '%s' wasn't detected as either CPE dictionary or "
 			"CPE lang model. Can't register it to the XCCDF policy model.", oscap_source_readable_origin(source));
@@ -144,6 +149,23 @@ bool cpe_session_add_cpe_autodetect_source(struct cpe_session *session, struct o
 	}
 }
 
+bool cpe_session_add_cpe_models(struct cpe_session *session, struct cpe_dict_model *dict, struct cpe_lang_model *lang_model)
+{
+	if (dict != NULL)
+		return oscap_list_add(session->dicts, dict);
+	return oscap_list_add(session->lang_models, lang_model);
+}
+
+bool cpe_session_add_cpe_autodetect_source(struct cpe_session *session, struct oscap_source *source)
+{
+	struct cpe_dict_model *dict;
+	struct cpe_lang_model *lang_model;
+
+	if (!cpe_session_import_cpe_autodetect_source(source, &dict, &lang_model))
+		return false;
+	return cpe_session_add_cpe_models(session, dict, lang_model);
+}
+
 void cpe_session_set_cache(struct cpe_session *session, struct oscap_htable *sources_cache)
 {
 	session->sources_cache = sources_cache;
@@ -28,6 +28,8 @@
 #include "common/list.h"
 #include "common/public/oscap.h"
 #include "common/util.h"
+#include "CPE/public/cpe_dict.h"
+#include "CPE/public/cpe_lang.h"
 #include "OVAL/public/oval_agent_api.h"
 
 OSCAP_HIDDEN_START;
@@ -46,6 +48,14 @@ struct oval_agent_session *cpe_session_lookup_oval_session(struct cpe_session *c
 bool cpe_session_add_cpe_lang_model_source(struct cpe_session *session, struct oscap_source *source);
 bool cpe_session_add_cpe_dict_source(struct cpe_session *session, struct oscap_source *source);
 bool cpe_session_add_cpe_autodetect_source(struct cpe_session *session, struct oscap_source *source);
+/**
+ * Import a CPE dictionary or a CPE lang model, whichever the source is,
+ * without registering it. No session is involved, so the sources may be
+ * imported by several threads at once.
+ */
+bool cpe_session_import_cpe_autodetect_source(struct oscap_source *source, struct cpe_dict_model **dict, struct cpe_lang_model **lang_model);
+/// Register models imported by cpe_session_import_cpe_autodetect_source, the session takes them over
+bool cpe_session_add_cpe_models(struct cpe_session *session, struct cpe_dict_model *dict, struct cpe_lang_model *lang_model);
 void cpe_session_set_cache(struct cpe_session *session, struct oscap_htable *sources_cache);
 
 OSCAP_HIDDEN_END;
@@ -0,0 +1,642 @@
+/*! \file cve_index.c
+ *  \brief Index of CVE ids and vulnerable products of a CVE feed
+ */
+
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "public/cve_nvd.h"
+#include "cve_priv.h"
+
+#include "common/util.h"
+#include "common/_error.h"
+
+#include "source/oscap_source_priv.h"
+#include "source/public/oscap_source.h"
+
+/*
+ * The index file consists of the header, the table of entries (their
+ * position in the feed), the table of keys sorted by their names and the
+ * names. Each key maps a CVE id or a vulnerable product to an entry. An entry
+ * is parsed on its own, prepended by the feed up to the root start tag (to
+ * get the namespace declarations) and followed by the root end tag.
+ * Integers are in the byte order of the machine which built the index.
+ */
+
+#define CVE_INDEX_MAGIC "OSCAPCVI"
+#define CVE_INDEX_VERSION 1
+
+struct cve_index_header {
+	char     magic[8];
+	uint32_t version;
+	uint32_t prolog_len;    ///< length of the feed up to the end of the root start tag
+	uint64_t feed_size;
+	int64_t  feed_mtime;
+	uint32_t entry_count;
+	uint32_t key_count;
+	uint64_t names_size;
+};
+
+struct cve_index_entry {
+	uint64_t offset;
+	uint64_t length;
+};
+
+struct cve_index_key {
+	uint32_t name;          ///< offset of the name in the names
+	uint32_t entry;
+};
+
+struct cve_index {
+	int feed_fd;
+	char *feed;
+	char *prolog;
+	char *root_qname;
+	char *data;             ///< content of the index file
+	const struct cve_index_header *header;
+	const struct cve_index_entry *entries;
+	const struct cve_index_key *keys;
+	const char *names;
+};
+
+/* Key while the index is being built */
+struct cve_index_build_key {
+	char *name;
+	uint32_t entry;
+};
+
+struct cve_index_builder {
+	struct cve_index_entry *entries;
+	size_t entry_count;
+	size_t entries_allocated;
+	struct cve_index_build_key *keys;
+	size_t key_count;
+	size_t keys_allocated;
+};
+
+/* Returns the position right after the end of the tag starting at `pos' or 0. */
+static size_t cve_index_tag_end(const char *data, size_t size, size_t pos)
+{
+	char quote = '\0';
+
+	for (; pos < size; ++pos) {
+		if (quote != '\0') {
+			if (data[pos] == quote)
+				quote = '\0';
+		} else if (data[pos] == '"' || data[pos] == '\'') {
+			quote = data[pos];
+		} else if (data[pos] == '>') {
+			return pos + 1;
+		}
+	}
+	return 0;
+}
+
+/* Skips a comment or a processing instruction starting at `pos', returns 0 if there is none. */
+static size_t cve_index_skip_markup(const char *data, size_t size, size_t pos)
+{
+	const char *end;
+
+	if (size - pos >= 4 && !strncmp(data + pos, "<!--", 4)) {
+		end = memmem(data + pos + 4, size - pos - 4, "-->", 3);
+		return end ? (size_t) (end - data) + 3 : size;
+	}
+	if (size - pos >= 2 && !strncmp(data + pos, "<?", 2)) {
+		end = memmem(data + pos + 2, size - pos - 2, "?>", 2);
+		return end ? (size_t) (end - data) + 2 : size;
+	}
+	if (size - pos >= 2 && !strncmp(data + pos, "<!", 2))
+		return cve_index_tag_end(data, size, pos);
+	return 0;
+}
+
+static bool cve_index_is_name_end(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '/' || c == '>';
+}
+
+/* Finds the root start tag, returns the length of the prolog or 0. */
+static size_t cve_index_scan_prolog(const char *data, size_t size, char **root_qname)
+{
+	size_t pos = 0;
+
+	while (pos < size) {
+		const char *lt = memchr(data + pos, '<', size - pos);
+		size_t skip, name_len;
+
+		if (lt == NULL)
+			break;
+		pos = lt - data;
+
+		skip = cve_index_skip_markup(data, size, pos);
+		if (skip > 0) {
+			pos = skip;
+			continue;
+		}
+		for (name_len = 0; pos + 1 + name_len < size && !cve_index_is_name_end(data[pos + 1 + name_len]); ++name_len)
+			;
+		*root_qname = oscap_sprintf("%.*s", (int) name_len, data + pos + 1);
+		return cve_index_tag_end(data, size, pos);
+	}
+	return 0;
+}
+
+static char *cve_index_entry_qname(const char *root_qname)
+{
+	const char *colon = strchr(root_qname, ':');
+
+	if (colon == NULL)
+		return oscap_strdup("entry");
+	return oscap_sprintf("%.*s:entry", (int) (colon - root_qname), root_qname);
+}
+
+static int cve_index_take_entry(struct cve_entry *entry, void *result)
+{
+	*(struct cve_entry **) result = entry;
+	return 1;
+}
+
+/*
+ * Parse one entry of the feed. The entry can't be parsed on its own, it
+ * needs the namespace declarations of the root element.
+ */
+static struct cve_entry *cve_index_parse_entry(const char *prolog, size_t prolog_len, const char *root_qname,
+					       const char *entry, size_t entry_len, const char *filename)
+{
+	struct cve_entry *ret = NULL;
+	size_t root_len = strlen(root_qname);
+	size_t size = prolog_len + entry_len + root_len + 3;
+	char *buffer = oscap_alloc(size);
+
+	memcpy(buffer, prolog, prolog_len);
+	memcpy(buffer + prolog_len, entry, entry_len);
+	sprintf(buffer + prolog_len + entry_len, "</%s", root_qname);
+	buffer[size - 1] = '>';
+
+	struct oscap_source *source = oscap_source_new_take_memory(buffer, size, filename);
+	cve_model_parse_entries_source(source, cve_index_take_entry, &ret);
+	oscap_source_free(source);
+
+	return ret;
+}
+
+static int cve_index_builder_add_key(struct cve_index_builder *builder, const char *name)
+{
+	if (name == NULL)
+		return 0;
+
+	if (builder->key_count == builder->keys_allocated) {
+		builder->keys_allocated = builder->keys_allocated ? builder->keys_allocated * 2 : 1024;
+		builder->keys = oscap_realloc(builder->keys, builder->keys_allocated * sizeof(struct cve_index_build_key));
+	}
+	builder->keys[builder->key_count].name = oscap_strdup(name);
+	builder->keys[builder->key_count].entry = builder->entry_count - 1;
+	builder->key_count++;
+	return 0;
+}
+
+static int cve_index_builder_add_entry(struct cve_index_builder *builder, struct cve_entry *entry, size_t offset, size_t length)
+{
+	if (builder->entry_count == builder->entries_allocated) {
+		builder->entries_allocated = builder->entries_allocated ? builder->entries_allocated * 2 : 1024;
+		builder->entries = oscap_realloc(builder->entries, builder->entries_allocated * sizeof(struct cve_index_entry));
+	}
+	builder->entries[builder->entry_count].offset = offset;
+	builder->entries[builder->entry_count].length = length;
+	builder->entry_count++;
+
+	cve_index_builder_add_key(builder, cve_entry_get_id(entry));
+
+	struct cve_product_iterator *products = cve_entry_get_products(entry);
+	while (cve_product_iterator_has_more(products))
+		cve_index_builder_add_key(builder, cve_product_get_value(cve_product_iterator_next(products)));
+	cve_product_iterator_free(products);
+
+	return 0;
+}
+
+static int cve_index_build_key_cmp(const void *a, const void *b)
+{
+	const struct cve_index_build_key *k1 = a, *k2 = b;
+	int ret = strcmp(k1->name, k2->name);
+
+	if (ret != 0)
+		return ret;
+	return (k1->entry > k2->entry) - (k1->entry < k2->entry);
+}
+
+/* Splits the feed to entries and collects their keys. */
+static int cve_index_scan(struct cve_index_builder *builder, const char *feed, const char *data, size_t size,
+			  size_t prolog_len, const char *root_qname)
+{
+	char *entry_qname = cve_index_entry_qname(root_qname);
+	size_t entry_qname_len = strlen(entry_qname);
+	char *close_tag = oscap_sprintf("</%s", entry_qname);
+	size_t pos = prolog_len;
+	int ret = -1;
+
+	for (;;) {
+		const char *lt = memchr(data + pos, '<', size - pos);
+		size_t skip, start, end;
+
+		if (lt == NULL) {
+			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Missing end of the root element in '%s'.", feed);
+			break;
+		}
+		pos = lt - data;
+
+		skip = cve_index_skip_markup(data, size, pos);
+		if (skip > 0) {
+			pos = skip;
+			continue;
+		}
+		if (size - pos >= 2 && data[pos + 1] == '/') {
+			ret = 0;
+			break;
+		}
+		if (size - pos <= entry_qname_len + 1 || strncmp(data + pos + 1, entry_qname, entry_qname_len) != 0 ||
+		    !cve_index_is_name_end(data[pos + 1 + entry_qname_len])) {
+			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Unexpected element at offset %zu of '%s'.", pos, feed);
+			break;
+		}
+
+		start = pos;
+		end = cve_index_tag_end(data, size, pos);
+		if (end == 0) {
+			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Unterminated element at offset %zu of '%s'.", pos, feed);
+			break;
+		}
+		if (data[end - 2] != '/') {
+			const char *close = memmem(data + end, size - end, close_tag, entry_qname_len + 2);
+
+			/* skip end tags of other elements whose names start with the same characters */
+			while (close != NULL && (size_t) (close - data) + entry_qname_len + 2 < size &&
+			       !cve_index_is_name_end(close[entry_qname_len + 2])) {
+				size_t next = close - data + entry_qname_len + 2;
+
+				close = memmem(data + next, size - next, close_tag, entry_qname_len + 2);
+			}
+			end = close ? cve_index_tag_end(data, size, close - data) : 0;
+			if (end == 0) {
+				oscap_seterr(OSCAP_EFAMILY_OSCAP, "Unterminated element at offset %zu of '%s'.", pos, feed);
+				break;
+			}
+		}
+
+		struct cve_entry *entry = cve_index_parse_entry(data, prolog_len, root_qname, data + start, end - start, feed);
+		if (entry != NULL) {
+			cve_index_builder_add_entry(builder, entry, start, end - start);
+			cve_entry_free(entry);
+		}
+		pos = end;
+	}
+
+	oscap_free(close_tag);
+	oscap_free(entry_qname);
+	return ret;
+}
+
+static int cve_index_write(const struct cve_index_builder *builder, const char *index,
+			   const struct stat *feed_stat, size_t prolog_len)
+{
+	struct cve_index_header header;
+	struct cve_index_key *keys;
+	uint64_t names_size = 0;
+	size_t i;
+	int ret = 0;
+
+	/* write a temporary file first so that readers never map a partial index */
+	char *tmp = oscap_sprintf("%s.XXXXXX", index);
+	int fd = mkstemp(tmp);
+	/* mkstemp() makes the file private, the index is as readable as the feed */
+	if (fd >= 0)
+		fchmod(fd, feed_stat->st_mode & 0666);
+	FILE *fp = fd < 0 ? NULL : fdopen(fd, "wb");
+	if (fp == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Unable to create '%s': %s", tmp, strerror(errno));
+		if (fd >= 0) {
+			close(fd);
+			unlink(tmp);
+		}
+		oscap_free(tmp);
+		return -1;
+	}
+
+	/* The keys are sorted, equal names share one string. */
+	keys = oscap_alloc((builder->key_count ? builder->key_count : 1) * sizeof(struct cve_index_key));
+	for (i = 0; i < builder->key_count; ++i) {
+		if (i == 0 || strcmp(builder->keys[i - 1].name, builder->keys[i].name) != 0) {
+			keys[i].name = names_size;
+			names_size += strlen(builder->keys[i].name) + 1;
+		} else {
+			keys[i].name = keys[i - 1].name;
+		}
+		keys[i].entry = builder->keys[i].entry;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CVE_INDEX_MAGIC, sizeof(header.magic));
+	header.version = CVE_INDEX_VERSION;
+	header.prolog_len = prolog_len;
+	header.feed_size = feed_stat->st_size;
+	header.feed_mtime = feed_stat->st_mtime;
+	header.entry_count = builder->entry_count;
+	header.key_count = builder->key_count;
+	header.names_size = names_size;
+
+	fwrite(&header, sizeof(header), 1, fp);
+	fwrite(builder->entries, sizeof(struct cve_index_entry), builder->entry_count, fp);
+	fwrite(keys, sizeof(struct cve_index_key), builder->key_count, fp);
+	for (i = 0; i < builder->key_count; ++i) {
+		if (i == 0 || keys[i].name != keys[i - 1].name)
+			fwrite(builder->keys[i].name, strlen(builder->keys[i].name) + 1, 1, fp);
+	}
+	oscap_free(keys);
+
+	if (ferror(fp) | fclose(fp)) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Unable to write '%s': %s", tmp, strerror(errno));
+		unlink(tmp);
+		ret = -1;
+	} else if (rename(tmp, index) != 0) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Unable to rename '%s' to '%s': %s", tmp, index, strerror(errno));
+		unlink(tmp);
+		ret = -1;
+	}
+	oscap_free(tmp);
+	return ret;
+}
+
+int cve_index_build(const char *feed, const char *index)
+{
+	__attribute__nonnull__(feed);
+	__attribute__nonnull__(index);
+
+	struct cve_index_builder builder;
+	struct stat st;
+	char *root_qname = NULL;
+	size_t prolog_len;
+	void *data;
+	int ret = -1;
+
+	int fd = open(feed, O_RDONLY);
+	if (fd == -1) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Unable to open file: '%s'", feed);
+		return -1;
+	}
+	if (fstat(fd, &st) == -1 || st.st_size == 0) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Unable to read file: '%s'", feed);
+		close(fd);
+		return -1;
+	}
+	data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Unable to read file: '%s'", feed);
+		return -1;
+	}
+
+	prolog_len = cve_index_scan_prolog(data, st.st_size, &root_qname);
+	if (prolog_len == 0 || prolog_len > UINT32_MAX) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "'%s' is not an uncompressed CVE feed.", feed);
+		goto cleanup;
+	}
+
+	memset(&builder, 0, sizeof(builder));
+	if (cve_index_scan(&builder, feed, data, st.st_size, prolog_len, root_qname) == 0) {
+		size_t count = 0;
+
+		qsort(builder.keys, builder.key_count, sizeof(struct cve_index_build_key), cve_index_build_key_cmp);
+		// a product may be listed more than once in an entry
+		for (size_t i = 0; i < builder.key_count; ++i) {
+			if (count > 0 && cve_index_build_key_cmp(&builder.keys[count - 1], &builder.keys[i]) == 0)
+				oscap_free(builder.keys[i].name);
+			else
+				builder.keys[count++] = builder.keys[i];
+		}
+		builder.key_count = count;
+		ret = cve_index_write(&builder, index, &st, prolog_len);
+	}
+
+	for (size_t i = 0; i < builder.key_count; ++i)
+		oscap_free(builder.keys[i].name);
+	oscap_free(builder.keys);
+	oscap_free(builder.entries);
+
+cleanup:
+	oscap_free(root_qname);
+	munmap(data, st.st_size);
+	return ret;
+}
+
+struct cve_index *cve_index_open(const char *feed, const char *index)
+{
+	__attribute__nonnull__(feed);
+	__attribute__nonnull__(index);
+
+	struct cve_index *ret = NULL;
+	struct stat st;
+	char *data = NULL;
+	const struct cve_index_header *header;
+	char *prolog = NULL;
+	char *root_qname = NULL;
+	int feed_fd = -1;
+	uint64_t expected_size;
+
+	int fd = open(index, O_RDONLY);
+	if (fd == -1) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Unable to open file: '%s'", index);
+		return NULL;
+	}
+	if (fstat(fd, &st) == -1 || (size_t) st.st_size < sizeof(struct cve_index_header)) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "'%s' is not a CVE index.", index);
+		close(fd);
+		return NULL;
+	}
+	data = oscap_alloc(st.st_size);
+	if (read(fd, data, st.st_size) != st.st_size) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Unable to read file: '%s'", index);
+		close(fd);
+		goto error;
+	}
+	close(fd);
+
+	header = (const struct cve_index_header *) data;
+	expected_size = sizeof(struct cve_index_header)
+		+ (uint64_t) header->entry_count * sizeof(struct cve_index_entry)
+		+ (uint64_t) header->key_count * sizeof(struct cve_index_key)
+		+ header->names_size;
+	if (memcmp(header->magic, CVE_INDEX_MAGIC, sizeof(header->magic)) != 0 ||
+	    header->version != CVE_INDEX_VERSION || expected_size != (uint64_t) st.st_size ||
+	    (header->names_size > 0 && data[st.st_size - 1] != '\0')) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "'%s' is not a CVE index.", index);
+		goto error;
+	}
+
+	feed_fd = open(feed, O_RDONLY);
+	if (feed_fd == -1 || fstat(feed_fd, &st) == -1) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Unable to open file: '%s'", feed);
+		goto error;
+	}
+	if ((uint64_t) st.st_size != header->feed_size || (int64_t) st.st_mtime != header->feed_mtime) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "CVE index '%s' is out of date.", index);
+		goto error;
+	}
+
+	prolog = oscap_alloc(header->prolog_len + 1);
+	if (pread(feed_fd, prolog, header->prolog_len, 0) != (ssize_t) header->prolog_len ||
+	    cve_index_scan_prolog(prolog, header->prolog_len, &root_qname) != header->prolog_len) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "CVE index '%s' doesn't match the feed.", index);
+		goto error;
+	}
+
+	ret = oscap_calloc(1, sizeof(struct cve_index));
+	ret->feed_fd = feed_fd;
+	ret->feed = oscap_strdup(feed);
+	ret->prolog = prolog;
+	ret->root_qname = root_qname;
+	ret->data = data;
+	ret->header = header;
+	ret->entries = (const struct cve_index_entry *) (data + sizeof(struct cve_index_header));
+	ret->keys = (const struct cve_index_key *) (ret->entries + header->entry_count);
+	ret->names = (const char *) (ret->keys + header->key_count);
+	return ret;
+
+error:
+	if (feed_fd != -1)
+		close(feed_fd);
+	oscap_free(root_qname);
+	oscap_free(prolog);
+	oscap_free(data);
+	return NULL;
+}
+
+void cve_index_free(struct cve_index *index)
+{
+	if (index == NULL)
+		return;
+
+	close(index->feed_fd);
+	oscap_free(index->feed);
+	oscap_free(index->prolog);
+	oscap_free(index->root_qname);
+	oscap_free(index->data);
+	oscap_free(index);
+}
+
+/* Returns the position of the first key with the name. */
+static uint32_t cve_index_lower_bound(const struct cve_index *index, const char *name)
+{
+	uint32_t low = 0, high = index->header->key_count;
+
+	while (low < high) {
+		uint32_t mid = low + (high - low) / 2;
+		uint32_t name_offset = index->keys[mid].name;
+
+		if (name_offset >= index->header->names_size ||
+		    strcmp(index->names + name_offset, name) < 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low;
+}
+
+static bool cve_index_key_is(const struct cve_index *index, uint32_t key, const char *name)
+{
+	return key < index->header->key_count &&
+		index->keys[key].name < index->header->names_size &&
+		!strcmp(index->names + index->keys[key].name, name);
+}
+
+static struct cve_entry *cve_index_read_entry(struct cve_index *index, uint32_t entry)
+{
+	const struct cve_index_entry *position;
+	struct cve_entry *ret;
+	char *data;
+
+	if (entry >= index->header->entry_count) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Invalid entry in the CVE index of '%s'.", index->feed);
+		return NULL;
+	}
+	position = &index->entries[entry];
+
+	data = oscap_alloc(position->length ? position->length : 1);
+	if (pread(index->feed_fd, data, position->length, position->offset) != (ssize_t) position->length) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Unable to read file: '%s'", index->feed);
+		oscap_free(data);
+		return NULL;
+	}
+	ret = cve_index_parse_entry(index->prolog, index->header->prolog_len, index->root_qname,
+				    data, position->length, index->feed);
+	oscap_free(data);
+	return ret;
+}
+
+struct cve_entry *cve_index_find_entry(struct cve_index *index, const char *cve_id)
+{
+	__attribute__nonnull__(index);
+	__attribute__nonnull__(cve_id);
+
+	for (uint32_t key = cve_index_lower_bound(index, cve_id); cve_index_key_is(index, key, cve_id); ++key) {
+		struct cve_entry *entry = cve_index_read_entry(index, index->keys[key].entry);
+
+		// the name may be a product as well
+		if (entry != NULL && oscap_streq(cve_entry_get_id(entry), cve_id))
+			return entry;
+		cve_entry_free(entry);
+	}
+	return NULL;
+}
+
+int cve_index_find_product(struct cve_index *index, const char *cpe, cve_entry_consumer consumer, void *user)
+{
+	__attribute__nonnull__(index);
+	__attribute__nonnull__(cpe);
+	__attribute__nonnull__(consumer);
+
+	for (uint32_t key = cve_index_lower_bound(index, cpe); cve_index_key_is(index, key, cpe); ++key) {
+		struct cve_entry *entry = cve_index_read_entry(index, index->keys[key].entry);
+
+		if (entry == NULL)
+			return -1;
+		if (oscap_streq(cve_entry_get_id(entry), cpe)) {
+			cve_entry_free(entry);
+			continue;
+		}
+		if (consumer(entry, user) != 0)
+			return 1;
+	}
+	return 0;
+}
@@ -392,28 +392,36 @@ struct cve_model * cve_model_clone(struct cve_model * old_model)
  * More info in representive header file.
  * returns the type of <structure>
  */
+/*
+ * Open a streaming reader positioned at the root element of the feed.
+ */
+static xmlTextReader *cve_model_open_reader(struct oscap_source *source)
+{
+	xmlTextReader *reader = oscap_source_get_streaming_xmlTextReader(source);
+	if (!reader)
+		return NULL;
+
+	if (xmlTextReaderNextNode(reader) == -1) {
+		xmlFreeTextReader(reader);
+		return NULL;
+	}
+	return reader;
+}
+
 struct cve_model *cve_model_parse_xml(const char *file)
 {
 
 	__attribute__nonnull__(file);
 
 	struct cve_model *ret = NULL;
-	int rc;
 
 	struct oscap_source *source = oscap_source_new_from_file(file);
-	xmlTextReader *reader = oscap_source_get_xmlTextReader(source);
+	xmlTextReader *reader = cve_model_open_reader(source);
 	if (!reader) {
 		oscap_source_free(source);
 		return NULL;
 	}
 
-	rc = xmlTextReaderNextNode(reader);
-	if (rc == -1) {
-		xmlFreeTextReader(reader);
-		oscap_source_free(source);
-		return NULL;
-	}
-
 	ret = cve_model_parse(reader);
 
 	xmlFreeTextReader(reader);
@@ -421,13 +429,45 @@ struct cve_model *cve_model_parse_xml(const char *file)
 	return ret;
 }
 
+int cve_model_parse_entries_source(struct oscap_source *source, cve_entry_consumer consumer, void *user)
+{
+
+	__attribute__nonnull__(source);
+
+	int ret;
+	xmlTextReader *reader = cve_model_open_reader(source);
+	if (!reader)
+		return -1;
+
+	ret = cve_model_parse_entries(reader, consumer, user);
+
+	xmlFreeTextReader(reader);
+	return ret;
+}
+
+int cve_model_parse_entries_xml(const char *file, cve_entry_consumer consumer, void *user)
+{
+
+	__attribute__nonnull__(file);
+
+	struct oscap_source *source = oscap_source_new_from_file(file);
+	int ret = cve_model_parse_entries_source(source, consumer, user);
+	oscap_source_free(source);
+	return ret;
+}
+
+static int cve_model_take_entry(struct cve_entry *entry, void *model)
+{
+	oscap_list_add(((struct cve_model *) model)->entries, entry);
+	return 0;
+}
+
 struct cve_model *cve_model_parse(xmlTextReaderPtr reader)
 {
 
 	__attribute__nonnull__(reader);
 
 	struct cve_model *ret = NULL;
-	struct cve_entry *entry = NULL;
 
 	if (!xmlStrcmp(xmlTextReaderConstLocalName(reader), TAG_NVD_STR) &&
 	    xmlTextReaderNodeType(reader) == XML_READER_TYPE_ELEMENT) {
@@ -439,22 +479,47 @@ struct cve_model *cve_model_parse(xmlTextReaderPtr reader)
 		ret->nvd_xml_version = (char*) xmlTextReaderGetAttribute(reader, BAD_CAST "nvd_xml_version");
 		ret->pub_date = (char*) xmlTextReaderGetAttribute(reader, BAD_CAST "pub_date");
 
-		/* skip nodes until new element */
-		xmlTextReaderNextElement(reader);
-
-		/* CVE-specification: entry */
-		while (xmlStrcmp(xmlTextReaderConstLocalName(reader), TAG_CVE_STR) == 0) {
-
-			entry = cve_entry_parse(reader);
-			if (entry)
-				oscap_list_add(ret->entries, entry);
-			xmlTextReaderNextElement(reader);
+		if (cve_model_parse_entries(reader, cve_model_take_entry, ret) == -1) {
+			cve_model_free(ret);
+			return NULL;
 		}
 	}
 
 	return ret;
 }
 
+int cve_model_parse_entries(xmlTextReaderPtr reader, cve_entry_consumer consumer, void *user)
+{
+
+	__attribute__nonnull__(reader);
+	__attribute__nonnull__(consumer);
+
+	struct cve_entry *entry = NULL;
+
+	if (xmlStrcmp(xmlTextReaderConstLocalName(reader), TAG_NVD_STR) != 0 ||
+	    xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Expected 'nvd' element, got '%s'.",
+			(const char *) xmlTextReaderConstLocalName(reader));
+		return -1;
+	}
+
+	/* skip nodes until new element */
+	if (xmlTextReaderNextElement(reader) == -1)
+		return -1;
+
+	/* CVE-specification: entry */
+	while (xmlStrcmp(xmlTextReaderConstLocalName(reader), TAG_CVE_STR) == 0) {
+
+		entry = cve_entry_parse(reader);
+		if (entry && consumer(entry, user) != 0)
+			return 1;
+		if (xmlTextReaderNextElement(reader) == -1)
+			return -1;
+	}
+
+	return 0;
+}
+
 struct cve_entry *cve_entry_parse(xmlTextReaderPtr reader)
 {
 
@@ -38,6 +38,8 @@
 
 #include "../common/list.h"
 #include "../common/elements.h"
+#include "../source/public/oscap_source.h"
+#include "public/cve_nvd.h"
 
 /** 
  * @cond INTERNAL
@@ -95,6 +97,30 @@ struct cve_model *cve_model_parse_xml(const char *file);
  */
 struct cve_model *cve_model_parse(xmlTextReaderPtr reader);
 
+/**
+ * Parse CVE entries of the feed one by one
+ * @param file path to the feed
+ * @param consumer callback taking the parsed entries
+ * @param user user data passed to the consumer
+ * @return 0 if all entries were parsed, 1 if the consumer stopped the parsing, -1 on error
+ */
+int cve_model_parse_entries_xml(const char *file, cve_entry_consumer consumer, void *user);
+
+/**
+ * Parse CVE entries of the feed from an OSCAP source
+ * @see cve_model_parse_entries_xml
+ */
+int cve_model_parse_entries_source(struct oscap_source *source, cve_entry_consumer consumer, void *user);
+
+/**
+ * Parse CVE entries
+ * @param reader XML Text Reader positioned at the root element of the feed
+ * @param consumer callback taking the parsed entries
+ * @param user user data passed to the consumer
+ * @return 0 if all entries were parsed, 1 if the consumer stopped the parsing, -1 on error
+ */
+int cve_model_parse_entries(xmlTextReaderPtr reader, cve_entry_consumer consumer, void *user);
+
 /**
  * Parse CVE entry
  * @param reader XML Text Reader representing XML model
@@ -74,6 +74,19 @@ struct cwe_entry;
  * Structure holding CVE reference data
  */
 struct cve_reference;
+/** 
+ * @struct cve_index
+ * Index of a CVE feed on disk, maps CVE ids and vulnerable products to the entries of the feed
+ */
+struct cve_index;
+
+/**
+ * Callback taking the CVE entries read one by one
+ * @param entry CVE entry, the callback takes its ownership and frees it by cve_entry_free()
+ * @param user user data
+ * @return zero to continue reading the feed, non-zero value to stop
+ */
+typedef int (*cve_entry_consumer)(struct cve_entry *entry, void *user);
 
 // fwd
 struct cvss_impact;
@@ -672,6 +685,57 @@ void cve_model_export(struct cve_model *cve, const char *file);
  */
 struct cve_model *cve_model_import(const char *file);
 
+/**
+ * Read the CVE entries of the feed one by one without building the whole model.
+ * @memberof cve_model
+ * @param file filename
+ * @param consumer callback taking the entries
+ * @param user user data passed to the consumer
+ * @return 0 if all entries were read, 1 if the consumer stopped the reading, -1 on error
+ */
+int cve_model_import_entries(const char *file, cve_entry_consumer consumer, void *user);
+
+/**
+ * Create an index of CVE ids and vulnerable products of the feed.
+ * The index refers to the entries by their position in the feed, it has to be
+ * rebuilt when the feed changes.
+ * @memberof cve_index
+ * @param feed filename of the feed, the feed must not be compressed
+ * @param index filename of the index to create
+ * @return 0 on success, -1 on error
+ */
+int cve_index_build(const char *feed, const char *index);
+
+/**
+ * Open an index created by cve_index_build().
+ * @memberof cve_index
+ * @param feed filename of the indexed feed
+ * @param index filename of the index
+ * @return the index or NULL if it can't be read or it is out of date
+ */
+struct cve_index *cve_index_open(const char *feed, const char *index);
+
+/**
+ * Find CVE entry by its id.
+ * @memberof cve_index
+ * @return new CVE entry or NULL if there is no such entry
+ */
+struct cve_entry *cve_index_find_entry(struct cve_index *index, const char *cve_id);
+
+/**
+ * Find CVE entries which list the product as vulnerable software.
+ * @memberof cve_index
+ * @param index CVE index
+ * @param cpe CPE name of the product as listed in the feed
+ * @param consumer callback taking the entries
+ * @param user user data passed to the consumer
+ * @return 0 if all entries were found, 1 if the consumer stopped the search, -1 on error
+ */
+int cve_index_find_product(struct cve_index *index, const char *cpe, cve_entry_consumer consumer, void *user);
+
+/// @memberof cve_index
+void cve_index_free(struct cve_index *index);
+
 /// @memberof cve_model
 const char *cve_model_get_nvd_xml_version(const struct cve_model *item);
 /// @memberof cve_model
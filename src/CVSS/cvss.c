@@ -37,6 +37,8 @@
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include <strings.h>
+#include <pthread.h>
 
 #include "public/cvss_score.h"
 #include "cvss_priv.h"
@@ -210,6 +212,133 @@ static const struct cvss_valtab_entry *cvss_valtab(enum cvss_key key, unsigned v
     return entry;
 }
 
+/*
+ * Packed vectors: the value of each vector component is stored in four bits,
+ * base components first, followed by the temporal and environmental ones.
+ * The bits above them flag the metrics categories present in the vector.
+ */
+#define CVSS_PACKED_KEY_NUM (CVSS_KEY_BASE_NUM + CVSS_KEY_TEMPORAL_NUM + CVSS_KEY_ENVIRONMENTAL_NUM)
+#define CVSS_PACKED_VALUE_BITS 4
+#define CVSS_PACKED_VALUE_MASK ((1 << CVSS_PACKED_VALUE_BITS) - 1)
+
+// position of the key among the packed components
+static inline unsigned cvss_packed_slot(enum cvss_key key)
+{
+    switch (CVSS_CATEGORY(key)) {
+        case CVSS_BASE:     return CVSS_KEY_IDX(key);
+        case CVSS_TEMPORAL: return CVSS_KEY_BASE_NUM + CVSS_KEY_IDX(key);
+        default:            return CVSS_KEY_BASE_NUM + CVSS_KEY_TEMPORAL_NUM + CVSS_KEY_IDX(key);
+    }
+}
+
+static inline cvss_packed_vector cvss_packed_flag(enum cvss_category cat)
+{
+    return (cvss_packed_vector) 1 << (CVSS_PACKED_KEY_NUM * CVSS_PACKED_VALUE_BITS + (cat >> 8) - 1);
+}
+
+static inline cvss_packed_vector cvss_packed_set(cvss_packed_vector packed, enum cvss_key key, unsigned value)
+{
+    unsigned shift = cvss_packed_slot(key) * CVSS_PACKED_VALUE_BITS;
+    // values without a weight all map to the same invalid value
+    if (value > CVSS_PACKED_VALUE_MASK) value = CVSS_PACKED_VALUE_MASK;
+    packed &= ~((cvss_packed_vector) CVSS_PACKED_VALUE_MASK << shift);
+    return packed | (cvss_packed_vector) value << shift | cvss_packed_flag(CVSS_CATEGORY(key));
+}
+
+struct cvss_packed_key {
+    enum cvss_key key;
+    const struct cvss_valtab_entry *values; // first valtab entry of the key
+    size_t prefix_len;                      // length of the key part of vector_str
+};
+
+// tables derived from CVSS_VALTAB, indexed by cvss_packed_slot()
+static struct cvss_packed_key CVSS_PACKED_KEYS[CVSS_PACKED_KEY_NUM];
+static float CVSS_PACKED_WEIGHTS[CVSS_PACKED_KEY_NUM][CVSS_PACKED_VALUE_MASK + 1];
+static pthread_once_t cvss_packed_once = PTHREAD_ONCE_INIT;
+
+static void cvss_packed_init(void)
+{
+    const struct cvss_valtab_entry *entry;
+
+    for (size_t i = 0; i < CVSS_PACKED_KEY_NUM; ++i)
+        for (size_t j = 0; j <= CVSS_PACKED_VALUE_MASK; ++j)
+            CVSS_PACKED_WEIGHTS[i][j] = NAN;
+
+    for (entry = CVSS_VALTAB; entry->key != CVSS_KEY_NONE; ++entry) {
+        unsigned slot = cvss_packed_slot(entry->key);
+        struct cvss_packed_key *k = &CVSS_PACKED_KEYS[slot];
+
+        if (k->values == NULL) {
+            k->key = entry->key;
+            k->values = entry;
+            k->prefix_len = strchr(entry->vector_str, ':') - entry->vector_str;
+        }
+        if (entry->value <= CVSS_PACKED_VALUE_MASK)
+            CVSS_PACKED_WEIGHTS[slot][entry->value] = entry->weight;
+    }
+}
+
+// valtab lookup of a vector component which is not NUL-terminated
+static const struct cvss_valtab_entry *cvss_packed_component(const char *comp, size_t len)
+{
+    const char *colon = memchr(comp, ':', len);
+    if (colon == NULL) return NULL;
+    size_t prefix_len = colon - comp;
+
+    for (size_t i = 0; i < CVSS_PACKED_KEY_NUM; ++i) {
+        const struct cvss_packed_key *k = &CVSS_PACKED_KEYS[i];
+        if (k->prefix_len != prefix_len || strncasecmp(k->values->vector_str, comp, prefix_len) != 0)
+            continue;
+        for (const struct cvss_valtab_entry *e = k->values; e->key == k->key; ++e)
+            if (strncasecmp(e->vector_str, comp, len) == 0 && e->vector_str[len] == '\0')
+                return e;
+        return NULL;
+    }
+    return NULL;
+}
+
+bool cvss_vector_pack(const char *vector, cvss_packed_vector *packed)
+{
+    assert(packed != NULL);
+    *packed = CVSS_PACKED_INVALID;
+    if (vector == NULL) return false;
+
+    (void)pthread_once(&cvss_packed_once, cvss_packed_init);
+
+    size_t len = strlen(vector);
+    // vector in parenthesis
+    if (vector[0] == '(') {
+        if (len < 2 || vector[len - 1] != ')') return false;
+        ++vector;
+        len -= 2;
+    }
+
+    const char *end = vector + len;
+    cvss_packed_vector ret = CVSS_PACKED_INVALID;
+    for (;;) {
+        const char *sep = memchr(vector, '/', end - vector);
+        const char *comp_end = sep ? sep : end;
+        const struct cvss_valtab_entry *entry = cvss_packed_component(vector, comp_end - vector);
+        if (entry == NULL) return false;
+        ret = cvss_packed_set(ret, entry->key, entry->value);
+        if (sep == NULL) break;
+        vector = sep + 1;
+    }
+
+    *packed = ret;
+    return true;
+}
+
+size_t cvss_vectors_pack(const char *const *vectors, size_t count, cvss_packed_vector *packed)
+{
+    size_t ok = 0;
+
+    for (size_t i = 0; i < count; ++i)
+        if (cvss_vector_pack(vectors[i], &packed[i]))
+            ++ok;
+    return ok;
+}
+
 struct cvss_impact *cvss_impact_new_from_vector(const char *cvss_vector)
 {
     struct cvss_impact *impact = cvss_impact_new();
@@ -344,19 +473,27 @@ char *cvss_impact_to_vector(const struct cvss_impact* impact)
     return result;
 }
 
-static unsigned cvss_impact_val(const struct cvss_impact *impact, enum cvss_key key)
+static cvss_packed_vector cvss_metrics_pack(cvss_packed_vector packed, const struct cvss_metrics *metrics)
 {
-    assert(impact != NULL);
-    assert(key != CVSS_KEY_NONE);
+    if (metrics == NULL) return packed;
 
-    const struct cvss_metrics *metric = *cvss_impact_metricsptr((/*const*/ struct cvss_impact *) impact, CVSS_CATEGORY(key));
-    if (metric == NULL) return -1;
-    return metric->metrics.ANY[CVSS_KEY_IDX(key)];
+    packed |= cvss_packed_flag(metrics->category);
+    for (size_t i = 0; i < cvss_metrics_component_num(metrics); ++i)
+        packed = cvss_packed_set(packed, metrics->category | i, metrics->metrics.ANY[i]);
+    return packed;
 }
 
-static inline const struct cvss_valtab_entry *cvss_impact_entry(const struct cvss_impact *impact, enum cvss_key key)
+cvss_packed_vector cvss_impact_pack(const struct cvss_impact *impact)
 {
-    return cvss_valtab(key, cvss_impact_val(impact, key), NULL, NULL);
+    assert(impact != NULL);
+
+    (void)pthread_once(&cvss_packed_once, cvss_packed_init);
+
+    cvss_packed_vector packed = CVSS_PACKED_INVALID;
+    packed = cvss_metrics_pack(packed, impact->base_metrics);
+    packed = cvss_metrics_pack(packed, impact->temporal_metrics);
+    packed = cvss_metrics_pack(packed, impact->environmental_metrics);
+    return packed;
 }
 
 void cvss_impact_free(struct cvss_impact* impact)
@@ -382,59 +519,69 @@ bool cvss_impact_set_metrics(struct cvss_impact* impact, struct cvss_metrics *me
     return true;
 }
 
-#define CVSS_W(key) (cvss_impact_entry(impact, CVSS_KEY_##key)->weight)
+static inline float cvss_packed_weight(cvss_packed_vector packed, enum cvss_key key)
+{
+    if (!(packed & cvss_packed_flag(CVSS_CATEGORY(key)))) return NAN;
+    unsigned slot = cvss_packed_slot(key);
+    return CVSS_PACKED_WEIGHTS[slot][(packed >> slot * CVSS_PACKED_VALUE_BITS) & CVSS_PACKED_VALUE_MASK];
+}
+
+#define CVSS_W(key) cvss_packed_weight(packed, CVSS_KEY_##key)
+
+// packed counterpart of cvss_metrics_is_valid()
+static inline bool cvss_packed_is_valid(cvss_packed_vector packed, enum cvss_category cat)
+{
+    if (!(packed & cvss_packed_flag(cat))) return false;
+
+    if (cat == CVSS_BASE)
+        for (size_t i = 0; i < CVSS_KEY_BASE_NUM; ++i)
+            if (((packed >> i * CVSS_PACKED_VALUE_BITS) & CVSS_PACKED_VALUE_MASK) == 0)
+                return false;
+
+    return true;
+}
 
 // round x to multiples of 0.1
 float cvss_round(float x) { return (int) round(x * 10.0 + 0.00001) / 10.0; }
 
-typedef float(*cvss_score_func)(const struct cvss_impact*);
-
-float cvss_impact_base_exploitability_subscore(const struct cvss_impact* impact)
+static float cvss_packed_base_exploitability_subscore(cvss_packed_vector packed)
 {
-    assert(impact);
     return 20 * CVSS_W(access_vector) * CVSS_W(access_complexity) * CVSS_W(authentication);
 }
 
-float cvss_impact_base_impact_subscore(const struct cvss_impact* impact)
+static float cvss_packed_base_impact_subscore(cvss_packed_vector packed)
 {
-    assert(impact);
     return 10.41 * (1.0 - (1.0 - CVSS_W(confidentiality_impact)) * (1.0 - CVSS_W(integrity_impact)) * (1.0 - CVSS_W(availability_impact)));
 }
 
-static inline float cvss_impact_base_score_impl(const struct cvss_impact* impact, cvss_score_func impact_score_calculator)
+static inline float cvss_packed_base_score_impl(cvss_packed_vector packed, float imp_s)
 {
-    assert(impact);
-    if (!cvss_metrics_is_valid(impact->base_metrics)) return NAN;
-    float imp_s = impact_score_calculator(impact);
-    float exp_s = cvss_impact_base_exploitability_subscore(impact);
+    if (!cvss_packed_is_valid(packed, CVSS_BASE)) return NAN;
+    float exp_s = cvss_packed_base_exploitability_subscore(packed);
     float f_imp = (imp_s == 0.0 ? 0.0 : 1.176);
     return cvss_round((0.6 * imp_s + 0.4 * exp_s - 1.5) * f_imp);
 }
 
-float cvss_impact_base_score(const struct cvss_impact* impact)
+static float cvss_packed_base_score(cvss_packed_vector packed)
 {
-    assert(impact);
-    return cvss_impact_base_score_impl(impact, cvss_impact_base_impact_subscore);
+    return cvss_packed_base_score_impl(packed, cvss_packed_base_impact_subscore(packed));
 }
 
-float cvss_impact_temporal_multiplier(const struct cvss_impact* impact)
+static float cvss_packed_temporal_multiplier(cvss_packed_vector packed)
 {
-    assert(impact);
-    if (!cvss_metrics_is_valid(impact->temporal_metrics)) return NAN;
+    if (!cvss_packed_is_valid(packed, CVSS_TEMPORAL)) return NAN;
     return CVSS_W(exploitability) * CVSS_W(remediation_level) * CVSS_W(report_confidence);
 }
 
-float cvss_impact_temporal_score(const struct cvss_impact* impact)
+static float cvss_packed_temporal_score(cvss_packed_vector packed)
 {
-    assert(impact);
-    if (!cvss_metrics_is_valid(impact->temporal_metrics)) return NAN;
-    return cvss_round(cvss_impact_base_score(impact) * cvss_impact_temporal_multiplier(impact));
+    if (!cvss_packed_is_valid(packed, CVSS_TEMPORAL)) return NAN;
+    return cvss_round(cvss_packed_base_score(packed) * cvss_packed_temporal_multiplier(packed));
 }
 
-float cvss_impact_base_adjusted_impact_subscore(const struct cvss_impact* impact)
+static float cvss_packed_base_adjusted_impact_subscore(cvss_packed_vector packed)
 {
-    assert(impact);
-    if (!cvss_metrics_is_valid(impact->environmental_metrics) || !cvss_metrics_is_valid(impact->base_metrics))
+    if (!cvss_packed_is_valid(packed, CVSS_ENVIRONMENTAL) || !cvss_packed_is_valid(packed, CVSS_BASE))
         return NAN;
 
     float c = CVSS_W(confidentiality_impact) * CVSS_W(confidentiality_requirement);
@@ -444,27 +591,57 @@ float cvss_impact_base_adjusted_impact_subscore(const struct cvss_impact* impact
     return imp <= 10.0 ? imp : 10.0;
 }
 
-float cvss_impact_adjusted_base_score(const struct cvss_impact* impact)
+static float cvss_packed_adjusted_base_score(cvss_packed_vector packed)
 {
-    assert(impact);
-    return cvss_impact_base_score_impl(impact, cvss_impact_base_adjusted_impact_subscore);
+    return cvss_packed_base_score_impl(packed, cvss_packed_base_adjusted_impact_subscore(packed));
 }
 
-float cvss_impact_adjusted_temporal_score(const struct cvss_impact* impact)
+static float cvss_packed_adjusted_temporal_score(cvss_packed_vector packed)
 {
-    assert(impact);
-    return cvss_round(cvss_impact_adjusted_base_score(impact) * cvss_impact_temporal_multiplier(impact));
+    return cvss_round(cvss_packed_adjusted_base_score(packed) * cvss_packed_temporal_multiplier(packed));
 }
 
-float cvss_impact_environmental_score(const struct cvss_impact* impact)
+static float cvss_packed_environmental_score(cvss_packed_vector packed)
 {
-    assert(impact);
-    if (!cvss_metrics_is_valid(impact->environmental_metrics)) return NAN;
-    float temp_s = cvss_impact_adjusted_temporal_score(impact);
+    if (!cvss_packed_is_valid(packed, CVSS_ENVIRONMENTAL)) return NAN;
+    float temp_s = cvss_packed_adjusted_temporal_score(packed);
     if (isnan(temp_s)) return NAN;
     return cvss_round((temp_s + (10.0 - temp_s) * CVSS_W(collateral_damage_potential)) * CVSS_W(target_distribution));
 }
 
+void cvss_packed_scores(const cvss_packed_vector *packed, size_t count, struct cvss_scores *scores)
+{
+    (void)pthread_once(&cvss_packed_once, cvss_packed_init);
+
+    for (size_t i = 0; i < count; ++i) {
+        struct cvss_scores *s = &scores[i];
+        s->base_exploitability_subscore  = cvss_packed_base_exploitability_subscore(packed[i]);
+        s->base_impact_subscore          = cvss_packed_base_impact_subscore(packed[i]);
+        s->base                          = cvss_packed_base_score(packed[i]);
+        s->temporal_multiplier           = cvss_packed_temporal_multiplier(packed[i]);
+        s->temporal                      = cvss_packed_temporal_score(packed[i]);
+        s->base_adjusted_impact_subscore = cvss_packed_base_adjusted_impact_subscore(packed[i]);
+        s->adjusted_base                 = cvss_packed_adjusted_base_score(packed[i]);
+        s->adjusted_temporal             = cvss_packed_adjusted_temporal_score(packed[i]);
+        s->environmental                 = cvss_packed_environmental_score(packed[i]);
+    }
+}
+
+// the cvss_impact score calculators work on the packed impact
+#define CVSS_IMPACT_SCORE(name) \
+    float cvss_impact_##name(const struct cvss_impact* impact) \
+    { assert(impact); return cvss_packed_##name(cvss_impact_pack(impact)); }
+
+CVSS_IMPACT_SCORE(base_exploitability_subscore)
+CVSS_IMPACT_SCORE(base_impact_subscore)
+CVSS_IMPACT_SCORE(base_score)
+CVSS_IMPACT_SCORE(temporal_multiplier)
+CVSS_IMPACT_SCORE(temporal_score)
+CVSS_IMPACT_SCORE(base_adjusted_impact_subscore)
+CVSS_IMPACT_SCORE(adjusted_base_score)
+CVSS_IMPACT_SCORE(adjusted_temporal_score)
+CVSS_IMPACT_SCORE(environmental_score)
+
 static void cvss_metrics_describe(const struct cvss_metrics *metrics, FILE *f)
 {
     if (metrics == NULL) return;
@@ -36,6 +36,8 @@
 #define _CVSSCALC_H_
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <time.h>
 #include <stdio.h>
 
@@ -311,6 +313,73 @@ float cvss_impact_environmental_score(const struct cvss_impact* impact);
 
 /** @} */
 
+/**
+ * @name Packed vectors
+ * Scoring of large amounts of CVSS vectors.
+ *
+ * A packed vector holds the values of all the vector components in a single
+ * integer, four bits per component, together with flags telling which of
+ * the metrics (base, temporal, environmental) are present. Vectors are packed
+ * and scored without any memory allocation and the weights of the values are
+ * looked up directly, so the functions are suitable for scoring whole feeds.
+ * The scores are the same as the ones calculated by the cvss_impact functions.
+ * @{
+ */
+
+/// CVSS vector packed to an integer
+typedef uint64_t cvss_packed_vector;
+
+/// Packed vector with no metrics, used for vectors which could not be parsed
+#define CVSS_PACKED_INVALID ((cvss_packed_vector) 0)
+
+/// All the scores of a CVSS vector, NAN for scores which can't be calculated
+struct cvss_scores {
+    float base_exploitability_subscore;  ///< @see cvss_impact_base_exploitability_subscore()
+    float base_impact_subscore;          ///< @see cvss_impact_base_impact_subscore()
+    float base;                          ///< @see cvss_impact_base_score()
+    float temporal_multiplier;           ///< @see cvss_impact_temporal_multiplier()
+    float temporal;                      ///< @see cvss_impact_temporal_score()
+    float base_adjusted_impact_subscore; ///< @see cvss_impact_base_adjusted_impact_subscore()
+    float adjusted_base;                 ///< @see cvss_impact_adjusted_base_score()
+    float adjusted_temporal;             ///< @see cvss_impact_adjusted_temporal_score()
+    float environmental;                 ///< @see cvss_impact_environmental_score()
+};
+
+/**
+ * Parse CVSS vector string to packed vector.
+ * Accepts the same vectors as cvss_impact_new_from_vector().
+ * @param vector CVSS vector, e.g. AV:N/AC:L/Au:N/C:P/I:P/A:P
+ * @param packed packed vector, set to CVSS_PACKED_INVALID on syntax error
+ * @return true on success, false if the vector is not valid
+ */
+bool cvss_vector_pack(const char *vector, cvss_packed_vector *packed);
+
+/**
+ * Parse an array of CVSS vector strings.
+ * Vectors which can't be parsed are packed to CVSS_PACKED_INVALID.
+ * @param vectors array of @a count vectors
+ * @param count number of vectors
+ * @param packed array of @a count packed vectors to fill
+ * @return number of successfully parsed vectors
+ */
+size_t cvss_vectors_pack(const char *const *vectors, size_t count, cvss_packed_vector *packed);
+
+/**
+ * Pack CVSS impact.
+ * @memberof cvss_impact
+ */
+cvss_packed_vector cvss_impact_pack(const struct cvss_impact *impact);
+
+/**
+ * Calculate all the scores of an array of packed vectors.
+ * @param packed array of @a count packed vectors
+ * @param count number of vectors
+ * @param scores array of @a count score sets to fill
+ */
+void cvss_packed_scores(const cvss_packed_vector *packed, size_t count, struct cvss_scores *scores);
+
+/** @} */
+
 /// @memberof cvss_metrics
 struct cvss_metrics *cvss_metrics_new(enum cvss_category category);
 /// @memberof cvss_metrics
@@ -37,9 +37,11 @@
 #include "ds_sds_session_priv.h"
 #include "sds_index_priv.h"
 #include "sds_priv.h"
+#include "sds_image_priv.h"
 #include "source/oscap_source_priv.h"
 #include "source/public/oscap_source.h"
 #include "source/xslt_priv.h"
+#include <ftw.h>
 #include <libgen.h>
 #include <libxml/tree.h>
 
@@ -51,6 +53,7 @@ struct ds_sds_session {
 	const char *datastream_id;              ///< ID of selected datastream
 	const char *checklist_id;               ///< ID of selected checklist
 	struct oscap_htable *component_sources;	///< oscap_source for parsed components
+	struct sds_image *image;                ///< Compiled image the components were loaded from
 };
 
 struct ds_sds_session *ds_sds_session_new_from_source(struct oscap_source *source)
@@ -74,6 +77,7 @@ void ds_sds_session_free(struct ds_sds_session *sds_session)
 			oscap_acquire_cleanup_dir(&(sds_session->temp_dir));
 		}
 		oscap_htable_free(sds_session->component_sources, (oscap_destruct_func) oscap_source_free);
+		sds_image_free(sds_session->image);
 		oscap_free(sds_session);
 	}
 }
@@ -85,6 +89,8 @@ void ds_sds_session_reset(struct ds_sds_session *session)
 	session->target_dir = NULL;
 	oscap_htable_free(session->component_sources, (oscap_destruct_func) oscap_source_free);
 	session->component_sources = oscap_htable_new();
+	sds_image_free(session->image);
+	session->image = NULL;
 }
 
 struct ds_sds_index *ds_sds_session_get_sds_idx(struct ds_sds_session *session)
@@ -225,6 +231,11 @@ xmlNode *ds_sds_session_get_selected_datastream(struct ds_sds_session *session)
 	return datastream;
 }
 
+struct oscap_source *ds_sds_session_get_source(struct ds_sds_session *session)
+{
+	return session->source;
+}
+
 xmlDoc *ds_sds_session_get_xmlDoc(struct ds_sds_session *session)
 {
 	return oscap_source_get_xmlDoc(session->source);
@@ -287,6 +298,74 @@ int ds_sds_session_dump_component_files(struct ds_sds_session *session)
 	return ds_dump_component_sources(session->component_sources);
 }
 
+static int _nftw_is_file(const char *fpath, const struct stat *sb, int typeflag, struct FTW *ftwbuf)
+{
+	return typeflag == FTW_F;
+}
+
+int ds_sds_session_compile(struct ds_sds_session *session, const char *target_file)
+{
+	if (session->checklist_id == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "No checklist has been selected from '%s'.",
+				oscap_source_readable_origin(session->source));
+		return -1;
+	}
+
+	struct ds_sds_index *sds_idx = ds_sds_session_get_sds_idx(session);
+	if (sds_idx == NULL) {
+		return -1;
+	}
+	struct ds_stream_index *stream_idx = ds_sds_index_get_stream(sds_idx, session->datastream_id);
+	struct oscap_string_iterator *cpe_it = ds_stream_index_get_dictionaries(stream_idx);
+	if (oscap_string_iterator_has_more(cpe_it)) {
+		if (ds_sds_session_register_component_with_dependencies(session, "dictionaries", NULL, NULL) != 0) {
+			oscap_string_iterator_free(cpe_it);
+			return -1;
+		}
+	}
+
+	// SCE scripts are dumped to the target directory instead of being kept
+	// in the session, the image wouldn't be complete without them.
+	if (session->target_dir != NULL && nftw(session->target_dir, _nftw_is_file, 16, FTW_PHYS) == 1) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Checklist '%s' from '%s' contains SCE scripts, these can't be compiled.",
+				session->checklist_id, oscap_source_readable_origin(session->source));
+		oscap_string_iterator_free(cpe_it);
+		return -1;
+	}
+
+	oscap_string_iterator_reset(cpe_it);
+	int ret = sds_image_write(session, cpe_it, target_file);
+	oscap_string_iterator_free(cpe_it);
+	return ret;
+}
+
+int ds_sds_session_load_compiled(struct ds_sds_session *session, const char *image_file, const char *datastream_id, const char *component_id)
+{
+	struct sds_image *image = sds_image_open(image_file);
+	if (image == NULL) {
+		return -1;
+	}
+	int matches = sds_image_matches(image, session->source, datastream_id, component_id);
+	if (matches != 1) {
+		sds_image_free(image);
+		return matches == 0 ? 1 : -1;
+	}
+	ds_sds_session_reset(session);
+	session->image = image;
+	session->datastream_id = sds_image_get_datastream_id(image);
+	session->checklist_id = sds_image_get_checklist_id(image);
+	if (sds_image_register_components(image, session) != 0) {
+		ds_sds_session_reset(session);
+		return -1;
+	}
+	return 0;
+}
+
+struct oscap_string_iterator *ds_sds_session_get_compiled_dictionaries(struct ds_sds_session *session)
+{
+	return session->image != NULL ? sds_image_get_dictionaries(session->image) : NULL;
+}
+
 char *ds_sds_session_get_html_guide(struct ds_sds_session *session, const char *profile_id)
 {
 	const char *params[] = {
@@ -34,10 +34,13 @@
 OSCAP_HIDDEN_START;
 
 xmlNode *ds_sds_session_get_selected_datastream(struct ds_sds_session *session);
+struct oscap_source *ds_sds_session_get_source(struct ds_sds_session *session);
 xmlDoc *ds_sds_session_get_xmlDoc(struct ds_sds_session *session);
 int ds_sds_session_register_component_source(struct ds_sds_session *session, const char *relative_filepath, struct oscap_source *component);
 const char *ds_sds_session_get_target_dir(struct ds_sds_session *session);
 struct oscap_htable *ds_sds_session_get_component_sources(struct ds_sds_session *session);
+/// Hrefs of CPE dictionaries if the session was loaded from a compiled image, NULL otherwise
+struct oscap_string_iterator *ds_sds_session_get_compiled_dictionaries(struct ds_sds_session *session);
 
 OSCAP_HIDDEN_END;
 #endif
@@ -172,6 +172,38 @@ int ds_sds_session_set_target_dir(struct ds_sds_session *session, const char *ta
  */
 void ds_sds_session_reset(struct ds_sds_session *session);
 
+/**
+ * Store the selected checklist with all its dependencies and the CPE
+ * dictionaries of the selected datastream to a compiled image. Loading the
+ * image with ds_sds_session_load_compiled skips splitting of the collection.
+ * The caller is responsible for validating the collection beforehand.
+ * Only collections read from uncompressed files can be compiled.
+ * @memberof ds_sds_session
+ * @param session The Source DataStream session with a checklist selected
+ * by ds_sds_session_select_checklist
+ * @param target_file Path of the image to write
+ * @returns 0 on success
+ */
+int ds_sds_session_compile(struct ds_sds_session *session, const char *target_file);
+
+/**
+ * Load components from an image created by ds_sds_session_compile instead
+ * of extracting them from the collection. The image is used only if it was
+ * compiled from the current content of the collection file and with the
+ * requested selection. On success the session is reset, the datastream and
+ * the checklist of the image are selected and the components become
+ * available through ds_sds_session_get_component_by_href.
+ * @memberof ds_sds_session
+ * @param session The Source DataStream session
+ * @param image_file Path to the compiled image
+ * @param datastream_id ID of the requested datastream or NULL
+ * @param component_id ID of the requested checklist component-ref or NULL
+ * @returns 0 if the image was loaded, 1 if it doesn't match the collection
+ * or the selection, -1 on error or if the collection is not read from an
+ * uncompressed file
+ */
+int ds_sds_session_load_compiled(struct ds_sds_session *session, const char *image_file, const char *datastream_id, const char *component_id);
+
 /**
  * Returns HTML representation of selected checklist in form of OpenSCAP guide.
  * @memberof ds_sds_session
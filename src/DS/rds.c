@@ -44,9 +44,12 @@
 #include <time.h>
 #include <libgen.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <libxml/parser.h>
 #include <libxml/tree.h>
+#include <libxml/xmlreader.h>
+#include <libxml/xmlwriter.h>
 #include <libxml/xpath.h>
 #include <libxml/xpathInternals.h>
 
@@ -222,165 +225,31 @@ xmlNodePtr ds_rds_create_report(xmlDocPtr target_doc, xmlNodePtr reports_node, x
 	return report;
 }
 
-static void ds_rds_add_relationship(xmlDocPtr doc, xmlNodePtr relationships,
-		const char* type, const char* subject, const char* ref)
-{
-	xmlNsPtr core_ns = xmlSearchNsByHref(doc, xmlDocGetRootElement(doc), BAD_CAST core_ns_uri);
-
-	// create relationship between given request and the report
-	xmlNodePtr relationship = xmlNewNode(core_ns, BAD_CAST "relationship");
-	xmlSetProp(relationship, BAD_CAST "type", BAD_CAST type);
-	xmlSetProp(relationship, BAD_CAST "subject", BAD_CAST subject);
-
-	xmlNodePtr ref_node = xmlNewNode(core_ns, BAD_CAST "ref");
-	xmlNodeSetContent(ref_node, BAD_CAST ref);
-	xmlAddChild(relationship, ref_node);
-
-	xmlAddChild(relationships, relationship);
-}
-
-static xmlNodePtr ds_rds_add_ai_from_xccdf_results(xmlDocPtr doc, xmlNodePtr assets,
-		xmlDocPtr xccdf_result_doc)
-{
-	xmlNsPtr arf_ns = xmlSearchNsByHref(doc, xmlDocGetRootElement(doc), BAD_CAST arf_ns_uri);
-	xmlNsPtr ai_ns = xmlSearchNsByHref(doc, xmlDocGetRootElement(doc), BAD_CAST ai_ns_uri);
-
-	xmlNodePtr asset = xmlNewNode(arf_ns, BAD_CAST "asset");
-
-	// Lets figure out a unique asset identification
-	// The format is: "asset%i" where %i is a increasing integer suffix
-	//
-	// We use a very simple optimization, we know that assets will be "ordered"
-	// by their @id because we are adding them there in that order.
-	// Whenever we get a collision we can simply bump the suffix and continue,
-	// no need to go back and check the previous assets.
-
-	xmlNodePtr child_asset = assets->children;
-
-	unsigned int suffix = 0;
-	for (; child_asset != NULL; child_asset = child_asset->next)
-	{
-		if (child_asset->type != XML_ELEMENT_NODE)
-			continue;
-
-		if (strcmp((const char*)(child_asset->name), "asset") != 0)
-			continue;
-
-		char* id_candidate = oscap_sprintf("asset%i", suffix);
-		xmlChar* id = xmlGetProp(child_asset, BAD_CAST "id");
-
-		if (strcmp(id_candidate, (const char*)id) == 0)
-		{
-			suffix++;
-		}
-		xmlFree(id);
-		oscap_free(id_candidate);
-	}
-
-	char* id = oscap_sprintf("asset%i", suffix);
-	xmlSetProp(asset, BAD_CAST "id", BAD_CAST id);
-	oscap_free(id);
-
-	xmlAddChild(assets, asset);
-
-	xmlNodePtr computing_device = xmlNewNode(ai_ns, BAD_CAST "computing-device");
-	xmlAddChild(asset, computing_device);
-
-	xmlNodePtr connections = xmlNewNode(ai_ns, BAD_CAST "connections");
-	xmlAddChild(computing_device, connections);
-
-	xmlNodePtr test_result = xmlDocGetRootElement(xccdf_result_doc);
-
-	xmlNodePtr test_result_child = test_result->children;
-
-	xmlNodePtr last_fqdn = NULL;
-	for (; test_result_child != NULL; test_result_child = test_result_child->next)
-	{
-		if (test_result_child->type != XML_ELEMENT_NODE)
-			continue;
-
-		// Order for the output to be valid:
-		// 1) All fqdn-s
-		// 2) All hostnames
-		if (strcmp((const char*)(test_result_child->name), "target") == 0)
-		{
-			// content is a full copy
-			char *content = (char*)xmlNodeGetContent(test_result_child);
-			xmlNodePtr fqdn = xmlNewNode(ai_ns, BAD_CAST "fqdn");
-			xmlNodeSetContent(fqdn, BAD_CAST content);
-
-			if (!last_fqdn) {
-				xmlAddChild(computing_device, fqdn);
-			}
-			else {
-				xmlAddNextSibling(last_fqdn, fqdn);
-			}
-			last_fqdn = fqdn;
-
-			// now we need to change content so that it represents just the hostname part of FQDN
-			char *delimiter = strchr(content, '.');
-			if (delimiter)
-				*delimiter = '\0';
-
-			xmlNewTextChild(computing_device, ai_ns, BAD_CAST "hostname", BAD_CAST content);
-
-			free(content);
-		}
-		else if (strcmp((const char*)(test_result_child->name), "target-address") == 0)
-		{
-			xmlNodePtr connection = xmlNewNode(ai_ns, BAD_CAST "connection");
-			xmlAddChild(connections, connection);
-			xmlNodePtr ip_address = xmlNewNode(ai_ns, BAD_CAST "ip-address");
-			xmlAddChild(connection, ip_address);
-
-			xmlChar* content = xmlNodeGetContent(test_result_child);
-
-			// we need to figure out whether the address is IPv4 or IPv6
-			if (strchr((char*)content, '.') != NULL) // IPv4 has to have 4 dots
-			{
-				xmlNewTextChild(ip_address, ai_ns, BAD_CAST "ip-v4", content);
-			}
-			else // IPv6 has semicolons instead of dots
-			{
-				// lets expand the IPv6 to conform to the AI XSD and specification
-				char *expanded_ipv6 = oscap_expand_ipv6((const char*)content);
-				xmlNewTextChild(ip_address, ai_ns, BAD_CAST "ip-v6", BAD_CAST expanded_ipv6);
-				oscap_free(expanded_ipv6);
-			}
-			xmlFree(content);
-		}
-		else if (strcmp((const char*)(test_result_child->name), "target-facts") == 0)
-		{
-			xmlNodePtr target_fact_child = test_result_child->children;
-
-			for (; target_fact_child != NULL; target_fact_child = target_fact_child->next)
-			{
-				if (target_fact_child->type != XML_ELEMENT_NODE)
-					continue;
-
-				if (strcmp((const char*)(target_fact_child->name), "fact") != 0)
-					continue;
-
-				xmlChar *name = xmlGetProp(target_fact_child, BAD_CAST "name");
-				if (!name || strcmp((const char*)name, "urn:xccdf:fact:ethernet:MAC") != 0) {
-					xmlFree(name);
-					continue;
-				}
-				xmlFree(name);
-
-				xmlChar *content = xmlNodeGetContent(target_fact_child);
-				xmlNodePtr connection = xmlNewNode(ai_ns, BAD_CAST "connection");
-				xmlAddChild(connections, connection);
-				xmlNewTextChild(connection, ai_ns, BAD_CAST "mac-address", content);
-				xmlFree(content);
-			}
-		}
-	}
+/*
+ * The ARF is written by xmlTextWriter. The report request and the reports are
+ * copied into it node by node straight from their oscap_sources, so neither
+ * the source datastream nor the results get cloned into a new document.
+ * Sources which haven't been parsed yet are streamed from their raw content.
+ */
 
-	return asset;
-}
+// level of the root elements of arf:content, the indentation follows xmlsave
+#define DS_RDS_CONTENT_LEVEL 4
+#define DS_RDS_MAX_INDENT 60
 
-static int ds_rds_report_inject_ai_target_id_ref(xmlDocPtr doc, xmlNodePtr test_result_node, const char *asset_id)
+/*
+ * TestResult written as an XCCDF report, together with the asset it is about.
+ * The TestResult gets a target-id-ref of the asset and its check-content-refs
+ * get @href pointing to the report.
+ */
+struct ds_rds_xccdf_report {
+	xmlNodePtr test_result;
+	xmlNodePtr target_id_ref_after;	///< the node target-id-ref is written after, or NULL
+	char *id;
+	char *asset_id;
+	char *href;
+};
+
+static xmlNodePtr ds_rds_target_id_ref_position(xmlNodePtr test_result_node, const char *asset_id)
 {
 	// Now we need to find the right place to inject the target-id-ref element.
 	// It has to come after target, target-address and target-facts elements.
@@ -406,7 +275,7 @@ static int ds_rds_report_inject_ai_target_id_ref(xmlDocPtr doc, xmlNodePtr test_
 		oscap_seterr(OSCAP_EFAMILY_XML, "No target element was found in TestResult. "
 			"The most likely reason is that the content is not valid! "
 			"(XCCDF spec states 'target' element as required)");
-		return -1;
+		return NULL;
 	}
 
 	// We have to make sure we are not injecting a target-id-ref that is there
@@ -423,7 +292,7 @@ static int ds_rds_report_inject_ai_target_id_ref(xmlDocPtr doc, xmlNodePtr test_
 
 					xmlFree(system_attr);
 					xmlFree(name_attr);
-					return 0;
+					return NULL;
 				}
 
 				xmlFree(system_attr);
@@ -436,323 +305,589 @@ static int ds_rds_report_inject_ai_target_id_ref(xmlDocPtr doc, xmlNodePtr test_
 		duplicate_candidate = duplicate_candidate->next;
 	}
 
-	xmlNodePtr target_id_ref = xmlNewNode(prev_sibling->ns, BAD_CAST "target-id-ref");
-	xmlNewProp(target_id_ref, BAD_CAST "system", BAD_CAST ai_ns_uri);
-	xmlNewProp(target_id_ref, BAD_CAST "name", BAD_CAST asset_id);
-	// @href is a required attribute by the XSD! The spec advocates filling it
-	// blank when it's not needed.
-	xmlNewProp(target_id_ref, BAD_CAST "href", BAD_CAST "");
+	return prev_sibling;
+}
 
-	xmlAddNextSibling(prev_sibling, target_id_ref);
+static void ds_rds_xccdf_report_init(struct ds_rds_xccdf_report *report, xmlNodePtr test_result, unsigned int index)
+{
+	report->test_result = test_result;
+	report->id = oscap_sprintf("xccdf%u", index + 1);
+	report->asset_id = oscap_sprintf("asset%u", index);
+	/*
+	 * All check-content-ref/@href are replaced with "#" + id of the report.
+	 * Doing this replaces potentially valuable data with a value easily
+	 * calculated from the XML.
+	 *
+	 * The only reason we do this is to pass requirement 370-1.
+	 *
+	 * TODO: Consider dropping this functionality if 370-1 is changed / clarified.
+	 */
+	report->href = oscap_sprintf("#%s", report->id);
+	// We deliberately don't act on errors here as these aren't fatal errors.
+	report->target_id_ref_after = ds_rds_target_id_ref_position(test_result, report->asset_id);
+}
 
-	return 0;
+static void ds_rds_xccdf_reports_free(struct ds_rds_xccdf_report *reports, size_t count)
+{
+	for (size_t i = 0; i < count; ++i) {
+		oscap_free(reports[i].id);
+		oscap_free(reports[i].asset_id);
+		oscap_free(reports[i].href);
+	}
+	oscap_free(reports);
 }
 
-static void ds_rds_report_inject_rule_result_check_refs(xmlDocPtr doc, xmlNodePtr rule_result, char *desired_href)
+static size_t ds_rds_xccdf_reports_new(xmlDocPtr xccdf_result_file_doc, struct ds_rds_xccdf_report **ret)
 {
-	xmlNodePtr child = rule_result->children;
+	xmlNodePtr root_element = xmlDocGetRootElement(xccdf_result_file_doc);
+	struct ds_rds_xccdf_report *reports = NULL;
+	size_t count = 0;
 
-	while (child) {
-		if (child->type == XML_ELEMENT_NODE) {
-			if (strcmp((const char*)child->name, "check") == 0) {
-				xmlNodePtr check_content_ref = child->children;
+	// There are 2 possible scenarios here:
 
-				while (check_content_ref) {
-					if (check_content_ref->type == XML_ELEMENT_NODE) {
-						if (strcmp((const char*)check_content_ref->name, "check-content-ref") == 0) {
-							xmlSetProp(check_content_ref, BAD_CAST "href", BAD_CAST desired_href);
-						}
-					}
+	// 1) root element of given xccdf result file doc is a TestResult element
+	// This is the easier scenario, it is the only report.
+	if (strcmp((const char*)root_element->name, "TestResult") == 0)
+	{
+		reports = oscap_calloc(1, sizeof(struct ds_rds_xccdf_report));
+		ds_rds_xccdf_report_init(&reports[count++], root_element, 0);
+	}
 
-					check_content_ref = check_content_ref->next;
-				}
-			}
+	// 2) the root element is a Benchmark, TestResults are embedded within
+	// Each TestResult becomes a separate report.
+	else if (strcmp((const char*)root_element->name, "Benchmark") == 0)
+	{
+		xmlNodePtr candidate_result = root_element->children;
+
+		for (; candidate_result != NULL; candidate_result = candidate_result->next)
+		{
+			if (candidate_result->type != XML_ELEMENT_NODE)
+				continue;
+
+			if (strcmp((const char*)(candidate_result->name), "TestResult") != 0)
+				continue;
+
+			reports = oscap_realloc(reports, (count + 1) * sizeof(struct ds_rds_xccdf_report));
+			ds_rds_xccdf_report_init(&reports[count], candidate_result, count);
+			count++;
 		}
+	}
 
-		child = child->next;
+	else
+	{
+		char* error = oscap_sprintf(
+				"Unknown root element '%s' in given XCCDF result document, expected TestResult or Benchmark.",
+				(const char*)root_element->name);
+
+		oscap_seterr(OSCAP_EFAMILY_XML, 0, error);
+		oscap_free(error);
 	}
+
+	*ret = reports;
+	return count;
+}
+
+static char *ds_rds_qname(xmlNsPtr ns, const xmlChar *name)
+{
+	if (ns != NULL && ns->prefix != NULL)
+		return oscap_sprintf("%s:%s", (const char*)ns->prefix, (const char*)name);
+	return oscap_strdup((const char*)name);
+}
+
+static void ds_rds_write_ns(xmlTextWriterPtr writer, xmlNsPtr ns)
+{
+	if (ns->prefix == NULL) {
+		xmlTextWriterWriteAttribute(writer, BAD_CAST "xmlns", ns->href);
+	}
+	else if (strcmp((const char*)ns->prefix, "xml") != 0) {
+		char *name = oscap_sprintf("xmlns:%s", (const char*)ns->prefix);
+		xmlTextWriterWriteAttribute(writer, BAD_CAST name, ns->href);
+		oscap_free(name);
+	}
+}
+
+static void ds_rds_write_newline(xmlTextWriterPtr writer, int level)
+{
+	char indent[DS_RDS_MAX_INDENT + 2];
+	int len = 2 * level > DS_RDS_MAX_INDENT ? DS_RDS_MAX_INDENT : 2 * level;
+
+	indent[0] = '\n';
+	memset(indent + 1, ' ', len);
+	indent[len + 1] = '\0';
+	xmlTextWriterWriteRaw(writer, BAD_CAST indent);
 }
 
 /*
- * This function replaces all check-content-ref/@href with "#" + id of ancestor arf:report.
- * Doing this replaces potentially valuable data with a value easily calculated from the XML.
- *
- * The only reason we do this is to pass requirement 370-1.
- *
- * TODO: Consider dropping this functionality if 370-1 is changed / clarified.
+ * xmlTextWriterWriteString() escapes quotes too, text is escaped the same
+ * way as xmlsave does it so that copied content doesn't change.
  */
-static void ds_rds_report_inject_rule_result_refs(xmlDocPtr doc, xmlNodePtr test_result_node, char *report_id)
+static void ds_rds_write_text(xmlTextWriterPtr writer, const xmlChar *text)
 {
-	char *desired_href = oscap_sprintf("#%s", report_id);
-
-	xmlNodePtr child = test_result_node->children;
-	while (child) {
-		if (child->type == XML_ELEMENT_NODE) {
-			if (strcmp((const char*)child->name, "rule-result") == 0) {
-				ds_rds_report_inject_rule_result_check_refs(doc, child, desired_href);
-			}
+	size_t len = 0;
+	for (const xmlChar *c = text; *c != '\0'; ++c)
+		len += (*c == '&') ? 5 : (*c == '<' || *c == '>') ? 4 : (*c == '\r') ? 5 : 1;
+
+	char *escaped = oscap_alloc(len + 1);
+	char *out = escaped;
+	for (const xmlChar *c = text; *c != '\0'; ++c) {
+		switch (*c) {
+		case '&':  memcpy(out, "&amp;", 5); out += 5; break;
+		case '<':  memcpy(out, "&lt;", 4); out += 4; break;
+		case '>':  memcpy(out, "&gt;", 4); out += 4; break;
+		case '\r': memcpy(out, "&#13;", 5); out += 5; break;
+		default:   *out++ = *c; break;
 		}
-
-		child = child->next;
 	}
-
-	oscap_free(desired_href);
+	*out = '\0';
+	xmlTextWriterWriteRaw(writer, BAD_CAST escaped);
+	oscap_free(escaped);
 }
 
-static int ds_rds_report_inject_refs(xmlDocPtr doc, xmlNodePtr report, const char *asset_id)
+static bool ds_rds_is_check_content_ref(xmlNodePtr node, xmlNodePtr test_result)
 {
-	xmlNodePtr content_node = ds_rds_get_inner_content(doc, report);
+	if (strcmp((const char*)node->name, "check-content-ref") != 0)
+		return false;
 
-	if (!content_node)
-		return -1;
+	xmlNodePtr check = node->parent;
+	if (check == NULL || strcmp((const char*)check->name, "check") != 0)
+		return false;
 
-	if (!content_node->children) {
-		oscap_seterr(OSCAP_EFAMILY_XML, "Given report doesn't contain any data, "
-			"can't inject AI asset target id ref");
-		return -1;
-	}
+	xmlNodePtr rule_result = check->parent;
+	if (rule_result == NULL || strcmp((const char*)rule_result->name, "rule-result") != 0)
+		return false;
 
-	xmlNodePtr test_result_node = NULL;
-	xmlNodePtr test_result_candidate = content_node->children;
-	xmlNodePtr inner_element_node = NULL;
+	return rule_result->parent == test_result;
+}
 
-	while (test_result_candidate) {
-		if (test_result_candidate->type == XML_ELEMENT_NODE) {
-			inner_element_node = test_result_candidate;
+static bool ds_rds_ns_used(xmlNodePtr node, xmlNsPtr ns)
+{
+	if (node->ns == ns)
+		return true;
+	for (xmlAttrPtr attr = node->properties; attr != NULL; attr = attr->next) {
+		if (attr->ns == ns)
+			return true;
+	}
+	for (xmlNodePtr child = node->children; child != NULL; child = child->next) {
+		if (child->type == XML_ELEMENT_NODE && ds_rds_ns_used(child, ns))
+			return true;
+	}
+	return false;
+}
 
-			if (strcmp((const char*)test_result_candidate->name, "TestResult") == 0) {
-				test_result_node = test_result_candidate;
-				break;
-			}
+static void ds_rds_write_start_element(xmlTextWriterPtr writer, xmlNodePtr node, bool top, const struct ds_rds_xccdf_report *report)
+{
+	char *name = ds_rds_qname(node->ns, node->name);
+	xmlTextWriterStartElement(writer, BAD_CAST name);
+	oscap_free(name);
+
+	// The top element has to declare the namespaces of its ancestors
+	// in the source which are used, the ancestors aren't copied.
+	if (top) {
+		bool nested = node->parent != NULL && node->parent->type == XML_ELEMENT_NODE;
+		xmlNsPtr *ns_list = xmlGetNsList(node->doc, node);
+		for (xmlNsPtr *ns = ns_list; ns != NULL && *ns != NULL; ns++) {
+			if (!nested || ds_rds_ns_used(node, *ns))
+				ds_rds_write_ns(writer, *ns);
 		}
-
-		test_result_candidate = test_result_candidate->next;
+		xmlFree(ns_list);
+	}
+	else {
+		for (xmlNsPtr ns = node->nsDef; ns != NULL; ns = ns->next)
+			ds_rds_write_ns(writer, ns);
 	}
 
-	if (!inner_element_node) {
-		oscap_seterr(OSCAP_EFAMILY_XML, "Given report doesn't contain any XML element! "
-			"Can't inject AI asset target id ref");
-		return -1;
+	bool replace_href = report != NULL && ds_rds_is_check_content_ref(node, report->test_result);
+	for (xmlAttrPtr attr = node->properties; attr != NULL; attr = attr->next) {
+		if (replace_href && attr->ns == NULL && strcmp((const char*)attr->name, "href") == 0) {
+			xmlTextWriterWriteAttribute(writer, BAD_CAST "href", BAD_CAST report->href);
+			replace_href = false;
+			continue;
+		}
+
+		char *attr_name = ds_rds_qname(attr->ns, attr->name);
+		xmlChar *value = xmlNodeListGetString(node->doc, attr->children, 1);
+		xmlTextWriterWriteAttribute(writer, BAD_CAST attr_name, value != NULL ? value : BAD_CAST "");
+		xmlFree(value);
+		oscap_free(attr_name);
 	}
+	if (replace_href)
+		xmlTextWriterWriteAttribute(writer, BAD_CAST "href", BAD_CAST report->href);
+}
 
-	if (!test_result_node) {
-		// TestResult may not be the top level element in the report.
-		// While that is very unusual it is legitimate, lets check child elements.
+static void ds_rds_write_target_id_ref(xmlTextWriterPtr writer, xmlNodePtr prev_sibling, const char *asset_id)
+{
+	char *name = ds_rds_qname(prev_sibling->ns, BAD_CAST "target-id-ref");
+	xmlTextWriterStartElement(writer, BAD_CAST name);
+	oscap_free(name);
+	xmlTextWriterWriteAttribute(writer, BAD_CAST "system", BAD_CAST ai_ns_uri);
+	xmlTextWriterWriteAttribute(writer, BAD_CAST "name", BAD_CAST asset_id);
+	// @href is a required attribute by the XSD! The spec advocates filling it
+	// blank when it's not needed.
+	xmlTextWriterWriteAttribute(writer, BAD_CAST "href", BAD_CAST "");
+	xmlTextWriterEndElement(writer);
+}
 
-		// As a rule, we only inject target-id-ref to the last test result
-		// (XML, top-down).
+/*
+ * Children of a DOM element are indented by us only when neither it nor
+ * any of its ancestors contain text, the same way as xmlsave does it.
+ */
+static bool ds_rds_format_children(xmlNodePtr node)
+{
+	for (xmlNodePtr child = node->children; child != NULL; child = child->next) {
+		if (child->type == XML_TEXT_NODE ||
+			child->type == XML_CDATA_SECTION_NODE ||
+			child->type == XML_ENTITY_REF_NODE)
+			return false;
+	}
+	return true;
+}
 
-		if (strcmp((const char*)inner_element_node->name, "Benchmark")) {
-			oscap_seterr(OSCAP_EFAMILY_XML, "Top level element of the report isn't TestResult "
-				"or Benchmark, the report is likely invalid!");
-			return -1;
-		}
+static bool ds_rds_is_ancestor(xmlNodePtr ancestor, xmlNodePtr node)
+{
+	for (xmlNodePtr parent = node->parent; parent != NULL; parent = parent->parent) {
+		if (parent == ancestor)
+			return true;
+	}
+	return false;
+}
 
-		if (!inner_element_node->children) {
-			oscap_seterr(OSCAP_EFAMILY_XML, "Top level element of the report isn't TestResult "
-				"and does not contain any children! No TestResult to inject to has been found.");
-			return -1;
+/*
+ * Move the reader to the given element, or to the root element if NULL
+ * is given. Only elements of a DOM walked by the reader can be given.
+ */
+static int ds_rds_reader_seek(xmlTextReaderPtr reader, xmlNodePtr element)
+{
+	int ret = xmlTextReaderRead(reader);
+	while (ret == 1) {
+		if (xmlTextReaderNodeType(reader) == XML_READER_TYPE_ELEMENT) {
+			xmlNodePtr current = xmlTextReaderCurrentNode(reader);
+			if (element == NULL || current == element)
+				return 1;
+			if (ds_rds_is_ancestor(current, element)) {
+				ret = xmlTextReaderRead(reader);
+				continue;
+			}
 		}
+		ret = xmlTextReaderNext(reader);
+	}
+	return ret;
+}
 
-		test_result_candidate = inner_element_node->children;
-		while (test_result_candidate) {
-			if (test_result_candidate->type == XML_ELEMENT_NODE) {
-				if (strcmp((const char*)test_result_candidate->name, "TestResult") == 0) {
-					test_result_node = test_result_candidate;
-					// we intentionally do not break here, we are looking for the
-					// last (top-down) TestResult in the report.
-					//break;
-				}
+/*
+ * Copy the element the reader is at, including its subtree. Children are
+ * indented only if `format' is set, which is meant for readers walking
+ * a DOM. The report is given when the element is its TestResult.
+ */
+static int ds_rds_write_element(xmlTextWriterPtr writer, xmlTextReaderPtr reader, bool format, const struct ds_rds_xccdf_report *report)
+{
+	const int top_depth = xmlTextReaderDepth(reader);
+	// formatted[depth] tells whether children of the open element are indented
+	size_t formatted_size = 32;
+	bool *formatted = oscap_calloc(formatted_size, sizeof(bool));
+	bool done = false;
+
+	while (!done) {
+		xmlNodePtr node = xmlTextReaderCurrentNode(reader);
+		int depth = xmlTextReaderDepth(reader) - top_depth;
+		int level = DS_RDS_CONTENT_LEVEL + depth;
+		bool indent = depth > 0 && formatted[depth - 1];
+		bool closed = false;
+
+		switch (xmlTextReaderNodeType(reader)) {
+		case XML_READER_TYPE_ELEMENT:
+			if (indent)
+				ds_rds_write_newline(writer, level);
+			ds_rds_write_start_element(writer, node, depth == 0, report);
+			if (xmlTextReaderIsEmptyElement(reader)) {
+				xmlTextWriterEndElement(writer);
+				closed = true;
+				break;
 			}
-
-			test_result_candidate = test_result_candidate->next;
+			if ((size_t) depth >= formatted_size) {
+				formatted_size *= 2;
+				formatted = oscap_realloc(formatted, formatted_size * sizeof(bool));
+			}
+			formatted[depth] = format && (depth == 0 || formatted[depth - 1]) && ds_rds_format_children(node);
+			break;
+		case XML_READER_TYPE_END_ELEMENT:
+			if (formatted[depth])
+				ds_rds_write_newline(writer, level);
+			xmlTextWriterEndElement(writer);
+			closed = true;
+			break;
+		case XML_READER_TYPE_TEXT:
+		case XML_READER_TYPE_WHITESPACE:
+		case XML_READER_TYPE_SIGNIFICANT_WHITESPACE:
+			ds_rds_write_text(writer, xmlTextReaderConstValue(reader));
+			break;
+		case XML_READER_TYPE_CDATA:
+			xmlTextWriterWriteCDATA(writer, xmlTextReaderConstValue(reader));
+			break;
+		case XML_READER_TYPE_COMMENT:
+			if (indent)
+				ds_rds_write_newline(writer, level);
+			xmlTextWriterWriteComment(writer, xmlTextReaderConstValue(reader));
+			break;
+		case XML_READER_TYPE_PROCESSING_INSTRUCTION:
+			if (indent)
+				ds_rds_write_newline(writer, level);
+			xmlTextWriterWritePI(writer, xmlTextReaderConstName(reader), xmlTextReaderConstValue(reader));
+			break;
+		case XML_READER_TYPE_ENTITY_REFERENCE: {
+			// there is no DTD in ARF, the entity is substituted
+			xmlChar *content = xmlNodeGetContent(node);
+			if (content != NULL)
+				ds_rds_write_text(writer, content);
+			xmlFree(content);
+			break;
+		}
+		default:
+			break;
 		}
-	}
 
-	if (!test_result_node) {
-		oscap_seterr(OSCAP_EFAMILY_XML, "TestResult node to inject to has not been found"
-			"(checked root element and all children of it).");
-		return -1;
+		if (closed) {
+			if (report != NULL && node == report->target_id_ref_after) {
+				if (indent)
+					ds_rds_write_newline(writer, level);
+				ds_rds_write_target_id_ref(writer, node, report->asset_id);
+			}
+			done = depth == 0;
+		}
+		if (!done && xmlTextReaderRead(reader) != 1)
+			break;
 	}
 
-	int ret = ds_rds_report_inject_ai_target_id_ref(doc, test_result_node, asset_id);
-
-	char *report_id = (char*)xmlGetProp(report, BAD_CAST "id");
-	ds_rds_report_inject_rule_result_refs(doc, test_result_node, report_id);
-	xmlFree(report_id);
+	oscap_free(formatted);
+	return done ? 0 : -1;
+}
 
+/*
+ * Write given element with @id containing arf:content with the root element
+ * read from the reader, or the given element of the DOM walked by the reader.
+ */
+static int ds_rds_write_content(xmlTextWriterPtr writer, const char *element_name, const char *id,
+		xmlTextReaderPtr reader, xmlNodePtr node, bool format, const struct ds_rds_xccdf_report *report)
+{
+	xmlTextWriterStartElement(writer, BAD_CAST element_name);
+	xmlTextWriterWriteAttribute(writer, BAD_CAST "id", BAD_CAST id);
+	xmlTextWriterStartElement(writer, BAD_CAST "arf:content");
+
+	// indentation of the writer would break mixed content of the copied element
+	xmlTextWriterSetIndent(writer, 0);
+	ds_rds_write_newline(writer, DS_RDS_CONTENT_LEVEL);
+	int ret = ds_rds_reader_seek(reader, node) == 1 ? ds_rds_write_element(writer, reader, format, report) : -1;
+	// the writer indents the end tag itself
+	ds_rds_write_newline(writer, 0);
+	xmlTextWriterSetIndent(writer, 1);
+
+	xmlTextWriterEndElement(writer);
+	xmlTextWriterEndElement(writer);
 	return ret;
 }
 
-static void ds_rds_add_xccdf_test_results(xmlDocPtr doc, xmlNodePtr reports,
-		xmlDocPtr xccdf_result_file_doc, xmlNodePtr relationships, xmlNodePtr assets,
-		const char* report_request_id)
+static int ds_rds_write_source_content(xmlTextWriterPtr writer, const char *element_name, const char *id, struct oscap_source *source)
 {
-	xmlNodePtr root_element = xmlDocGetRootElement(xccdf_result_file_doc);
-
-	// There are 2 possible scenarios here:
+	xmlTextReaderPtr reader = oscap_source_get_streaming_xmlTextReader(source);
+	if (reader == NULL)
+		return -1;
 
-	// 1) root element of given xccdf result file doc is a TestResult element
-	// This is the easier scenario, we will just use ds_rds_create_report and
-	// be done with it.
-	if (strcmp((const char*)root_element->name, "TestResult") == 0)
-	{
-		xmlNodePtr report = ds_rds_create_report(doc, reports, xccdf_result_file_doc, "xccdf1");
-		ds_rds_add_relationship(doc, relationships, "arfvocab:createdFor",
-				"xccdf1", report_request_id);
+	int ret = ds_rds_write_content(writer, element_name, id, reader, NULL, oscap_source_has_xmlDoc(source), NULL);
+	if (ret != 0) {
+		oscap_setxmlerr(xmlGetLastError());
+		oscap_seterr(OSCAP_EFAMILY_XML, "Could not read XML from '%s'", oscap_source_readable_origin(source));
+	}
+	xmlFreeTextReader(reader);
+	return ret;
+}
 
-		xmlNodePtr asset = ds_rds_add_ai_from_xccdf_results(doc, assets, xccdf_result_file_doc);
-		char* asset_id = (char*)xmlGetProp(asset, BAD_CAST "id");
-		ds_rds_add_relationship(doc, relationships, "arfrel:isAbout",
-				"xccdf1", asset_id);
-		xmlFree(asset_id);
+static void ds_rds_write_relationship(xmlTextWriterPtr writer, const char* type, const char* subject, const char* ref)
+{
+	// create relationship between given request and the report
+	xmlTextWriterStartElement(writer, BAD_CAST "core:relationship");
+	xmlTextWriterWriteAttribute(writer, BAD_CAST "type", BAD_CAST type);
+	xmlTextWriterWriteAttribute(writer, BAD_CAST "subject", BAD_CAST subject);
+	xmlTextWriterWriteElement(writer, BAD_CAST "core:ref", BAD_CAST ref);
+	xmlTextWriterEndElement(writer);
+}
 
-		// We deliberately don't act on errors in inject refs as
-		// these aren't fatal errors.
-		ds_rds_report_inject_refs(doc, report, asset_id);
-	}
+static void ds_rds_write_asset(xmlTextWriterPtr writer, const struct ds_rds_xccdf_report *report)
+{
+	xmlTextWriterStartElement(writer, BAD_CAST "arf:asset");
+	xmlTextWriterWriteAttribute(writer, BAD_CAST "id", BAD_CAST report->asset_id);
+	xmlTextWriterStartElement(writer, BAD_CAST "ai:computing-device");
 
-	// 2) the root element is a Benchmark, TestResults are embedded within
-	// We will have to walk through all elements, wrap each TestResult
-	// in a xmlDoc and add them separately
-	else if (strcmp((const char*)root_element->name, "Benchmark") == 0)
+	xmlTextWriterStartElement(writer, BAD_CAST "ai:connections");
+	for (xmlNodePtr child = report->test_result->children; child != NULL; child = child->next)
 	{
-		unsigned int report_suffix = 1;
-
-		xmlNodePtr candidate_result = root_element->children;
+		if (child->type != XML_ELEMENT_NODE)
+			continue;
 
-		for (; candidate_result != NULL; candidate_result = candidate_result->next)
+		if (strcmp((const char*)(child->name), "target-address") == 0)
 		{
-			if (candidate_result->type != XML_ELEMENT_NODE)
-				continue;
-
-			if (strcmp((const char*)(candidate_result->name), "TestResult") != 0)
-				continue;
+			xmlTextWriterStartElement(writer, BAD_CAST "ai:connection");
+			xmlTextWriterStartElement(writer, BAD_CAST "ai:ip-address");
 
-			xmlDocPtr wrap_doc = xmlNewDoc(BAD_CAST "1.0");
+			xmlChar* content = xmlNodeGetContent(child);
 
-			xmlDOMWrapCtxtPtr wrap_ctxt = xmlDOMWrapNewCtxt();
-			xmlNodePtr res_node = NULL;
-			xmlDOMWrapCloneNode(wrap_ctxt, xccdf_result_file_doc, candidate_result,
-					&res_node, wrap_doc, NULL, 1, 0);
-			xmlDocSetRootElement(wrap_doc, res_node);
-			xmlDOMWrapReconcileNamespaces(wrap_ctxt, res_node, 0);
-			xmlDOMWrapFreeCtxt(wrap_ctxt);
-
-			char* report_id = oscap_sprintf("xccdf%i", report_suffix++);
-			xmlNodePtr report = ds_rds_create_report(doc, reports, wrap_doc, report_id);
-			ds_rds_add_relationship(doc, relationships, "arfvocab:createdFor",
-					report_id, report_request_id);
+			// we need to figure out whether the address is IPv4 or IPv6
+			if (strchr((char*)content, '.') != NULL) // IPv4 has to have 4 dots
+			{
+				xmlTextWriterWriteElement(writer, BAD_CAST "ai:ip-v4", content);
+			}
+			else // IPv6 has semicolons instead of dots
+			{
+				// lets expand the IPv6 to conform to the AI XSD and specification
+				char *expanded_ipv6 = oscap_expand_ipv6((const char*)content);
+				xmlTextWriterWriteElement(writer, BAD_CAST "ai:ip-v6", BAD_CAST expanded_ipv6);
+				oscap_free(expanded_ipv6);
+			}
+			xmlFree(content);
 
-			xmlNodePtr asset = ds_rds_add_ai_from_xccdf_results(doc, assets, wrap_doc);
-			char* asset_id = (char*)xmlGetProp(asset, BAD_CAST "id");
-			ds_rds_add_relationship(doc, relationships, "arfrel:isAbout",
-					report_id, asset_id);
+			xmlTextWriterEndElement(writer);
+			xmlTextWriterEndElement(writer);
+		}
+		else if (strcmp((const char*)(child->name), "target-facts") == 0)
+		{
+			xmlNodePtr target_fact_child = child->children;
 
-			// We deliberately don't act on errors in inject ref as
-			// these aren't fatal errors.
-			ds_rds_report_inject_refs(doc, report, asset_id);
+			for (; target_fact_child != NULL; target_fact_child = target_fact_child->next)
+			{
+				if (target_fact_child->type != XML_ELEMENT_NODE)
+					continue;
 
-			xmlFree(asset_id);
+				if (strcmp((const char*)(target_fact_child->name), "fact") != 0)
+					continue;
 
-			oscap_free(report_id);
+				xmlChar *name = xmlGetProp(target_fact_child, BAD_CAST "name");
+				if (!name || strcmp((const char*)name, "urn:xccdf:fact:ethernet:MAC") != 0) {
+					xmlFree(name);
+					continue;
+				}
+				xmlFree(name);
 
-			xmlFreeDoc(wrap_doc);
+				xmlChar *content = xmlNodeGetContent(target_fact_child);
+				xmlTextWriterStartElement(writer, BAD_CAST "ai:connection");
+				xmlTextWriterWriteElement(writer, BAD_CAST "ai:mac-address", content);
+				xmlTextWriterEndElement(writer);
+				xmlFree(content);
+			}
 		}
 	}
+	xmlTextWriterEndElement(writer);
 
-	else
+	// Order for the output to be valid:
+	// 1) All fqdn-s
+	// 2) All hostnames
+	for (int hostnames = 0; hostnames < 2; ++hostnames)
 	{
-		char* error = oscap_sprintf(
-				"Unknown root element '%s' in given XCCDF result document, expected TestResult or Benchmark.",
-				(const char*)root_element->name);
+		for (xmlNodePtr child = report->test_result->children; child != NULL; child = child->next)
+		{
+			if (child->type != XML_ELEMENT_NODE)
+				continue;
 
-		oscap_seterr(OSCAP_EFAMILY_XML, 0, error);
-		oscap_free(error);
+			if (strcmp((const char*)(child->name), "target") != 0)
+				continue;
+
+			// content is a full copy
+			char *content = (char*)xmlNodeGetContent(child);
+			if (hostnames) {
+				// the hostname is just the hostname part of FQDN
+				char *delimiter = strchr(content, '.');
+				if (delimiter)
+					*delimiter = '\0';
+			}
+			xmlTextWriterWriteElement(writer, BAD_CAST (hostnames ? "ai:hostname" : "ai:fqdn"), BAD_CAST content);
+			xmlFree(content);
+		}
 	}
+
+	xmlTextWriterEndElement(writer);
+	xmlTextWriterEndElement(writer);
 }
 
-static int ds_rds_create_from_dom(xmlDocPtr* ret, xmlDocPtr sds_doc, xmlDocPtr xccdf_result_file_doc, struct oscap_htable* oval_result_sources)
+static int ds_rds_write(xmlTextWriterPtr writer, struct oscap_source *sds_source, xmlDocPtr xccdf_result_file_doc, struct oscap_htable* oval_result_sources)
 {
-	*ret = NULL;
-
-	xmlDocPtr doc = xmlNewDoc(BAD_CAST "1.0");
-	xmlNodePtr root = xmlNewNode(NULL, BAD_CAST "asset-report-collection");
-	xmlDocSetRootElement(doc, root);
-
-	xmlNsPtr arf_ns = xmlNewNs(root, BAD_CAST arf_ns_uri, BAD_CAST "arf");
-	xmlSetNs(root, arf_ns);
-
-	xmlNsPtr core_ns = xmlNewNs(root, BAD_CAST core_ns_uri, BAD_CAST "core");
-	xmlNewNs(root, BAD_CAST ai_ns_uri, BAD_CAST "ai");
-
-	xmlNodePtr relationships = xmlNewNode(core_ns, BAD_CAST "relationships");
-	xmlNewNs(relationships, BAD_CAST arfvocab_ns_uri, BAD_CAST "arfvocab");
-	xmlNewNs(relationships, BAD_CAST arfrel_ns_uri, BAD_CAST "arfrel");
-	xmlAddChild(root, relationships);
-
-	xmlNodePtr report_requests = xmlNewNode(arf_ns, BAD_CAST "report-requests");
-	xmlAddChild(root, report_requests);
-
-	xmlNodePtr assets = xmlNewNode(arf_ns, BAD_CAST "assets");
-	xmlAddChild(root, assets);
-
-	xmlNodePtr report_request = xmlNewNode(arf_ns, BAD_CAST "report-request");
-	xmlSetProp(report_request, BAD_CAST "id", BAD_CAST "collection1");
-
-	xmlNodePtr arf_content = xmlNewNode(arf_ns, BAD_CAST "content");
-
-	xmlDOMWrapCtxtPtr sds_wrap_ctxt = xmlDOMWrapNewCtxt();
-	xmlNodePtr sds_res_node = NULL;
-	xmlDOMWrapCloneNode(sds_wrap_ctxt, sds_doc, xmlDocGetRootElement(sds_doc),
-			&sds_res_node, doc, NULL, 1, 0);
-	xmlAddChild(arf_content, sds_res_node);
-	xmlDOMWrapReconcileNamespaces(sds_wrap_ctxt, sds_res_node, 0);
-	xmlDOMWrapFreeCtxt(sds_wrap_ctxt);
-
-	xmlAddChild(report_request, arf_content);
-
-	xmlAddChild(report_requests, report_request);
-
-	xmlNodePtr reports = xmlNewNode(arf_ns, BAD_CAST "reports");
-
-	ds_rds_add_xccdf_test_results(doc, reports, xccdf_result_file_doc,
-			relationships, assets, "collection1");
+	struct ds_rds_xccdf_report *xccdf_reports = NULL;
+	size_t xccdf_reports_count = ds_rds_xccdf_reports_new(xccdf_result_file_doc, &xccdf_reports);
+	int ret = 0;
+
+	xmlTextWriterStartDocument(writer, NULL, "UTF-8", NULL);
+	xmlTextWriterStartElement(writer, BAD_CAST "arf:asset-report-collection");
+	xmlTextWriterWriteAttribute(writer, BAD_CAST "xmlns:arf", BAD_CAST arf_ns_uri);
+	xmlTextWriterWriteAttribute(writer, BAD_CAST "xmlns:core", BAD_CAST core_ns_uri);
+	xmlTextWriterWriteAttribute(writer, BAD_CAST "xmlns:ai", BAD_CAST ai_ns_uri);
+
+	xmlTextWriterStartElement(writer, BAD_CAST "core:relationships");
+	xmlTextWriterWriteAttribute(writer, BAD_CAST "xmlns:arfvocab", BAD_CAST arfvocab_ns_uri);
+	xmlTextWriterWriteAttribute(writer, BAD_CAST "xmlns:arfrel", BAD_CAST arfrel_ns_uri);
+	for (size_t i = 0; i < xccdf_reports_count; ++i) {
+		ds_rds_write_relationship(writer, "arfvocab:createdFor", xccdf_reports[i].id, "collection1");
+		ds_rds_write_relationship(writer, "arfrel:isAbout", xccdf_reports[i].id, xccdf_reports[i].asset_id);
+	}
+	xmlTextWriterEndElement(writer);
+
+	xmlTextWriterStartElement(writer, BAD_CAST "arf:report-requests");
+	ret = ds_rds_write_source_content(writer, "arf:report-request", "collection1", sds_source);
+	xmlTextWriterEndElement(writer);
+
+	xmlTextWriterStartElement(writer, BAD_CAST "arf:assets");
+	for (size_t i = 0; i < xccdf_reports_count; ++i)
+		ds_rds_write_asset(writer, &xccdf_reports[i]);
+	xmlTextWriterEndElement(writer);
+
+	xmlTextWriterStartElement(writer, BAD_CAST "arf:reports");
+	for (size_t i = 0; ret == 0 && i < xccdf_reports_count; ++i) {
+		xmlTextReaderPtr reader = xmlReaderWalker(xccdf_result_file_doc);
+		ret = ds_rds_write_content(writer, "arf:report", xccdf_reports[i].id, reader,
+				xccdf_reports[i].test_result, true, &xccdf_reports[i]);
+		xmlFreeTextReader(reader);
+	}
 
 	unsigned int oval_report_suffix = 2;
 	struct oscap_htable_iterator *hit = oscap_htable_iterator_new(oval_result_sources);
-	while (oscap_htable_iterator_has_more(hit)) {
+	while (ret == 0 && oscap_htable_iterator_has_more(hit)) {
 		struct oscap_source *oval_source = oscap_htable_iterator_next_value(hit);
-		xmlDoc *oval_result_doc = oscap_source_get_xmlDoc(oval_source);
 
 		char* report_id = oscap_sprintf("oval%i", oval_report_suffix++);
-		ds_rds_create_report(doc, reports, oval_result_doc, report_id);
+		ret = ds_rds_write_source_content(writer, "arf:report", report_id, oval_source);
 		oscap_free(report_id);
 	}
 	oscap_htable_iterator_free(hit);
+	xmlTextWriterEndElement(writer);
 
-	xmlAddChild(root, reports);
+	ds_rds_xccdf_reports_free(xccdf_reports, xccdf_reports_count);
 
-	*ret = doc;
-	return 0;
+	if (xmlTextWriterEndDocument(writer) < 0 || xmlTextWriterFlush(writer) < 0) {
+		oscap_setxmlerr(xmlGetLastError());
+		ret = -1;
+	}
+	return ret;
 }
 
-struct oscap_source *ds_rds_create_source(struct oscap_source *sds_source, struct oscap_source *xccdf_result_source, struct oscap_htable *oval_result_sources, const char *target_file)
+int ds_rds_create_from_sources(struct oscap_source *sds_source, struct oscap_source *xccdf_result_source, struct oscap_htable *oval_result_sources, const char *target_file)
 {
-	xmlDoc *sds_doc = oscap_source_get_xmlDoc(sds_source);
-	if (sds_doc == NULL) {
-		return NULL;
-	}
 	xmlDoc *result_file_doc = oscap_source_get_xmlDoc(xccdf_result_source);
 	if (result_file_doc == NULL) {
-		return NULL;
+		return -1;
 	}
 
-	xmlDocPtr rds_doc = NULL;
-	if (ds_rds_create_from_dom(&rds_doc, sds_doc, result_file_doc, oval_result_sources) != 0) {
-		return NULL;
+	xmlTextWriterPtr writer = xmlNewTextWriterFilename(target_file, 0);
+	if (writer == NULL) {
+		oscap_setxmlerr(xmlGetLastError());
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not open '%s' for writing.", target_file);
+		return -1;
 	}
-	return oscap_source_new_from_xmlDoc(rds_doc, target_file);
+	xmlTextWriterSetIndent(writer, 1);
+	xmlTextWriterSetIndentString(writer, BAD_CAST "  ");
+
+	int ret = ds_rds_write(writer, sds_source, result_file_doc, oval_result_sources);
+	xmlFreeTextWriter(writer);
+	if (ret != 0) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not write result DataStream to '%s'.", target_file);
+		if (strcmp(target_file, "-") != 0)
+			unlink(target_file);
+	}
+	return ret;
 }
 
 int ds_rds_create(const char* sds_file, const char* xccdf_result_file, const char** oval_result_files, const char* target_file)
@@ -761,31 +896,22 @@ int ds_rds_create(const char* sds_file, const char* xccdf_result_file, const cha
 	struct oscap_source *xccdf_result_source = oscap_source_new_from_file(xccdf_result_file);
 	struct oscap_htable *oval_result_sources = oscap_htable_new();
 
-	int result = 0;
 	// this check is there to allow passing NULL instead of having to allocate
 	// an empty array
 	if (oval_result_files != NULL)
 	{
 		while (*oval_result_files != NULL)
 		{
+			// OVAL results are streamed into the result DataStream,
+			// they get parsed while it is written
 			struct oscap_source *oval_source = oscap_source_new_from_file(*oval_result_files);
-			if (oscap_source_get_xmlDoc(oval_source) == NULL) {
-				result = -1;
+			if (!oscap_htable_add(oval_result_sources, *oval_result_files, oval_source)) {
 				oscap_source_free(oval_source);
-			} else {
-				oscap_htable_add(oval_result_sources, *oval_result_files, oval_source);
 			}
 			oval_result_files++;
 		}
 	}
-	if (result == 0) {
-		struct oscap_source *target_rds = ds_rds_create_source(sds_source, xccdf_result_source, oval_result_sources, target_file);
-		result = target_rds == NULL;
-		if (result == 0) {
-			result = oscap_source_save_as(target_rds, NULL);
-		}
-		oscap_source_free(target_rds);
-	}
+	int result = ds_rds_create_from_sources(sds_source, xccdf_result_source, oval_result_sources, target_file);
 	oscap_htable_free(oval_result_sources, (oscap_destruct_func) oscap_source_free);
 	oscap_source_free(sds_source);
 	oscap_source_free(xccdf_result_source);
@@ -0,0 +1,393 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "common/_error.h"
+#include "common/alloc.h"
+#include "common/list.h"
+#include "common/util.h"
+#include "source/bz2_priv.h"
+#include "source/oscap_source_priv.h"
+#include "source/public/oscap_source.h"
+#include "ds_sds_session_priv.h"
+#include "sds_image_priv.h"
+
+#define SDS_IMAGE_MAGIC  "OSCAPSDS"
+#define SDS_IMAGE_FORMAT 1
+#define SDS_IMAGE_ALIGN  8
+
+/*
+ * Image layout: header, entry table, and the names and data of the
+ * entries. Offsets are relative to the beginning of the file, names are
+ * NUL terminated. Integers are stored in the byte order of the host which
+ * wrote the image; an image from a host with a different byte order is
+ * rejected because its format field doesn't match.
+ */
+struct sds_image_header {
+	char     magic[8];
+	uint32_t format;
+	uint32_t count;                 ///< Number of entries
+	uint64_t source_size;           ///< Size of the compiled collection
+	uint64_t source_checksum;       ///< FNV-1a hash of the compiled collection
+	char     version[32];           ///< Version of the library which wrote the image
+};
+
+enum sds_image_entry_type {
+	SDS_IMAGE_DATASTREAM_ID = 1,    ///< name is the ID of the datastream
+	SDS_IMAGE_CHECKLIST_ID,         ///< name is the ID of the checklist component-ref
+	SDS_IMAGE_DICTIONARY,           ///< name is the href of a CPE dictionary
+	SDS_IMAGE_COMPONENT             ///< name is the href, data the XML document
+};
+
+struct sds_image_entry {
+	uint32_t type;
+	uint32_t name_size;             ///< Including the terminating NUL
+	uint64_t name_offset;
+	uint64_t data_offset;
+	uint64_t data_size;
+};
+
+struct sds_image {
+	char *map;
+	size_t size;
+	const struct sds_image_header *header;
+	const struct sds_image_entry *entries;
+	const char *datastream_id;
+	const char *checklist_id;
+	struct oscap_stringlist *dictionaries;
+};
+
+static uint64_t _fnv1a(uint64_t hash, const unsigned char *data, size_t size)
+{
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= data[i];
+		hash *= UINT64_C(0x100000001b3);
+	}
+	return hash;
+}
+
+/*
+ * The image is bound to the collection by the size and the checksum of its
+ * file. Collections loaded from memory have no file to compare with, the
+ * content of compressed ones is not what the checksum would cover.
+ */
+static int _sds_checksum(struct oscap_source *sds, uint64_t *size, uint64_t *checksum)
+{
+	const char *filepath = oscap_source_readable_origin(sds);
+	struct stat st;
+	void *map;
+
+	if (!oscap_source_is_file(sds)) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "DataStream '%s' wasn't loaded from a file, it can't have a compiled image.", filepath);
+		return -1;
+	}
+
+	int fd = open(filepath, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) != 0) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Can't read DataStream file '%s': %s", filepath, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return -1;
+	}
+	if (bz2_fd_is_bzip(fd)) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "DataStream file '%s' is compressed, it can't have a compiled image.", filepath);
+		close(fd);
+		return -1;
+	}
+	*size = st.st_size;
+	*checksum = UINT64_C(0xcbf29ce484222325);
+	if (st.st_size > 0) {
+		map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map == MAP_FAILED) {
+			oscap_seterr(OSCAP_EFAMILY_GLIBC, "Can't map DataStream file '%s': %s", filepath, strerror(errno));
+			close(fd);
+			return -1;
+		}
+		*checksum = _fnv1a(*checksum, map, st.st_size);
+		munmap(map, st.st_size);
+	}
+	close(fd);
+	return 0;
+}
+
+struct _sds_image_item {
+	uint32_t type;
+	const char *name;
+	char *data;
+	size_t data_size;
+};
+
+static size_t _align(size_t offset)
+{
+	return (offset + SDS_IMAGE_ALIGN - 1) & ~((size_t)SDS_IMAGE_ALIGN - 1);
+}
+
+static bool _write_padding(FILE *f, size_t size)
+{
+	static const char padding[SDS_IMAGE_ALIGN];
+
+	return size == 0 || fwrite(padding, size, 1, f) == 1;
+}
+
+int sds_image_write(struct ds_sds_session *session, struct oscap_string_iterator *dictionaries, const char *target_file)
+{
+	struct sds_image_header header;
+	struct _sds_image_item *items = NULL;
+	struct sds_image_entry *entries = NULL;
+	size_t count = 0, i, offset;
+	bool ok;
+	int ret = -1;
+	FILE *f = NULL;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SDS_IMAGE_MAGIC, sizeof(header.magic));
+	header.format = SDS_IMAGE_FORMAT;
+	strncpy(header.version, oscap_get_version(), sizeof(header.version) - 1);
+	if (_sds_checksum(ds_sds_session_get_source(session), &header.source_size, &header.source_checksum) != 0)
+		return -1;
+
+#define _ADD_ITEM(t, n, d, s) do { \
+		items = oscap_realloc(items, (count + 1) * sizeof(struct _sds_image_item)); \
+		items[count].type = (t); items[count].name = (n); \
+		items[count].data = (d); items[count].data_size = (s); \
+		++count; \
+	} while (0)
+
+	_ADD_ITEM(SDS_IMAGE_DATASTREAM_ID, ds_sds_session_get_datastream_id(session), NULL, 0);
+	_ADD_ITEM(SDS_IMAGE_CHECKLIST_ID, ds_sds_session_get_checklist_id(session), NULL, 0);
+	while (oscap_string_iterator_has_more(dictionaries))
+		_ADD_ITEM(SDS_IMAGE_DICTIONARY, oscap_string_iterator_next(dictionaries), NULL, 0);
+
+	struct oscap_htable_iterator *hit = oscap_htable_iterator_new(ds_sds_session_get_component_sources(session));
+	while (oscap_htable_iterator_has_more(hit)) {
+		const char *href;
+		struct oscap_source *source;
+		char *data;
+		size_t size;
+
+		oscap_htable_iterator_next_kv(hit, &href, (void **) &source);
+		if (oscap_source_get_raw_memory(source, &data, &size) != 0) {
+			oscap_htable_iterator_free(hit);
+			goto cleanup;
+		}
+		_ADD_ITEM(SDS_IMAGE_COMPONENT, href, data, size);
+	}
+	oscap_htable_iterator_free(hit);
+#undef _ADD_ITEM
+
+	if (items[0].name == NULL || items[1].name == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Internal error: No checklist has been selected.");
+		goto cleanup;
+	}
+	header.count = count;
+
+	/* lay out the names and the data after the entry table */
+	entries = oscap_calloc(count, sizeof(struct sds_image_entry));
+	offset = sizeof(header) + count * sizeof(struct sds_image_entry);
+	for (i = 0; i < count; ++i) {
+		entries[i].type = items[i].type;
+		entries[i].name_size = strlen(items[i].name) + 1;
+		entries[i].name_offset = offset;
+		offset = _align(offset + entries[i].name_size);
+		entries[i].data_offset = offset;
+		entries[i].data_size = items[i].data_size;
+		offset = _align(offset + items[i].data_size);
+	}
+
+	f = fopen(target_file, "wb");
+	if (f == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Can't open '%s' for writing: %s", target_file, strerror(errno));
+		oscap_free(entries);
+		goto cleanup;
+	}
+	ok = fwrite(&header, sizeof(header), 1, f) == 1
+		&& fwrite(entries, sizeof(struct sds_image_entry), count, f) == count;
+	offset = sizeof(header) + count * sizeof(struct sds_image_entry);
+	for (i = 0; ok && i < count; ++i) {
+		ok = fwrite(items[i].name, entries[i].name_size, 1, f) == 1
+			&& _write_padding(f, entries[i].data_offset - offset - entries[i].name_size);
+		if (ok && items[i].data_size > 0)
+			ok = fwrite(items[i].data, items[i].data_size, 1, f) == 1;
+		offset = _align(entries[i].data_offset + items[i].data_size);
+		if (ok)
+			ok = _write_padding(f, offset - entries[i].data_offset - items[i].data_size);
+	}
+	oscap_free(entries);
+	if (fclose(f) != 0 || !ok) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Can't write the image '%s': %s", target_file, strerror(errno));
+		unlink(target_file);
+		goto cleanup;
+	}
+	ret = 0;
+
+cleanup:
+	for (i = 0; i < count; ++i)
+		free(items[i].data);
+	oscap_free(items);
+	return ret;
+}
+
+struct sds_image *sds_image_open(const char *image_file)
+{
+	struct stat st;
+	struct sds_image *image;
+
+	int fd = open(image_file, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) != 0) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Can't open compiled content '%s': %s", image_file, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return NULL;
+	}
+	if ((size_t) st.st_size < sizeof(struct sds_image_header)) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "File '%s' is not a compiled DataStream.", image_file);
+		close(fd);
+		return NULL;
+	}
+
+	image = oscap_calloc(1, sizeof(struct sds_image));
+	image->size = st.st_size;
+	image->map = mmap(NULL, image->size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (image->map == MAP_FAILED) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Can't map compiled content '%s': %s", image_file, strerror(errno));
+		oscap_free(image);
+		return NULL;
+	}
+	image->header = (const struct sds_image_header *) image->map;
+	image->entries = (const struct sds_image_entry *) (image->map + sizeof(struct sds_image_header));
+	image->dictionaries = oscap_stringlist_new();
+
+	if (memcmp(image->header->magic, SDS_IMAGE_MAGIC, sizeof(image->header->magic)) != 0
+	    || image->header->format != SDS_IMAGE_FORMAT) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "File '%s' is not a compiled DataStream.", image_file);
+		goto error;
+	}
+	if (strncmp(image->header->version, oscap_get_version(), sizeof(image->header->version)) != 0) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Compiled DataStream '%s' was created by OpenSCAP %.*s.",
+			image_file, (int) sizeof(image->header->version), image->header->version);
+		goto error;
+	}
+	if (image->header->count > (image->size - sizeof(struct sds_image_header)) / sizeof(struct sds_image_entry))
+		goto corrupted;
+
+	for (uint32_t i = 0; i < image->header->count; ++i) {
+		const struct sds_image_entry *e = &image->entries[i];
+		if (e->name_size == 0 || e->name_offset > image->size || e->name_size > image->size - e->name_offset
+		    || e->data_offset > image->size || e->data_size > image->size - e->data_offset
+		    || image->map[e->name_offset + e->name_size - 1] != '\0')
+			goto corrupted;
+
+		const char *name = image->map + e->name_offset;
+		switch (e->type) {
+		case SDS_IMAGE_DATASTREAM_ID:
+			image->datastream_id = name;
+			break;
+		case SDS_IMAGE_CHECKLIST_ID:
+			image->checklist_id = name;
+			break;
+		case SDS_IMAGE_DICTIONARY:
+			oscap_stringlist_add_string(image->dictionaries, name);
+			break;
+		case SDS_IMAGE_COMPONENT:
+			break;
+		default:
+			goto corrupted;
+		}
+	}
+	if (image->datastream_id == NULL || image->checklist_id == NULL)
+		goto corrupted;
+
+	return image;
+
+corrupted:
+	oscap_seterr(OSCAP_EFAMILY_OSCAP, "Compiled DataStream '%s' is corrupted.", image_file);
+error:
+	sds_image_free(image);
+	return NULL;
+}
+
+void sds_image_free(struct sds_image *image)
+{
+	if (image != NULL) {
+		munmap(image->map, image->size);
+		oscap_stringlist_free(image->dictionaries);
+		oscap_free(image);
+	}
+}
+
+int sds_image_matches(struct sds_image *image, struct oscap_source *sds, const char *datastream_id, const char *component_id)
+{
+	uint64_t size, checksum;
+
+	if (_sds_checksum(sds, &size, &checksum) != 0)
+		return -1;
+	if (datastream_id != NULL && strcmp(datastream_id, image->datastream_id) != 0)
+		return 0;
+	if (component_id != NULL && strcmp(component_id, image->checklist_id) != 0)
+		return 0;
+
+	return size == image->header->source_size && checksum == image->header->source_checksum;
+}
+
+const char *sds_image_get_datastream_id(const struct sds_image *image)
+{
+	return image->datastream_id;
+}
+
+const char *sds_image_get_checklist_id(const struct sds_image *image)
+{
+	return image->checklist_id;
+}
+
+struct oscap_string_iterator *sds_image_get_dictionaries(const struct sds_image *image)
+{
+	return oscap_stringlist_get_strings(image->dictionaries);
+}
+
+int sds_image_register_components(struct sds_image *image, struct ds_sds_session *session)
+{
+	for (uint32_t i = 0; i < image->header->count; ++i) {
+		const struct sds_image_entry *e = &image->entries[i];
+		if (e->type != SDS_IMAGE_COMPONENT)
+			continue;
+
+		const char *href = image->map + e->name_offset;
+		struct oscap_source *source = oscap_source_new_borrow_memory(image->map + e->data_offset, e->data_size, href);
+		if (ds_sds_session_register_component_source(session, href, source) != 0) {
+			oscap_source_free(source);
+			return -1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef OSCAP_DS_SDS_IMAGE_PRIV_H
+#define OSCAP_DS_SDS_IMAGE_PRIV_H
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdbool.h>
+#include "common/public/oscap.h"
+#include "common/public/oscap_text.h"
+#include "common/util.h"
+#include "DS/public/ds_sds_session.h"
+
+OSCAP_HIDDEN_START;
+
+/*
+ * Compiled Source DataStream image. The image holds the components of one
+ * checklist (with all its dependencies) and the CPE dictionaries of its
+ * datastream, split out of the collection and validated. Components are
+ * stored as serialized XML documents which are parsed directly from the
+ * mapped image file. The image remembers a checksum of the collection it
+ * was compiled from, it is not used once the collection changes.
+ */
+struct sds_image;
+
+/**
+ * Write components registered in the session into a new image file.
+ * @param session session with selected datastream and checklist
+ * @param dictionaries hrefs of the CPE dictionaries of the datastream
+ * @param target_file path of the image
+ * @returns 0 on success
+ */
+int sds_image_write(struct ds_sds_session *session, struct oscap_string_iterator *dictionaries, const char *target_file);
+
+/**
+ * Map an image file.
+ * @returns image or NULL if the file is not a valid image of this version of the library
+ */
+struct sds_image *sds_image_open(const char *image_file);
+void sds_image_free(struct sds_image *image);
+
+/**
+ * Check whether the image was compiled from the current content of the
+ * given collection and with the given selection.
+ * @param datastream_id requested datastream or NULL for any
+ * @param component_id requested checklist or NULL for any
+ * @returns 1 if it was, 0 if it wasn't, -1 if the collection can't have
+ * an image (it is not read from a plain file)
+ */
+int sds_image_matches(struct sds_image *image, struct oscap_source *sds, const char *datastream_id, const char *component_id);
+
+const char *sds_image_get_datastream_id(const struct sds_image *image);
+const char *sds_image_get_checklist_id(const struct sds_image *image);
+struct oscap_string_iterator *sds_image_get_dictionaries(const struct sds_image *image);
+
+/**
+ * Register all components of the image with the session. Sources of the
+ * components refer to the mapped image, the image has to outlive them.
+ */
+int sds_image_register_components(struct sds_image *image, struct ds_sds_session *session);
+
+OSCAP_HIDDEN_END;
+#endif
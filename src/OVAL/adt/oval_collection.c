@@ -58,6 +58,7 @@ typedef struct oval_iterator {
 
 static bool debug = true;
 static struct oval_iterator *_debugStack[0];
+/* iterators are created by the evaluation threads concurrently */
 static int iterator_count;
 
 /* End of variable definitions
@@ -126,7 +127,7 @@ struct oval_iterator *oval_collection_iterator(struct oval_collection *collectio
 	if (iterator == NULL)
 		return NULL;
 
-	if ((iterator_count++) < 0) {
+	if (__sync_fetch_and_add(&iterator_count, 1) < 0) {
 		_debugStack[iterator_count - 1] = iterator;
 		oscap_dlprintf(DBG_W, "iterator_count: %d.\n", iterator_count);
 	}
@@ -191,7 +192,7 @@ void *oval_collection_iterator_next(struct oval_iterator *iterator)
 void oval_collection_iterator_free(struct oval_iterator *iterator)
 {
 	if (iterator) {		//NOOP if iterator is NULL
-		if ((--iterator_count) < 0) {
+		if (__sync_sub_and_fetch(&iterator_count, 1) < 0) {
 			oscap_dlprintf(DBG_W, "iterator_count: %d.\n", iterator_count);
 			if (iterator != _debugStack[iterator_count]) {
 				debug = false;
@@ -217,7 +218,7 @@ struct oval_iterator *oval_collection_iterator_new()
 	if (iterator == NULL)
 		return NULL;
 
-	if ((iterator_count++) < 0) {
+	if (__sync_fetch_and_add(&iterator_count, 1) < 0) {
 		_debugStack[iterator_count - 1] = iterator;
 		oscap_dlprintf(DBG_W, "iterator_count: %d.\n", iterator_count);
 	}
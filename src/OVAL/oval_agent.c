@@ -49,6 +49,7 @@
 #include "common/debug_priv.h"
 #include "common/_error.h"
 #include "oval_agent_xccdf_api.h"
+#include "oval_peval.h"
 
 struct oval_agent_session {
 	char *filename;
@@ -88,7 +89,6 @@ static const struct oval_result_to_xccdf_spec XCCDF_OVAL_RESULTS_MAP[] = {
 
 oval_agent_session_t * oval_agent_new_session(struct oval_definition_model *model, const char * name) {
 	oval_agent_session_t *ag_sess;
-	struct oval_sysinfo *sysinfo;
 	struct oval_generator *generator;
 	int ret;
 
@@ -103,15 +103,13 @@ oval_agent_session_t * oval_agent_new_session(struct oval_definition_model *mode
 	ag_sess->psess     = oval_probe_session_new(ag_sess->sys_model);
 
 	/* probe sysinfo */
-	ret = oval_probe_query_sysinfo(ag_sess->psess, &sysinfo);
+	ret = oval_agent_refresh_sysinfo(ag_sess);
 	if (ret != 0) {
 		oval_probe_session_destroy(ag_sess->psess);
 		oval_syschar_model_free(ag_sess->sys_model);
 		oscap_free(ag_sess);
 		return NULL;
 	}
-	oval_syschar_model_set_sysinfo(ag_sess->sys_model, sysinfo);
-	oval_sysinfo_free(sysinfo);
 
 	/* one system only */
 	ag_sess->sys_models[0] = ag_sess->sys_model;
@@ -236,6 +234,17 @@ int oval_agent_reset_session(oval_agent_session_t * ag_sess) {
 	return 0;
 }
 
+int oval_agent_refresh_sysinfo(oval_agent_session_t *ag_sess)
+{
+	struct oval_sysinfo *sysinfo;
+
+	if (oval_probe_query_sysinfo(ag_sess->psess, &sysinfo) != 0)
+		return -1;
+	oval_syschar_model_set_sysinfo(ag_sess->sys_model, sysinfo);
+	oval_sysinfo_free(sysinfo);
+	return 0;
+}
+
 int oval_agent_abort_session(oval_agent_session_t *ag_sess)
 {
 	assume_d(ag_sess != NULL, -1);
@@ -244,11 +253,94 @@ int oval_agent_abort_session(oval_agent_session_t *ag_sess)
 	return oval_probe_session_abort(ag_sess->psess);
 }
 
+/*
+ * All definitions are probed before any of them is evaluated: the objects
+ * are collected concurrently by probe type and the result tests of all
+ * definitions are evaluated by a pool of threads. The definitions are then
+ * evaluated from the results of their tests and reported in their order.
+ */
+static int oval_agent_eval_system_parallel(oval_agent_session_t *ag_sess, agent_reporter cb, void *arg, unsigned int jobs)
+{
+	struct oval_result_system *rsystem;
+	struct oval_definition_iterator *oval_def_it;
+	struct oval_result_definition **res_defs = NULL;
+	char **ids = NULL;
+	size_t count = 0, size = 0, i;
+	int ret = 0, probe_ret = 0;
+
+	probe_ret = oval_peval_collect(ag_sess->psess, ag_sess->def_model, jobs);
+	if (probe_ret == -1)
+		return -1;
+	/* probe evaluation terminated by signal */
+	if (probe_ret == -2)
+		return 1;
+
+	rsystem = _oval_agent_get_first_result_system(ag_sess);
+
+	oval_def_it = oval_definition_model_get_definitions(ag_sess->def_model);
+	while (oval_definition_iterator_has_more(oval_def_it)) {
+		struct oval_result_definition *res_def;
+		char *id;
+
+		id = oval_definition_get_id(oval_definition_iterator_next(oval_def_it));
+
+		/* objects depending on other objects and variables are probed here */
+		probe_ret = oval_probe_query_definition(ag_sess->psess, id);
+		if (probe_ret == -1 || probe_ret == -2)
+			break;
+
+		res_def = oval_result_system_prepare_definition(rsystem, id);
+		if (res_def == NULL) {
+			probe_ret = -1;
+			break;
+		}
+
+		if (count == size) {
+			size = size ? size * 2 : 64;
+			res_defs = oscap_realloc(res_defs, sizeof(struct oval_result_definition *) * size);
+			ids = oscap_realloc(ids, sizeof(char *) * size);
+		}
+
+		res_defs[count] = res_def;
+		ids[count++] = id;
+	}
+	oval_definition_iterator_free(oval_def_it);
+
+	oval_peval_tests(res_defs, count, jobs);
+
+	for (i = 0; i < count; ++i) {
+		oval_result_definition_eval(res_defs[i]);
+
+		/* callback */
+		if (cb != NULL) {
+			ret = cb(oval_agent_get_result_definition(ag_sess, ids[i]), arg);
+			/* stop? */
+			if (ret != 0)
+				goto cleanup;
+		}
+	}
+
+	if (probe_ret == -1)
+		ret = -1;
+	else if (probe_ret == -2)
+		ret = 1;
+
+cleanup:
+	oscap_free(res_defs);
+	oscap_free(ids);
+	return ret;
+}
+
 int oval_agent_eval_system(oval_agent_session_t * ag_sess, agent_reporter cb, void *arg) {
 	struct oval_definition *oval_def;
 	struct oval_definition_iterator *oval_def_it;
 	char   *id;
 	int ret = 0;
+	unsigned int jobs;
+
+	jobs = oval_peval_jobs();
+	if (jobs > 1)
+		return oval_agent_eval_system_parallel(ag_sess, cb, arg, jobs);
 
 	oval_def_it = oval_definition_model_get_definitions(ag_sess->def_model);
 	while (oval_definition_iterator_has_more(oval_def_it)) {
@@ -378,6 +470,35 @@ static bool _stringlist_conflicts_with_value_it(struct oscap_stringlist *slist,
 	return oscap_list_get_itemcount((struct oscap_list *) slist) != multival_count;
 }
 
+/**
+ * Collect the external variables whose values are going to change when the
+ * external variables are cleared and the new bindings are applied. That is
+ * every bound variable except those bound again to the very same values.
+ */
+static struct oval_string_map *_oval_agent_changed_variables(struct oval_definition_model *def_model, struct oscap_htable *dict)
+{
+	struct oval_string_map *changed = oval_string_map_new();
+	struct oval_variable_iterator *var_it = oval_definition_model_get_variables(def_model);
+
+	while (oval_variable_iterator_has_more(var_it)) {
+		struct oval_variable *variable = oval_variable_iterator_next(var_it);
+
+		if (oval_variable_get_type(variable) != OVAL_VARIABLE_EXTERNAL)
+			continue;
+
+		char *var_id = oval_variable_get_id(variable);
+		struct oscap_stringlist *value_list = oscap_htable_get(dict, var_id);
+		struct oval_value_iterator *value_it = oval_variable_get_values(variable);
+
+		if (oval_value_iterator_has_more(value_it) &&
+		    (value_list == NULL || _stringlist_conflicts_with_value_it(value_list, value_it)))
+			oval_string_map_put(changed, var_id, variable);
+		oval_value_iterator_free(value_it);
+	}
+	oval_variable_iterator_free(var_it);
+	return changed;
+}
+
 /**
  * Finds out, if the new batch of variable bindings compel new variable model
  * (so-called multiset). Creates new variable model if needed.
@@ -391,7 +512,7 @@ static void _oval_agent_resolve_variables_conflict(struct oval_agent_session *se
 	struct oscap_htable_iterator *hit = oscap_htable_iterator_new(dict);
 	struct oval_definition_model *def_model =
 			oval_results_model_get_definition_model(oval_agent_get_results_model(session));
-	while (!conflict && oscap_htable_iterator_has_more(hit)) {
+	while (oscap_htable_iterator_has_more(hit)) {
 		oscap_htable_iterator_next_kv(hit, &var_name, (void*) &value_list);
 		struct oval_variable *variable = oval_definition_model_get_variable(def_model, var_name);
 		if (variable != NULL) {
@@ -452,12 +573,21 @@ static void _oval_agent_resolve_variables_conflict(struct oval_agent_session *se
 		}
 	}
 	oscap_htable_iterator_free(hit);
-	oscap_htable_free(dict, (oscap_destruct_func) oscap_stringlist_free);
 
     if (conflict) {
-        /* We have a conflict, clear session and external variables */
-        oval_agent_reset_session(session);
+	/* We have a conflict, clear external variables and invalidate only what
+	 * was collected using their previous values. Probes keep running. */
+	struct oval_string_map *changed = _oval_agent_changed_variables(def_model, dict);
+
+	session->cur_var_model = NULL;
+	oval_definition_model_clear_external_variables(def_model);
+	if (oval_probe_hint_variables(session->psess, def_model, changed) != 0) {
+		oscap_dlprintf(DBG_W, "Selective invalidation failed, resetting the probe session.\n");
+		oval_agent_reset_session(session);
+	}
+	oval_string_map_free(changed, NULL);
     }
+    oscap_htable_free(dict, (oscap_destruct_func) oscap_stringlist_free);
 
     if (!session->cur_var_model) {
 	    session->cur_var_model = oval_variable_model_new();
@@ -0,0 +1,617 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <seap.h>
+#include <strbuf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "common/alloc.h"
+#include "common/list.h"
+#include "common/debug_priv.h"
+#include "probes/public/probe-api.h"
+#include "oval_ccache.h"
+
+#define OVAL_CCACHE_ENV     "OSCAP_COLLECTION_CACHE"
+#define OVAL_CCACHE_MAGIC   "oscap-collection-cache"
+#define OVAL_CCACHE_FORMAT  "1"
+#define OVAL_CCACHE_HSIZE   1021
+/* Directories with more entries are not fingerprinted */
+#define OVAL_CCACHE_DIRMAX  4096
+
+struct oval_ccache {
+	pthread_mutex_t      lock;
+	char                *path;
+	struct oscap_htable *records;
+	unsigned int         refs;
+	bool                 dirty;
+};
+
+typedef struct {
+	char   *key;
+	SEXP_t *obj;
+	SEXP_t *fp;
+	SEXP_t *cobj;
+} oval_ccache_rec_t;
+
+static pthread_mutex_t  __ccache_lock = PTHREAD_MUTEX_INITIALIZER;
+static oval_ccache_t   *__ccache      = NULL;
+
+static void oval_ccache_rec_free(void *ptr)
+{
+	oval_ccache_rec_t *rec = ptr;
+
+	oscap_free(rec->key);
+	SEXP_free(rec->obj);
+	SEXP_free(rec->fp);
+	SEXP_free(rec->cobj);
+	oscap_free(rec);
+}
+
+static void oval_ccache_key(const SEXP_t *s_obj, char *key, size_t keylen)
+{
+	snprintf(key, keylen, "%016llx", (unsigned long long)SEXP_ID_v(s_obj));
+}
+
+static bool oval_ccache_hdrcmp(const SEXP_t *s_list)
+{
+	const char *hdr[] = { OVAL_CCACHE_MAGIC, OVAL_CCACHE_FORMAT, PACKAGE_VERSION };
+	SEXP_t *r0;
+	size_t i;
+	bool ok = true;
+
+	for (i = 0; ok && i < sizeof hdr / sizeof hdr[0]; ++i) {
+		r0 = SEXP_list_nth(s_list, i + 1);
+		ok = r0 != NULL && SEXP_stringp(r0) && SEXP_strcmp(r0, hdr[i]) == 0;
+		SEXP_free(r0);
+	}
+
+	return ok;
+}
+
+/*
+ * Cache file: a single list
+ *
+ *   ("oscap-collection-cache" "<format>" "<version>" (key obj fp cobj) ...)
+ *
+ * in the SEAP transport encoding. The key is stored because the ID of a
+ * parsed S-exp may differ from the one it was written from (e.g. numbers
+ * may be read back with a different type). Files written by a different
+ * version are ignored since the probe output may differ.
+ */
+static void oval_ccache_load(oval_ccache_t *cache)
+{
+	int fd;
+	struct stat st;
+	char *buffer;
+	ssize_t l;
+	size_t off;
+	SEXP_psetup_t *psetup;
+	SEXP_pstate_t *pstate = NULL;
+	SEXP_t *s_file, *s_list, *s_rec, *r0;
+
+	fd = open(cache->path, O_RDONLY);
+	if (fd < 0) {
+		if (errno != ENOENT)
+			dW("Can't open the collection cache %s: %s\n", cache->path, strerror(errno));
+		return;
+	}
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		return;
+	}
+	buffer = oscap_alloc(st.st_size);
+	for (off = 0; off < (size_t)st.st_size; off += l) {
+		l = read(fd, buffer + off, st.st_size - off);
+		if (l <= 0) {
+			close(fd);
+			oscap_free(buffer);
+			return;
+		}
+	}
+	close(fd);
+
+	psetup = SEXP_psetup_new();
+	s_file = SEXP_parse(psetup, buffer, off, &pstate);
+	SEXP_psetup_free(psetup);
+	if (pstate != NULL)
+		SEXP_pstate_free(pstate);
+	oscap_free(buffer);
+
+	if (s_file == NULL) {
+		dW("Ignoring corrupted collection cache %s\n", cache->path);
+		return;
+	}
+	s_list = SEXP_list_first(s_file);
+	SEXP_free(s_file);
+
+	if (s_list == NULL || !SEXP_listp(s_list) || !oval_ccache_hdrcmp(s_list)) {
+		dI("Collection cache %s was written by a different version, ignoring it\n", cache->path);
+		SEXP_free(s_list);
+		return;
+	}
+
+	SEXP_sublist_foreach(s_rec, s_list, 4, SEXP_LIST_END) {
+		oval_ccache_rec_t *rec;
+
+		if (!SEXP_listp(s_rec) || SEXP_list_length(s_rec) != 4)
+			continue;
+
+		rec = oscap_talloc(oval_ccache_rec_t);
+		rec->key  = SEXP_string_cstr(r0 = SEXP_list_first(s_rec));
+		rec->obj  = SEXP_list_nth(s_rec, 2);
+		rec->fp   = SEXP_list_nth(s_rec, 3);
+		rec->cobj = SEXP_list_nth(s_rec, 4);
+		SEXP_free(r0);
+
+		if (rec->key == NULL || !oscap_htable_add(cache->records, rec->key, rec))
+			oval_ccache_rec_free(rec);
+	}
+	SEXP_free(s_list);
+
+	dI("Loaded collection cache %s\n", cache->path);
+}
+
+static void oval_ccache_save(oval_ccache_t *cache)
+{
+	struct oscap_htable_iterator *hit;
+	SEXP_t *s_list, *s_rec, *r0, *r1, *r2;
+	strbuf_t *sb;
+	char *tmp;
+	size_t tmplen;
+	int fd;
+
+	s_list = SEXP_list_new(r0 = SEXP_string_newf("%s", OVAL_CCACHE_MAGIC),
+			       r1 = SEXP_string_newf("%s", OVAL_CCACHE_FORMAT),
+			       r2 = SEXP_string_newf("%s", PACKAGE_VERSION), NULL);
+	SEXP_vfree(r0, r1, r2, NULL);
+
+	hit = oscap_htable_iterator_new(cache->records);
+	while (oscap_htable_iterator_has_more(hit)) {
+		oval_ccache_rec_t *rec = oscap_htable_iterator_next_value(hit);
+
+		s_rec = SEXP_list_new(r0 = SEXP_string_newf("%s", rec->key),
+				      rec->obj, rec->fp, rec->cobj, NULL);
+		SEXP_list_add(s_list, s_rec);
+		SEXP_vfree(s_rec, r0, NULL);
+	}
+	oscap_htable_iterator_free(hit);
+
+	sb = strbuf_new(SEAP_STRBUF_MAX);
+	if (SEXP_sbprintf_t(s_list, sb) != 0) {
+		strbuf_free(sb);
+		SEXP_free(s_list);
+		return;
+	}
+	SEXP_free(s_list);
+
+	/* write a temporary file first so that concurrent scans never see a partial cache */
+	tmplen = strlen(cache->path) + sizeof ".XXXXXX";
+	tmp = oscap_alloc(tmplen);
+	snprintf(tmp, tmplen, "%s.XXXXXX", cache->path);
+
+	fd = mkstemp(tmp);
+	if (fd < 0) {
+		dW("Can't write the collection cache %s: %s\n", tmp, strerror(errno));
+		goto out;
+	}
+	if ((size_t)strbuf_write(sb, fd) != strbuf_length(sb) || fsync(fd) != 0) {
+		dW("Can't write the collection cache %s: %s\n", tmp, strerror(errno));
+		close(fd);
+		unlink(tmp);
+		goto out;
+	}
+	close(fd);
+
+	if (rename(tmp, cache->path) != 0) {
+		dW("Can't rename %s to %s: %s\n", tmp, cache->path, strerror(errno));
+		unlink(tmp);
+	}
+out:
+	oscap_free(tmp);
+	strbuf_free(sb);
+}
+
+oval_ccache_t *oval_ccache_acquire(void)
+{
+	const char *path;
+	oval_ccache_t *cache;
+
+	path = getenv(OVAL_CCACHE_ENV);
+	if (path == NULL || *path == '\0')
+		return NULL;
+
+	pthread_mutex_lock(&__ccache_lock);
+
+	if (__ccache == NULL) {
+		cache = oscap_talloc(oval_ccache_t);
+		pthread_mutex_init(&cache->lock, NULL);
+		cache->path    = oscap_strdup(path);
+		cache->records = oscap_htable_new1((oscap_compare_func)strcmp, OVAL_CCACHE_HSIZE);
+		cache->refs    = 0;
+		cache->dirty   = false;
+
+		oval_ccache_load(cache);
+		__ccache = cache;
+	}
+
+	cache = __ccache;
+	++cache->refs;
+
+	pthread_mutex_unlock(&__ccache_lock);
+
+	return cache;
+}
+
+void oval_ccache_release(oval_ccache_t *cache)
+{
+	if (cache == NULL)
+		return;
+
+	pthread_mutex_lock(&__ccache_lock);
+
+	if (--cache->refs == 0) {
+		if (cache->dirty)
+			oval_ccache_save(cache);
+
+		oscap_htable_free(cache->records, oval_ccache_rec_free);
+		pthread_mutex_destroy(&cache->lock);
+		oscap_free(cache->path);
+		oscap_free(cache);
+		__ccache = NULL;
+	}
+
+	pthread_mutex_unlock(&__ccache_lock);
+}
+
+/*
+ * Fingerprints
+ */
+static void fp_add_path(SEXP_t *fp, const char *path)
+{
+	struct stat st;
+	SEXP_t *r0;
+
+	if (lstat(path, &st) != 0) {
+		r0 = SEXP_string_newf("%s\t-%d", path, errno);
+	} else {
+		if (S_ISLNK(st.st_mode)) {
+			struct stat tst;
+
+			if (stat(path, &tst) == 0)
+				st = tst;
+		}
+		r0 = SEXP_string_newf("%s\t%lld.%09ld:%lld.%09ld:%lld:%llu:%o:%u:%u", path,
+				      (long long)st.st_mtim.tv_sec, (long)st.st_mtim.tv_nsec,
+				      (long long)st.st_ctim.tv_sec, (long)st.st_ctim.tv_nsec,
+				      (long long)st.st_size, (unsigned long long)st.st_ino,
+				      (unsigned int)st.st_mode, (unsigned int)st.st_uid, (unsigned int)st.st_gid);
+	}
+
+	SEXP_list_add(fp, r0);
+	SEXP_free(r0);
+}
+
+static int fp_strcmp(const void *a, const void *b)
+{
+	return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/* The directory itself and every entry in it */
+static int fp_add_dir(SEXP_t *fp, const char *path)
+{
+	DIR *dir;
+	struct dirent *de;
+	char **names = NULL, buf[PATH_MAX];
+	size_t count = 0, i;
+	int ret = 0;
+
+	fp_add_path(fp, path);
+
+	dir = opendir(path);
+	if (dir == NULL)
+		return 0;
+
+	while ((de = readdir(dir)) != NULL) {
+		if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0)
+			continue;
+		if (count == OVAL_CCACHE_DIRMAX) {
+			ret = -1;
+			break;
+		}
+		names = oscap_realloc(names, sizeof(char *) * (count + 1));
+		names[count++] = oscap_strdup(de->d_name);
+	}
+	closedir(dir);
+
+	qsort(names, count, sizeof(char *), fp_strcmp);
+
+	for (i = 0; i < count; ++i) {
+		if (ret == 0) {
+			snprintf(buf, sizeof buf, "%s/%s", strcmp(path, "/") == 0 ? "" : path, names[i]);
+			fp_add_path(fp, buf);
+		}
+		oscap_free(names[i]);
+	}
+	oscap_free(names);
+
+	return ret;
+}
+
+/*
+ * Get the string value of an entity which is compared for equality with
+ * a literal value, NULL if the entity has a different operation or a
+ * variable reference.
+ */
+static char *fp_ent_literal(SEXP_t *ent, oval_operation_t *op)
+{
+	SEXP_t *val;
+	char *str;
+
+	*op = probe_ent_getoperation(ent, OVAL_OPERATION_EQUALS);
+
+	if (probe_ent_attrexists(ent, "var_ref"))
+		return NULL;
+
+	val = probe_ent_getval(ent);
+	if (val == NULL)
+		return NULL;
+
+	str = SEXP_stringp(val) ? SEXP_string_cstr(val) : NULL;
+	SEXP_free(val);
+
+	return str;
+}
+
+/*
+ * file, textfilecontent54, xmlfilecontent, ... objects: only non-recursive
+ * lookups of literal paths are supported. The fingerprint covers the files
+ * and the directories they are looked up in. If the filename is a pattern,
+ * all entries of the directory are included.
+ */
+static int fp_file_obj(SEXP_t *fp, const SEXP_t *s_obj)
+{
+	SEXP_t *ent, *val;
+	char *path = NULL, *name = NULL, buf[PATH_MAX];
+	oval_operation_t op;
+	int ret = -1;
+
+	if ((ent = probe_obj_getent(s_obj, "set", 1)) != NULL
+	    || (ent = probe_obj_getent(s_obj, "filter", 1)) != NULL) {
+		SEXP_free(ent);
+		return -1;
+	}
+
+	if ((ent = probe_obj_getent(s_obj, "behaviors", 1)) != NULL) {
+		val = probe_ent_getattrval(ent, "recurse_direction");
+		SEXP_free(ent);
+
+		if (val != NULL) {
+			bool none = SEXP_strcmp(val, "none") == 0;
+
+			SEXP_free(val);
+			if (!none)
+				return -1;
+		}
+	}
+
+	if ((ent = probe_obj_getent(s_obj, "filepath", 1)) != NULL) {
+		path = fp_ent_literal(ent, &op);
+		SEXP_free(ent);
+
+		if (path == NULL || op != OVAL_OPERATION_EQUALS || path[0] != '/')
+			goto out;
+
+		fp_add_path(fp, path);
+		*strrchr(path, '/') = '\0';
+		fp_add_path(fp, path[0] == '\0' ? "/" : path);
+		ret = 0;
+		goto out;
+	}
+
+	if ((ent = probe_obj_getent(s_obj, "path", 1)) == NULL)
+		return -1;
+	path = fp_ent_literal(ent, &op);
+	SEXP_free(ent);
+
+	if (path == NULL || op != OVAL_OPERATION_EQUALS || path[0] != '/')
+		goto out;
+
+	if ((ent = probe_obj_getent(s_obj, "filename", 1)) == NULL
+	    || probe_ent_getvals(ent, NULL) == 0) {
+		/* the directory itself */
+		SEXP_free(ent);
+		fp_add_path(fp, path);
+		ret = 0;
+		goto out;
+	}
+	name = fp_ent_literal(ent, &op);
+	SEXP_free(ent);
+
+	if (name == NULL)
+		goto out;
+
+	switch (op) {
+	case OVAL_OPERATION_EQUALS:
+		fp_add_path(fp, path);
+		snprintf(buf, sizeof buf, "%s/%s", strcmp(path, "/") == 0 ? "" : path, name);
+		fp_add_path(fp, buf);
+		ret = 0;
+		break;
+	case OVAL_OPERATION_PATTERN_MATCH:
+		ret = fp_add_dir(fp, path);
+		break;
+	default:
+		break;
+	}
+out:
+	oscap_free(path);
+	oscap_free(name);
+
+	return ret;
+}
+
+static const char *fp_rpmdb[] = {
+	"/var/lib/rpm/Packages",
+	"/var/lib/rpm/rpmdb.sqlite",
+	"/usr/lib/sysimage/rpm/rpmdb.sqlite",
+	NULL
+};
+
+static const char *fp_dpkgdb[] = {
+	"/var/lib/dpkg/status",
+	NULL
+};
+
+static const char *fp_passwd[] = {
+	"/etc/passwd",
+	NULL
+};
+
+static const char *fp_shadow[] = {
+	"/etc/shadow",
+	NULL
+};
+
+/*
+ * Compute the fingerprint of the system state the probe result for
+ * `s_obj' depends on. Returns NULL if the result can't be cached.
+ */
+static SEXP_t *oval_ccache_fingerprint(oval_subtype_t type, const SEXP_t *s_obj)
+{
+	const char **files = NULL;
+	SEXP_t *fp;
+	int ret = 0;
+
+	/* offline scans use a different root for every run */
+	if (getenv("OSCAP_PROBE_ROOT") != NULL || getenv("OSCAP_PROBE_OCI_LAYERS") != NULL)
+		return NULL;
+
+	switch ((int)type) {
+	case OVAL_LINUX_RPM_INFO:
+		files = fp_rpmdb;
+		break;
+	case OVAL_LINUX_DPKG_INFO:
+		files = fp_dpkgdb;
+		break;
+	case OVAL_UNIX_PASSWORD:
+		files = fp_passwd;
+		break;
+	case OVAL_UNIX_SHADOW:
+		files = fp_shadow;
+		break;
+	case OVAL_UNIX_FILE:
+	case OVAL_INDEPENDENT_FILE_HASH:
+	case OVAL_INDEPENDENT_FILE_HASH58:
+	case OVAL_INDEPENDENT_TEXT_FILE_CONTENT:
+	case OVAL_INDEPENDENT_TEXT_FILE_CONTENT_54:
+	case OVAL_INDEPENDENT_XML_FILE_CONTENT:
+		break;
+	default:
+		return NULL;
+	}
+
+	fp = SEXP_list_new(NULL);
+
+	if (files != NULL) {
+		for (; *files != NULL; ++files)
+			fp_add_path(fp, *files);
+	} else
+		ret = fp_file_obj(fp, s_obj);
+
+	if (ret != 0) {
+		SEXP_free(fp);
+		return NULL;
+	}
+
+	return fp;
+}
+
+SEXP_t *oval_ccache_get(oval_ccache_t *cache, oval_subtype_t type, const SEXP_t *s_obj, SEXP_t **fp)
+{
+	oval_ccache_rec_t *rec;
+	SEXP_t *s_cobj = NULL;
+	char key[32];
+
+	*fp = oval_ccache_fingerprint(type, s_obj);
+	if (*fp == NULL)
+		return NULL;
+
+	oval_ccache_key(s_obj, key, sizeof key);
+
+	pthread_mutex_lock(&cache->lock);
+	rec = oscap_htable_get(cache->records, key);
+	if (rec != NULL && SEXP_deepcmp(rec->obj, s_obj) && SEXP_deepcmp(rec->fp, *fp))
+		s_cobj = SEXP_ref(rec->cobj);
+	pthread_mutex_unlock(&cache->lock);
+
+	if (s_cobj != NULL) {
+		SEXP_free(*fp);
+		*fp = NULL;
+	}
+
+	return s_cobj;
+}
+
+void oval_ccache_put(oval_ccache_t *cache, const SEXP_t *s_obj, const SEXP_t *fp, const SEXP_t *s_cobj)
+{
+	oval_ccache_rec_t *rec;
+	char key[32];
+
+	if (fp == NULL || s_cobj == NULL)
+		return;
+
+	switch (probe_cobj_get_flag(s_cobj)) {
+	case SYSCHAR_FLAG_COMPLETE:
+	case SYSCHAR_FLAG_DOES_NOT_EXIST:
+		break;
+	default:
+		return;
+	}
+
+	oval_ccache_key(s_obj, key, sizeof key);
+
+	pthread_mutex_lock(&cache->lock);
+	rec = oscap_htable_get(cache->records, key);
+	if (rec == NULL) {
+		rec = oscap_talloc(oval_ccache_rec_t);
+		rec->key = oscap_strdup(key);
+		oscap_htable_add(cache->records, key, rec);
+	} else
+		SEXP_vfree(rec->obj, rec->fp, rec->cobj, NULL);
+
+	rec->obj  = SEXP_ref(s_obj);
+	rec->fp   = SEXP_ref(fp);
+	rec->cobj = SEXP_ref(s_cobj);
+	cache->dirty = true;
+	pthread_mutex_unlock(&cache->lock);
+}
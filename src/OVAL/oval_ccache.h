@@ -0,0 +1,70 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ * Collection cache persisted between scans. Collected objects (as returned
+ * by the probes) are stored in the file named by the OSCAP_COLLECTION_CACHE
+ * environment variable together with a fingerprint of the filesystem state
+ * the probe result depends on. A later scan reuses a cached result if both
+ * the object S-exp and the fingerprint match, i.e. only objects whose
+ * inputs changed since the previous run are collected again.
+ */
+#ifndef OVAL_CCACHE_H
+#define OVAL_CCACHE_H
+
+#include <seap.h>
+#include "public/oval_types.h"
+#include "common/util.h"
+
+OSCAP_HIDDEN_START;
+
+typedef struct oval_ccache oval_ccache_t;
+
+/**
+ * Get a reference to the process-wide collection cache. The cache file is
+ * loaded on the first call.
+ * @return NULL if OSCAP_COLLECTION_CACHE is not set
+ */
+oval_ccache_t *oval_ccache_acquire(void);
+
+/**
+ * Drop a reference obtained by oval_ccache_acquire(). The cache file is
+ * written when the last reference is dropped and the cache was modified.
+ */
+void oval_ccache_release(oval_ccache_t *cache);
+
+/**
+ * Look up the collected object for `s_obj'.
+ * @param fp if the lookup fails, the fingerprint computed for `s_obj' is
+ *           stored here (to be passed to oval_ccache_put()). It is set to
+ *           NULL if the object type or the object itself can't be cached.
+ * @return new reference to the cached collected object or NULL
+ */
+SEXP_t *oval_ccache_get(oval_ccache_t *cache, oval_subtype_t type, const SEXP_t *s_obj, SEXP_t **fp);
+
+/**
+ * Store the collected object `s_cobj' of `s_obj'. Results of incomplete
+ * or failed collections are ignored.
+ */
+void oval_ccache_put(oval_ccache_t *cache, const SEXP_t *s_obj, const SEXP_t *fp, const SEXP_t *s_cobj);
+
+OSCAP_HIDDEN_END;
+
+#endif /* OVAL_CCACHE_H */
@@ -1792,22 +1792,22 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_SUBSTRING(oval_ar
 static long unsigned int _comp_sec(int year, int month, int day, int hour, int minute, int second)
 {
 	time_t t;
-	struct tm *ts;
+	struct tm ts;
 
 	t = time(NULL);
-	ts = localtime(&t);
-
-	ts->tm_year = year - 1900;
-	ts->tm_mon = month - 1;
-	ts->tm_mday = day;
-	ts->tm_hour = hour;
-	ts->tm_min = minute;
-	ts->tm_sec = second;
-	ts->tm_isdst = -1;
-	t = mktime(ts);
-	ts = localtime(&t);
-
-	if (ts->tm_isdst == 1)
+	localtime_r(&t, &ts);
+
+	ts.tm_year = year - 1900;
+	ts.tm_mon = month - 1;
+	ts.tm_mday = day;
+	ts.tm_hour = hour;
+	ts.tm_min = minute;
+	ts.tm_sec = second;
+	ts.tm_isdst = -1;
+	t = mktime(&ts);
+	localtime_r(&t, &ts);
+
+	if (ts.tm_isdst == 1)
 		t -= 3600;
 
 	return (long unsigned int) t;
@@ -1892,11 +1892,11 @@ static long unsigned int _parse_fmt_win(char *dt)
 static long unsigned int _parse_fmt_sse(char *dt)
 {
 	time_t t;
-	struct tm *ts;
+	struct tm ts;
 
 	t = (time_t) atol(dt);
-	ts = localtime(&t);
-	if (ts->tm_isdst == 1)
+	localtime_r(&t, &ts);
+	if (ts.tm_isdst == 1)
 		t -= 3600;
 
 	return (long unsigned int) t;
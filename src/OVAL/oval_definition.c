@@ -42,6 +42,7 @@
 
 #include "common/assume.h"
 #include "common/util.h"
+#include "common/intern.h"
 #include "common/debug_priv.h"
 #include "common/elements.h"
 #include "common/_error.h"
@@ -155,7 +156,7 @@ struct oval_definition *oval_definition_new(struct oval_definition_model *model,
 
         assume_r(definition != NULL, /* return */ NULL);
 
-	definition->id = oscap_strdup(id);
+	definition->id = oscap_intern(id);
 	definition->version = 0;
 	definition->class = OVAL_CLASS_UNKNOWN;
 	definition->deprecated = 0;
@@ -218,8 +219,7 @@ void oval_definition_free(struct oval_definition *definition)
 {
 	__attribute__nonnull__(definition);
 
-	if (definition->id != NULL)
-		oscap_free(definition->id);
+	oscap_intern_release(definition->id);
 	if (definition->title != NULL)
 		oscap_free(definition->title);
 	if (definition->description != NULL)
@@ -43,6 +43,7 @@
 #include "oval_parser_impl.h"
 
 #include "common/util.h"
+#include "common/intern.h"
 #include "common/debug_priv.h"
 #include "common/elements.h"
 #include "common/_error.h"
@@ -209,8 +210,7 @@ void oval_entity_free(struct oval_entity *entity)
 
 	if (entity->value != NULL)
 		oval_value_free(entity->value);
-	if (entity->name != NULL)
-		oscap_free(entity->name);
+	oscap_intern_release(entity->name);
 
 	entity->name = NULL;
 	entity->value = NULL;
@@ -269,9 +269,8 @@ void oval_entity_set_value(struct oval_entity *entity, struct oval_value *value)
 void oval_entity_set_name(struct oval_entity *entity, char *name)
 {
 	__attribute__nonnull__(entity);
-	if (entity->name != NULL)
-		oscap_free(entity->name);
-	entity->name = (name == NULL) ? NULL : oscap_strdup(name);
+	oscap_intern_release(entity->name);
+	entity->name = oscap_intern(name);
 }
 
 static void oval_consume_varref(char *varref, void *user)
@@ -52,7 +52,7 @@ struct oval_generator *oval_generator_new(void)
 {
 	struct oval_generator *gen;
 	time_t et;
-	struct tm *lt;
+	struct tm lt;
 	char timestamp[] = "yyyy-mm-ddThh:mm:ss";
 
 	gen = oscap_alloc(sizeof(struct oval_generator));
@@ -61,10 +61,11 @@ struct oval_generator *oval_generator_new(void)
 	gen->schema_version = oscap_strdup(OVAL_SUPPORTED);
 	gen->anyxml = NULL;
 
+	/* models are created by several threads at once, see xccdf_session_load_oval() */
 	time(&et);
-	lt = localtime(&et);
+	localtime_r(&et, &lt);
 	snprintf(timestamp, sizeof(timestamp), "%4d-%02d-%02dT%02d:%02d:%02d",
-		 1900 + lt->tm_year, 1 + lt->tm_mon, lt->tm_mday, lt->tm_hour, lt->tm_min, lt->tm_sec);
+		 1900 + lt.tm_year, 1 + lt.tm_mon, lt.tm_mday, lt.tm_hour, lt.tm_min, lt.tm_sec);
 	gen->timestamp = oscap_strdup(timestamp);
 
 	return gen;
@@ -39,6 +39,7 @@
 #include "adt/oval_collection_impl.h"
 #include "oval_agent_api_impl.h"
 #include "common/debug_priv.h"
+#include "common/intern.h"
 #include "common/elements.h"
 #include "public/oval_version.h"
 
@@ -168,7 +169,7 @@ struct oval_object *oval_object_new(struct oval_definition_model *model, const c
 		return NULL;
 
 	object->comment = NULL;
-	object->id = oscap_strdup(id);
+	object->id = oscap_intern(id);
 	object->subtype = OVAL_SUBTYPE_UNKNOWN;
 	object->base_obj_ref = NULL;
 	object->deprecated = 0;
@@ -235,8 +236,7 @@ void oval_object_free(struct oval_object *object)
 
 	if (object->comment != NULL)
 		oscap_free(object->comment);
-	if (object->id != NULL)
-		oscap_free(object->id);
+	oscap_intern_release(object->id);
 	oval_collection_free_items(object->behaviors, (oscap_destruct_func) oval_behavior_free);
 	oval_collection_free_items(object->notes, (oscap_destruct_func) oscap_free);
 	oval_collection_free_items(object->object_content, (oscap_destruct_func) oval_object_content_free);
@@ -0,0 +1,499 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "common/alloc.h"
+#include "common/debug_priv.h"
+#include "adt/oval_string_map_impl.h"
+#include "results/oval_results_impl.h"
+#include "collectVarRefs_impl.h"
+#include "oval_definitions_impl.h"
+#include "oval_system_characteristics_impl.h"
+#include "_oval_probe_session.h"
+#include "_oval_probe_handler.h"
+#include "oval_probe_ext.h"
+#include "oval_peval.h"
+
+/* default upper limit of the number of threads */
+#define OVAL_PEVAL_JOBS_DEFAULT_MAX 8
+#define OVAL_PEVAL_JOBS_MAX         64
+
+unsigned int oval_peval_jobs(void)
+{
+	const char *env;
+	char *end;
+	long jobs;
+
+	env = getenv(OVAL_PEVAL_JOBS_ENV);
+
+	if (env != NULL) {
+		jobs = strtol(env, &end, 10);
+
+		if (*env == '\0' || *end != '\0' || jobs < 1) {
+			dW("Invalid value of %s: \"%s\", evaluating sequentially.\n", OVAL_PEVAL_JOBS_ENV, env);
+			return 1;
+		}
+
+		return (jobs > OVAL_PEVAL_JOBS_MAX ? OVAL_PEVAL_JOBS_MAX : jobs);
+	}
+
+	jobs = sysconf(_SC_NPROCESSORS_ONLN);
+
+	if (jobs < 1)
+		return 1;
+
+	return (jobs > OVAL_PEVAL_JOBS_DEFAULT_MAX ? OVAL_PEVAL_JOBS_DEFAULT_MAX : jobs);
+}
+
+/*
+ * Run `worker' in `jobs' threads, the calling thread being one of them.
+ * If a thread can't be created, the work is done by the threads that
+ * were created.
+ */
+static void peval_run(void *(*worker)(void *), void *arg, unsigned int jobs)
+{
+	pthread_t *threads;
+	unsigned int i, n;
+
+	threads = oscap_alloc(sizeof(pthread_t) * jobs);
+
+	for (n = 0; n < jobs - 1; ++n) {
+		int err = pthread_create(&threads[n], NULL, worker, arg);
+
+		if (err != 0) {
+			dW("Can't create an evaluation thread: %d, %s.\n", err, strerror(err));
+			break;
+		}
+	}
+
+	worker(arg);
+
+	for (i = 0; i < n; ++i)
+		pthread_join(threads[i], NULL);
+
+	oscap_free(threads);
+}
+
+/*
+ * Collection
+ *
+ * The system characteristics model and the probe session state are shared
+ * by the threads, so every thread holds the evaluation lock while it works
+ * with them. The lock is released only while a thread waits for the reply
+ * of a probe (see oval_probe_comm), which is where most of the time goes.
+ */
+
+struct peval_object {
+	struct oval_object *object;
+	oval_subtype_t      subtype;
+	size_t              index;
+};
+
+struct peval_collector {
+	oval_probe_session_t *sess;
+	pthread_mutex_t       lock;
+
+	struct peval_object  *memb;
+	size_t                count;
+	size_t                size;
+	size_t                next;  /* first object of the next unclaimed subtype */
+	bool                  abort;
+	int                   ret;   /* first error which stopped the collection */
+
+	struct oval_string_map *seen;
+};
+
+/*
+ * Objects without variable references, sets and filters don't make the
+ * library query other objects or states during their collection.
+ */
+static bool peval_object_independent(struct oval_object *object)
+{
+	struct oval_object_content_iterator *cont_itr;
+	struct oval_string_map *vm;
+	struct oval_iterator *var_itr;
+	bool independent = true;
+
+	cont_itr = oval_object_get_object_contents(object);
+	while (oval_object_content_iterator_has_more(cont_itr)) {
+		struct oval_object_content *content = oval_object_content_iterator_next(cont_itr);
+
+		if (oval_object_content_get_type(content) != OVAL_OBJECTCONTENT_ENTITY) {
+			independent = false;
+			break;
+		}
+	}
+	oval_object_content_iterator_free(cont_itr);
+
+	if (!independent)
+		return false;
+
+	vm = oval_string_map_new();
+	oval_obj_collect_var_refs(object, vm);
+	var_itr = oval_string_map_values(vm);
+	independent = !oval_collection_iterator_has_more(var_itr);
+	oval_collection_iterator_free(var_itr);
+	oval_string_map_free(vm, NULL);
+
+	return independent;
+}
+
+static void peval_add_object(struct peval_collector *col, struct oval_object *object)
+{
+	char *id = oval_object_get_id(object);
+
+	if (oval_string_map_get_value(col->seen, id) != NULL)
+		return;
+
+	oval_string_map_put(col->seen, id, object);
+
+	if (!peval_object_independent(object))
+		return;
+
+	if (col->count == col->size) {
+		col->size = col->size ? col->size * 2 : 64;
+		col->memb = oscap_realloc(col->memb, sizeof(struct peval_object) * col->size);
+	}
+
+	col->memb[col->count].object  = object;
+	col->memb[col->count].subtype = oval_object_get_subtype(object);
+	col->memb[col->count].index   = col->count;
+	++col->count;
+}
+
+static void peval_add_criteria(struct peval_collector *col, struct oval_criteria_node *node, struct oval_string_map *defs)
+{
+	switch (oval_criteria_node_get_type(node)) {
+	case OVAL_NODETYPE_CRITERIA: {
+		struct oval_criteria_node_iterator *subnodes = oval_criteria_node_get_subnodes(node);
+
+		while (oval_criteria_node_iterator_has_more(subnodes))
+			peval_add_criteria(col, oval_criteria_node_iterator_next(subnodes), defs);
+		oval_criteria_node_iterator_free(subnodes);
+	}	break;
+	case OVAL_NODETYPE_CRITERION: {
+		struct oval_test *test = oval_criteria_node_get_test(node);
+
+		if (test != NULL && oval_test_get_object(test) != NULL)
+			peval_add_object(col, oval_test_get_object(test));
+	}	break;
+	case OVAL_NODETYPE_EXTENDDEF: {
+		struct oval_definition *definition = oval_criteria_node_get_definition(node);
+		char *id;
+
+		if (definition == NULL || oval_definition_get_criteria(definition) == NULL)
+			break;
+
+		id = oval_definition_get_id(definition);
+		if (oval_string_map_get_value(defs, id) != NULL)
+			break;
+
+		oval_string_map_put(defs, id, definition);
+		peval_add_criteria(col, oval_definition_get_criteria(definition), defs);
+	}	break;
+	default:
+		break;
+	}
+}
+
+static int peval_object_cmp(const void *a, const void *b)
+{
+	const struct peval_object *x = a, *y = b;
+
+	if (x->subtype != y->subtype)
+		return (x->subtype < y->subtype ? -1 : 1);
+
+	return (x->index > y->index) - (x->index < y->index);
+}
+
+static void *peval_collect_worker(void *arg)
+{
+	struct peval_collector *col = arg;
+	size_t i, end;
+	int ret;
+
+	pthread_mutex_lock(&col->lock);
+
+	while (!col->abort && col->next < col->count) {
+		/* claim all objects of the next subtype */
+		i = end = col->next;
+
+		while (end < col->count && col->memb[end].subtype == col->memb[i].subtype)
+			++end;
+
+		col->next = end;
+
+		for (; i < end && !col->abort; ++i) {
+			ret = oval_probe_query_object(col->sess, col->memb[i].object, 0, NULL);
+
+			/* -2: evaluation aborted by oval_probe_session_abort() */
+			if (ret == -1 || ret == -2) {
+				if (!col->abort)
+					col->ret = ret;
+				col->abort = true;
+			}
+		}
+	}
+
+	pthread_mutex_unlock(&col->lock);
+
+	return NULL;
+}
+
+int oval_peval_collect(oval_probe_session_t *sess, struct oval_definition_model *model, unsigned int jobs)
+{
+	struct peval_collector col;
+	struct oval_definition_iterator *def_itr;
+	struct oval_string_map *defs;
+	unsigned int types;
+	bool connected = false;
+	size_t i, n;
+
+	memset(&col, 0, sizeof col);
+	col.sess = sess;
+	col.seen = oval_string_map_new();
+	defs     = oval_string_map_new();
+
+	def_itr = oval_definition_model_get_definitions(model);
+	while (oval_definition_iterator_has_more(def_itr)) {
+		struct oval_definition *definition = oval_definition_iterator_next(def_itr);
+
+		if (oval_definition_get_criteria(definition) != NULL)
+			peval_add_criteria(&col, oval_definition_get_criteria(definition), defs);
+	}
+	oval_definition_iterator_free(def_itr);
+
+	oval_string_map_free(defs, NULL);
+	oval_string_map_free(col.seen, NULL);
+
+	if (col.count > 0)
+		qsort(col.memb, col.count, sizeof(struct peval_object), peval_object_cmp);
+
+	/*
+	 * Start the probes from this thread, the probes exit when the thread
+	 * that started them does. Objects of the types which can't be handled
+	 * this way are collected sequentially.
+	 */
+	for (i = 0, n = 0, types = 0; i < col.count; ++i) {
+		if (i == 0 || col.memb[i].subtype != col.memb[i - 1].subtype) {
+			oval_ph_t *ph = oval_probe_handler_get(sess->ph, col.memb[i].subtype);
+
+			connected = ph != NULL && ph->func == &oval_probe_ext_handler
+				&& oval_probe_ext_connect(sess->pext, col.memb[i].subtype) == 0;
+
+			if (connected)
+				++types;
+		}
+
+		if (connected)
+			col.memb[n++] = col.memb[i];
+	}
+
+	col.count = n;
+
+	/* nothing to run concurrently */
+	if (types < 2) {
+		oscap_free(col.memb);
+		return 0;
+	}
+
+	dI("Collecting %zu objects of %u types using %u threads.\n", col.count, types, jobs < types ? jobs : types);
+
+	pthread_mutex_init(&col.lock, NULL);
+	sess->pext->eval_lock = &col.lock;
+
+	peval_run(peval_collect_worker, &col, jobs < types ? jobs : types);
+
+	sess->pext->eval_lock = NULL;
+	pthread_mutex_destroy(&col.lock);
+	oscap_free(col.memb);
+
+	return col.ret;
+}
+
+/*
+ * Evaluation of result tests
+ *
+ * A result test reads the collected objects and items and the values of
+ * the variables referenced by its states, and writes only to itself. The
+ * variables are computed before the threads are started; tests using a
+ * variable which couldn't be computed would compute it again during their
+ * evaluation, those are evaluated by the calling thread first.
+ */
+
+struct peval_tests {
+	struct oval_result_test **memb;
+	size_t count;
+	size_t size;
+	size_t next;
+};
+
+static void peval_add_test(struct peval_tests *tests, struct oval_result_test *test)
+{
+	if (tests->count == tests->size) {
+		tests->size = tests->size ? tests->size * 2 : 64;
+		tests->memb = oscap_realloc(tests->memb, sizeof(struct oval_result_test *) * tests->size);
+	}
+
+	tests->memb[tests->count++] = test;
+}
+
+static void peval_add_result_criteria(struct peval_tests *tests, struct oval_result_criteria_node *node)
+{
+	switch (oval_result_criteria_node_get_type(node)) {
+	case OVAL_NODETYPE_CRITERIA: {
+		struct oval_result_criteria_node_iterator *subnodes = oval_result_criteria_node_get_subnodes(node);
+
+		while (oval_result_criteria_node_iterator_has_more(subnodes))
+			peval_add_result_criteria(tests, oval_result_criteria_node_iterator_next(subnodes));
+		oval_result_criteria_node_iterator_free(subnodes);
+	}	break;
+	case OVAL_NODETYPE_CRITERION: {
+		struct oval_result_test *test = oval_result_criteria_node_get_test(node);
+
+		if (test != NULL && oval_result_test_get_result(test) == OVAL_RESULT_NOT_EVALUATED)
+			peval_add_test(tests, test);
+	}	break;
+	case OVAL_NODETYPE_EXTENDDEF: {
+		struct oval_result_definition *definition = oval_result_criteria_node_get_extends(node);
+
+		if (definition != NULL
+		    && oval_result_definition_get_result(definition) == OVAL_RESULT_NOT_EVALUATED
+		    && oval_result_definition_get_criteria(definition) != NULL)
+			peval_add_result_criteria(tests, oval_result_definition_get_criteria(definition));
+	}	break;
+	default:
+		break;
+	}
+}
+
+static int peval_ptr_cmp(const void *a, const void *b)
+{
+	uintptr_t x = (uintptr_t)*(void * const *)a, y = (uintptr_t)*(void * const *)b;
+
+	return (x > y) - (x < y);
+}
+
+/*
+ * Compute the variables referenced by the states of the test.
+ * @return true if all of them have their values
+ */
+static bool peval_test_prepare(struct oval_result_test *rtest)
+{
+	struct oval_test *test = oval_result_test_get_test(rtest);
+	struct oval_syschar_model *sysmod;
+	struct oval_state_iterator *ste_itr;
+	struct oval_string_map *vm;
+	struct oval_iterator *var_itr;
+	bool ready = true;
+
+	if (test == NULL)
+		return true;
+
+	sysmod = oval_result_system_get_syschar_model(oval_result_test_get_system(rtest));
+	vm = oval_string_map_new();
+
+	ste_itr = oval_test_get_states(test);
+	while (oval_state_iterator_has_more(ste_itr))
+		oval_ste_collect_var_refs(oval_state_iterator_next(ste_itr), vm);
+	oval_state_iterator_free(ste_itr);
+
+	var_itr = oval_string_map_values(vm);
+	while (oval_collection_iterator_has_more(var_itr)) {
+		struct oval_variable *var = oval_collection_iterator_next(var_itr);
+
+		oval_syschar_model_compute_variable(sysmod, var);
+
+		if (oval_variable_get_type(var) == OVAL_VARIABLE_LOCAL
+		    && oval_variable_get_collection_flag(var) == SYSCHAR_FLAG_UNKNOWN)
+			ready = false;
+	}
+	oval_collection_iterator_free(var_itr);
+	oval_string_map_free(vm, NULL);
+
+	return ready;
+}
+
+static void *peval_test_worker(void *arg)
+{
+	struct peval_tests *tests = arg;
+	size_t i;
+
+	while ((i = __sync_fetch_and_add(&tests->next, 1)) < tests->count)
+		oval_result_test_eval(tests->memb[i]);
+
+	return NULL;
+}
+
+void oval_peval_tests(struct oval_result_definition **defs, size_t count, unsigned int jobs)
+{
+	struct peval_tests tests;
+	struct oval_result_test *prev = NULL;
+	size_t i, n;
+
+	memset(&tests, 0, sizeof tests);
+
+	for (i = 0; i < count; ++i) {
+		if (oval_result_definition_get_result(defs[i]) == OVAL_RESULT_NOT_EVALUATED
+		    && oval_result_definition_get_criteria(defs[i]) != NULL)
+			peval_add_result_criteria(&tests, oval_result_definition_get_criteria(defs[i]));
+	}
+
+	if (tests.count == 0)
+		return;
+
+	/* tests shared by several definitions are evaluated once */
+	qsort(tests.memb, tests.count, sizeof(struct oval_result_test *), peval_ptr_cmp);
+
+	for (i = 0, n = 0; i < tests.count; ++i) {
+		if (tests.memb[i] == prev)
+			continue;
+
+		prev = tests.memb[i];
+
+		if (!peval_test_prepare(tests.memb[i])) {
+			oval_result_test_eval(tests.memb[i]);
+			continue;
+		}
+
+		tests.memb[n++] = tests.memb[i];
+	}
+
+	tests.count = n;
+
+	if (tests.count > 0) {
+		dI("Evaluating %zu tests using %u threads.\n", tests.count,
+		   jobs < tests.count ? jobs : (unsigned int)tests.count);
+
+		peval_run(peval_test_worker, &tests, jobs < tests.count ? jobs : (unsigned int)tests.count);
+	}
+
+	oscap_free(tests.memb);
+}
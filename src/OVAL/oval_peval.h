@@ -0,0 +1,64 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ * Parallel evaluation of the definitions of an OVAL agent session, see
+ * oval_agent_eval_system().
+ */
+#ifndef OVAL_PEVAL_H
+#define OVAL_PEVAL_H
+
+#include <stddef.h>
+#include "public/oval_probe_session.h"
+#include "public/oval_definitions.h"
+#include "public/oval_results.h"
+#include "common/util.h"
+
+OSCAP_HIDDEN_START;
+
+#define OVAL_PEVAL_JOBS_ENV "OSCAP_OVAL_JOBS"
+
+/**
+ * Number of threads used to evaluate the definitions. Taken from the
+ * OSCAP_OVAL_JOBS environment variable, defaults to the number of online
+ * processors. 1 means that the definitions are evaluated one by one.
+ */
+unsigned int oval_peval_jobs(void);
+
+/**
+ * Collect the objects of all definitions of the model using `jobs' threads.
+ * Objects of the same type are collected by the same thread, so different
+ * probes work concurrently. Objects that depend on variables, sets or
+ * filters are left for the sequential collection.
+ * @returns 0 on success, -1 on error, -2 if the evaluation was aborted
+ * by oval_probe_session_abort()
+ */
+int oval_peval_collect(oval_probe_session_t *sess, struct oval_definition_model *model, unsigned int jobs);
+
+/**
+ * Evaluate the result tests of the given result definitions using `jobs'
+ * threads. The definitions themselves aren't evaluated, this is left to
+ * the caller, which gets the results of the tests from the result tests.
+ */
+void oval_peval_tests(struct oval_result_definition **defs, size_t count, unsigned int jobs);
+
+OSCAP_HIDDEN_END;
+
+#endif /* OVAL_PEVAL_H */
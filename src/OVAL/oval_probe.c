@@ -258,7 +258,14 @@ int oval_probe_query_object(oval_probe_session_t *psess, struct oval_object *obj
 
 			dI("Syschar already exists, flag: %u, '%s'.\n", sc_flg, oval_syschar_collection_flag_get_text(sc_flg));
 
-			if (sc_flg != SYSCHAR_FLAG_UNKNOWN || (flags & OVAL_PDFLAG_NOREPLY)) {
+			if (flags & OVAL_PDFLAG_SLAVE) {
+				/*
+				 * The probe asking for the object doesn't have its result,
+				 * it was dropped from its result cache or not collected by
+				 * it at all. Collect it again for the probe only.
+				 */
+				dI("Collecting the object again for the probe.\n");
+			} else if (sc_flg != SYSCHAR_FLAG_UNKNOWN || (flags & OVAL_PDFLAG_NOREPLY)) {
 				if (out_syschar)
 					*out_syschar = sysc;
 				return 0;
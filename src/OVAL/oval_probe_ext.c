@@ -43,6 +43,7 @@
 #include "oval_probe_ext.h"
 #include "oval_sexp.h"
 #include "oval_probe_meta.h"
+#include "oval_pstats.h"
 
 #define __ERRBUF_SIZE 128
 
@@ -75,9 +76,19 @@ oval_pext_t *oval_pext_new(void)
         if (pext->probe_dir == NULL)
                 pext->probe_dir = OVAL_PROBE_DIR;
 
+#if defined(OVAL_PROBEDIR_ENV)
+        pext->probe_scheme = getenv("OVAL_PROBE_SCHEME");
+#else
+        pext->probe_scheme = NULL;
+#endif
+        if (pext->probe_scheme == NULL)
+                pext->probe_scheme = OVAL_PROBE_SCHEME;
+
         pext->pdtbl     = NULL;
         pext->pdsc      = NULL;
         pext->pdsc_cnt  = 0;
+        pext->ccache    = oval_ccache_acquire();
+        pext->eval_lock = NULL;
 
         return(pext);
 }
@@ -85,6 +96,21 @@ oval_pext_t *oval_pext_new(void)
 void oval_pext_free(oval_pext_t *pext)
 {
         if (!pext->do_init) {
+                if (oval_pstats_enabled()) {
+                        for (size_t i = 0; i < pext->pdtbl->count; ++i) {
+                                oval_pd_t *pd = pext->pdtbl->memb[i];
+                                SEXP_t *stats;
+
+                                if (pd->sd == -1)
+                                        continue;
+
+                                stats = oval_probe_ext_rcache_stats(pext->pdtbl->ctx, pd);
+                                if (stats != NULL) {
+                                        oval_pstats_write_rcache(oval_subtype_to_str(pd->subtype), stats);
+                                        SEXP_free(stats);
+                                }
+                        }
+                }
                 /* free structs */
 		oscap_free(pext->pdsc);
 		pext->pdsc     = NULL;
@@ -92,6 +118,7 @@ void oval_pext_free(oval_pext_t *pext)
                 oval_pdtbl_free(pext->pdtbl);
         }
 
+        oval_ccache_release(pext->ccache);
         pthread_mutex_destroy(&pext->lock);
         oscap_free(pext);
 }
@@ -206,7 +233,7 @@ static int oval_probe_cmd_init(oval_pext_t *pext)
 	return (0);
 }
 
-static SEXP_t *oval_probe_cmd_obj_eval(SEXP_t *sexp, void *arg)
+static SEXP_t *_oval_probe_cmd_obj_eval(SEXP_t *sexp, void *arg)
 {
 	char *id_str;
 	struct oval_definition_model *defs;
@@ -264,7 +291,7 @@ static SEXP_t *oval_probe_cmd_obj_eval(SEXP_t *sexp, void *arg)
 	return (ret);
 }
 
-static SEXP_t *oval_probe_cmd_ste_fetch(SEXP_t *sexp, void *arg)
+static SEXP_t *_oval_probe_cmd_ste_fetch(SEXP_t *sexp, void *arg)
 {
 	SEXP_t *id, *ste_list, *ste_sexp;
 	char *id_str;
@@ -314,6 +341,42 @@ static SEXP_t *oval_probe_cmd_ste_fetch(SEXP_t *sexp, void *arg)
 	return (ste_list);
 }
 
+/*
+ * The commands are handled by the thread waiting for the reply of the
+ * probe, with the evaluation lock released.
+ */
+static SEXP_t *oval_probe_cmd_obj_eval(SEXP_t *sexp, void *arg)
+{
+	pthread_mutex_t *eval_lock = ((oval_pext_t *)arg)->eval_lock;
+	SEXP_t *ret;
+
+	if (eval_lock != NULL)
+		pthread_mutex_lock(eval_lock);
+
+	ret = _oval_probe_cmd_obj_eval(sexp, arg);
+
+	if (eval_lock != NULL)
+		pthread_mutex_unlock(eval_lock);
+
+	return (ret);
+}
+
+static SEXP_t *oval_probe_cmd_ste_fetch(SEXP_t *sexp, void *arg)
+{
+	pthread_mutex_t *eval_lock = ((oval_pext_t *)arg)->eval_lock;
+	SEXP_t *ret;
+
+	if (eval_lock != NULL)
+		pthread_mutex_lock(eval_lock);
+
+	ret = _oval_probe_cmd_ste_fetch(sexp, arg);
+
+	if (eval_lock != NULL)
+		pthread_mutex_unlock(eval_lock);
+
+	return (ret);
+}
+
 static inline const char *_probe_strerror(uint32_t error_code)
 {
 	const char *codemsg;
@@ -430,7 +493,8 @@ static inline int _handle_SEAP_receive_failure(SEAP_CTX_t *ctx, oval_pd_t *pd, S
 	return (-1);
 }
 
-static int oval_probe_comm(SEAP_CTX_t *ctx, oval_pd_t *pd, const SEXP_t *s_iobj, int flags, SEXP_t **out_sexp)
+static int oval_probe_comm(SEAP_CTX_t *ctx, oval_pd_t *pd, const SEXP_t *s_iobj, int flags, SEXP_t **out_sexp, oval_pstats_t *stats,
+			   pthread_mutex_t *eval_lock)
 {
 	int retry, ret;
 
@@ -490,6 +554,11 @@ static int oval_probe_comm(SEAP_CTX_t *ctx, oval_pd_t *pd, const SEXP_t *s_iobj,
 			}
 		}
 
+		if (stats != NULL) {
+			SEAP_msgattr_set(s_omsg, PROBE_MSGATTR_STATS, NULL);
+			oval_pstats_comm_begin(stats, ctx, pd->sd);
+		}
+
 		oscap_dlprintf(DBG_I, "Sending message.\n");
 
 		ret = SEAP_sendmsg(ctx, pd->sd, s_omsg);
@@ -554,7 +623,17 @@ static int oval_probe_comm(SEAP_CTX_t *ctx, oval_pd_t *pd, const SEXP_t *s_iobj,
 		/* recv_retry: */
 		s_imsg = NULL;
 
+		/* let other threads use the models while the probe works */
+		if (eval_lock != NULL)
+			pthread_mutex_unlock(eval_lock);
+
 		ret = SEAP_recvmsg(ctx, pd->sd, &s_imsg);
+
+		if (eval_lock != NULL) {
+			protect_errno {
+				pthread_mutex_lock(eval_lock);
+			}
+		}
 		if (ret != 0) {
 			protect_errno {
 				ret = _handle_SEAP_receive_failure(ctx, pd, s_omsg, flags);
@@ -589,6 +668,9 @@ static int oval_probe_comm(SEAP_CTX_t *ctx, oval_pd_t *pd, const SEXP_t *s_iobj,
 
 	s_oobj = SEAP_msg_get(s_imsg);
 
+	if (stats != NULL)
+		oval_pstats_comm_end(stats, ctx, pd->sd, s_imsg);
+
 	SEAP_msg_free(s_imsg);
 	SEAP_msg_free(s_omsg);
 
@@ -637,7 +719,7 @@ static int oval_probe_sys_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, struct oval_sysch
                 SEXP_free (r0);
         }
 
-        ret = oval_probe_comm(ctx, pd, s_obj, 0, &r0);
+        ret = oval_probe_comm(ctx, pd, s_obj, 0, &r0, NULL, NULL);
         SEXP_free(s_obj);
 
 	if (ret != 0)
@@ -788,7 +870,7 @@ int oval_probe_sys_handler(oval_subtype_t type, void *ptr, int act, ...)
 		}
 
                 probe_urilen = snprintf(probe_uri, sizeof probe_uri,
-                                        "%s://%s/%s", OVAL_PROBE_SCHEME, probe_dir, probe_dsc->file);
+                                        "%s://%s/%s", pext->probe_scheme, probe_dir, probe_dsc->file);
 
                 if (probe_urilen >= sizeof probe_uri) {
                         oscap_seterr (OSCAP_EFAMILY_GLIBC, "probe URI too long");
@@ -817,6 +899,77 @@ int oval_probe_sys_handler(oval_subtype_t type, void *ptr, int act, ...)
         return(ret);
 }
 
+/*
+ * Get the descriptor of the probe handling objects of `type', add it to the
+ * descriptor table if it isn't there yet.
+ * @return 0 on success, 1 if there's no probe for the type, -1 on error
+ */
+static int oval_pext_getpd(oval_pext_t *pext, oval_subtype_t type, oval_pd_t **out_pd)
+{
+	oval_pd_t *pd;
+
+	pd = oval_pdtbl_get(pext->pdtbl, type);
+
+	if (pd == NULL) {
+		char         probe_uri[PATH_MAX + 1];
+		size_t       probe_urilen;
+		oval_pdsc_t *probe_dsc;
+
+		probe_dsc = oval_pdsc_lookup(pext->pdsc, pext->pdsc_cnt, type);
+
+		if (probe_dsc == NULL)
+			return (1);
+
+		probe_urilen = snprintf(probe_uri, sizeof probe_uri,
+					"%s://%s/%s", pext->probe_scheme, pext->probe_dir, probe_dsc->file);
+
+		if (probe_urilen >= sizeof probe_uri) {
+			oscap_seterr (OSCAP_EFAMILY_GLIBC, "probe URI too long");
+			return (-1);
+		}
+
+		oscap_dlprintf(DBG_I, "URI: %s.\n", probe_uri);
+
+		if (oval_pdtbl_add(pext->pdtbl, type, -1, probe_uri) != 0)
+			return (1);
+
+		pd = oval_pdtbl_get(pext->pdtbl, type);
+
+		if (pd == NULL) {
+			oscap_seterr (OSCAP_EFAMILY_OVAL, "internal error");
+			return (-1);
+		}
+	}
+
+	*out_pd = pd;
+	return (0);
+}
+
+int oval_probe_ext_connect(oval_pext_t *pext, oval_subtype_t type)
+{
+	oval_pd_t *pd;
+
+	if (pext->do_init)
+		return (-1);
+
+	if (oval_pext_getpd(pext, type, &pd) != 0)
+		return (-1);
+
+	if (pd->sd == -1) {
+		pd->sd = SEAP_connect(pext->pdtbl->ctx, pd->uri, 0);
+
+		if (pd->sd < 0) {
+			protect_errno {
+				oscap_dlprintf(DBG_W, "Can't connect: %u, %s.\n", errno, strerror(errno));
+			}
+			pd->sd = -1;
+			return (-1);
+		}
+	}
+
+	return (0);
+}
+
 int oval_probe_ext_handler(oval_subtype_t type, void *ptr, int act, ...)
 {
         int          ret = 0;
@@ -836,58 +989,30 @@ int oval_probe_ext_handler(oval_subtype_t type, void *ptr, int act, ...)
 		sys = va_arg(ap, struct oval_syschar *);
 		flags = va_arg(ap, int);
 		obj = oval_syschar_get_object(sys);
-                pd = oval_pdtbl_get(pext->pdtbl, oval_object_get_subtype(obj));
-
-                if (pd == NULL) {
-                        char         probe_uri[PATH_MAX + 1];
-                        size_t       probe_urilen;
-                        char        *probe_dir;
-                        oval_pdsc_t *probe_dsc;
-
-                        probe_dir = pext->probe_dir;
-                        probe_dsc = oval_pdsc_lookup(pext->pdsc, pext->pdsc_cnt, oval_object_get_subtype(obj));
-
-			if (probe_dsc == NULL) {
-				oval_syschar_add_new_message(sys, "OVAL object not supported", OVAL_MESSAGE_LEVEL_WARNING);
-				oval_syschar_set_flag(sys, SYSCHAR_FLAG_NOT_COLLECTED);
-				va_end(ap);
-				return (1);
-			}
 
-                        probe_urilen = snprintf(probe_uri, sizeof probe_uri,
-                                                "%s://%s/%s", OVAL_PROBE_SCHEME, probe_dir, probe_dsc->file);
+		ret = oval_pext_getpd(pext, oval_object_get_subtype(obj), &pd);
 
-                        if (probe_urilen >= sizeof probe_uri) {
-                                oscap_seterr (OSCAP_EFAMILY_GLIBC, "probe URI too long");
-				va_end(ap);
-                                return (-1);
-                        }
-
-                        oscap_dlprintf(DBG_I, "URI: %s.\n", probe_uri);
-
-                        if (oval_pdtbl_add(pext->pdtbl, oval_object_get_subtype(obj), -1, probe_uri) != 0) {
+		if (ret != 0) {
+			if (ret > 0) {
 				oval_syschar_add_new_message(sys, "OVAL object not supported", OVAL_MESSAGE_LEVEL_WARNING);
 				oval_syschar_set_flag(sys, SYSCHAR_FLAG_NOT_COLLECTED);
-				va_end(ap);
-                                return (1);
 			}
-
-			pd = oval_pdtbl_get(pext->pdtbl, oval_object_get_subtype(obj));
-
-                        if (pd == NULL) {
-                                oscap_seterr (OSCAP_EFAMILY_OVAL, "internal error");
-				va_end(ap);
-                                return (-1);
-                        }
-                }
+			va_end(ap);
+			return (ret);
+		}
 
 		ret = oval_probe_ext_eval(pext->pdtbl->ctx, pd, pext, sys, flags);
 
 		if (ret >= 0)
 			ret = 0;
 
+		/*
+		 * The descriptor table can't be replaced while other threads
+		 * use it, the probes are restarted by the next sequential
+		 * evaluation.
+		 */
 		if (ret < 0 && errno == ECONNABORTED) {
-			if (!(flags & OVAL_PDFLAG_SLAVE)) {
+			if (!(flags & OVAL_PDFLAG_SLAVE) && pext->eval_lock == NULL) {
 				if (!pext->do_init) {
 					oval_pdtbl_free(pext->pdtbl);
 				}
@@ -957,6 +1082,25 @@ int oval_probe_ext_handler(oval_subtype_t type, void *ptr, int act, ...)
                 }
                 break;
         }
+        case PROBE_HANDLER_ACT_INVALIDATE:
+        {
+                SEXP_t *ids = va_arg(ap, SEXP_t *);
+
+                /*
+                 * Only the probes that are already connected can hold
+                 * cached results.
+                 */
+                for (size_t i = 0; i < pext->pdtbl->count; ++i) {
+                        pd = pext->pdtbl->memb[i];
+
+                        if (pd == NULL || pd->sd == -1)
+                                continue;
+
+                        if (oval_probe_ext_invalidate(pext->pdtbl->ctx, pd, ids) != 0)
+                                ret = -1;
+                }
+                break;
+        }
         case PROBE_HANDLER_ACT_FREE:
         case PROBE_HANDLER_ACT_CLOSE:
         default:
@@ -1049,8 +1193,9 @@ _ret:
 
 int oval_probe_ext_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struct oval_syschar *syschar, int flags)
 {
-        SEXP_t *s_obj, *s_sys;
+        SEXP_t *s_obj, *s_sys, *s_fp = NULL;
 	struct oval_object *object;
+	oval_pstats_t stats_mem, *stats = NULL;
 	int ret;
 
 	if (syschar == NULL) {
@@ -1058,16 +1203,40 @@ int oval_probe_ext_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struc
 		return (-1);
 	}
 
+	if (oval_pstats_enabled() && !(flags & OVAL_PDFLAG_NOREPLY)) {
+		stats = &stats_mem;
+		oval_pstats_begin(stats);
+	}
+
 	object = oval_syschar_get_object(syschar);
 	ret = oval_object_to_sexp(pext->sess_ptr, oval_subtype_to_str(oval_object_get_subtype(object)), syschar, &s_obj);
 
 	if (ret != 0)
 		return (1);
 
-	ret = oval_probe_comm(ctx, pd, s_obj, flags, &s_sys);
-	SEXP_free(s_obj);
+	/*
+	 * Reuse the result collected by a previous scan if the inputs of
+	 * the probe didn't change since then.
+	 */
+	if (pext->ccache != NULL && !(flags & OVAL_PDFLAG_NOREPLY)) {
+		s_sys = oval_ccache_get(pext->ccache, pd->subtype, s_obj, &s_fp);
+
+		if (s_sys != NULL) {
+			SEXP_free(s_obj);
+
+			if (stats != NULL)
+				stats->ccache_hit = true;
+
+			goto convert;
+		}
+	}
+
+	ret = oval_probe_comm(ctx, pd, s_obj, flags, &s_sys, stats, pext->eval_lock);
 
 	if (ret != 0) {
+		SEXP_free(s_obj);
+		SEXP_free(s_fp);
+
 		switch (errno) {
 		case ECONNABORTED:
 			dI("Closing sd=%d (pd=%p) after abort\n", pd->sd, pd);
@@ -1079,6 +1248,12 @@ int oval_probe_ext_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struc
 		return (ret);
 	}
 
+	if (s_fp != NULL) {
+		oval_ccache_put(pext->ccache, s_obj, s_fp, s_sys);
+		SEXP_free(s_fp);
+	}
+	SEXP_free(s_obj);
+
 	if (flags & OVAL_PDFLAG_NOREPLY) {
 		if (s_sys != NULL) {
                         /*
@@ -1091,10 +1266,16 @@ int oval_probe_ext_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struc
 		return (0);
 	}
 
+convert:
         /*
 	 * Convert the received S-exp to OVAL system characteristic.
 	 */
 	ret = oval_sexp_to_sysch(s_sys, syschar);
+
+	if (stats != NULL)
+		oval_pstats_write(stats, oval_subtype_to_str(oval_object_get_subtype(object)),
+				  oval_object_get_id(object), s_sys);
+
 	SEXP_free(s_sys);
 
 	return (ret);
@@ -1107,6 +1288,25 @@ int oval_probe_ext_reset(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext)
         return (0);
 }
 
+int oval_probe_ext_invalidate(SEAP_CTX_t *ctx, oval_pd_t *pd, SEXP_t *ids)
+{
+        SEXP_t *res;
+
+        res = SEAP_cmd_exec(ctx, pd->sd, SEAP_EXEC_RECV, PROBECMD_OBJ_INVALIDATE, ids, SEAP_CMDTYPE_SYNC, NULL, NULL);
+        if (res == NULL) {
+                dE("Can't invalidate cached results of probe %s.\n", pd->uri);
+                return (-1);
+        }
+        SEXP_free(res);
+
+        return (0);
+}
+
+SEXP_t *oval_probe_ext_rcache_stats(SEAP_CTX_t *ctx, oval_pd_t *pd)
+{
+        return SEAP_cmd_exec(ctx, pd->sd, SEAP_EXEC_RECV, PROBECMD_RCACHE_STATS, NULL, SEAP_CMDTYPE_SYNC, NULL, NULL);
+}
+
 #include <signal.h>
 #include "SEAP/_seap-types.h"
 #include "SEAP/seap-descriptor.h"
@@ -27,6 +27,7 @@
 #include <stdbool.h>
 #include "oval_probe_impl.h"
 #include "oval_system_characteristics_impl.h"
+#include "oval_ccache.h"
 #include "common/util.h"
 
 typedef struct {
@@ -58,9 +59,18 @@ struct oval_pext {
         size_t        pdsc_cnt;
         oval_pdtbl_t *pdtbl;
         char         *probe_dir;
+        char         *probe_scheme;
 
         void *sess_ptr;
         struct oval_syschar_model **model;
+        oval_ccache_t *ccache;
+
+        /*
+         * Set while objects are collected by several threads, see
+         * oval_peval.c. The lock is released while waiting for a reply
+         * of a probe and taken by the probe command handlers.
+         */
+        pthread_mutex_t *eval_lock;
 };
 
 typedef struct oval_pext oval_pext_t;
@@ -70,8 +80,17 @@ void oval_pext_free(oval_pext_t *pext);
 int oval_probe_ext_init(oval_pext_t *pext);
 int oval_probe_ext_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struct oval_syschar *syschar, int flags);
 int oval_probe_ext_reset(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext);
+int oval_probe_ext_invalidate(SEAP_CTX_t *ctx, oval_pd_t *pd, SEXP_t *ids);
+SEXP_t *oval_probe_ext_rcache_stats(SEAP_CTX_t *ctx, oval_pd_t *pd);
 int oval_probe_ext_abort(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext);
 
+/*
+ * Start the probe of `type' if it isn't running yet. Probes are terminated
+ * when the thread which started them exits, so this is used to start them
+ * from the calling thread before the objects are collected by other threads.
+ */
+int oval_probe_ext_connect(oval_pext_t *pext, oval_subtype_t type);
+
 int oval_probe_ext_handler(oval_subtype_t type, void *ptr, int act, ...);
 int oval_probe_sys_handler(oval_subtype_t type, void *ptr, int act, ...);
 
@@ -24,14 +24,18 @@
 #include <config.h>
 #endif
 
+#include <string.h>
 #include "public/oval_definitions.h"
 #include "public/oval_system_characteristics.h"
 #include "oval_system_characteristics_impl.h"
 #include "oval_probe_impl.h"
+#include "collectVarRefs_impl.h"
+#include "adt/oval_string_map_impl.h"
 #include "_oval_probe_session.h"
 
 static int _oval_probe_hint_criteria(oval_probe_session_t *sess, struct oval_criteria_node *cnode, int variable_instance_hint);
 static int _oval_probe_hint_object(oval_probe_session_t *psess, struct oval_object *object, int variable_instance_hint);
+static bool _oval_probe_hint_refs_changed(struct oval_string_map *refs, struct oval_string_map *changed);
 
 /**
  * Finds all the oval_syschars (collected objects) assigned with a given definition
@@ -99,3 +103,82 @@ int _oval_probe_hint_object(oval_probe_session_t *psess, struct oval_object *obj
 	}
 	return 0;
 }
+
+static bool _oval_probe_hint_refs_changed(struct oval_string_map *refs, struct oval_string_map *changed)
+{
+	bool ret = false;
+	struct oval_string_iterator *ref_it = (struct oval_string_iterator *)oval_string_map_keys(refs);
+
+	while (!ret && oval_string_iterator_has_more(ref_it)) {
+		char *var_id = oval_string_iterator_next(ref_it);
+		ret = oval_string_map_get_value(changed, var_id) != NULL;
+	}
+	oval_string_iterator_free(ref_it);
+	return ret;
+}
+
+/**
+ * Invalidates everything which was collected using the previous values of the
+ * given variables. Syschars of the objects which (transitively) reference any
+ * of the variables are hinted to be collected again and the cached results of
+ * these objects and of the dependent states are dropped from the running probes.
+ * The probes and the rest of their caches stay intact.
+ * @param changed map of the changed variables (keyed by variable id)
+ * @returns 0 on success; -1 on error
+ */
+int oval_probe_hint_variables(oval_probe_session_t *sess, struct oval_definition_model *model, struct oval_string_map *changed)
+{
+	SEXP_t *ids, *id;
+	oval_ph_t *ph;
+	int ret = 0;
+
+	ids = SEXP_list_new(NULL);
+
+	struct oval_object_iterator *obj_it = oval_definition_model_get_objects(model);
+	while (oval_object_iterator_has_more(obj_it)) {
+		struct oval_object *object = oval_object_iterator_next(obj_it);
+		struct oval_string_map *refs = oval_string_map_new();
+
+		oval_obj_collect_var_refs(object, refs);
+		if (_oval_probe_hint_refs_changed(refs, changed)) {
+			const char *oid = oval_object_get_id(object);
+			struct oval_syschar *syschar = oval_syschar_model_get_syschar(sess->sys_model, oid);
+			if (syschar != NULL) {
+				int instance = oval_syschar_get_variable_instance(syschar);
+				/* keep the hint if it was already set by oval_probe_hint_definition */
+				if (oval_syschar_get_variable_instance_hint(syschar) == instance)
+					oval_syschar_set_variable_instance_hint(syschar, instance + 1);
+			}
+			SEXP_list_add(ids, id = SEXP_string_new(oid, strlen(oid)));
+			SEXP_free(id);
+		}
+		oval_string_map_free(refs, NULL);
+	}
+	oval_object_iterator_free(obj_it);
+
+	struct oval_state_iterator *ste_it = oval_definition_model_get_states(model);
+	while (oval_state_iterator_has_more(ste_it)) {
+		struct oval_state *state = oval_state_iterator_next(ste_it);
+		struct oval_string_map *refs = oval_string_map_new();
+
+		oval_ste_collect_var_refs(state, refs);
+		if (_oval_probe_hint_refs_changed(refs, changed)) {
+			const char *sid = oval_state_get_id(state);
+			SEXP_list_add(ids, id = SEXP_string_new(sid, strlen(sid)));
+			SEXP_free(id);
+		}
+		oval_string_map_free(refs, NULL);
+	}
+	oval_state_iterator_free(ste_it);
+
+	if (SEXP_list_length(ids) > 0) {
+		ph = oval_probe_handler_get(sess->ph, OVAL_SUBTYPE_ALL);
+		if (ph == NULL)
+			ret = -1;
+		else if (ph->func(OVAL_SUBTYPE_ALL, ph->uptr, PROBE_HANDLER_ACT_INVALIDATE, ids) != 0)
+			ret = -1;
+	}
+
+	SEXP_free(ids);
+	return ret;
+}
@@ -47,7 +47,12 @@
 
 OSCAP_HIDDEN_START;
 
-#define OVAL_PROBE_SCHEME "pipe"
+/*
+ * Replies of the probes are passed through a shared memory ring. The
+ * "shm" scheme falls back to "pipe" if the ring can't be created. The
+ * testing library takes the scheme from OVAL_PROBE_SCHEME if it is set.
+ */
+#define OVAL_PROBE_SCHEME "shm"
 
 #ifndef OVAL_PROBE_DIR
 # define OVAL_PROBE_DIR    "/usr/libexec/openscap"
@@ -68,7 +73,10 @@ void oval_probe_tblinit(void);
 const char *oval_subtype_to_str(oval_subtype_t subtype);
 oval_subtype_t oval_str_to_subtype(const char *str);
 
+struct oval_string_map;
+
 int oval_probe_hint_definition(oval_probe_session_t *sess, struct oval_definition *definition, int variable_instance_hint);
+int oval_probe_hint_variables(oval_probe_session_t *sess, struct oval_definition_model *model, struct oval_string_map *changed);
 
 #endif /* OVAL_PROBE_IMPL_H */
 /// @}
@@ -0,0 +1,195 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <seap.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <unistd.h>
+
+#include "common/_error.h"
+#include "common/debug_priv.h"
+#include "probes/public/probe-api.h"
+#include "probes/SEAP/_seap-types.h"
+#include "probes/SEAP/seap-descriptor.h"
+#include "public/oval_probe.h"
+#include "oval_pstats.h"
+
+#define OVAL_PSTATS_HEADER "object_id,type,wall_us,cpu_us,items,bytes_sent,bytes_received,icache_hits,icache_hit_ratio,rcache_hit,ccache_hit\n"
+
+/*
+ * The file is opened with O_APPEND and every record is written by a single
+ * write() so that records of concurrent evaluations (threads or processes
+ * forked by the caller) don't interleave.
+ */
+static int pstats_fd = -1;
+
+int oval_probe_stats_open(const char *path)
+{
+	int fd;
+
+	oval_probe_stats_close();
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+
+	if (fd < 0) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Can't open statistics file '%s': %s", path, strerror(errno));
+		return (-1);
+	}
+
+	if (write(fd, OVAL_PSTATS_HEADER, strlen(OVAL_PSTATS_HEADER)) < 0) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Can't write statistics file '%s': %s", path, strerror(errno));
+		close(fd);
+		return (-1);
+	}
+
+	pstats_fd = fd;
+	return (0);
+}
+
+void oval_probe_stats_close(void)
+{
+	if (pstats_fd != -1) {
+		close(pstats_fd);
+		pstats_fd = -1;
+	}
+}
+
+bool oval_pstats_enabled(void)
+{
+	return (pstats_fd != -1);
+}
+
+void oval_pstats_begin(oval_pstats_t *st)
+{
+	memset(st, 0, sizeof *st);
+	clock_gettime(CLOCK_MONOTONIC, &st->start);
+}
+
+void oval_pstats_comm_begin(oval_pstats_t *st, SEAP_CTX_t *ctx, int sd)
+{
+	SEAP_desc_t *dsc = SEAP_desc_get(ctx->sd_table, sd);
+
+	if (dsc != NULL) {
+		st->sent_mark = dsc->bytes_sent;
+		st->recv_mark = dsc->bytes_recv;
+	}
+}
+
+void oval_pstats_comm_end(oval_pstats_t *st, SEAP_CTX_t *ctx, int sd, SEAP_msg_t *reply)
+{
+	SEAP_desc_t *dsc = SEAP_desc_get(ctx->sd_table, sd);
+	SEXP_t *r0;
+
+	if (dsc != NULL) {
+		st->bytes_sent += dsc->bytes_sent - st->sent_mark;
+		st->bytes_recv += dsc->bytes_recv - st->recv_mark;
+	}
+
+	if ((r0 = SEAP_msgattr_get(reply, PROBE_MSGATTR_CPUTIME)) != NULL) {
+		st->cpu_us += SEXP_number_getu_64(r0);
+		SEXP_free(r0);
+	}
+
+	if ((r0 = SEAP_msgattr_get(reply, PROBE_MSGATTR_ICACHE_HITS)) != NULL) {
+		st->icache_hits += SEXP_number_getu_32(r0);
+		SEXP_free(r0);
+	}
+
+	if (SEAP_msgattr_exists(reply, PROBE_MSGATTR_RCACHE_HIT))
+		st->rcache_hit = true;
+}
+
+void oval_pstats_write(oval_pstats_t *st, const char *type, const char *object_id, const SEXP_t *cobj)
+{
+	struct timespec now;
+	uint64_t wall_us;
+	char buffer[512];
+	int length;
+
+	if (pstats_fd == -1)
+		return;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	wall_us = (uint64_t)(now.tv_sec - st->start.tv_sec) * 1000000
+		+ (now.tv_nsec - st->start.tv_nsec) / 1000;
+
+	if (cobj != NULL) {
+		SEXP_t *items = probe_cobj_get_items(cobj);
+
+		st->items = SEXP_list_length(items);
+		SEXP_free(items);
+	}
+
+	length = snprintf(buffer, sizeof buffer,
+			  "%s,%s,%"PRIu64",%"PRIu64",%"PRIu32",%"PRIu64",%"PRIu64",%"PRIu32",%.3f,%d,%d\n",
+			  object_id, type, wall_us, st->cpu_us, st->items,
+			  st->bytes_sent, st->bytes_recv, st->icache_hits,
+			  st->items > 0 ? (double)st->icache_hits / st->items : 0.0,
+			  st->rcache_hit, st->ccache_hit);
+
+	if (length < 0 || (size_t)length >= sizeof buffer) {
+		dW("Statistics record of '%s' truncated.\n", object_id);
+		return;
+	}
+
+	if (write(pstats_fd, buffer, length) != length)
+		dW("Can't write statistics record of '%s': %s\n", object_id, strerror(errno));
+}
+
+void oval_pstats_write_rcache(const char *type, const SEXP_t *stats)
+{
+	uint64_t v[6];
+	char buffer[256];
+	int length, i;
+
+	if (pstats_fd == -1)
+		return;
+
+	if (SEXP_list_length(stats) != 6) {
+		dW("Unexpected result cache statistics of the %s probe.\n", type);
+		return;
+	}
+
+	for (i = 0; i < 6; ++i) {
+		SEXP_t *n = SEXP_list_nth(stats, i + 1);
+
+		v[i] = SEXP_number_getu_64(n);
+		SEXP_free(n);
+	}
+
+	/* not a CSV record, readers skip lines starting with # */
+	length = snprintf(buffer, sizeof buffer,
+			  "# rcache %s: hits=%"PRIu64" misses=%"PRIu64" evictions=%"PRIu64
+			  " entries=%"PRIu64" bytes=%"PRIu64" limit=%"PRIu64"\n",
+			  type, v[0], v[1], v[2], v[3], v[4], v[5]);
+
+	if (length < 0 || (size_t)length >= sizeof buffer)
+		return;
+
+	if (write(pstats_fd, buffer, length) != length)
+		dW("Can't write result cache statistics of the %s probe: %s\n", type, strerror(errno));
+}
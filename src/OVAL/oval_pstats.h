@@ -0,0 +1,84 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ * Per-object collection statistics. When enabled by oval_probe_stats_open(),
+ * every object evaluated by an external probe is appended as one CSV line
+ * to the statistics file.
+ */
+#ifndef OVAL_PSTATS_H
+#define OVAL_PSTATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <seap.h>
+#include "common/util.h"
+
+OSCAP_HIDDEN_START;
+
+typedef struct {
+	struct timespec start; /* wall clock time when the evaluation started */
+	uint64_t cpu_us;       /* CPU time spent by the probe worker */
+	uint64_t bytes_sent;   /* bytes sent to the probe */
+	uint64_t bytes_recv;   /* bytes received from the probe */
+	uint32_t items;        /* number of collected items */
+	uint32_t icache_hits;  /* collected items found in the probe item cache */
+	bool     rcache_hit;   /* the probe answered from its result cache */
+	bool     ccache_hit;   /* the result was taken from the collection cache */
+
+	uint64_t sent_mark;    /* descriptor counters when the request was sent */
+	uint64_t recv_mark;
+} oval_pstats_t;
+
+/**
+ * @return true if statistics are being collected
+ */
+bool oval_pstats_enabled(void);
+
+/**
+ * Start measuring an evaluation of an object.
+ */
+void oval_pstats_begin(oval_pstats_t *st);
+
+/**
+ * Called before a request is sent to the probe on descriptor `sd'.
+ */
+void oval_pstats_comm_begin(oval_pstats_t *st, SEAP_CTX_t *ctx, int sd);
+
+/**
+ * Called after the reply of the probe was received.
+ */
+void oval_pstats_comm_end(oval_pstats_t *st, SEAP_CTX_t *ctx, int sd, SEAP_msg_t *reply);
+
+/**
+ * Append the record of an evaluated object to the statistics file.
+ */
+void oval_pstats_write(oval_pstats_t *st, const char *type, const char *object_id, const SEXP_t *cobj);
+
+/**
+ * Append the result cache statistics of a probe (the reply to the
+ * PROBECMD_RCACHE_STATS command) to the statistics file.
+ */
+void oval_pstats_write_rcache(const char *type, const SEXP_t *stats);
+
+OSCAP_HIDDEN_END;
+
+#endif /* OVAL_PSTATS_H */
@@ -801,6 +801,7 @@ static struct oval_sysent *oval_sexp_to_sysent(struct oval_syschar_model *model,
 	    oval_message_set_level(msg, lvl);
 	    oval_message_set_text(msg, txt);
 	    oval_sysitem_add_message(item, msg);
+	    oscap_free(key);
 
 	    return (NULL);
 	}
@@ -809,7 +810,9 @@ static struct oval_sysent *oval_sexp_to_sysent(struct oval_syschar_model *model,
 	dt = probe_ent_getdatatype(sexp);
 
 	ent = oval_sysent_new(model);
+	/* the sysent takes over the name, use its interned copy from now on */
 	oval_sysent_set_name(ent, key);
+	key = oval_sysent_get_name(ent);
 	oval_sysent_set_status(ent, status);
 	oval_sysent_set_datatype(ent, dt);
 	if (mask_map == NULL || oval_string_map_get_value(mask_map, key) == NULL)
@@ -39,6 +39,7 @@
 #include "adt/oval_collection_impl.h"
 #include "oval_agent_api_impl.h"
 #include "common/util.h"
+#include "common/intern.h"
 #include "common/debug_priv.h"
 #include "common/elements.h"
 
@@ -154,7 +155,7 @@ struct oval_state *oval_state_new(struct oval_definition_model *model, const cha
 	state->operator = OVAL_OPERATOR_UNKNOWN;
 	state->subtype = OVAL_SUBTYPE_UNKNOWN;
 	state->comment = NULL;
-	state->id = strdup(id);
+	state->id = oscap_intern(id);
 	state->notes = oval_collection_new();
 	state->contents = oval_collection_new();
 	state->model = model;
@@ -198,8 +199,7 @@ void oval_state_free(struct oval_state *state)
 
 	if (state->comment != NULL)
 		free(state->comment);
-	if (state->id != NULL)
-		free(state->id);
+	oscap_intern_release(state->id);
 	oval_collection_free_items(state->notes, &free);
 	oval_collection_free_items(state->contents, (oscap_destruct_func) oval_state_content_free);
 
@@ -42,6 +42,7 @@
 #include "oval_definitions_impl.h"
 
 #include "common/util.h"
+#include "common/intern.h"
 #include "common/debug_priv.h"
 #include "common/elements.h"
 
@@ -75,15 +76,8 @@ struct oval_sysent *oval_sysent_clone(struct oval_syschar_model *new_model, stru
 {
 	struct oval_sysent *new_item = oval_sysent_new(new_model);
 
-	char *old_value = oval_sysent_get_value(old_item);
-	if (old_value) {
-		oval_sysent_set_value(new_item, oscap_strdup(old_value));
-	}
-
-	char *old_name = oval_sysent_get_name(old_item);
-	if (old_name) {
-		oval_sysent_set_name(new_item, oscap_strdup(old_name));
-	}
+	new_item->value = oscap_intern(oval_sysent_get_value(old_item));
+	new_item->name = oscap_intern(oval_sysent_get_name(old_item));
 
 	oval_sysent_set_datatype(new_item, oval_sysent_get_datatype(old_item));
 	oval_sysent_set_mask(new_item, oval_sysent_get_mask(old_item));
@@ -97,10 +91,8 @@ void oval_sysent_free(struct oval_sysent *sysent)
 	if (sysent == NULL)
 		return;
 
-	if (sysent->name != NULL)
-		oscap_free(sysent->name);
-	if (sysent->value != NULL)
-		oscap_free(sysent->value);
+	oscap_intern_release(sysent->name);
+	oscap_intern_release(sysent->value);
 	if (sysent->record_fields)
 		oval_collection_free_items(sysent->record_fields, (oscap_destruct_func) oval_record_field_free);
 
@@ -174,9 +166,8 @@ int oval_sysent_get_mask(struct oval_sysent *sysent)
 void oval_sysent_set_name(struct oval_sysent *sysent, char *name)
 {
 	__attribute__nonnull__(sysent);
-	if (sysent->name != NULL)
-		oscap_free(sysent->name);
-	sysent->name = name;
+	oscap_intern_release(sysent->name);
+	sysent->name = oscap_intern_take(name);
 }
 
 void oval_sysent_set_status(struct oval_sysent *sysent, oval_syschar_status_t status)
@@ -200,9 +191,8 @@ void oval_sysent_set_mask(struct oval_sysent *sysent, int mask)
 void oval_sysent_set_value(struct oval_sysent *sysent, char *value)
 {
 	__attribute__nonnull__(sysent);
-	if (sysent->value != NULL)
-		oscap_free(sysent->value);
-	sysent->value = oscap_strdup(value);
+	oscap_intern_release(sysent->value);
+	sysent->value = oscap_intern(value);
 }
 
 void oval_sysent_add_record_field(struct oval_sysent *sysent, struct oval_record_field *rf)
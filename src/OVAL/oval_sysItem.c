@@ -40,6 +40,7 @@
 #include "adt/oval_collection_impl.h"
 #include "oval_definitions_impl.h"
 #include "common/util.h"
+#include "common/intern.h"
 #include "common/debug_priv.h"
 
 typedef struct oval_sysitem {
@@ -61,7 +62,7 @@ struct oval_sysitem *oval_sysitem_new(struct oval_syschar_model *model, const ch
 	if (sysitem == NULL)
 		return NULL;
 
-	sysitem->id = oscap_strdup(id);
+	sysitem->id = oscap_intern(id);
 	sysitem->subtype = OVAL_SUBTYPE_UNKNOWN;
 	sysitem->status = SYSCHAR_STATUS_UNKNOWN;
 	sysitem->messages = oval_collection_new();
@@ -106,7 +107,7 @@ void oval_sysitem_free(struct oval_sysitem *sysitem)
 
 	oval_collection_free_items(sysitem->messages, (oscap_destruct_func) oval_message_free);
 	oval_collection_free_items(sysitem->sysents, (oscap_destruct_func) oval_sysent_free);
-	oscap_free(sysitem->id);
+	oscap_intern_release(sysitem->id);
 
 	sysitem->id = NULL;
 	sysitem->sysents = NULL;
@@ -40,6 +40,7 @@
 #include "adt/oval_collection_impl.h"
 #include "oval_agent_api_impl.h"
 #include "common/util.h"
+#include "common/intern.h"
 #include "common/debug_priv.h"
 #include "common/elements.h"
 #include "common/_error.h"
@@ -176,7 +177,7 @@ struct oval_test *oval_test_new(struct oval_definition_model *model, const char
 	test->state_operator = OVAL_OPERATOR_AND;
 	test->subtype = OVAL_SUBTYPE_UNKNOWN;
 	test->comment = NULL;
-	test->id = oscap_strdup(id);
+	test->id = oscap_intern(id);
 	test->object = NULL;
 	test->states = oval_collection_new();
 	test->notes = oval_collection_new();
@@ -233,8 +234,7 @@ void oval_test_free(struct oval_test *test)
 
 	if (test->comment != NULL)
 		oscap_free(test->comment);
-	if (test->id != NULL)
-		oscap_free(test->id);
+	oscap_intern_release(test->id);
 	oval_collection_free_items(test->notes, &oscap_free);
 	oval_collection_free(test->states);
 
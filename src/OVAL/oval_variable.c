@@ -40,6 +40,7 @@
 #include "adt/oval_string_map_impl.h"
 #include "oval_agent_api_impl.h"
 #include "common/util.h"
+#include "common/intern.h"
 #include "common/debug_priv.h"
 #include "common/_error.h"
 #include "results/oval_cmp_impl.h"
@@ -482,7 +483,7 @@ struct oval_variable *oval_variable_new(struct oval_definition_model *model, con
 	}
 
 	variable->model = model;
-	variable->id = oscap_strdup(id);
+	variable->id = oscap_intern(id);
 	variable->comment = NULL;
 	variable->datatype = OVAL_DATATYPE_UNKNOWN;
 	variable->type = type;
@@ -596,8 +597,7 @@ struct oval_variable *oval_variable_clone(struct oval_definition_model *new_mode
 void oval_variable_free(struct oval_variable *variable)
 {
 	if (variable) {
-		if (variable->id)
-			oscap_free(variable->id);
+		oscap_intern_release(variable->id);
 		if (variable->comment)
 			oscap_free(variable->comment);
 		variable->id = variable->comment = NULL;
@@ -45,6 +45,12 @@ typedef struct {
         int     (*sch_close)    (SEAP_desc_t *, uint32_t);
         ssize_t (*sch_sendsexp) (SEAP_desc_t *, SEXP_t *, uint32_t);
         int     (*sch_select)   (SEAP_desc_t *, int, uint16_t, uint32_t);
+        /*
+         * Optional zero-copy receiving: sch_recvptr returns a pointer to
+         * the received data which stays valid until sch_release is called.
+         */
+        ssize_t (*sch_recvptr)  (SEAP_desc_t *, void **, uint32_t);
+        int     (*sch_release)  (SEAP_desc_t *, uint32_t);
 } SEAP_schemefn_t;
 
 extern const SEAP_schemefn_t __schtbl[];
@@ -57,6 +63,9 @@ extern const SEAP_schemefn_t __schtbl[];
 #define SCH_CLOSE(idx, ...)    __schtbl[idx].sch_close (__VA_ARGS__)
 #define SCH_SENDSEXP(idx, ...) __schtbl[idx].sch_sendsexp (__VA_ARGS__)
 #define SCH_SELECT(idx, ...)   __schtbl[idx].sch_select (__VA_ARGS__)
+#define SCH_RECVPTR(idx, ...)  __schtbl[idx].sch_recvptr (__VA_ARGS__)
+#define SCH_RELEASE(idx, ...)  __schtbl[idx].sch_release (__VA_ARGS__)
+#define SCH_HAS_RECVPTR(idx)   (__schtbl[idx].sch_recvptr != NULL)
 
 #define SEAP_IO_EVREAD  0x01
 #define SEAP_IO_EVWRITE 0x02
@@ -83,6 +92,10 @@ SEAP_scheme_t SEAP_scheme_search (const SEAP_schemefn_t fntable[], const char *s
 #include "sch_pipe.h"
 #define SCH_PIPE    3
 
+/* shared memory */
+#include "sch_shm.h"
+#define SCH_SHM     4
+
 #define SCH_NONE    255
 
 OSCAP_HIDDEN_END;
@@ -51,6 +51,12 @@ SEXP_t *SEXP_lstack_top (const SEXP_lstack_t *stack);
 SEXP_t *SEXP_lstack_list (SEXP_lstack_t *stack);
 size_t  SEXP_lstack_depth (SEXP_lstack_t *stack);
 
+/*
+ * Flatten the list blocks of a finished list so that SEXP_list_nth
+ * doesn't have to walk the block chain.
+ */
+void SEXP_list_compact (SEXP_t *list);
+
 OSCAP_HIDDEN_END;
 
 #endif /* _SEXP_MANIP_H */
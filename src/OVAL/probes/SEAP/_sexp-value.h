@@ -102,6 +102,12 @@ size_t    SEXP_rawval_list_length (struct SEXP_val_list *list);
 uintptr_t SEXP_rawval_list_copy (uintptr_t s_valp);
 
 uintptr_t SEXP_rawval_lblk_copy (uintptr_t lblkp, uint16_t n_skip);
+/*
+ * Merge the blocks of a list into one block, members of the list are then
+ * accessed in constant time. Nothing is done if some of the blocks are
+ * shared with another list. Iterators over the list are invalidated.
+ */
+uintptr_t SEXP_rawval_lblk_compact (uintptr_t lblkp);
 uintptr_t SEXP_rawval_lblk_new  (uint8_t sz);
 uintptr_t SEXP_rawval_lblk_incref (uintptr_t lblkp);
 int       SEXP_rawval_lblk_decref (uintptr_t lblkp);
@@ -42,6 +42,7 @@
 #include "_seap-types.h"
 #include "_seap-scheme.h"
 #include "sch_generic.h"
+#include "sch_shm.h"
 #include "seap-descriptor.h"
 
 #define DATA(ptr) ((sch_genericdata_t *)(ptr))
@@ -60,6 +61,8 @@ int sch_generic_openfd (SEAP_desc_t *desc, int fd, uint32_t flags)
         data = sm_talloc (sch_genericdata_t);
         data->ifd = -1;
         data->ofd = -1;
+        data->ring = NULL;
+        data->head = 0;
 
         if (flags & SEAP_DESC_FDIN)
                 data->ifd = fd;
@@ -78,6 +81,29 @@ int sch_generic_openfd2 (SEAP_desc_t *desc, int ifd, int ofd, uint32_t flags)
         data = sm_talloc (sch_genericdata_t);
         data->ifd = ifd;
         data->ofd = ofd;
+        data->ring = NULL;
+        data->head = 0;
+
+        /*
+         * Started by the "shm" scheme: send the output through the ring
+         * buffer shared with the parent process.
+         */
+        if (getenv (SCH_SHM_ENV) != NULL) {
+                int shmfd = atoi (getenv (SCH_SHM_ENV));
+
+                data->ring = sch_shm_ring_attach (shmfd);
+
+                if (data->ring == NULL) {
+                        protect_errno {
+                                sm_free (data);
+                        }
+                        return (-1);
+                }
+
+                close (shmfd);
+                unsetenv (SCH_SHM_ENV);
+        }
+
         desc->scheme_data = data;
 
         return (0);
@@ -103,6 +129,10 @@ ssize_t sch_generic_sendsexp (SEAP_desc_t *desc, SEXP_t *sexp, uint32_t flags)
 
         if (SEXP_sbprintf_t (sexp, sb) != 0)
                 ret = -1;
+        else if (DATA(desc->scheme_data)->ring != NULL)
+                ret = sch_shm_ring_put (DATA(desc->scheme_data)->ring,
+                                        &DATA(desc->scheme_data)->head,
+                                        DATA(desc->scheme_data)->ofd, sb);
         else
                 ret = strbuf_write (sb, DATA(desc->scheme_data)->ofd);
 
@@ -121,6 +151,8 @@ int sch_generic_close (SEAP_desc_t *desc, uint32_t flags)
                 close(data->ifd);
         if (data->ofd != -1)
                 close(data->ofd);
+        if (data->ring != NULL)
+                sch_shm_ring_detach(data->ring);
         sm_free(data);
 
         return (0);
@@ -24,6 +24,7 @@
 #ifndef SCH_GENERIC_H
 #define SCH_GENERIC_H
 
+#include <stdint.h>
 #include "../../../common/util.h"
 
 OSCAP_HIDDEN_START;
@@ -31,6 +32,8 @@ OSCAP_HIDDEN_START;
 typedef struct {
         int ifd;
         int ofd;
+        struct sch_shmring *ring; /* see sch_shm.h */
+        uint64_t            head;
 } sch_genericdata_t;
 
 int sch_generic_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags);
@@ -184,17 +184,17 @@ static int check_child (pid_t pid, int waitf)
         return (1);
 }
 
-int sch_pipe_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags)
+int sch_pipe_check (sch_pipedata_t *data, int waitf)
+{
+        return check_child (data->pid, waitf);
+}
+
+int sch_pipe_spawn (sch_pipedata_t *data, const char *uri, uint32_t flags, int xfd, const char *xenv)
 {
-        sch_pipedata_t *data;
         pid_t pid;
         int   pfd[2] = { -1, -1 };
+        char **envp = environ;
 
-        assume_r (desc != NULL, -1, errno = EFAULT;);
-        assume_r (uri  != NULL, -1, errno = EFAULT;);
-        assume_r (desc->scheme_data == NULL, -1, errno = EALREADY;);
-
-        data = (sch_pipedata_t *) sm_talloc (sch_pipedata_t);
         data->execpath = get_exec_path (uri, flags);
 
         if (data->execpath == NULL) {
@@ -209,6 +209,29 @@ int sch_pipe_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags)
                         goto fail1;
         }
 
+        if (xenv != NULL) {
+                /*
+                 * The environment of the child is prepared here because
+                 * allocating memory after fork() isn't safe in a threaded
+                 * process.
+                 */
+                size_t i, n, xlen;
+
+                xlen = strcspn (xenv, "=") + 1;
+
+                for (n = 0; environ[n] != NULL; ++n);
+
+                envp = sm_alloc (sizeof (char *) * (n + 2));
+
+                for (i = 0, n = 0; environ[i] != NULL; ++i) {
+                        if (strncmp (environ[i], xenv, xlen) != 0)
+                                envp[n++] = environ[i];
+                }
+
+                envp[n++] = (char *)xenv;
+                envp[n]   = NULL;
+        }
+
         if (socketpair (AF_UNIX, SOCK_STREAM, 0, pfd) < 0)
                 goto fail1;
 
@@ -234,11 +257,25 @@ int sch_pipe_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags)
                 if (dup2 (pfd[0], STDERR_FILENO) != STDERR_FILENO)
                         _exit (errno);
 #endif
-                execl (data->execpath, data->execpath, NULL);
+                /*
+                 * pass the extra descriptor at a well-known number
+                 */
+                if (xfd != -1) {
+                        if (xfd == SCH_PIPE_XFD) {
+                                if (fcntl (xfd, F_SETFD, 0) != 0)
+                                        _exit (errno);
+                        } else if (dup2 (xfd, SCH_PIPE_XFD) != SCH_PIPE_XFD)
+                                _exit (errno);
+                }
+
+                execve (data->execpath, (char *[]){ data->execpath, NULL }, envp);
                 _exit (errno);
         default: /* parent */
                 close (pfd[1]);
 
+                if (envp != environ)
+                        sm_free (envp);
+
                 data->pfd = pfd[0];
                 data->pid = pid;
 
@@ -246,8 +283,6 @@ int sch_pipe_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags)
                         goto fail2;
         }
 
-        desc->scheme_data = (void *)data;
-
         return (0);
 fail2:
         protect_errno {
@@ -255,13 +290,37 @@ fail2:
         }
 fail1:
         protect_errno {
+                if (envp != environ)
+                        sm_free (envp);
                 if (data->execpath != NULL)
                         sm_free (data->execpath);
-                sm_free (data);
+                data->execpath = NULL;
         }
         return (-1);
 }
 
+int sch_pipe_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags)
+{
+        sch_pipedata_t *data;
+
+        assume_r (desc != NULL, -1, errno = EFAULT;);
+        assume_r (uri  != NULL, -1, errno = EFAULT;);
+        assume_r (desc->scheme_data == NULL, -1, errno = EALREADY;);
+
+        data = (sch_pipedata_t *) sm_talloc (sch_pipedata_t);
+
+        if (sch_pipe_spawn (data, uri, flags, -1, NULL) != 0) {
+                protect_errno {
+                        sm_free (data);
+                }
+                return (-1);
+        }
+
+        desc->scheme_data = (void *)data;
+
+        return (0);
+}
+
 int sch_pipe_openfd (SEAP_desc_t *desc, int fd, uint32_t flags)
 {
         errno = EOPNOTSUPP;
@@ -36,6 +36,18 @@ typedef struct {
         char *execpath;
 } sch_pipedata_t;
 
+/* descriptor number at which sch_pipe_spawn passes `xfd' to the child */
+#define SCH_PIPE_XFD 3
+
+/*
+ * Start the executable referenced by `uri' connected to `data->pfd'.
+ * If `xfd' isn't -1 it is made available to the child as SCH_PIPE_XFD
+ * and `xenv' ("NAME=value") is added to the environment of the child.
+ */
+int sch_pipe_spawn (sch_pipedata_t *data, const char *uri, uint32_t flags, int xfd, const char *xenv);
+int sch_pipe_check (sch_pipedata_t *data, int waitf);
+
+
 int sch_pipe_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags);
 int sch_pipe_openfd (SEAP_desc_t *desc, int fd, uint32_t flags);
 int sch_pipe_openfd2 (SEAP_desc_t *desc, int ifd, int ofd, uint32_t flags);
@@ -0,0 +1,518 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+#include <common/assume.h>
+
+#include "generic/common.h"
+#include "public/sm_alloc.h"
+#include "public/strbuf.h"
+#include "_sexp-types.h"
+#include "_seap-types.h"
+#include "_sexp-output.h"
+#include "_seap-scheme.h"
+#include "sch_shm.h"
+#include "seap-descriptor.h"
+
+#define DATA(ptr) ((sch_shmdata_t *)(ptr))
+
+/* the value has to match SCH_PIPE_XFD */
+#define SHM_XENV SCH_SHM_ENV "=3"
+
+#ifndef MFD_CLOEXEC
+# define MFD_CLOEXEC 0x0001U
+#endif
+
+static int shm_create (size_t size)
+{
+        int fd = -1;
+
+#if defined(SYS_memfd_create)
+        fd = syscall (SYS_memfd_create, "seap-shm", MFD_CLOEXEC);
+#endif
+        if (fd < 0) {
+                char path[] = "/dev/shm/seap-shm.XXXXXX";
+
+                if ((fd = mkstemp (path)) < 0)
+                        return (-1);
+
+                unlink (path);
+
+                if (fcntl (fd, F_SETFD, FD_CLOEXEC) != 0)
+                        goto fail;
+        }
+
+        if (ftruncate (fd, size) != 0)
+                goto fail;
+
+        return (fd);
+fail:
+        protect_errno {
+                close (fd);
+        }
+        return (-1);
+}
+
+static sch_shmring_t *shm_map (int fd, size_t size)
+{
+        void *map;
+
+        map = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        return (map == MAP_FAILED ? NULL : (sch_shmring_t *)map);
+}
+
+/*
+ * Wake up the sender waiting for space in the ring, see shm_wait.
+ */
+static void shm_wake (sch_shmring_t *ring)
+{
+        __sync_fetch_and_add (&ring->released, 1);
+
+        if (ring->waiting) {
+#if defined(SYS_futex)
+                syscall (SYS_futex, &ring->released, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+        }
+}
+
+/*
+ * Sleep until the receiver releases some space (`released' is no longer
+ * `seq') or SCH_SHM_WAITSEC seconds pass. The receiver can't wake us up if
+ * it went away, so the socket is checked after every wait.
+ */
+static int shm_wait (sch_shmring_t *ring, uint32_t seq, int ofd)
+{
+        struct pollfd pfd;
+        int timeout = 0;
+
+#if defined(SYS_futex)
+        struct timespec ts;
+
+        ts.tv_sec  = SCH_SHM_WAITSEC;
+        ts.tv_nsec = 0;
+
+        ring->waiting = 1;
+        __sync_synchronize ();
+
+        if (ring->released == seq)
+                syscall (SYS_futex, &ring->released, FUTEX_WAIT, seq, &ts, NULL, 0);
+
+        ring->waiting = 0;
+#else
+        /* no way to sleep on the shared memory, poll it instead */
+        timeout = 1;
+#endif
+        pfd.fd      = ofd;
+        pfd.events  = 0;
+        pfd.revents = 0;
+
+        if (poll (&pfd, 1, timeout) < 0 && errno != EINTR)
+                return (-1);
+        if (pfd.revents & (POLLHUP | POLLERR | POLLNVAL)) {
+                errno = EPIPE;
+                return (-1);
+        }
+
+        return (0);
+}
+
+static ssize_t shm_readall (int fd, void *buf, size_t len)
+{
+        size_t  off = 0;
+        ssize_t ret;
+
+        while (off < len) {
+                ret = read (fd, (uint8_t *)buf + off, len - off);
+
+                if (ret < 0) {
+                        if (errno == EINTR)
+                                continue;
+                        return (-1);
+                } else if (ret == 0) {
+                        if (off == 0)
+                                return (0);
+
+                        errno = EPIPE;
+                        return (-1);
+                }
+
+                off += ret;
+        }
+
+        return (off);
+}
+
+static ssize_t shm_writeall (int fd, const void *buf, size_t len)
+{
+        size_t  off = 0;
+        ssize_t ret;
+
+        while (off < len) {
+                ret = write (fd, (const uint8_t *)buf + off, len - off);
+
+                if (ret < 0) {
+                        if (errno == EINTR)
+                                continue;
+                        return (-1);
+                }
+
+                off += ret;
+        }
+
+        return (off);
+}
+
+int sch_shm_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags)
+{
+        sch_shmdata_t *data;
+        size_t size;
+        int    fd;
+
+        assume_r (desc != NULL, -1, errno = EFAULT;);
+        assume_r (uri  != NULL, -1, errno = EFAULT;);
+        assume_r (desc->scheme_data == NULL, -1, errno = EALREADY;);
+
+        data = sm_talloc (sch_shmdata_t);
+        data->ring    = NULL;
+        data->pending = 0;
+        data->inbufs  = NULL;
+
+        size = SCH_SHM_HDRSIZE + SCH_SHM_RINGSIZE;
+        fd   = shm_create (size);
+
+        if (fd >= 0) {
+                data->ring = shm_map (fd, size);
+
+                if (data->ring == NULL) {
+                        close (fd);
+                        fd = -1;
+                } else {
+                        data->ring->magic    = SCH_SHM_MAGIC;
+                        data->ring->hdrsize  = SCH_SHM_HDRSIZE;
+                        data->ring->size     = SCH_SHM_RINGSIZE;
+                        data->ring->tail     = 0;
+                        data->ring->released = 0;
+                        data->ring->waiting  = 0;
+                }
+        }
+
+        if (fd < 0) {
+                /*
+                 * Shared memory isn't available. sch_shmdata_t starts with
+                 * sch_pipedata_t so the descriptor can be handled by the pipe
+                 * scheme from now on.
+                 */
+                dI("Can't create the shared ring: %u, %s. Falling back to pipe.\n", errno, strerror (errno));
+
+                if (sch_pipe_spawn (&data->pipe, uri, flags, -1, NULL) != 0)
+                        goto fail;
+
+                desc->scheme      = SCH_PIPE;
+                desc->scheme_data = (void *)data;
+
+                return (0);
+        }
+
+        if (sch_pipe_spawn (&data->pipe, uri, flags, fd, SHM_XENV) != 0) {
+                protect_errno {
+                        close (fd);
+                        munmap (data->ring, size);
+                }
+                goto fail;
+        }
+
+        /* the child has its own copy of the descriptor, the mapping stays */
+        close (fd);
+        desc->scheme_data = (void *)data;
+
+        return (0);
+fail:
+        protect_errno {
+                sm_free (data);
+        }
+        return (-1);
+}
+
+int sch_shm_openfd (SEAP_desc_t *desc, int fd, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+int sch_shm_openfd2 (SEAP_desc_t *desc, int ifd, int ofd, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+ssize_t sch_shm_recv (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags)
+{
+        /* data from the child can only be received using sch_shm_recvptr */
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+ssize_t sch_shm_send (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags)
+{
+        return sch_pipe_send (desc, buf, len, flags);
+}
+
+ssize_t sch_shm_sendsexp (SEAP_desc_t *desc, SEXP_t *sexp, uint32_t flags)
+{
+        return sch_pipe_sendsexp (desc, sexp, flags);
+}
+
+int sch_shm_close (SEAP_desc_t *desc, uint32_t flags)
+{
+        sch_shmdata_t *data;
+        sch_shmring_t *ring;
+        struct sch_shm_inbuf *ib;
+        int ret;
+
+        assume_d (desc != NULL, -1, errno = EFAULT;);
+
+        data = DATA(desc->scheme_data);
+
+        assume_r (data != NULL, -1, errno = EBADF;);
+
+        ring = data->ring;
+
+        while ((ib = data->inbufs) != NULL) {
+                data->inbufs = ib->next;
+                sm_free (ib);
+        }
+
+        /* frees data if the child was reaped */
+        ret = sch_pipe_close (desc, flags);
+
+        if (ret == 0 && ring != NULL)
+                munmap (ring, ring->hdrsize + ring->size);
+
+        return (ret);
+}
+
+int sch_shm_select (SEAP_desc_t *desc, int ev, uint16_t timeout, uint32_t flags)
+{
+        return sch_pipe_select (desc, ev, timeout, flags);
+}
+
+ssize_t sch_shm_recvptr (SEAP_desc_t *desc, void **ptr, uint32_t flags)
+{
+        sch_shmdata_t *data;
+        sch_shmrec_t   rec;
+        ssize_t        ret;
+
+        assume_d (desc != NULL, -1, errno = EFAULT;);
+        assume_d (ptr  != NULL, -1, errno = EFAULT;);
+
+        data = DATA(desc->scheme_data);
+
+        assume_r (data != NULL, -1, errno = EBADF;);
+
+        if (sch_pipe_check (&data->pipe, 0) != 0)
+                return (-1);
+
+        ret = shm_readall (data->pipe.pfd, &rec, sizeof rec);
+
+        if (ret == 0) {
+                if (sch_pipe_check (&data->pipe, 0) != 0)
+                        return (-1);
+                return (0);
+        } else if (ret < 0)
+                return (-1);
+
+        if (rec.len == 0 || rec.len > SSIZE_MAX) {
+                errno = EILSEQ;
+                return (-1);
+        }
+
+        if (rec.pos == SCH_SHM_INLINE) {
+                struct sch_shm_inbuf *ib;
+
+                ib = sm_alloc (sizeof (struct sch_shm_inbuf) + rec.len);
+
+                if (shm_readall (data->pipe.pfd, ib->data, rec.len) != (ssize_t)rec.len) {
+                        protect_errno {
+                                sm_free (ib);
+                        }
+                        return (-1);
+                }
+
+                ib->next     = data->inbufs;
+                data->inbufs = ib;
+                *ptr = ib->data;
+        } else {
+                uint64_t idx;
+
+                idx = rec.pos % data->ring->size;
+
+                if (rec.len > data->ring->size - idx) {
+                        errno = EILSEQ;
+                        return (-1);
+                }
+
+                data->pending = rec.pos + rec.len;
+                *ptr = SCH_SHM_DATA(data->ring) + idx;
+        }
+
+        return ((ssize_t)rec.len);
+}
+
+int sch_shm_release (SEAP_desc_t *desc, uint32_t flags)
+{
+        sch_shmdata_t *data;
+        struct sch_shm_inbuf *ib;
+
+        assume_d (desc != NULL, -1, errno = EFAULT;);
+
+        data = DATA(desc->scheme_data);
+
+        assume_r (data != NULL, -1, errno = EBADF;);
+
+        while ((ib = data->inbufs) != NULL) {
+                data->inbufs = ib->next;
+                sm_free (ib);
+        }
+
+        if (data->pending > data->ring->tail) {
+                __sync_synchronize ();
+                data->ring->tail = data->pending;
+                shm_wake (data->ring);
+        }
+
+        return (0);
+}
+
+sch_shmring_t *sch_shm_ring_attach (int fd)
+{
+        sch_shmring_t *ring;
+        struct stat st;
+
+        if (fstat (fd, &st) != 0)
+                return (NULL);
+
+        if ((size_t)st.st_size < SCH_SHM_HDRSIZE) {
+                errno = EINVAL;
+                return (NULL);
+        }
+
+        ring = shm_map (fd, st.st_size);
+
+        if (ring == NULL)
+                return (NULL);
+
+        if (ring->magic != SCH_SHM_MAGIC ||
+            ring->hdrsize + ring->size != (uint64_t)st.st_size)
+        {
+                munmap (ring, st.st_size);
+                errno = EINVAL;
+                return (NULL);
+        }
+
+        return (ring);
+}
+
+void sch_shm_ring_detach (sch_shmring_t *ring)
+{
+        if (ring != NULL)
+                munmap (ring, ring->hdrsize + ring->size);
+}
+
+ssize_t sch_shm_ring_put (sch_shmring_t *ring, uint64_t *head, int ofd, strbuf_t *sb)
+{
+        sch_shmrec_t rec;
+        uint64_t idx, pad;
+        size_t   len;
+
+        len = strbuf_size (sb);
+
+        if (len > ring->size / 2) {
+                /*
+                 * Sending a message this large through the ring could
+                 * block the sender until the receiver releases all the
+                 * previous messages. Send it through the socket instead.
+                 */
+                rec.pos = SCH_SHM_INLINE;
+                rec.len = len;
+
+                if (shm_writeall (ofd, &rec, sizeof rec) != sizeof rec)
+                        return (-1);
+
+                return strbuf_write (sb, ofd);
+        }
+
+        /*
+         * Messages are stored contiguously so that they can be parsed
+         * in place. Skip the end of the ring if there is not enough space.
+         */
+        idx = *head % ring->size;
+        pad = (ring->size - idx < len) ? ring->size - idx : 0;
+
+        for (;;) {
+                uint64_t tail;
+                uint32_t seq;
+
+                seq = ring->released;
+                __sync_synchronize ();
+                tail = ring->tail;
+
+                if (ring->size - (*head - tail) >= pad + len)
+                        break;
+
+                if (shm_wait (ring, seq, ofd) != 0)
+                        return (-1);
+        }
+
+        *head += pad;
+
+        strbuf_copy (sb, SCH_SHM_DATA(ring) + (*head % ring->size), len);
+
+        rec.pos = *head;
+        rec.len = len;
+        *head  += len;
+
+        __sync_synchronize ();
+
+        if (shm_writeall (ofd, &rec, sizeof rec) != sizeof rec)
+                return (-1);
+
+        return ((ssize_t)len);
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ * The "shm" scheme works like the "pipe" scheme but the data sent by the
+ * child (i.e. probe results) is placed into a ring buffer shared between
+ * both processes. Only a small record describing the position and the
+ * length of each S-expression goes through the socket and the receiver
+ * parses the S-expression directly from the shared mapping. The child
+ * side is handled by the generic scheme which switches to the ring when
+ * SCH_SHM_ENV is set in its environment.
+ */
+#pragma once
+#ifndef SCH_SHM_H
+#define SCH_SHM_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include "public/strbuf.h"
+#include "sch_pipe.h"
+#include "../../../common/util.h"
+
+OSCAP_HIDDEN_START;
+
+#define SCH_SHM_ENV      "SEAP_SHM_FD"
+#define SCH_SHM_RINGSIZE (8 * 1024 * 1024)
+#define SCH_SHM_MAGIC    0x53454150 /* "SEAP" */
+#define SCH_SHM_HDRSIZE  64
+#define SCH_SHM_INLINE   UINT64_MAX
+#define SCH_SHM_WAITSEC  1 /* how often a waiting sender checks the receiver */
+
+typedef struct sch_shmring {
+        uint32_t          magic;
+        uint32_t          hdrsize;
+        uint64_t          size;  /* size of the data area */
+        volatile uint64_t tail;  /* released by the receiver */
+        volatile uint32_t released; /* bumped on every release, the sender sleeps on it */
+        volatile uint32_t waiting;  /* set while the sender sleeps */
+} sch_shmring_t;
+
+#define SCH_SHM_DATA(ring) ((uint8_t *)(ring) + (ring)->hdrsize)
+
+/*
+ * Message record sent through the socket. `pos' is a position in the
+ * ring that grows monotonically or SCH_SHM_INLINE if `len' bytes follow
+ * the record in the socket (used for messages that don't fit the ring).
+ */
+typedef struct {
+        uint64_t pos;
+        uint64_t len;
+} sch_shmrec_t;
+
+struct sch_shm_inbuf {
+        struct sch_shm_inbuf *next;
+        uint8_t               data[];
+};
+
+typedef struct {
+        sch_pipedata_t        pipe; /* must be first, see sch_shm_connect */
+        sch_shmring_t        *ring;
+        uint64_t              pending;
+        struct sch_shm_inbuf *inbufs;
+} sch_shmdata_t;
+
+int sch_shm_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags);
+int sch_shm_openfd (SEAP_desc_t *desc, int fd, uint32_t flags);
+int sch_shm_openfd2 (SEAP_desc_t *desc, int ifd, int ofd, uint32_t flags);
+ssize_t sch_shm_recv (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags);
+ssize_t sch_shm_send (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags);
+ssize_t sch_shm_sendsexp (SEAP_desc_t *desc, SEXP_t *sexp, uint32_t flags);
+int sch_shm_close (SEAP_desc_t *desc, uint32_t flags);
+int sch_shm_select (SEAP_desc_t *desc, int ev, uint16_t timeout, uint32_t flags);
+ssize_t sch_shm_recvptr (SEAP_desc_t *desc, void **ptr, uint32_t flags);
+int sch_shm_release (SEAP_desc_t *desc, uint32_t flags);
+
+/*
+ * Sender side, used by the generic scheme.
+ */
+sch_shmring_t *sch_shm_ring_attach (int fd);
+void sch_shm_ring_detach (sch_shmring_t *ring);
+ssize_t sch_shm_ring_put (sch_shmring_t *ring, uint64_t *head, int ofd, strbuf_t *sb);
+
+OSCAP_HIDDEN_END;
+
+#endif /* SCH_SHM_H */
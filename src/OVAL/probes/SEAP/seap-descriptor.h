@@ -64,6 +64,9 @@ typedef struct {
         SEAP_cmdid_t   next_cid;
         SEAP_cmdtbl_t *cmd_c_table; /* Local SEAP commands */
         SEAP_cmdtbl_t *cmd_w_table; /* Waiting SEAP commands */
+
+        uint64_t bytes_sent; /* Bytes written to the descriptor */
+        uint64_t bytes_recv; /* Bytes read from the descriptor */
 } SEAP_desc_t;
 
 #define SEAP_DESC_FDIN  0x00000001
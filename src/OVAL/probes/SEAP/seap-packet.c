@@ -171,7 +171,7 @@ static int SEAP_packet_sexp2msg (SEXP_t *sexp_msg, SEAP_msg_t *seap_msg)
 
                                 SEXP_free (attr_val);
                         } else {
-                                seap_msg->attrs[attr_i].name  = SEXP_string_subcstr (attr_name, 1, 0);
+                                seap_msg->attrs[attr_i].name  = SEXP_string_subcstr (attr_name, 1, SEXP_string_length (attr_name) - 1);
                                 seap_msg->attrs[attr_i].value = SEXP_list_nth (sexp_msg, msg_n + 1);
 
                                 if (seap_msg->attrs[attr_i].value == NULL) {
@@ -597,6 +597,7 @@ int SEAP_packet_recv (SEAP_CTX_t *ctx, int sd, SEAP_packet_t **packet)
         void        *data_buffer;
         size_t       data_buflen;
         ssize_t      data_length;
+        int          zcopy;
 
         SEXP_psetup_t *psetup;
         SEXP_pstate_t *pstate;
@@ -673,23 +674,36 @@ eloop_exit:
 
         pstate = NULL;
         psetup = SEXP_psetup_new ();
+        zcopy  = SCH_HAS_RECVPTR(dsc->scheme);
 
         /*
          * All buffer passed to SEXP_parse will be freed by
-         * SEXP_pstate_free (i.e. after successful parsing)
+         * SEXP_pstate_free (i.e. after successful parsing). Buffers
+         * owned by the scheme are handed back using SCH_RELEASE
+         * instead.
          */
-        SEXP_psetup_setflags(psetup, SEXP_PFLAG_FREEBUF);
+        if (!zcopy)
+                SEXP_psetup_setflags(psetup, SEXP_PFLAG_FREEBUF);
 
         for (;;) {
-                data_buffer = sm_alloc (SEAP_RECVBUF_SIZE);
-                data_buflen = SEAP_RECVBUF_SIZE;
-                data_length = SCH_RECV(dsc->scheme, dsc, data_buffer, data_buflen, 0);
+                if (zcopy) {
+                        data_buflen = 0;
+                        data_length = SCH_RECVPTR(dsc->scheme, dsc, &data_buffer, 0);
+                } else {
+                        data_buffer = sm_alloc (SEAP_RECVBUF_SIZE);
+                        data_buflen = SEAP_RECVBUF_SIZE;
+                        data_length = SCH_RECV(dsc->scheme, dsc, data_buffer, data_buflen, 0);
+                }
 
                 if (data_length < 0) {
                         protect_errno {
                                 dI("FAIL: recv failed: dsc=%p, errno=%u, %s.\n", dsc, errno, strerror (errno));
 
-                                sm_free (data_buffer);
+                                if (zcopy)
+                                        SCH_RELEASE(dsc->scheme, dsc, 0);
+                                else
+                                        sm_free (data_buffer);
+
                                 SEXP_psetup_free (psetup);
 
                                 if (pstate != NULL)
@@ -698,7 +712,12 @@ eloop_exit:
                         return (-1);
                 } else if (data_length == 0) {
                         dI("zero bytes received -> EOF\n");
-                        sm_free (data_buffer);
+
+                        if (zcopy)
+                                SCH_RELEASE(dsc->scheme, dsc, 0);
+                        else
+                                sm_free (data_buffer);
+
                         SEXP_psetup_free (psetup);
 
                         if (pstate != NULL) {
@@ -712,8 +731,9 @@ eloop_exit:
                 }
 
                 _A(data_length > 0);
+                dsc->bytes_recv += data_length;
 
-                if (data_buflen != (size_t)(data_length)) {
+                if (!zcopy && data_buflen != (size_t)(data_length)) {
                         data_buffer = sm_realloc (data_buffer, data_length);
 			data_buflen = data_length;
 		}
@@ -723,6 +743,9 @@ eloop_exit:
                 if (sexp_buffer != NULL) {
                         _A(pstate == NULL);
 
+                        if (zcopy)
+                                SCH_RELEASE(dsc->scheme, dsc, 0);
+
                         DESC_RUNLOCK(dsc);
 
                         if (SEXP_list_length (sexp_buffer) > 0) {
@@ -742,6 +765,9 @@ eloop_exit:
 				SEXP_psetup_free(psetup);
 				SEXP_pstate_free(pstate);
 
+				if (zcopy)
+					SCH_RELEASE(dsc->scheme, dsc, 0);
+
 				errno = EILSEQ;
 
 				return (-1);
@@ -763,6 +789,9 @@ eloop_exit:
 
                                         SEXP_psetup_free (psetup);
                                         SEXP_pstate_free (pstate);
+
+                                        if (zcopy)
+                                                SCH_RELEASE(dsc->scheme, dsc, 0);
                                 }
                                 SEXP_free(sexp_buffer);
                                 return (-1);
@@ -973,15 +1002,19 @@ int SEAP_packet_send (SEAP_CTX_t *ctx, int sd, SEAP_packet_t *packet)
         }
 
         if (DESC_WLOCK (dsc)) {
-                ret = 0;
+                ssize_t sent;
+
+                ret  = 0;
+                sent = SCH_SENDSEXP(dsc->scheme, dsc, packet_sexp, 0);
 
-                if (SCH_SENDSEXP(dsc->scheme, dsc, packet_sexp, 0) < 0) {
+                if (sent < 0) {
                         ret = -1;
 
                         protect_errno {
                                 dI("FAIL: errno=%u, %s.\n", errno, strerror (errno));
                         }
-                }
+                } else
+                        dsc->bytes_sent += sent;
 
                 DESC_WUNLOCK(dsc);
         }
@@ -846,7 +846,6 @@ char *SEXP_string_subcstr (const SEXP_t *s_exp, size_t beg, size_t len)
                 s_len = len;
 
         if (s_len > 0) {
-                s_len = v_dsc.hdr->size / sizeof (char);
                 s_str = sm_alloc (sizeof (char) * (s_len + 1));
 
                 memcpy (s_str, ((char *) v_dsc.mem) + beg, sizeof (char) * s_len);
@@ -1230,6 +1229,19 @@ SEXP_t *SEXP_list_add (SEXP_t *list, const SEXP_t *s_exp)
         return (list);
 }
 
+void SEXP_list_compact (SEXP_t *list)
+{
+        SEXP_val_t v_dsc;
+
+        SEXP_VALIDATE(list);
+        SEXP_val_dsc (&v_dsc, list->s_valp);
+
+        if (v_dsc.type != SEXP_VALTYPE_LIST || SEXP_LCASTP(v_dsc.mem)->offset != 0)
+                return;
+
+        SEXP_LCASTP(v_dsc.mem)->b_addr = (void *)SEXP_rawval_lblk_compact ((uintptr_t)SEXP_LCASTP(v_dsc.mem)->b_addr);
+}
+
 SEXP_t *SEXP_list_join (const SEXP_t *list_a, const SEXP_t *list_b)
 {
         SEXP_t *list_j, *memb;
@@ -1133,6 +1133,11 @@ SEXP_t *SEXP_parse (const SEXP_psetup_t *psetup, char *buffer, size_t buflen, SE
                         SEXP_t *ref_t;
 
                         ref_t = SEXP_lstack_pop (&state->l_stack);
+                        /*
+                         * The list is complete, it's only going to be read
+                         * from now on.
+                         */
+                        SEXP_list_compact (ref_t);
                         SEXP_free (ref_t);
                         ref_l = SEXP_lstack_top (&state->l_stack);
 
@@ -456,62 +456,77 @@ uintptr_t SEXP_rawval_list_copy (uintptr_t s_valp)
         return (SEXP_val_ptr (&v_dsc_c));
 }
 
+/*
+ * Size exponent of the smallest block which can hold `length' members
+ */
+static uint8_t SEXP_rawval_lblk_sz (size_t length)
+{
+        uint8_t sz;
+
+        for (sz = 0; sz < 15 && ((size_t)1 << sz) < length; ++sz);
+
+        return (sz);
+}
+
 uintptr_t SEXP_rawval_lblk_copy (uintptr_t lblkp, uint16_t n_skip)
 {
         struct SEXP_val_lblk *lb_new, *lb_old;
         uintptr_t lb_next;
         uintptr_t lb_head;
-        uint16_t  off_n;  /* offset in the new block */
+        size_t    length; /* number of members not copied yet */
         uint16_t  off_o;  /* offset in the old block */
         uint8_t  cur_sz;  /* size of the new block */
 
-        lb_head = 0;
-        off_n   = 0;
         off_o   = n_skip;
         lb_old  = SEXP_VALP_LBLK(lblkp);
 
         if (lb_old == NULL)
                 return ((uintptr_t) NULL);
 
-        cur_sz  = 0;
-        lb_new  = (struct SEXP_val_lblk *)SEXP_rawval_lblk_new (cur_sz);
+        /*
+         * Size the new blocks to the length of the list so that
+         * the copy consists of as few blocks as possible.
+         */
+        for (length = 0; lb_old != NULL; lb_old = SEXP_VALP_LBLK(lb_old->nxsz))
+                length += lb_old->real;
+
+        length -= n_skip;
+        lb_old  = SEXP_VALP_LBLK(lblkp);
+        cur_sz = SEXP_rawval_lblk_sz (length);
+        lb_new = (struct SEXP_val_lblk *)SEXP_rawval_lblk_new (cur_sz);
         lb_head = (uintptr_t)lb_new;
 
         while (lb_old != NULL) {
-                if ((lb_old->real - off_o) == 0) {
+                if (off_o >= lb_old->real) {
                         /*
                          * move to the next old block
                          */
                         lb_old = SEXP_VALP_LBLK(lb_old->nxsz);
-
-                        if (lb_old == NULL)
-                                break;
-
                         off_o  = 0;
+                        continue;
                 }
 
                 /*
                  * allocate new block
                  */
-                if (lb_new->real >= (1 << (cur_sz))) {
-                        lb_next = SEXP_rawval_lblk_new (++cur_sz);
+                if (lb_new->real >= (1 << cur_sz)) {
+                        length -= lb_new->real;
+                        cur_sz  = SEXP_rawval_lblk_sz (length);
+                        lb_next = SEXP_rawval_lblk_new (cur_sz);
                         lb_new->nxsz = (lb_next & SEXP_LBLKP_MASK) | (lb_new->nxsz & SEXP_LBLKS_MASK);
                         lb_new  = SEXP_VALP_LBLK(lb_next);
-                        off_n   = 0;
                 }
 
                 /*
                  * copy list items
                  */
-                while (off_n < (1 << cur_sz) && off_o < lb_old->real) {
-                        lb_new->memb[off_n].s_valp = SEXP_rawval_incref (lb_old->memb[off_o].s_valp);
-                        lb_new->memb[off_n].s_type = lb_old->memb[off_o].s_type;
+                while (lb_new->real < (1 << cur_sz) && off_o < lb_old->real) {
+                        lb_new->memb[lb_new->real].s_valp = SEXP_rawval_incref (lb_old->memb[off_o].s_valp);
+                        lb_new->memb[lb_new->real].s_type = lb_old->memb[off_o].s_type;
 #if !defined(NDEBUG) || defined(VALIDATE_SEXP)
-                        lb_new->memb[off_n].__magic0 = lb_old->memb[off_o].__magic0;
-                        lb_new->memb[off_n].__magic1 = lb_old->memb[off_o].__magic1;
+                        lb_new->memb[lb_new->real].__magic0 = lb_old->memb[off_o].__magic0;
+                        lb_new->memb[lb_new->real].__magic1 = lb_old->memb[off_o].__magic1;
 #endif
-
-                        ++off_n;
                         ++off_o;
                         ++lb_new->real;
                 }
@@ -520,6 +535,48 @@ uintptr_t SEXP_rawval_lblk_copy (uintptr_t lblkp, uint16_t n_skip)
         return (lb_head);
 }
 
+uintptr_t SEXP_rawval_lblk_compact (uintptr_t lblkp)
+{
+        struct SEXP_val_lblk *lblk, *next, *lb_new;
+        size_t length;
+
+        lblk = SEXP_VALP_LBLK(lblkp);
+
+        if (lblk == NULL || SEXP_VALP_LBLK(lblk->nxsz) == NULL)
+                return (lblkp);
+
+        /*
+         * Blocks shared with other lists can't be moved
+         */
+        length = 0;
+
+        for (next = lblk; next != NULL; next = SEXP_VALP_LBLK(next->nxsz)) {
+                if (next->refs != 1)
+                        return (lblkp);
+
+                length += next->real;
+        }
+
+        if (length > (1 << 15))
+                return (lblkp);
+
+        lb_new = (struct SEXP_val_lblk *)SEXP_rawval_lblk_new (SEXP_rawval_lblk_sz (length));
+
+        /*
+         * The members are moved to the new block, their
+         * reference counters don't change.
+         */
+        while (lblk != NULL) {
+                next = SEXP_VALP_LBLK(lblk->nxsz);
+                memcpy (lb_new->memb + lb_new->real, lblk->memb, sizeof (SEXP_t) * lblk->real);
+                lb_new->real += lblk->real;
+                sm_free (lblk);
+                lblk = next;
+        }
+
+        return ((uintptr_t)lb_new);
+}
+
 void SEXP_rawval_lblk_free (uintptr_t lblkp, void (*func) (SEXP_t *))
 {
         if (SEXP_rawval_lblk_decref (lblkp)) {
@@ -233,9 +233,10 @@ static int process_file(const char *path, const char *filename, void *arg)
 {
 	struct pfdata *pfd = (struct pfdata *) arg;
 	int ret = 0, path_len, filename_len;
-	char *whole_path = NULL;
+	char *whole_path = NULL, *content = NULL;
 	FILE *fp = NULL;
 	struct stat st;
+	ocifs_t *ocifs = ocifs_active();
 
 // todo: move to probe_main()?
 #if defined USE_REGEX_PCRE
@@ -277,12 +278,26 @@ static int process_file(const char *path, const char *filename, void *arg)
 	 * to return 'FTS_SL' and the presence of a valid target has to
 	 * be determined with stat().
 	 */
-	if (stat(whole_path, &st) == -1)
+	if ((ocifs != NULL ? ocifs_stat(ocifs, whole_path, &st) : stat(whole_path, &st)) == -1)
 		goto cleanup;
 	if (!S_ISREG(st.st_mode))
 		goto cleanup;
 
-	fp = fopen(whole_path, "rb");
+	if (ocifs != NULL) {
+		size_t size;
+
+		/* read the content straight from the image layer */
+		content = ocifs_read_file(ocifs, whole_path, &size);
+		if (content == NULL) {
+			ret = -2;
+			goto cleanup;
+		}
+		if (size == 0)
+			goto cleanup;
+		fp = fmemopen(content, size, "rb");
+	} else {
+		fp = fopen(whole_path, "rb");
+	}
 	if (fp == NULL) {
 		ret = -2;
 		goto cleanup;
@@ -315,6 +330,8 @@ static int process_file(const char *path, const char *filename, void *arg)
  cleanup:
 	if (fp != NULL)
 		fclose(fp);
+	if (content != NULL)
+		oscap_free(content);
 	if (whole_path != NULL)
 		free(whole_path);
 #if defined USE_REGEX_PCRE
@@ -329,7 +346,7 @@ static int process_file(const char *path, const char *filename, void *arg)
 
 void *probe_init(void)
 {
-	probe_setoption(PROBEOPT_OFFLINE_MODE_SUPPORTED, PROBE_OFFLINE_CHROOT);
+	probe_setoption(PROBEOPT_OFFLINE_MODE_SUPPORTED, PROBE_OFFLINE_CHROOT|PROBE_OFFLINE_OCI);
 	return NULL;
 }
 
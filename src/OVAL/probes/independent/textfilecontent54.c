@@ -227,6 +227,7 @@ static int process_file(const char *path, const char *file, void *arg)
 	char *whole_path = NULL, *buf = NULL;
 	SEXP_t *next_inst = NULL;
 	struct stat st;
+	ocifs_t *ocifs = ocifs_active();
 
 	if (file == NULL)
 		goto cleanup;
@@ -253,11 +254,31 @@ static int process_file(const char *path, const char *file, void *arg)
 	 * to return 'FTS_SL' and the presence of a valid target has to
 	 * be determined with stat().
 	 */
-	if (stat(whole_path, &st) == -1)
+	if ((ocifs != NULL ? ocifs_stat(ocifs, whole_path, &st) : stat(whole_path, &st)) == -1)
 		goto cleanup;
 	if (!S_ISREG(st.st_mode))
 		goto cleanup;
 
+	if (ocifs != NULL) {
+		size_t size;
+
+		/* read the content straight from the image layer */
+		buf = ocifs_read_file(ocifs, whole_path, &size);
+		if (buf == NULL) {
+			SEXP_t *msg;
+
+			msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR, "read(): '%s' %s.", whole_path, strerror(errno));
+			probe_cobj_add_msg(probe_ctx_getresult(pfd->ctx), msg);
+			SEXP_free(msg);
+			probe_cobj_set_flag(probe_ctx_getresult(pfd->ctx), SYSCHAR_FLAG_ERROR);
+			ret = -2;
+			goto cleanup;
+		}
+		buf_used = size;
+		buf_size = size + 1;
+		goto buf_ready;
+	}
+
 	fd = open(whole_path, O_RDONLY);
 	if (fd == -1) {
 		SEXP_t *msg;
@@ -287,6 +308,7 @@ static int process_file(const char *path, const char *file, void *arg)
 		buf_used += ret;
 	} while (ret == buf_inc);
 
+buf_ready:
 	if (buf_used == buf_size)
 		buf = realloc(buf, ++buf_size);
 	buf[buf_used++] = '\0';
@@ -336,7 +358,7 @@ static int process_file(const char *path, const char *file, void *arg)
 
 void *probe_init(void)
 {
-  probe_setoption(PROBEOPT_OFFLINE_MODE_SUPPORTED, PROBE_OFFLINE_CHROOT);
+  probe_setoption(PROBEOPT_OFFLINE_MODE_SUPPORTED, PROBE_OFFLINE_CHROOT|PROBE_OFFLINE_OCI);
   return NULL;
 }
 
@@ -0,0 +1,1005 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <sys/sysmacros.h>
+#endif
+
+#include "alloc.h"
+#include "list.h"
+#include "util.h"
+#include "debug_priv.h"
+#include "ocifs.h"
+
+#define OCIFS_BLOCK        512
+#define OCIFS_MAXSYMLINKS  40
+#define OCIFS_INDEX_HSIZE  65521
+#define OCIFS_META_MAXSIZE (1024 * 1024)
+
+#define OCIFS_WH_PREFIX     ".wh."
+#define OCIFS_WH_OPAQUE     ".wh..wh..opq"
+
+/* POSIX ustar header, GNU tar uses the same layout for the fields below */
+struct tar_header {
+	char name[100];
+	char mode[8];
+	char uid[8];
+	char gid[8];
+	char size[12];
+	char mtime[12];
+	char chksum[8];
+	char typeflag;
+	char linkname[100];
+	char magic[6];
+	char version[2];
+	char uname[32];
+	char gname[32];
+	char devmajor[8];
+	char devminor[8];
+	char prefix[155];
+	char padding[12];
+};
+
+struct ocifs_node {
+	char *path;                 /* relative to the image root, "" for the root */
+	const char *name;           /* last component of path */
+	struct ocifs_node *parent;
+	struct ocifs_node **kids;
+	size_t kids_cnt;
+	size_t kids_max;
+	struct stat st;
+	char *link;                 /* symlink target */
+	int layer;                  /* layer which defined the entry */
+	int data_layer;             /* layer holding the content (differs for hardlinks) */
+	off_t data;                 /* offset of the content in data_layer */
+};
+
+struct ocifs {
+	int *fds;
+	size_t layer_cnt;
+	struct ocifs_node *root;
+	struct oscap_htable *index; /* path => struct ocifs_node */
+	ino_t next_ino;
+};
+
+static ocifs_t *__ocifs_active = NULL;
+
+ocifs_t *ocifs_active(void)
+{
+	return __ocifs_active;
+}
+
+void ocifs_set_active(ocifs_t *fs)
+{
+	__ocifs_active = fs;
+}
+
+/*
+ * Index
+ */
+
+static struct ocifs_node *ocifs_node_new(ocifs_t *fs, struct ocifs_node *parent, const char *path)
+{
+	struct ocifs_node *node;
+	const char *slash;
+
+	node = oscap_calloc(1, sizeof(struct ocifs_node));
+	node->path = strdup(path);
+	slash = strrchr(node->path, '/');
+	node->name = slash != NULL ? slash + 1 : node->path;
+	node->parent = parent;
+	node->st.st_ino = fs->next_ino++;
+	node->st.st_nlink = 1;
+	node->st.st_blksize = OCIFS_BLOCK;
+
+	if (parent != NULL) {
+		if (parent->kids_cnt == parent->kids_max) {
+			parent->kids_max = parent->kids_max == 0 ? 8 : parent->kids_max * 2;
+			parent->kids = oscap_realloc(parent->kids, parent->kids_max * sizeof(struct ocifs_node *));
+		}
+		parent->kids[parent->kids_cnt++] = node;
+		oscap_htable_add(fs->index, node->path, node);
+	}
+
+	return node;
+}
+
+static void ocifs_node_free(ocifs_t *fs, struct ocifs_node *node)
+{
+	size_t i;
+
+	for (i = 0; i < node->kids_cnt; ++i)
+		ocifs_node_free(fs, node->kids[i]);
+	if (fs != NULL && node->parent != NULL)
+		oscap_htable_detach(fs->index, node->path);
+	oscap_free(node->kids);
+	oscap_free(node->link);
+	oscap_free(node->path);
+	oscap_free(node);
+}
+
+/* detach the node from its parent and free the whole subtree */
+static void ocifs_node_remove(ocifs_t *fs, struct ocifs_node *node)
+{
+	struct ocifs_node *parent = node->parent;
+	size_t i;
+
+	for (i = 0; i < parent->kids_cnt; ++i) {
+		if (parent->kids[i] == node) {
+			parent->kids[i] = parent->kids[--parent->kids_cnt];
+			break;
+		}
+	}
+	ocifs_node_free(fs, node);
+}
+
+static struct ocifs_node *ocifs_lookup(ocifs_t *fs, const char *path)
+{
+	if (*path == '\0')
+		return fs->root;
+	return oscap_htable_get(fs->index, path);
+}
+
+/* Strip "./", leading and duplicate slashes. Returns false for entries
+ * which would escape the image root. */
+static bool ocifs_normalize(char *path)
+{
+	char *src = path, *dst = path;
+
+	while (*src != '\0') {
+		while (*src == '/')
+			++src;
+		if (src[0] == '.' && (src[1] == '/' || src[1] == '\0')) {
+			++src;
+			continue;
+		}
+		if (src[0] == '.' && src[1] == '.' && (src[2] == '/' || src[2] == '\0'))
+			return false;
+		if (*src == '\0')
+			break;
+		if (dst != path)
+			*dst++ = '/';
+		while (*src != '\0' && *src != '/')
+			*dst++ = *src++;
+	}
+	*dst = '\0';
+
+	return true;
+}
+
+/* Look up the parent directory of `path', creating the missing ones */
+static struct ocifs_node *ocifs_mkparents(ocifs_t *fs, char *path, int layer)
+{
+	struct ocifs_node *dir = fs->root, *next;
+	char *slash;
+
+	for (slash = strchr(path, '/'); slash != NULL; slash = strchr(slash + 1, '/')) {
+		*slash = '\0';
+		next = ocifs_lookup(fs, path);
+		if (next == NULL) {
+			next = ocifs_node_new(fs, dir, path);
+			next->st.st_mode = S_IFDIR | 0755;
+			next->layer = layer;
+		}
+		*slash = '/';
+		if (!S_ISDIR(next->st.st_mode))
+			return NULL;
+		dir = next;
+	}
+
+	return dir;
+}
+
+static void ocifs_whiteout(ocifs_t *fs, char *path, int layer)
+{
+	struct ocifs_node *dir, *node;
+	char *name, *target;
+	size_t i;
+
+	dir = ocifs_mkparents(fs, path, layer);
+	if (dir == NULL)
+		return;
+	name = strrchr(path, '/');
+	name = name != NULL ? name + 1 : path;
+
+	if (strcmp(name, OCIFS_WH_OPAQUE) == 0) {
+		/* hide everything the lower layers put into the directory */
+		for (i = dir->kids_cnt; i > 0; --i) {
+			if (dir->kids[i - 1]->layer < layer)
+				ocifs_node_remove(fs, dir->kids[i - 1]);
+		}
+		return;
+	}
+
+	target = oscap_sprintf("%.*s%s", (int) (name - path), path, name + strlen(OCIFS_WH_PREFIX));
+	node = ocifs_lookup(fs, target);
+	if (node != NULL && node != fs->root && node->layer < layer)
+		ocifs_node_remove(fs, node);
+	oscap_free(target);
+}
+
+static void ocifs_insert(ocifs_t *fs, char *path, const struct stat *st, const char *link,
+		char typeflag, int layer, off_t data)
+{
+	struct ocifs_node *dir, *node, *target = NULL;
+	const char *name;
+
+	if (!ocifs_normalize(path)) {
+		dW("Skipping entry outside of the image root: '%s'.\n", path);
+		return;
+	}
+	if (*path == '\0') {
+		fs->root->st.st_mode = st->st_mode;
+		fs->root->st.st_uid = st->st_uid;
+		fs->root->st.st_gid = st->st_gid;
+		fs->root->st.st_mtime = st->st_mtime;
+		return;
+	}
+
+	name = strrchr(path, '/');
+	name = name != NULL ? name + 1 : path;
+	if (strncmp(name, OCIFS_WH_PREFIX, strlen(OCIFS_WH_PREFIX)) == 0) {
+		ocifs_whiteout(fs, path, layer);
+		return;
+	}
+
+	if (typeflag == '1') {
+		char *tpath = strdup(link);
+
+		if (ocifs_normalize(tpath))
+			target = ocifs_lookup(fs, tpath);
+		oscap_free(tpath);
+		if (target == NULL || !S_ISREG(target->st.st_mode)) {
+			dW("Skipping hardlink '%s' with an unknown target '%s'.\n", path, link);
+			return;
+		}
+	}
+
+	dir = ocifs_mkparents(fs, path, layer);
+	if (dir == NULL) {
+		dW("Skipping entry '%s': parent is not a directory.\n", path);
+		return;
+	}
+
+	node = ocifs_lookup(fs, path);
+	if (node != NULL && S_ISDIR(node->st.st_mode) && !S_ISDIR(st->st_mode)) {
+		ocifs_node_remove(fs, node);
+		node = NULL;
+	}
+	if (node == NULL)
+		node = ocifs_node_new(fs, dir, path);
+
+	oscap_free(node->link);
+	node->link = NULL;
+	node->layer = layer;
+
+	if (target != NULL) {
+		node->st.st_mode = target->st.st_mode;
+		node->st.st_uid = target->st.st_uid;
+		node->st.st_gid = target->st.st_gid;
+		node->st.st_size = target->st.st_size;
+		node->st.st_mtime = target->st.st_mtime;
+		node->data_layer = target->data_layer;
+		node->data = target->data;
+	} else {
+		node->st.st_mode = st->st_mode;
+		node->st.st_uid = st->st_uid;
+		node->st.st_gid = st->st_gid;
+		node->st.st_size = st->st_size;
+		node->st.st_mtime = st->st_mtime;
+		node->st.st_rdev = st->st_rdev;
+		node->data_layer = layer;
+		node->data = data;
+		if (S_ISLNK(st->st_mode)) {
+			node->link = strdup(link);
+			node->st.st_size = strlen(link);
+		}
+	}
+	node->st.st_atime = node->st.st_ctime = node->st.st_mtime;
+	node->st.st_blocks = (node->st.st_size + OCIFS_BLOCK - 1) / OCIFS_BLOCK;
+}
+
+static uint64_t tar_num(const char *field, size_t len)
+{
+	uint64_t val = 0;
+	size_t i = 0;
+
+	if ((unsigned char) field[0] & 0x80) {
+		/* GNU base-256 encoding */
+		val = (unsigned char) field[0] & 0x7f;
+		for (i = 1; i < len; ++i)
+			val = (val << 8) | (unsigned char) field[i];
+		return val;
+	}
+	while (i < len && (field[i] == ' ' || field[i] == '\0'))
+		++i;
+	for (; i < len && field[i] >= '0' && field[i] <= '7'; ++i)
+		val = (val << 3) | (field[i] - '0');
+
+	return val;
+}
+
+static bool tar_checksum_ok(const char *block)
+{
+	const struct tar_header *hdr = (const struct tar_header *) block;
+	unsigned long sum = 0;
+	size_t i;
+
+	for (i = 0; i < OCIFS_BLOCK; ++i) {
+		if (i >= offsetof(struct tar_header, chksum)
+		    && i < offsetof(struct tar_header, chksum) + sizeof hdr->chksum)
+			sum += ' ';
+		else
+			sum += (unsigned char) block[i];
+	}
+
+	return sum == tar_num(hdr->chksum, sizeof hdr->chksum);
+}
+
+static char *tar_read_meta(int fd, off_t offset, uint64_t size)
+{
+	char *buf;
+
+	if (size > OCIFS_META_MAXSIZE) {
+		errno = EFBIG;
+		return NULL;
+	}
+	buf = oscap_alloc(size + 1);
+	if (pread(fd, buf, size, offset) != (ssize_t) size) {
+		if (errno == 0)
+			errno = EIO;
+		oscap_free(buf);
+		return NULL;
+	}
+	buf[size] = '\0';
+
+	return buf;
+}
+
+/* Pick the attributes we care about out of the PAX extended header records */
+static void tar_parse_pax(char *buf, size_t size, char **path, char **link, uint64_t *esize)
+{
+	char *rec = buf, *end = buf + size;
+
+	while (rec < end) {
+		char *key, *val, *eq, *next;
+		unsigned long len = strtoul(rec, &key, 10);
+
+		if (len == 0 || key == rec || *key != ' ' || rec + len > end)
+			break;
+		next = rec + len;
+		++key;
+		eq = memchr(key, '=', next - key);
+		if (eq == NULL)
+			break;
+		*eq = '\0';
+		val = eq + 1;
+		next[-1] = '\0';
+
+		if (strcmp(key, "path") == 0) {
+			oscap_free(*path);
+			*path = strdup(val);
+		} else if (strcmp(key, "linkpath") == 0) {
+			oscap_free(*link);
+			*link = strdup(val);
+		} else if (strcmp(key, "size") == 0) {
+			*esize = strtoull(val, NULL, 10);
+		}
+		rec = next;
+	}
+}
+
+static int ocifs_index_layer(ocifs_t *fs, int layer)
+{
+	int fd = fs->fds[layer];
+	char block[OCIFS_BLOCK];
+	const struct tar_header *hdr = (const struct tar_header *) block;
+	char *lname = NULL, *llink = NULL;
+	uint64_t esize = 0;
+	off_t offset = 0;
+	ssize_t r;
+
+	for (;;) {
+		char *path, *link, *meta;
+		uint64_t size;
+		struct stat st;
+		off_t data;
+
+		r = pread(fd, block, sizeof block, offset);
+		if (r == 0)
+			break;
+		if (r != sizeof block) {
+			dE("Truncated tar header at offset %lld in layer #%d.\n", (long long) offset, layer);
+			goto fail;
+		}
+		if (block[0] == '\0') /* end of archive */
+			break;
+		if (offset == 0 && (unsigned char) block[0] == 0x1f && (unsigned char) block[1] == 0x8b) {
+			dE("Layer #%d is compressed, only uncompressed tar layers are supported.\n", layer);
+			goto fail;
+		}
+		if (!tar_checksum_ok(block)) {
+			dE("Invalid tar header checksum at offset %lld in layer #%d.\n", (long long) offset, layer);
+			goto fail;
+		}
+
+		size = tar_num(hdr->size, sizeof hdr->size);
+		if (esize != 0) {
+			size = esize;
+			esize = 0;
+		}
+		data = offset + OCIFS_BLOCK;
+		offset = data + ((size + OCIFS_BLOCK - 1) & ~((uint64_t) OCIFS_BLOCK - 1));
+
+		switch (hdr->typeflag) {
+		case 'L':
+		case 'K':
+			if ((meta = tar_read_meta(fd, data, size)) == NULL)
+				goto fail;
+			if (hdr->typeflag == 'L') {
+				oscap_free(lname);
+				lname = meta;
+			} else {
+				oscap_free(llink);
+				llink = meta;
+			}
+			continue;
+		case 'x':
+			if ((meta = tar_read_meta(fd, data, size)) == NULL)
+				goto fail;
+			tar_parse_pax(meta, size, &lname, &llink, &esize);
+			oscap_free(meta);
+			continue;
+		case 'g':
+			continue;
+		}
+
+		if (lname != NULL) {
+			path = lname;
+			lname = NULL;
+		} else if (memcmp(hdr->magic, "ustar\0", 6) == 0 && hdr->prefix[0] != '\0') {
+			path = oscap_sprintf("%.*s/%.*s", (int) sizeof hdr->prefix, hdr->prefix,
+					(int) sizeof hdr->name, hdr->name);
+		} else {
+			path = oscap_sprintf("%.*s", (int) sizeof hdr->name, hdr->name);
+		}
+		if (llink != NULL) {
+			link = llink;
+			llink = NULL;
+		} else {
+			link = oscap_sprintf("%.*s", (int) sizeof hdr->linkname, hdr->linkname);
+		}
+
+		memset(&st, 0, sizeof st);
+		st.st_mode = tar_num(hdr->mode, sizeof hdr->mode) & 07777;
+		st.st_uid = tar_num(hdr->uid, sizeof hdr->uid);
+		st.st_gid = tar_num(hdr->gid, sizeof hdr->gid);
+		st.st_mtime = tar_num(hdr->mtime, sizeof hdr->mtime);
+		st.st_size = size;
+
+		switch (hdr->typeflag) {
+		case '0':
+		case '\0':
+		case '7':
+			st.st_mode |= S_IFREG;
+			break;
+		case '1':
+			break;
+		case '2':
+			st.st_mode |= S_IFLNK;
+			break;
+		case '3':
+		case '4':
+			st.st_mode |= hdr->typeflag == '3' ? S_IFCHR : S_IFBLK;
+			st.st_rdev = makedev(tar_num(hdr->devmajor, sizeof hdr->devmajor),
+					     tar_num(hdr->devminor, sizeof hdr->devminor));
+			st.st_size = 0;
+			break;
+		case '5':
+			st.st_mode |= S_IFDIR;
+			st.st_size = 0;
+			break;
+		case '6':
+			st.st_mode |= S_IFIFO;
+			st.st_size = 0;
+			break;
+		default:
+			dW("Skipping '%s' with unsupported tar entry type '%c'.\n", path, hdr->typeflag);
+			oscap_free(path);
+			oscap_free(link);
+			continue;
+		}
+
+		ocifs_insert(fs, path, &st, link, hdr->typeflag, layer, data);
+		oscap_free(path);
+		oscap_free(link);
+	}
+
+	oscap_free(lname);
+	oscap_free(llink);
+	return 0;
+fail:
+	oscap_free(lname);
+	oscap_free(llink);
+	if (errno == 0)
+		errno = EINVAL;
+	return -1;
+}
+
+/* detached keys of the index are set to NULL */
+static int ocifs_path_cmp(const char *a, const char *b)
+{
+	if (a == NULL || b == NULL)
+		return a == b ? 0 : 1;
+	return strcmp(a, b);
+}
+
+static int ocifs_node_cmp(const void *a, const void *b)
+{
+	return strcmp((*(struct ocifs_node * const *) a)->name, (*(struct ocifs_node * const *) b)->name);
+}
+
+ocifs_t *ocifs_open(const char *layers)
+{
+	ocifs_t *fs;
+	char *lcopy, *lpath, *saveptr = NULL;
+	struct oscap_htable_iterator *hit;
+
+	fs = oscap_calloc(1, sizeof(ocifs_t));
+	fs->index = oscap_htable_new1(ocifs_path_cmp, OCIFS_INDEX_HSIZE);
+	fs->next_ino = 2;
+	fs->root = ocifs_node_new(fs, NULL, "");
+	fs->root->st.st_mode = S_IFDIR | 0755;
+
+	lcopy = strdup(layers);
+	for (lpath = strtok_r(lcopy, ":", &saveptr); lpath != NULL; lpath = strtok_r(NULL, ":", &saveptr)) {
+		int fd = open(lpath, O_RDONLY);
+
+		if (fd == -1) {
+			dE("Can't open layer '%s': %s.\n", lpath, strerror(errno));
+			goto fail;
+		}
+		fs->fds = oscap_realloc(fs->fds, (fs->layer_cnt + 1) * sizeof(int));
+		fs->fds[fs->layer_cnt] = fd;
+
+		errno = 0;
+		if (ocifs_index_layer(fs, fs->layer_cnt++) != 0) {
+			dE("Can't index layer '%s': %s.\n", lpath, strerror(errno));
+			goto fail;
+		}
+		dI("Indexed layer #%zu '%s'.\n", fs->layer_cnt - 1, lpath);
+	}
+	oscap_free(lcopy);
+
+	/* fts(3) returns the directory entries in a stable order, so do we */
+	qsort(fs->root->kids, fs->root->kids_cnt, sizeof(struct ocifs_node *), ocifs_node_cmp);
+	hit = oscap_htable_iterator_new(fs->index);
+	while (oscap_htable_iterator_has_more(hit)) {
+		struct ocifs_node *node = oscap_htable_iterator_next_value(hit);
+
+		if (node != NULL)
+			qsort(node->kids, node->kids_cnt, sizeof(struct ocifs_node *), ocifs_node_cmp);
+	}
+	oscap_htable_iterator_free(hit);
+
+	return fs;
+fail:
+	oscap_free(lcopy);
+	{
+		int err = errno;
+		ocifs_close(fs);
+		errno = err;
+	}
+	return NULL;
+}
+
+void ocifs_close(ocifs_t *fs)
+{
+	size_t i;
+
+	if (fs == NULL)
+		return;
+	if (__ocifs_active == fs)
+		__ocifs_active = NULL;
+	for (i = 0; i < fs->layer_cnt; ++i)
+		close(fs->fds[i]);
+	oscap_free(fs->fds);
+	ocifs_node_free(NULL, fs->root);
+	oscap_htable_free(fs->index, NULL);
+	oscap_free(fs);
+}
+
+/*
+ * Path resolution
+ */
+
+static struct ocifs_node *ocifs_resolve(ocifs_t *fs, const char *path, bool follow)
+{
+	struct ocifs_node *cur = fs->root, *next = NULL;
+	char *buf, *rest, *comp, key[PATH_MAX];
+	int links = 0;
+
+	buf = rest = strdup(path);
+
+	for (;;) {
+		while (*rest == '/')
+			++rest;
+		if (*rest == '\0')
+			break;
+		comp = rest;
+		rest = strchr(comp, '/');
+		if (rest != NULL)
+			*rest++ = '\0';
+		else
+			rest = comp + strlen(comp);
+
+		if (strcmp(comp, ".") == 0)
+			continue;
+		if (strcmp(comp, "..") == 0) {
+			if (cur->parent != NULL)
+				cur = cur->parent;
+			continue;
+		}
+		if (!S_ISDIR(cur->st.st_mode)) {
+			errno = ENOTDIR;
+			cur = NULL;
+			break;
+		}
+		if (snprintf(key, sizeof key, *cur->path ? "%s/%s" : "%s%s", cur->path, comp) >= (int) sizeof key) {
+			errno = ENAMETOOLONG;
+			cur = NULL;
+			break;
+		}
+		if ((next = ocifs_lookup(fs, key)) == NULL) {
+			errno = ENOENT;
+			cur = NULL;
+			break;
+		}
+		if (S_ISLNK(next->st.st_mode) && (follow || rest[strspn(rest, "/")] != '\0')) {
+			char *tmp;
+
+			if (++links > OCIFS_MAXSYMLINKS) {
+				errno = ELOOP;
+				cur = NULL;
+				break;
+			}
+			tmp = oscap_sprintf("%s/%s", next->link, rest);
+			oscap_free(buf);
+			buf = rest = tmp;
+			if (next->link[0] == '/')
+				cur = fs->root;
+			continue;
+		}
+		cur = next;
+	}
+	oscap_free(buf);
+
+	return cur;
+}
+
+int ocifs_lstat(ocifs_t *fs, const char *path, struct stat *st)
+{
+	struct ocifs_node *node = ocifs_resolve(fs, path, false);
+
+	if (node == NULL)
+		return -1;
+	memcpy(st, &node->st, sizeof(struct stat));
+	return 0;
+}
+
+int ocifs_stat(ocifs_t *fs, const char *path, struct stat *st)
+{
+	struct ocifs_node *node = ocifs_resolve(fs, path, true);
+
+	if (node == NULL)
+		return -1;
+	memcpy(st, &node->st, sizeof(struct stat));
+	return 0;
+}
+
+ssize_t ocifs_readlink(ocifs_t *fs, const char *path, char *buf, size_t bufsiz)
+{
+	struct ocifs_node *node = ocifs_resolve(fs, path, false);
+	size_t len;
+
+	if (node == NULL)
+		return -1;
+	if (!S_ISLNK(node->st.st_mode)) {
+		errno = EINVAL;
+		return -1;
+	}
+	len = strlen(node->link);
+	if (len > bufsiz)
+		len = bufsiz;
+	memcpy(buf, node->link, len);
+
+	return len;
+}
+
+char *ocifs_read_file(ocifs_t *fs, const char *path, size_t *size)
+{
+	struct ocifs_node *node = ocifs_resolve(fs, path, true);
+	char *buf;
+	size_t done = 0;
+
+	if (node == NULL)
+		return NULL;
+	if (!S_ISREG(node->st.st_mode)) {
+		errno = S_ISDIR(node->st.st_mode) ? EISDIR : EINVAL;
+		return NULL;
+	}
+
+	buf = oscap_alloc(node->st.st_size + 1);
+	while (done < (size_t) node->st.st_size) {
+		ssize_t r = pread(fs->fds[node->data_layer], buf + done,
+				  node->st.st_size - done, node->data + done);
+		if (r <= 0) {
+			if (r == 0)
+				errno = EIO;
+			oscap_free(buf);
+			return NULL;
+		}
+		done += r;
+	}
+	buf[done] = '\0';
+	if (size != NULL)
+		*size = done;
+
+	return buf;
+}
+
+/*
+ * fts(3) emulation
+ */
+
+struct ocifs_fts_frame {
+	FTSENT *ent;                /* FTS_D entry of the directory */
+	struct ocifs_node *dir;
+	size_t pos;                 /* next child to return */
+};
+
+struct ocifs_fts {
+	ocifs_t *fs;
+	int options;
+	char **paths;
+	size_t paths_cnt;
+	size_t paths_pos;
+	struct ocifs_fts_frame *stack;
+	size_t depth;
+	size_t stack_max;
+	FTSENT *last;               /* entry returned by the previous read */
+};
+
+static FTSENT *ocifs_ftsent_new(const char *path, const char *name, short level)
+{
+	FTSENT *ent;
+	size_t namelen = strlen(name);
+
+	ent = oscap_calloc(1, sizeof(FTSENT) + namelen + 1);
+	memcpy(ent->fts_name, name, namelen + 1);
+	ent->fts_namelen = namelen;
+	ent->fts_path = strdup(path);
+	ent->fts_accpath = ent->fts_path;
+	ent->fts_pathlen = strlen(path);
+	ent->fts_level = level;
+	ent->fts_instr = FTS_NOINSTR;
+	ent->fts_statp = oscap_calloc(1, sizeof(struct stat));
+
+	return ent;
+}
+
+static void ocifs_ftsent_free(FTSENT *ent)
+{
+	oscap_free(ent->fts_statp);
+	oscap_free(ent->fts_path);
+	oscap_free(ent);
+}
+
+static void ocifs_ftsent_set(OCIFS_FTS *ofts, FTSENT *ent, struct ocifs_node *node)
+{
+	size_t i;
+
+	memcpy(ent->fts_statp, &node->st, sizeof(struct stat));
+	ent->fts_pointer = node;
+	ent->fts_dev = node->st.st_dev;
+	ent->fts_ino = node->st.st_ino;
+	ent->fts_nlink = node->st.st_nlink;
+	ent->fts_errno = 0;
+
+	switch (node->st.st_mode & S_IFMT) {
+	case S_IFDIR:
+		ent->fts_info = FTS_D;
+		for (i = 0; i < ofts->depth; ++i) {
+			if (ofts->stack[i].dir == node) {
+				ent->fts_info = FTS_DC;
+				ent->fts_cycle = ofts->stack[i].ent;
+				break;
+			}
+		}
+		break;
+	case S_IFLNK:
+		ent->fts_info = FTS_SL;
+		break;
+	case S_IFREG:
+		ent->fts_info = FTS_F;
+		break;
+	default:
+		ent->fts_info = FTS_DEFAULT;
+	}
+}
+
+/* (re)stat the entry by its path, following symlinks if requested */
+static void ocifs_ftsent_stat(OCIFS_FTS *ofts, FTSENT *ent, bool follow)
+{
+	struct ocifs_node *node;
+
+	node = ocifs_resolve(ofts->fs, ent->fts_path, follow);
+	if (node != NULL) {
+		ocifs_ftsent_set(ofts, ent, node);
+		return;
+	}
+	if (follow && (node = ocifs_resolve(ofts->fs, ent->fts_path, false)) != NULL) {
+		ocifs_ftsent_set(ofts, ent, node);
+		if (ent->fts_info == FTS_SL)
+			ent->fts_info = FTS_SLNONE;
+		return;
+	}
+	ent->fts_errno = errno;
+	ent->fts_info = FTS_NS;
+	ent->fts_pointer = NULL;
+	memset(ent->fts_statp, 0, sizeof(struct stat));
+}
+
+OCIFS_FTS *ocifs_fts_open(ocifs_t *fs, char * const *paths, int options)
+{
+	OCIFS_FTS *ofts;
+	size_t i;
+
+	ofts = oscap_calloc(1, sizeof(OCIFS_FTS));
+	ofts->fs = fs;
+	ofts->options = options;
+	for (i = 0; paths[i] != NULL; ++i) {
+		ofts->paths = oscap_realloc(ofts->paths, (i + 1) * sizeof(char *));
+		ofts->paths[i] = strdup(paths[i]);
+	}
+	ofts->paths_cnt = i;
+
+	return ofts;
+}
+
+FTSENT *ocifs_fts_read(OCIFS_FTS *ofts)
+{
+	FTSENT *ent = ofts->last;
+	struct ocifs_fts_frame *frame;
+
+	ofts->last = NULL;
+	if (ent != NULL) {
+		int instr = ent->fts_instr;
+
+		ent->fts_instr = FTS_NOINSTR;
+		if (instr == FTS_AGAIN) {
+			ocifs_ftsent_stat(ofts, ent, ent->fts_level == 0 && (ofts->options & FTS_COMFOLLOW));
+			return (ofts->last = ent);
+		}
+		if (instr == FTS_FOLLOW && (ent->fts_info == FTS_SL || ent->fts_info == FTS_SLNONE)) {
+			ocifs_ftsent_stat(ofts, ent, true);
+			return (ofts->last = ent);
+		}
+		if (ent->fts_info == FTS_D && instr != FTS_SKIP) {
+			if (ofts->depth == ofts->stack_max) {
+				ofts->stack_max = ofts->stack_max == 0 ? 16 : ofts->stack_max * 2;
+				ofts->stack = oscap_realloc(ofts->stack, ofts->stack_max * sizeof(struct ocifs_fts_frame));
+			}
+			frame = &ofts->stack[ofts->depth++];
+			frame->ent = ent;
+			frame->dir = ent->fts_pointer;
+			frame->pos = 0;
+		} else {
+			ocifs_ftsent_free(ent);
+		}
+	}
+
+	while (ofts->depth > 0) {
+		frame = &ofts->stack[ofts->depth - 1];
+		if (frame->pos < frame->dir->kids_cnt) {
+			struct ocifs_node *node = frame->dir->kids[frame->pos++];
+			const char *ppath = frame->ent->fts_path;
+			size_t plen = frame->ent->fts_pathlen;
+			char *path;
+
+			if (plen > 0 && ppath[plen - 1] == '/')
+				path = oscap_sprintf("%s%s", ppath, node->name);
+			else
+				path = oscap_sprintf("%s/%s", ppath, node->name);
+			ent = ocifs_ftsent_new(path, node->name, frame->ent->fts_level + 1);
+			oscap_free(path);
+			ocifs_ftsent_set(ofts, ent, node);
+
+			return (ofts->last = ent);
+		}
+		/* all children returned, post-order visit of the directory */
+		ent = frame->ent;
+		ent->fts_info = FTS_DP;
+		--ofts->depth;
+
+		return (ofts->last = ent);
+	}
+
+	if (ofts->paths_pos < ofts->paths_cnt) {
+		const char *path = ofts->paths[ofts->paths_pos++];
+		const char *name = strrchr(path, '/');
+
+		/* fts(3) names the root entry by its last component */
+		name = (name != NULL && name[1] != '\0') ? name + 1 : path;
+		ent = ocifs_ftsent_new(path, name, 0);
+		ocifs_ftsent_stat(ofts, ent, ofts->options & FTS_COMFOLLOW);
+
+		return (ofts->last = ent);
+	}
+
+	errno = 0;
+	return NULL;
+}
+
+int ocifs_fts_set(OCIFS_FTS *ofts, FTSENT *ent, int instr)
+{
+	(void) ofts;
+
+	if (instr != FTS_NOINSTR && instr != FTS_AGAIN
+	    && instr != FTS_FOLLOW && instr != FTS_SKIP) {
+		errno = EINVAL;
+		return 1;
+	}
+	ent->fts_instr = instr;
+
+	return 0;
+}
+
+int ocifs_fts_close(OCIFS_FTS *ofts)
+{
+	size_t i;
+
+	if (ofts->last != NULL)
+		ocifs_ftsent_free(ofts->last);
+	for (i = 0; i < ofts->depth; ++i)
+		ocifs_ftsent_free(ofts->stack[i].ent);
+	for (i = 0; i < ofts->paths_cnt; ++i)
+		oscap_free(ofts->paths[i]);
+	oscap_free(ofts->paths);
+	oscap_free(ofts->stack);
+	oscap_free(ofts);
+
+	return 0;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ * Read-only view of a container image given as a stack of OCI layer
+ * tarballs. Every layer is indexed in a single sequential pass, whiteout
+ * entries (".wh.<name>" and the opaque marker ".wh..wh..opq") are applied
+ * against the lower layers and file contents are read directly from the
+ * archives. Only uncompressed layers (the "layer.tar" files written by
+ * `docker save` or the OCI "tar" media type) are supported.
+ */
+#ifndef OCIFS_H
+#define OCIFS_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined(__SVR4) && defined(__sun)
+#include "fts_sun.h"
+#else
+#include <fts.h>
+#endif
+
+typedef struct ocifs ocifs_t;
+typedef struct ocifs_fts OCIFS_FTS;
+
+/**
+ * Index a stack of layer tarballs.
+ * @param layers colon separated list of paths, the lowest layer first
+ * @return new image view or NULL on error (errno is set)
+ */
+ocifs_t *ocifs_open(const char *layers);
+void ocifs_close(ocifs_t *fs);
+
+/**
+ * Image view used by the probe in place of the real filesystem. It is
+ * NULL unless the probe runs in the PROBE_OFFLINE_OCI mode.
+ */
+ocifs_t *ocifs_active(void);
+void ocifs_set_active(ocifs_t *fs);
+
+/*
+ * lstat(2), stat(2) and readlink(2) counterparts. Paths are absolute
+ * paths inside of the image, symlinks are resolved relative to the image.
+ */
+int ocifs_lstat(ocifs_t *fs, const char *path, struct stat *st);
+int ocifs_stat(ocifs_t *fs, const char *path, struct stat *st);
+ssize_t ocifs_readlink(ocifs_t *fs, const char *path, char *buf, size_t bufsiz);
+
+/**
+ * Read the whole content of a regular file (symlinks are followed).
+ * The returned buffer is NUL terminated, its length without the
+ * terminator is stored in `size'.
+ */
+char *ocifs_read_file(ocifs_t *fs, const char *path, size_t *size);
+
+/*
+ * fts(3) emulation with the subset of semantics used by oval_fts:
+ * FTS_PHYSICAL traversal, FTS_COMFOLLOW, and the FTS_SKIP, FTS_FOLLOW
+ * and FTS_AGAIN instructions set with ocifs_fts_set().
+ */
+OCIFS_FTS *ocifs_fts_open(ocifs_t *fs, char * const *paths, int options);
+FTSENT *ocifs_fts_read(OCIFS_FTS *ofts);
+int ocifs_fts_set(OCIFS_FTS *ofts, FTSENT *ent, int instr);
+int ocifs_fts_close(OCIFS_FTS *ofts);
+
+#endif /* OCIFS_H */
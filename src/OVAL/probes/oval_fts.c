@@ -53,6 +53,61 @@
 
 #undef OSCAP_FTS_DEBUG
 
+/*
+ * fts(3) wrappers which walk the indexed OCI image layers instead of
+ * the real filesystem if the probe runs in the PROBE_OFFLINE_OCI mode.
+ */
+static OVAL_FTS_WALK *__fts_open(char * const *paths, int options,
+				 int (*compar)(const FTSENT **, const FTSENT **))
+{
+	OVAL_FTS_WALK *walk;
+	ocifs_t *ocifs = ocifs_active();
+
+	walk = oscap_talloc(OVAL_FTS_WALK);
+	walk->fts = NULL;
+	walk->ocifs = NULL;
+
+	if (ocifs != NULL)
+		walk->ocifs = ocifs_fts_open(ocifs, paths, options);
+	else
+		walk->fts = fts_open(paths, options, compar);
+
+	if (walk->fts == NULL && walk->ocifs == NULL) {
+		oscap_free(walk);
+		return (NULL);
+	}
+
+	return (walk);
+}
+
+static FTSENT *__fts_read(OVAL_FTS_WALK *walk)
+{
+	if (walk->ocifs != NULL)
+		return ocifs_fts_read(walk->ocifs);
+	return fts_read(walk->fts);
+}
+
+static int __fts_set(OVAL_FTS_WALK *walk, FTSENT *ent, int instr)
+{
+	/* fts_set() only marks the entry, the walk may not be open yet */
+	if (walk != NULL && walk->ocifs != NULL)
+		return ocifs_fts_set(walk->ocifs, ent, instr);
+	return fts_set(walk != NULL ? walk->fts : NULL, ent, instr);
+}
+
+static int __fts_close(OVAL_FTS_WALK *walk)
+{
+	int ret;
+
+	if (walk->ocifs != NULL)
+		ret = ocifs_fts_close(walk->ocifs);
+	else
+		ret = fts_close(walk->fts);
+	oscap_free(walk);
+
+	return (ret);
+}
+
 static OVAL_FTS *OVAL_FTS_new()
 {
 	OVAL_FTS *ofts;
@@ -70,9 +125,9 @@ static OVAL_FTS *OVAL_FTS_new()
 static void OVAL_FTS_free(OVAL_FTS *ofts)
 {
 	if (ofts->ofts_match_path_fts != NULL)
-		fts_close(ofts->ofts_match_path_fts);
+		__fts_close(ofts->ofts_match_path_fts);
 	if (ofts->ofts_recurse_path_fts != NULL)
-		fts_close(ofts->ofts_recurse_path_fts);
+		__fts_close(ofts->ofts_recurse_path_fts);
 
 	oscap_free(ofts);
 	return;
@@ -794,6 +849,10 @@ OVAL_FTS *oval_fts_open(SEXP_t *path, SEXP_t *filename, SEXP_t *filepath, SEXP_t
 #endif
 	SEXP_free(r0);
 
+	/* There are no mount points in an OCI image, its whole tree is local. */
+	if (filesystem == OVAL_RECURSE_FS_LOCAL && ocifs_active() != NULL)
+		filesystem = OVAL_RECURSE_FS_ALL;
+
 	/* todo:
 	   Still missing is a propagation of the error to the
 	   user. Currently, all the information is provided in the
@@ -814,7 +873,8 @@ OVAL_FTS *oval_fts_open(SEXP_t *path, SEXP_t *filename, SEXP_t *filepath, SEXP_t
 
 	/* Fail if the provided path doensn't actually exist. Symlinks
 	   without targets are accepted. */
-	if (lstat(paths[0], &st) == -1) {
+	if ((ocifs_active() != NULL ? ocifs_lstat(ocifs_active(), paths[0], &st)
+				    : lstat(paths[0], &st)) == -1) {
 		if (errno) {
 			dE("lstat() failed: errno: %d, '%s'.\n",
 			   errno, strerror(errno));
@@ -828,7 +888,7 @@ OVAL_FTS *oval_fts_open(SEXP_t *path, SEXP_t *filename, SEXP_t *filepath, SEXP_t
 	ofts = OVAL_FTS_new();
 	/* reset errno as fts_open() doesn't do it itself. */
 	errno = 0;
-	ofts->ofts_match_path_fts = fts_open((char * const *) paths, mtc_fts_options, NULL);
+	ofts->ofts_match_path_fts = __fts_open((char * const *) paths, mtc_fts_options, NULL);
 	free((void *) paths[0]);
 	/* fts_open() doesn't return NULL for all errors (e.g. nonexistent paths),
 	   so check errno to detect it. Far from being perfect. */
@@ -857,7 +917,7 @@ OVAL_FTS *oval_fts_open(SEXP_t *path, SEXP_t *filename, SEXP_t *filepath, SEXP_t
 			/* One dummy read to get rid of an uninitialized
 			 * value in the FTS data before calling
 			 * fts_close() on it. */
-			fts_read(ofts->ofts_match_path_fts);
+			__fts_read(ofts->ofts_match_path_fts);
 			oval_fts_close(ofts);
 			return (NULL);
 		}
@@ -866,10 +926,10 @@ OVAL_FTS *oval_fts_open(SEXP_t *path, SEXP_t *filename, SEXP_t *filepath, SEXP_t
 		/* store the device id for future comparison */
 		FTSENT *fts_ent;
 
-		fts_ent = fts_read(ofts->ofts_match_path_fts);
+		fts_ent = __fts_read(ofts->ofts_match_path_fts);
 		if (fts_ent != NULL) {
 			ofts->ofts_recurse_path_devid = fts_ent->fts_statp->st_dev;
-			fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_AGAIN);
+			__fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_AGAIN);
 		}
 	}
 
@@ -923,7 +983,7 @@ static FTSENT *oval_fts_read_match_path(OVAL_FTS *ofts)
 
 	/* iterate until a match is found or all elements have been traversed */
 	for (;;) {
-		fts_ent = fts_read(ofts->ofts_match_path_fts);
+		fts_ent = __fts_read(ofts->ofts_match_path_fts);
 		if (fts_ent == NULL)
 			return NULL;
 		switch (fts_ent->fts_info) {
@@ -931,7 +991,7 @@ static FTSENT *oval_fts_read_match_path(OVAL_FTS *ofts)
 			continue;
 		case FTS_DC:
 			dW("Filesystem tree cycle detected at '%s'.\n", fts_ent->fts_path);
-			fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_SKIP);
+			__fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_SKIP);
 			continue;
 		}
 
@@ -946,19 +1006,19 @@ static FTSENT *oval_fts_read_match_path(OVAL_FTS *ofts)
 #if defined(OSCAP_FTS_DEBUG)
 			dI("Only the target of a symlink gets reported, skipping '%s'.\n", fts_ent->fts_path, fts_ent->fts_name);
 #endif
-			fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_FOLLOW);
+			__fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_FOLLOW);
 			continue;
 		}
 		if (_oval_fts_is_local(ofts, fts_ent)) {
 			dI("Don't recurse into non-local filesystems, skipping '%s'.\n", fts_ent->fts_path);
-			fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+			__fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
 			continue;
 		}
 		/* don't recurse beyond the initial filesystem */
 		if (ofts->filesystem == OVAL_RECURSE_FS_DEFINED
 		    && (fts_ent->fts_info == FTS_D || fts_ent->fts_info == FTS_SL)
 		    && ofts->ofts_recurse_path_devid != fts_ent->fts_statp->st_dev) {
-			fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+			__fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
 			continue;
 		}
 
@@ -973,7 +1033,7 @@ static FTSENT *oval_fts_read_match_path(OVAL_FTS *ofts)
 				switch (ret) {
 				case PCRE_ERROR_NOMATCH:
 					dI("Partial match optimization: PCRE_ERROR_NOMATCH, skipping.\n");
-					fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_SKIP);
+					__fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_SKIP);
 					continue;
 				case PCRE_ERROR_PARTIAL:
 					dI("Partial match optimization: PCRE_ERROR_PARTIAL, continuing.\n");
@@ -1012,7 +1072,7 @@ static FTSENT *oval_fts_read_match_path(OVAL_FTS *ofts)
 	    ofts->ofts_sfilename == NULL &&
 	    ofts->ofts_sfilepath == NULL)
 	{
-		fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_SKIP);
+		__fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_SKIP);
 	}
 
 	return fts_ent;
@@ -1047,7 +1107,7 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 #endif
 			/* reset errno as fts_open() doesn't do it itself. */
 			errno = 0;
-			ofts->ofts_recurse_path_fts = fts_open(paths,
+			ofts->ofts_recurse_path_fts = __fts_open(paths,
 				ofts->ofts_recurse_path_fts_opts, NULL);
 			/* fts_open() doesn't return NULL for all errors
 			   (e.g. nonexistent paths), so check errno to detect it.
@@ -1060,7 +1120,7 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 					paths[0], ofts->ofts_recurse_path_fts_opts);
 #endif
 				if (ofts->ofts_recurse_path_fts != NULL) {
-					fts_close(ofts->ofts_recurse_path_fts);
+					__fts_close(ofts->ofts_recurse_path_fts);
 					ofts->ofts_recurse_path_fts = NULL;
 				}
 				return (NULL);
@@ -1071,9 +1131,9 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 		while (out_fts_ent == NULL) {
 			FTSENT *fts_ent;
 
-			fts_ent = fts_read(ofts->ofts_recurse_path_fts);
+			fts_ent = __fts_read(ofts->ofts_recurse_path_fts);
 			if (fts_ent == NULL) {
-				fts_close(ofts->ofts_recurse_path_fts);
+				__fts_close(ofts->ofts_recurse_path_fts);
 				ofts->ofts_recurse_path_fts = NULL;
 
 				return NULL;
@@ -1084,7 +1144,7 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 				continue;
 			case FTS_DC:
 				dW("Filesystem tree cycle detected at '%s'.\n", fts_ent->fts_path);
-				fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+				__fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
 				continue;
 			}
 
@@ -1115,7 +1175,7 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 				/* limit recursion depth */
 				if (ofts->direction == OVAL_RECURSE_DIRECTION_NONE
 				    || (ofts->max_depth != -1 && fts_ent->fts_level > ofts->max_depth)) {
-					fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+					__fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
 					continue;
 				}
 
@@ -1123,30 +1183,30 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 				switch (fts_ent->fts_info) {
 				case FTS_D:
 					if (!(ofts->recurse & OVAL_RECURSE_DIRS)) {
-						fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+						__fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
 						continue;
 					}
 					break;
 				case FTS_SL:
 					if (!(ofts->recurse & OVAL_RECURSE_SYMLINKS)) {
-						fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+						__fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
 						continue;
 					}
-					fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_FOLLOW);
+					__fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_FOLLOW);
 					break;
 				default:
 					continue;
 				}
 			}
 			if (_oval_fts_is_local(ofts, fts_ent)) {
-				fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+				__fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
 				continue;
 			}
 			/* don't recurse beyond the initial filesystem */
 			if (ofts->filesystem == OVAL_RECURSE_FS_DEFINED
 			    && (fts_ent->fts_info == FTS_D || fts_ent->fts_info == FTS_SL)
 			    && ofts->ofts_recurse_path_devid != fts_ent->fts_statp->st_dev) {
-				fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+				__fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
 				continue;
 			}
 		}
@@ -1173,7 +1233,7 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 				/* fts_open() doesn't return NULL for all errors
 				   (e.g. nonexistent paths), so check errno to
 				   detect it. Far from being perfect. */
-				ofts->ofts_recurse_path_fts = fts_open(paths,
+				ofts->ofts_recurse_path_fts = __fts_open(paths,
 					ofts->ofts_recurse_path_fts_opts, NULL);
 				if (ofts->ofts_recurse_path_fts == NULL || errno != 0) {
 					dE("fts_open() failed, errno: %d \"%s\".\n",
@@ -1183,7 +1243,7 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 						paths[0], ofts->ofts_recurse_path_fts_opts);
 #endif
 					if (ofts->ofts_recurse_path_fts != NULL) {
-						fts_close(ofts->ofts_recurse_path_fts);
+						__fts_close(ofts->ofts_recurse_path_fts);
 						ofts->ofts_recurse_path_fts = NULL;
 					}
 					return (NULL);
@@ -1194,7 +1254,7 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 			while (out_fts_ent == NULL) {
 				FTSENT *fts_ent;
 
-				fts_ent = fts_read(ofts->ofts_recurse_path_fts);
+				fts_ent = __fts_read(ofts->ofts_recurse_path_fts);
 				if (fts_ent == NULL)
 					break;
 
@@ -1228,7 +1288,7 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 					/* only fts root is collected */
 					if (fts_ent->fts_level == 0 && fts_ent->fts_info == FTS_D) {
 						out_fts_ent = fts_ent;
-						fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+						__fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
 						break;
 					}
 				} else {
@@ -1243,16 +1303,16 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 				}
 
 				if (fts_ent->fts_info == FTS_SL)
-					fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_FOLLOW);
+					__fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_FOLLOW);
 				/* limit recursion only to fts root */
 				else if (fts_ent->fts_level > 0)
-					fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+					__fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
 			}
 
 			if (out_fts_ent != NULL)
 				break;
 
-			fts_close(ofts->ofts_recurse_path_fts);
+			__fts_close(ofts->ofts_recurse_path_fts);
 			ofts->ofts_recurse_path_fts = NULL;
 
 			if (!strcmp(ofts->ofts_recurse_path_curpth, "/"))
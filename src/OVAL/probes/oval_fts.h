@@ -30,6 +30,7 @@
 #endif
 #include <pcre.h>
 #include "fsdev.h"
+#include "ocifs.h"
 
 #define ENT_GET_AREF(ent, dst, attr_name, mandatory)			\
 	do {								\
@@ -64,12 +65,18 @@
 		}						\
 	} while (0)
 
+/* fts(3) handle, or its emulation when scanning OCI image layers */
+typedef struct {
+	FTS *fts;
+	OCIFS_FTS *ocifs;
+} OVAL_FTS_WALK;
+
 typedef struct {
 	/* oval_fts_read_match_path() state */
-	FTS *ofts_match_path_fts;
+	OVAL_FTS_WALK *ofts_match_path_fts;
 	FTSENT *ofts_match_path_fts_ent;
 	/* oval_fts_read_recurse_path() state */
-	FTS *ofts_recurse_path_fts;
+	OVAL_FTS_WALK *ofts_recurse_path_fts;
 	int ofts_recurse_path_fts_opts;
 	int ofts_recurse_path_curdepth;
 	char *ofts_recurse_path_pthcpy;
@@ -217,6 +217,9 @@ static void *probe_icache_worker(void *arg)
                                         dI("cache HIT #2 -> real HIT\n");
                                         SEXP_free(pair->p.item);
                                         pair->p.item = cached->item[i];
+
+                                        if (pair->hits != NULL)
+                                                ++(*pair->hits);
                                 }
                         } else {
                                 /*
@@ -308,12 +311,13 @@ fail:
         return (NULL);
 }
 
-static int __probe_icache_add_nolock(probe_icache_t *cache, SEXP_t *cobj, SEXP_t *item, pthread_cond_t *cond)
+static int __probe_icache_add_nolock(probe_icache_t *cache, SEXP_t *cobj, SEXP_t *item, pthread_cond_t *cond, uint32_t *hits)
 {
         assume_d((cond == NULL) ^ (item == NULL), -1);
 retry:
         if (cache->queue_cnt < cache->queue_max) {
                 cache->queue[cache->queue_end].cobj = cobj;
+                cache->queue[cache->queue_end].hits = hits;
 
                 if (item != NULL) {
 			assume_d(cobj != NULL, -1);
@@ -344,7 +348,7 @@ retry:
         return (0);
 }
 
-int probe_icache_add(probe_icache_t *cache, SEXP_t *cobj, SEXP_t *item)
+int probe_icache_add(probe_icache_t *cache, SEXP_t *cobj, SEXP_t *item, uint32_t *hits)
 {
         int ret;
 
@@ -357,7 +361,7 @@ int probe_icache_add(probe_icache_t *cache, SEXP_t *cobj, SEXP_t *item)
                 return (-1);
         }
 
-        ret = __probe_icache_add_nolock(cache, cobj, item, NULL);
+        ret = __probe_icache_add_nolock(cache, cobj, item, NULL, hits);
 
         if (pthread_mutex_unlock(&cache->queue_mutex) != 0) {
                 dE("An error ocured while unlocking the queue mutex: %u, %s\n",
@@ -395,7 +399,7 @@ int probe_icache_nop(probe_icache_t *cache)
                 return (-1);
         }
 
-        if (__probe_icache_add_nolock(cache, NULL, NULL, &cond) != 0) {
+        if (__probe_icache_add_nolock(cache, NULL, NULL, &cond, NULL) != 0) {
                 if (pthread_mutex_unlock(&cache->queue_mutex) != 0) {
                         dE("An error ocured while unlocking the queue mutex: %u, %s\n",
                            errno, strerror(errno));
@@ -538,7 +542,7 @@ int probe_item_collect(struct probe_ctx *ctx, SEXP_t *item)
 		return (1);
         }
 
-        if (probe_icache_add(ctx->icache, ctx->probe_out, item) != 0) {
+        if (probe_icache_add(ctx->icache, ctx->probe_out, item, ctx->icache_hits) != 0) {
                 dE("Can't add item (%p) to the item cache (%p)\n", item, ctx->icache);
                 SEXP_free(item);
                 return (-1);
@@ -36,6 +36,7 @@ typedef struct {
                 SEXP_t         *item;
                 pthread_cond_t *cond;
         } p;
+        uint32_t *hits; /* counter of cache hits, may be NULL */
 } probe_iqpair_t;
 
 typedef struct {
@@ -59,7 +60,7 @@ typedef struct {
 } probe_citem_t;
 
 probe_icache_t *probe_icache_new(void);
-int probe_icache_add(probe_icache_t *cache, SEXP_t *cobj, SEXP_t *item);
+int probe_icache_add(probe_icache_t *cache, SEXP_t *cobj, SEXP_t *item, uint32_t *hits);
 int probe_icache_nop(probe_icache_t *cache);
 void probe_icache_free(probe_icache_t *cache);
 
@@ -51,6 +51,7 @@ void *probe_input_handler(void *arg)
         int probe_ret, cstate; /* XXX */
         SEAP_msg_t *seap_request, *seap_reply;
         SEXP_t *probe_in, *probe_out, *oid;
+        bool rcache_hit;
 
 #define TH_CANCEL_ON  pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &cstate)
 #define TH_CANCEL_OFF pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cstate)
@@ -93,6 +94,7 @@ void *probe_input_handler(void *arg)
                 TH_CANCEL_OFF;
 
 		probe_in = SEAP_msg_get(seap_request);
+		rcache_hit = false;
 
 		if (probe_in == NULL)
 			abort();
@@ -205,6 +207,7 @@ void *probe_input_handler(void *arg)
 					SEXP_free(oid);
 					SEXP_free(probe_in);
 					probe_ret = 0;
+					rcache_hit = true;
 				}
 			}
 		} else {
@@ -233,6 +236,9 @@ void *probe_input_handler(void *arg)
 			SEAP_msg_set(seap_reply, probe_out);
                         SEXP_free(probe_out);
 
+			if (rcache_hit && SEAP_msgattr_exists(seap_request, PROBE_MSGATTR_STATS))
+				SEAP_msgattr_set(seap_reply, PROBE_MSGATTR_RCACHE_HIT, NULL);
+
 			if (SEAP_reply(probe->SEAP_ctx, probe->sd, seap_reply, seap_request) == -1) {
 				dE("An error ocured while sending SEAP message. errno=%u, %s.\n",
 				   errno, strerror(errno));
@@ -34,6 +34,7 @@
 #include <libgen.h>
 #include <seap.h>
 #include "common/bfind.h"
+#include "OVAL/probes/ocifs.h"
 #include "probe.h"
 #include "ncache.h"
 #include "rcache.h"
@@ -67,7 +68,7 @@ static int probe_optecmp(char **a, char **b)
 	return strcmp(*a, *b);
 }
 
-static SEXP_t *probe_reset(SEXP_t *arg0, void *arg1)
+static SEXP_t *probe_reset_cmd(SEXP_t *arg0, void *arg1)
 {
         probe_t *probe = (probe_t *)arg1;
         /*
@@ -79,9 +80,39 @@ static SEXP_t *probe_reset(SEXP_t *arg0, void *arg1)
         probe->rcache = probe_rcache_new();
         probe->ncache = probe_ncache_new();
 
+        probe_reset(probe->probe_arg);
+
         return(NULL);
 }
 
+static SEXP_t *probe_invalidate(SEXP_t *arg0, void *arg1)
+{
+        probe_t *probe = (probe_t *)arg1;
+        SEXP_t  *id;
+        uint32_t count = 0;
+
+        if (arg0 == NULL)
+                return(NULL);
+        /*
+         * Drop the cached results of objects and states which depend
+         * on a variable whose value has changed.
+         */
+        SEXP_list_foreach(id, arg0) {
+                probe_rcache_sexp_del(probe->rcache, id);
+                ++count;
+        }
+
+        /* the library needs a reply to tell success from a lost command */
+        return SEXP_number_newu_32(count);
+}
+
+static SEXP_t *probe_rcache_stats_cmd(SEXP_t *arg0, void *arg1)
+{
+        probe_t *probe = (probe_t *)arg1;
+
+        return probe_rcache_stats_sexp(probe->rcache);
+}
+
 static int probe_opthandler_varref(int option, int op, va_list args)
 {
 	bool  o_switch;
@@ -166,6 +197,7 @@ int main(int argc, char *argv[])
 	sigset_t       sigmask;
 	probe_t        probe;
 	char *rootdir = NULL;
+	char *oci_layers = NULL;
 
 	if ((errno = pthread_barrier_init(&OSCAP_GSYM(th_barrier), NULL,
 	                                  1 + // signal thread
@@ -206,7 +238,11 @@ int main(int argc, char *argv[])
 	if (probe.sd < 0)
 		fail(errno, "SEAP_openfd2", __LINE__ - 3);
 
-	if (SEAP_cmd_register(probe.SEAP_ctx, PROBECMD_RESET, 0, &probe_reset) != 0)
+	if (SEAP_cmd_register(probe.SEAP_ctx, PROBECMD_RESET, SEAP_CMDREG_USEARG, &probe_reset_cmd, &probe) != 0)
+		fail(errno, "SEAP_cmd_register", __LINE__ - 1);
+	if (SEAP_cmd_register(probe.SEAP_ctx, PROBECMD_OBJ_INVALIDATE, SEAP_CMDREG_USEARG, &probe_invalidate, &probe) != 0)
+		fail(errno, "SEAP_cmd_register", __LINE__ - 1);
+	if (SEAP_cmd_register(probe.SEAP_ctx, PROBECMD_RCACHE_STATS, SEAP_CMDREG_USEARG, &probe_rcache_stats_cmd, &probe) != 0)
 		fail(errno, "SEAP_cmd_register", __LINE__ - 1);
 
 	/*
@@ -252,6 +288,21 @@ int main(int argc, char *argv[])
 	/*
 	 * Setup offline mode(s)
 	 */
+	if ((oci_layers = getenv("OSCAP_PROBE_OCI_LAYERS")) != NULL) {
+		if (strlen(oci_layers) > 0) {
+			ocifs_t *ocifs;
+
+			/* Index the image layers before a possible chroot
+			 * below, the layer paths are given relative to the
+			 * environment oscap runs in.
+			 */
+			if ((ocifs = ocifs_open(oci_layers)) == NULL) {
+				fail(errno, "ocifs_open", __LINE__ - 1);
+			}
+			ocifs_set_active(ocifs);
+			OSCAP_GSYM(offline_mode) |= PROBE_OFFLINE_OCI;
+		}
+	}
 	if ((rootdir = getenv("OSCAP_PROBE_ROOT")) != NULL) {
 		if(strlen(rootdir) > 0) {
 			if (chdir(rootdir) != 0) {
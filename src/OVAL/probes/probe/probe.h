@@ -69,12 +69,14 @@ struct probe_ctx {
         SEXP_t         *probe_out; /**< collected object */
         SEXP_t         *filters;   /**< object filters (OVAL 5.8 and higher) */
         probe_icache_t *icache;    /**< item cache */
+        uint32_t       *icache_hits; /**< number of collected items found in the item cache */
 };
 
 typedef enum {
 	PROBE_OFFLINE_NONE = 0x00,
 	PROBE_OFFLINE_CHROOT = 0x01,
 	PROBE_OFFLINE_RPMDB = 0x02,
+	PROBE_OFFLINE_OCI = 0x04,
 	PROBE_OFFLINE_ALL = 0x0f
 } probe_offline_flags;
 
@@ -25,55 +25,178 @@
 #endif
 
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sexp.h>
 
 #include "common/alloc.h"
 #include "common/assume.h"
+#include "common/debug_priv.h"
 #include "../SEAP/generic/rbt/rbt.h"
 
 #include "rcache.h"
 
+static size_t probe_rcache_limit(void)
+{
+        const char *env;
+        char *end;
+        unsigned long long limit;
+
+        env = getenv(PROBE_RCACHE_LIMIT_ENV);
+
+        if (env == NULL)
+                return (PROBE_RCACHE_LIMIT_DEFAULT);
+
+        limit = strtoull(env, &end, 10);
+
+        if (*env == '\0' || *end != '\0') {
+                dW("Invalid value of %s: \"%s\", using the default limit.\n", PROBE_RCACHE_LIMIT_ENV, env);
+                return (PROBE_RCACHE_LIMIT_DEFAULT);
+        }
+
+        return ((size_t)limit);
+}
+
 probe_rcache_t *probe_rcache_new(void)
 {
 	probe_rcache_t *cache;
 
 	cache = oscap_talloc(probe_rcache_t);
 	cache->tree = rbt_str_new();
+        pthread_mutex_init(&cache->lock, NULL);
+        cache->lru_head  = NULL;
+        cache->lru_tail  = NULL;
+        cache->holds     = NULL;
+        cache->size      = 0;
+        cache->limit     = probe_rcache_limit();
+        cache->hits      = 0;
+        cache->misses    = 0;
+        cache->evictions = 0;
 
 	return (cache);
 }
 
+static void probe_rcache_entry_free(probe_rcache_entry_t *e)
+{
+        oscap_free(e->key);
+        SEXP_free(e->item);
+        oscap_free(e);
+}
+
 static void probe_rcache_free_node(struct rbt_str_node *n)
 {
-        oscap_free(n->key);
-        SEXP_free(n->data);
+        probe_rcache_entry_free(n->data);
 }
 
 void probe_rcache_free(probe_rcache_t *cache)
 {
+        while (cache->holds != NULL)
+                SEXP_free(probe_rcache_release(cache, cache->holds));
+
         rbt_str_free_cb(cache->tree, &probe_rcache_free_node);
+        pthread_mutex_destroy(&cache->lock);
 	oscap_free(cache);
 	return;
 }
 
+/*
+ * LRU list manipulation, the cache has to be locked.
+ */
+static void probe_rcache_lru_unlink(probe_rcache_t *cache, probe_rcache_entry_t *e)
+{
+        if (e->prev != NULL)
+                e->prev->next = e->next;
+        else
+                cache->lru_head = e->next;
+
+        if (e->next != NULL)
+                e->next->prev = e->prev;
+        else
+                cache->lru_tail = e->prev;
+
+        e->prev = e->next = NULL;
+}
+
+static void probe_rcache_lru_push(probe_rcache_t *cache, probe_rcache_entry_t *e)
+{
+        e->prev = NULL;
+        e->next = cache->lru_head;
+
+        if (cache->lru_head != NULL)
+                cache->lru_head->prev = e;
+        else
+                cache->lru_tail = e;
+
+        cache->lru_head = e;
+}
+
+/*
+ * Drop the least recently used entries until the cache fits into its
+ * limit. The most recently used entry is kept even if it doesn't fit.
+ */
+static void probe_rcache_evict(probe_rcache_t *cache)
+{
+        probe_rcache_entry_t *e;
+        void *data;
+
+        while (cache->limit != 0 && cache->size > cache->limit &&
+               cache->lru_tail != cache->lru_head)
+        {
+                e = cache->lru_tail;
+                probe_rcache_lru_unlink(cache, e);
+
+                if (rbt_str_del(cache->tree, e->key, &data) != 0) {
+                        dE("Can't remove \"%s\" from the result cache\n", e->key);
+                        abort();
+                }
+
+                cache->size -= e->size;
+                ++cache->evictions;
+                probe_rcache_entry_free(e);
+        }
+}
+
 int probe_rcache_sexp_add(probe_rcache_t *cache, const SEXP_t *id, SEXP_t *item)
 {
-        SEXP_t *r;
-        char   *k;
+        probe_rcache_entry_t *e;
+        probe_rcache_hold_t  *h;
 
 	assume_d(cache != NULL, -1);
 	assume_d(id    != NULL, -1);
 	assume_d(item  != NULL, -1);
 
-        k = SEXP_string_cstr(id);
-        r = SEXP_ref(item);
+        e = oscap_talloc(probe_rcache_entry_t);
+        e->key  = SEXP_string_cstr(id);
+        e->item = SEXP_ref(item);
+        e->size = SEXP_sizeof(item) + strlen(e->key) + 1 + sizeof(probe_rcache_entry_t);
+        e->prev = e->next = NULL;
 
-        if (rbt_str_add(cache->tree, k, (void *)r) != 0) {
-                SEXP_free(r);
-                oscap_free(k);
-                return (-1);
+        pthread_mutex_lock(&cache->lock);
+
+        for (h = cache->holds; h != NULL; h = h->next) {
+                if (h->item == NULL && strcmp(h->key, e->key) == 0)
+                        h->item = SEXP_ref(item);
+        }
+
+        if (rbt_str_add(cache->tree, e->key, (void *)e) != 0) {
+                probe_rcache_entry_t *c = NULL;
+                int r = -1;
+
+                /* collected twice for different requesters, keep the first result */
+                if (rbt_str_get(cache->tree, e->key, (void *)&c) == 0 && c != NULL)
+                        r = 0;
+
+                pthread_mutex_unlock(&cache->lock);
+                probe_rcache_entry_free(e);
+                return (r);
         }
 
+        probe_rcache_lru_push(cache, e);
+        cache->size += e->size;
+        probe_rcache_evict(cache);
+
+        pthread_mutex_unlock(&cache->lock);
+
 	return (0);
 }
 
@@ -84,18 +207,47 @@ int probe_rcache_cstr_add(probe_rcache_t *cache, const char *id, SEXP_t * item)
 
 int probe_rcache_sexp_del(probe_rcache_t *cache, const SEXP_t * id)
 {
-	return (-1);
+        char b[128], *k = b;
+        int  r;
+
+        if (SEXP_string_cstr_r(id, k, sizeof b) == ((size_t)-1))
+                k = SEXP_string_cstr(id);
+
+        if (k == NULL)
+                return(-1);
+
+        r = probe_rcache_cstr_del(cache, k);
+
+        if (k != b)
+                oscap_free(k);
+
+        return (r);
 }
 
 int probe_rcache_cstr_del(probe_rcache_t *cache, const char *id)
 {
-	return (-1);
+        probe_rcache_entry_t *e = NULL;
+
+        pthread_mutex_lock(&cache->lock);
+
+        if (rbt_str_del(cache->tree, id, (void *)&e) != 0) {
+                pthread_mutex_unlock(&cache->lock);
+                return (1);
+        }
+
+        probe_rcache_lru_unlink(cache, e);
+        cache->size -= e->size;
+
+        pthread_mutex_unlock(&cache->lock);
+        probe_rcache_entry_free(e);
+
+        return (0);
 }
 
 SEXP_t *probe_rcache_sexp_get(probe_rcache_t *cache, const SEXP_t * id)
 {
         char    b[128], *k = b;
-        SEXP_t *r = NULL;
+        SEXP_t *r;
 
         if (SEXP_string_cstr_r(id, k, sizeof b) == ((size_t)-1))
                 k = SEXP_string_cstr(id);
@@ -103,19 +255,107 @@ SEXP_t *probe_rcache_sexp_get(probe_rcache_t *cache, const SEXP_t * id)
         if (k == NULL)
                 return(NULL);
 
-        rbt_str_get(cache->tree, k, (void *)&r);
+        r = probe_rcache_cstr_get(cache, k);
 
         if (k != b)
                 oscap_free(k);
 
-        return (r != NULL ? SEXP_ref(r) : NULL);
+        return (r);
 }
 
 SEXP_t *probe_rcache_cstr_get(probe_rcache_t *cache, const char *k)
 {
+        probe_rcache_entry_t *e = NULL;
         SEXP_t *r = NULL;
 
-        rbt_str_get(cache->tree, k, (void *)&r);
+        pthread_mutex_lock(&cache->lock);
+
+        if (rbt_str_get(cache->tree, k, (void *)&e) == 0 && e != NULL) {
+                probe_rcache_lru_unlink(cache, e);
+                probe_rcache_lru_push(cache, e);
+                r = SEXP_ref(e->item);
+                ++cache->hits;
+        } else
+                ++cache->misses;
+
+        pthread_mutex_unlock(&cache->lock);
+
+        return (r);
+}
+
+probe_rcache_hold_t *probe_rcache_sexp_hold(probe_rcache_t *cache, const SEXP_t *id)
+{
+        probe_rcache_hold_t  *h;
+        probe_rcache_entry_t *e = NULL;
+
+        h = oscap_talloc(probe_rcache_hold_t);
+        h->key  = SEXP_string_cstr(id);
+        h->item = NULL;
+
+        pthread_mutex_lock(&cache->lock);
+
+        if (rbt_str_get(cache->tree, h->key, (void *)&e) == 0 && e != NULL)
+                h->item = SEXP_ref(e->item);
+
+        h->next = cache->holds;
+        cache->holds = h;
+
+        pthread_mutex_unlock(&cache->lock);
+
+        return (h);
+}
+
+SEXP_t *probe_rcache_release(probe_rcache_t *cache, probe_rcache_hold_t *hold)
+{
+        probe_rcache_hold_t **link;
+        SEXP_t *r;
+
+        pthread_mutex_lock(&cache->lock);
+
+        for (link = &cache->holds; *link != hold; link = &(*link)->next)
+                ;
+        *link = hold->next;
+
+        pthread_mutex_unlock(&cache->lock);
+
+        r = hold->item;
+        oscap_free(hold->key);
+        oscap_free(hold);
+
+        return (r);
+}
+
+void probe_rcache_stats(probe_rcache_t *cache, probe_rcache_stats_t *stats)
+{
+        pthread_mutex_lock(&cache->lock);
+        stats->hits      = cache->hits;
+        stats->misses    = cache->misses;
+        stats->evictions = cache->evictions;
+        stats->entries   = rbt_str_size(cache->tree);
+        stats->bytes     = cache->size;
+        stats->limit     = cache->limit;
+        pthread_mutex_unlock(&cache->lock);
+}
+
+SEXP_t *probe_rcache_stats_sexp(probe_rcache_t *cache)
+{
+        probe_rcache_stats_t st;
+        SEXP_t *r, *n[6];
+        int i;
+
+        probe_rcache_stats(cache, &st);
+
+        n[0] = SEXP_number_newu_64(st.hits);
+        n[1] = SEXP_number_newu_64(st.misses);
+        n[2] = SEXP_number_newu_64(st.evictions);
+        n[3] = SEXP_number_newu_64(st.entries);
+        n[4] = SEXP_number_newu_64(st.bytes);
+        n[5] = SEXP_number_newu_64(st.limit);
+
+        r = SEXP_list_new(n[0], n[1], n[2], n[3], n[4], n[5], NULL);
+
+        for (i = 0; i < 6; ++i)
+                SEXP_free(n[i]);
 
-        return (r != NULL ? SEXP_ref(r) : NULL);
+        return (r);
 }
@@ -23,18 +23,73 @@
 #define RCACHE_H
 
 #include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
 #include <sexp.h>
 #include "../SEAP/generic/rbt/rbt.h"
 
+/**
+ * Environment variable with the maximal number of bytes used by the
+ * S-exps stored in the cache. 0 means no limit.
+ */
+#define PROBE_RCACHE_LIMIT_ENV "OSCAP_PROBE_RCACHE_LIMIT"
+#define PROBE_RCACHE_LIMIT_DEFAULT (64 * 1024 * 1024)
+
+/**
+ * Probe cache entry. The entries are linked in the order of their last
+ * use, the least recently used entry is evicted first when the size of
+ * the cache exceeds its limit.
+ */
+typedef struct probe_rcache_entry {
+        char   *key;  /**< id of the cached S-exp, shared with the tree */
+        SEXP_t *item; /**< cached S-exp */
+        size_t  size; /**< size of the S-exp in bytes */
+        struct probe_rcache_entry *prev; /**< more recently used entry */
+        struct probe_rcache_entry *next; /**< less recently used entry */
+} probe_rcache_entry_t;
+
+/**
+ * Hold on an id. The first S-exp added to the cache under the id (or the
+ * one cached when the hold was taken) is kept here, so that it can't be
+ * lost to an eviction before its holder gets it.
+ */
+typedef struct probe_rcache_hold {
+        char   *key;  /**< id of the held S-exp */
+        SEXP_t *item; /**< reference to the held S-exp, NULL until added */
+        struct probe_rcache_hold *next;
+} probe_rcache_hold_t;
+
+/**
+ * Probe cache statistics.
+ */
+typedef struct {
+        uint64_t hits;      /**< successful lookups */
+        uint64_t misses;    /**< lookups of ids that weren't cached */
+        uint64_t evictions; /**< entries dropped because of the size limit */
+        uint64_t entries;   /**< number of cached S-exps */
+        uint64_t bytes;     /**< size of the cached S-exps */
+        uint64_t limit;     /**< size limit, 0 if there is none */
+} probe_rcache_stats_t;
+
 /**
  * Probe cache structure.
  */
 typedef struct {
         rbt_t *tree; /**< red-black tree used to store the items */
+        pthread_mutex_t lock; /**< protects the LRU list and the counters */
+        probe_rcache_entry_t *lru_head; /**< most recently used entry */
+        probe_rcache_entry_t *lru_tail; /**< least recently used entry */
+        probe_rcache_hold_t  *holds;    /**< pending holds */
+        size_t size;  /**< sum of the sizes of the cached S-exps */
+        size_t limit; /**< maximal size, 0 means no limit */
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
 } probe_rcache_t;
 
 /**
- * Create a new probe cache.
+ * Create a new probe cache. The size limit is taken from the
+ * OSCAP_PROBE_RCACHE_LIMIT environment variable.
  * @return probe cache pointer or NULL on failure
  */
 probe_rcache_t *probe_rcache_new(void);
@@ -47,7 +102,10 @@ probe_rcache_t *probe_rcache_new(void);
 void probe_rcache_free(probe_rcache_t *cache);
 
 /**
- * Add a new S-exp to the cache identified by an S-exp string.
+ * Add a new S-exp to the cache identified by an S-exp string. If the
+ * size of the cache exceeds its limit, the least recently used S-exps
+ * are dropped. The S-exp is handed to the holds on its id first. If an
+ * S-exp with the same id is cached already, that one is kept.
  * @param cache probe cache
  * @param id S-exp string object containing the id
  * @param item the S-exp (item) to be stored in the cache
@@ -70,8 +128,8 @@ int probe_rcache_cstr_add(probe_rcache_t *cache, const char *id, SEXP_t *item);
  * Delete an S-exp from the cache identified by an S-exp string.
  * @param cache probe cache
  * @param id S-exp string object containing the id
- * @param item the S-exp (item) to be stored in the cache
  * @retval 0 on success
+ * @retval 1 if there is no such S-exp in the cache
  * @retval -1 on failure
  */
 int probe_rcache_sexp_del(probe_rcache_t *cache, const SEXP_t *id);
@@ -81,8 +139,8 @@ int probe_rcache_sexp_del(probe_rcache_t *cache, const SEXP_t *id);
  * Delete an S-exp from the cache identified by a C string.
  * @param cache probe cache
  * @param id C string containing the id
- * @param item the S-exp (item) to be stored in the cache
  * @retval 0 on success
+ * @retval 1 if there is no such S-exp in the cache
  * @retval -1 on failure
  */
 int probe_rcache_cstr_del(probe_rcache_t *cache, const char *id);
@@ -105,4 +163,36 @@ SEXP_t *probe_rcache_sexp_get(probe_rcache_t *cache, const SEXP_t *id);
  */
 SEXP_t *probe_rcache_cstr_get(probe_rcache_t *cache, const char *id);
 
+/**
+ * Hold on the S-exp identified by an S-exp string, whether it is cached
+ * already or will be added later.
+ * @param cache probe cache
+ * @param id S-exp string object containing the id
+ * @return the hold, to be released with probe_rcache_release
+ */
+probe_rcache_hold_t *probe_rcache_sexp_hold(probe_rcache_t *cache, const SEXP_t *id);
+
+/**
+ * Release a hold.
+ * @param cache probe cache
+ * @param hold the hold to be released
+ * @return reference to the held S-exp or NULL if none was added
+ */
+SEXP_t *probe_rcache_release(probe_rcache_t *cache, probe_rcache_hold_t *hold);
+
+/**
+ * Get the statistics of the cache.
+ * @param cache probe cache
+ * @param stats where to store the statistics
+ */
+void probe_rcache_stats(probe_rcache_t *cache, probe_rcache_stats_t *stats);
+
+/**
+ * Get the statistics of the cache as an S-exp list of numbers in the
+ * order of the probe_rcache_stats_t members. Reply to the
+ * PROBECMD_RCACHE_STATS command.
+ * @param cache probe cache
+ */
+SEXP_t *probe_rcache_stats_sexp(probe_rcache_t *cache);
+
 #endif /* PROBE_RCACHE_H */
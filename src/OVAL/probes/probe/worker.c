@@ -29,6 +29,7 @@
 #include <string.h>
 #include <pthread.h>
 #include <errno.h>
+#include <time.h>
 
 #include "probe-api.h"
 #include "common/debug_priv.h"
@@ -46,12 +47,22 @@ void *probe_worker_runfn(void *arg)
 
 	SEXP_t *probe_res, *obj, *oid;
 	int     probe_ret;
+	bool    stats;
+	struct timespec cpu_beg, cpu_end;
 
 	dI("handling SEAP message ID %u\n", pair->pth->sid);
+
+	stats = SEAP_msgattr_exists(pair->pth->msg, PROBE_MSGATTR_STATS);
+
+	if (stats)
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_beg);
 	//
 	probe_ret = -1;
-	probe_res = pair->pth->msg_handler(pair->probe, pair->pth->msg, &probe_ret);
+	probe_res = pair->pth->msg_handler(pair->probe, pair->pth, &probe_ret);
 	//
+	if (stats)
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_end);
+
 	dI("handler result = %p, return code = %d\n", probe_res, probe_ret);
 
 	/* Assuming that the red-black tree API is doing locking for us... */
@@ -113,6 +124,19 @@ void *probe_worker_runfn(void *arg)
 		seap_reply = SEAP_msg_new();
 		SEAP_msg_set(seap_reply, probe_res);
 
+		if (stats) {
+			SEXP_t *r0;
+			uint64_t cpu_us;
+
+			cpu_us = (uint64_t)(cpu_end.tv_sec - cpu_beg.tv_sec) * 1000000
+				+ (cpu_end.tv_nsec - cpu_beg.tv_nsec) / 1000;
+
+			SEAP_msgattr_set(seap_reply, PROBE_MSGATTR_CPUTIME, r0 = SEXP_number_newu_64(cpu_us));
+			SEXP_free(r0);
+			SEAP_msgattr_set(seap_reply, PROBE_MSGATTR_ICACHE_HITS, r0 = SEXP_number_newu_32(pair->pth->icache_hits));
+			SEXP_free(r0);
+		}
+
 		if (SEAP_reply(pair->probe->SEAP_ctx, pair->probe->sd, seap_reply, pair->pth->msg) == -1) {
 			int ret = errno;
 
@@ -142,6 +166,7 @@ probe_worker_t *probe_worker_new(void)
 	pth->tid = 0;
 	pth->msg_handler = NULL;
 	pth->msg = NULL;
+	pth->icache_hits = 0;
 
 	return (pth);
 }
@@ -356,22 +381,25 @@ static SEXP_t *probe_ste_fetch(probe_t *probe, SEXP_t *id_list)
  * indirectly spawns a new thread in the probe process which evaluates
  * the object and stores the result in the probe cache. That result is
  * not send to the library because it doesn't know how to handle
- * it. Instead, the result is fetched by this function from the cache
- * and returned to the caller.
+ * it. Instead, the result is taken from a hold on the id which is set
+ * up before the request, so that it can't be evicted from the cache
+ * in the meantime, and returned to the caller.
  * @param id the id of the OVAL object to be evaluated
  * @return the result of the evaluation of the object or NULL on failure
  */
 static SEXP_t *probe_obj_eval(probe_t *probe, SEXP_t *id)
 {
 	SEXP_t *res, *rid;
+	probe_rcache_hold_t *hold;
 
+	hold = probe_rcache_sexp_hold(probe->rcache, id);
 	res = SEAP_cmd_exec(probe->SEAP_ctx, probe->sd, 0, PROBECMD_OBJ_EVAL, id, SEAP_CMDTYPE_SYNC, NULL, NULL);
 
 	rid = SEXP_list_first(res);
-	assume_r(SEXP_string_cmp(id, rid) == 0, NULL);
+	assume_r(SEXP_string_cmp(id, rid) == 0, NULL, SEXP_free(probe_rcache_release(probe->rcache, hold)););
 	SEXP_vfree(res, rid, NULL);
 
-	return probe_rcache_sexp_get(probe->rcache, id);
+	return probe_rcache_release(probe->rcache, hold);
 }
 
 static SEXP_t *probe_prepare_filters(probe_t *probe, SEXP_t *obj)
@@ -625,6 +653,7 @@ static SEXP_t *probe_set_eval(probe_t *probe, SEXP_t *set, size_t depth)
 	int op_num;
 
 	SEXP_t *r0, *r1, *result, *Omsg = NULL;
+	uint32_t i;
 
 	if (depth > MAX_EVAL_DEPTH) {
 		char *fmt = "probe_set_eval: Too many levels: max=%zu.";
@@ -795,20 +824,24 @@ static SEXP_t *probe_set_eval(probe_t *probe, SEXP_t *set, size_t depth)
 					"%s: Can't get unavailable filters.", __FUNCTION__);
 		goto eval_fail;
 	}
-	SEXP_vfree(filters_req, result, NULL);
+	SEXP_free(filters_req);
 
+	/*
+	 * The fetched states are in the order of the requested ids. Take them
+	 * from the reply, the result cache might have dropped them already.
+	 */
+	i = 1;
 	SEXP_list_foreach(member, filters_u) {
-		SEXP_t *id, *act, *ste;
+		SEXP_t *act, *ste;
 
 		act = SEXP_list_first(member);
-		id = SEXP_list_nth(member, 2);
-		ste = probe_rcache_sexp_get(probe->rcache, id);
+		ste = SEXP_list_nth(result, i++);
 		r0 = SEXP_list_new(act, ste, NULL);
 		SEXP_list_add(filters_a, r0);
-		SEXP_vfree(act, id, ste, r0, NULL);
+		SEXP_vfree(act, ste, r0, NULL);
 	}
 
-	SEXP_free(filters_u);
+	SEXP_vfree(filters_u, result, NULL);
 
 	_A((s_subset_i > 0 && o_subset_i == 0) || (s_subset_i == 0 && o_subset_i > 0));
 
@@ -888,12 +921,13 @@ static SEXP_t *probe_set_eval(probe_t *probe, SEXP_t *set, size_t depth)
 
 /**
  * Worker thread function. This functions handles the evalution of objects and sets.
- * @param msg_in SEAP message with the request which contains the object to be evaluated
+ * @param pth worker handling the SEAP message with the request which contains the object to be evaluated
  * @param ret pointer to the return code storage
  */
-SEXP_t *probe_worker(probe_t *probe, SEAP_msg_t *msg_in, int *ret)
+SEXP_t *probe_worker(probe_t *probe, probe_worker_t *pth, int *ret)
 {
 	SEXP_t *probe_in, *probe_out, *set;
+	SEAP_msg_t *msg_in = pth->msg;
 
 	if (msg_in == NULL) {
 		*ret = PROBE_EINVAL;
@@ -922,6 +956,7 @@ SEXP_t *probe_worker(probe_t *probe, SEAP_msg_t *msg_in, int *ret)
 
 		/* simple object */
                 pctx.icache  = probe->icache;
+                pctx.icache_hits = &pth->icache_hits;
 		pctx.filters = probe_prepare_filters(probe, probe_in);
                 mask = probe_obj_getmask(probe_in);
 
@@ -35,12 +35,15 @@
 # define PROBE_WORKER_DEFAULT_MAX_CHDEPTH 8 /**< maximum depth of a worker thread chain */
 #endif
 
-typedef struct {
+typedef struct probe_worker probe_worker_t;
+
+struct probe_worker {
 	SEAP_msgid_t sid; /**< SEAP message handled by this thread */
 	pthread_t    tid; /**< thread ID */
-	SEXP_t * (*msg_handler)(probe_t *, SEAP_msg_t *, int *); /**< input message (object) handler */
+	SEXP_t * (*msg_handler)(probe_t *, probe_worker_t *, int *); /**< input message (object) handler */
 	SEAP_msg_t  *msg; /**< the message being handled */
-} probe_worker_t;
+	uint32_t     icache_hits; /**< number of collected items found in the item cache */
+};
 
 typedef struct {
 	probe_t        *probe;
@@ -49,6 +52,6 @@ typedef struct {
 
 probe_worker_t *probe_worker_new(void);
 void *probe_worker_runfn(void *arg);
-SEXP_t *probe_worker(probe_t *probe, SEAP_msg_t *msg_in, int *ret);
+SEXP_t *probe_worker(probe_t *probe, probe_worker_t *pth, int *ret);
 
 #endif /* WORKER_H */
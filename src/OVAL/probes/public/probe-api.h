@@ -467,9 +467,25 @@ void probe_tfc54behaviors_canonicalize(SEXP_t **behaviors);
 #define PROBECMD_STE_FETCH 1 /**< State fetch command code */
 #define PROBECMD_OBJ_EVAL  2 /**< Object eval command code */
 #define PROBECMD_RESET     3 /**< Reset command code */
+#define PROBECMD_OBJ_INVALIDATE 4 /**< Drop cached results of the listed objects and states */
+#define PROBECMD_RCACHE_STATS   5 /**< Get the result cache statistics (hits, misses, evictions, entries, bytes, limit) */
+
+/*
+ * SEAP message attributes used to collect statistics. The library sets
+ * the request attribute, the probe answers with the reply attributes.
+ */
+#define PROBE_MSGATTR_STATS       "stats"       /**< request: collect statistics of the object */
+#define PROBE_MSGATTR_CPUTIME     "cpu-time"    /**< reply: CPU time of the worker thread in microseconds */
+#define PROBE_MSGATTR_ICACHE_HITS "icache-hits" /**< reply: number of items found in the item cache */
+#define PROBE_MSGATTR_RCACHE_HIT  "rcache-hit"  /**< reply: the result was taken from the result cache */
 
 void *probe_init(void) __attribute__ ((unused));
 void probe_fini(void *) __attribute__ ((unused));
+/**
+ * Called on PROBECMD_RESET with the value returned by probe_init(). Probes
+ * which keep state between objects drop it here, the default does nothing.
+ */
+void probe_reset(void *) __attribute__ ((unused));
 
 typedef struct probe_ctx probe_ctx;
 
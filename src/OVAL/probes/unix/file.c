@@ -274,6 +274,7 @@ static int file_cb (const char *p, const char *f, void *ptr)
         struct cbargs *args = (struct cbargs *) ptr;
         struct stat st;
         const char *st_path;
+	ocifs_t *ocifs = ocifs_active();
 
 	if (f == NULL) {
 		st_path = p;
@@ -282,7 +283,7 @@ static int file_cb (const char *p, const char *f, void *ptr)
 		st_path = path_buffer;
 	}
 
-        if (lstat (st_path, &st) == -1) {
+        if ((ocifs != NULL ? ocifs_lstat(ocifs, st_path, &st) : lstat (st_path, &st)) == -1) {
                 dI("lstat failed when processing %s: errno=%u, %s.\n", st_path, errno, strerror (errno));
 		return strncmp(st_path, "/proc", 4) == 0 ? 0 : -1;
         } else {
@@ -308,7 +309,8 @@ static int file_cb (const char *p, const char *f, void *ptr)
 		} else
 			SEXP_string_new_r(&gr_lastpath, p, strlen(p));
 
-		if (oval_version_cmp(over, OVAL_VERSION(5.7)) < 0) {
+		if (oval_version_cmp(over, OVAL_VERSION(5.7)) < 0 || ocifs != NULL) {
+			/* ACLs of files in image layers are not indexed */
 			se_acl = NULL;
 		} else {
 			se_acl = has_extended_acl(st_path);
@@ -421,7 +423,7 @@ void *probe_init (void)
 	probe_setoption(PROBEOPT_VARREF_HANDLING, false, "path");
 	probe_setoption(PROBEOPT_VARREF_HANDLING, false, "filename");
 #endif
-		probe_setoption(PROBEOPT_OFFLINE_MODE_SUPPORTED, PROBE_OFFLINE_CHROOT);
+		probe_setoption(PROBEOPT_OFFLINE_MODE_SUPPORTED, PROBE_OFFLINE_CHROOT|PROBE_OFFLINE_OCI);
         return (NULL);
 }
 
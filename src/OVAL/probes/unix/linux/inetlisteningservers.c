@@ -59,6 +59,14 @@
 #include <netdb.h>
 #include <arpa/inet.h>
 #include <regex.h>
+#include <pthread.h>
+
+#if defined(HAVE_LINUX_SOCK_DIAG_H) && defined(HAVE_LINUX_INET_DIAG_H)
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
+#endif
 
 #include "seap.h"
 #include "probe-api.h"
@@ -89,92 +97,124 @@ typedef struct _lnode {
   uid_t uid;            // effective user ID
   char *cmd;            // command run by user
   unsigned long inode;  // inode of socket
-  struct _lnode* next;  // Next node pointer
+  struct _lnode* next;  // Next node in the hash bucket
 } lnode;
 
-/* This is the linked list head. Only data elements go here. */
+/* Hash index of the socket inodes held by the running processes. When more
+ * processes hold the same socket, the first one found is kept. */
 typedef struct {
-  lnode *head;          // List head
-  lnode *cur;           // Pointer to current node
-} llist;
-
-/* Local data */
-static struct server_info req;
-
-/* Function prototypes */
-static inline lnode *list_get_cur(llist *l) { return l->cur; }
-static void list_create(llist *l);
-static void list_append(llist *l, lnode *node);
-static void list_clear(llist* l);
-static lnode *list_find_inode(llist *l, unsigned long i);
+  lnode **table;        // Buckets
+  size_t size;          // Number of buckets, a power of two
+  size_t count;         // Number of nodes
+  unsigned int refs;    // Objects using the index
+} inode_index;
+
+/* The index is built once and shared by all objects of a probe session */
+struct inet_probe_data {
+	pthread_mutex_t lock;
+	inode_index *index;
+};
 
+#define INODE_INDEX_INITIAL_SIZE 1024
 
-static void list_create(llist *l)
+static inline size_t inode_hash(unsigned long inode, size_t size)
 {
-	l->head = NULL;
-	l->cur = NULL;
+	return (size_t)((inode * 0x9E3779B97F4A7C15ULL) >> 32) & (size - 1);
 }
 
-static void list_append(llist *l, lnode *node)
+static inode_index *inode_index_new(void)
 {
-	lnode* newnode;
+	inode_index *idx = oscap_talloc(inode_index);
 
-	if (node == NULL || l == NULL)
-		return;
+	idx->size = INODE_INDEX_INITIAL_SIZE;
+	idx->count = 0;
+	idx->refs = 0;
+	idx->table = oscap_calloc(idx->size, sizeof(lnode *));
 
-	newnode = malloc(sizeof(lnode));
-	if (newnode == NULL)
-		return;
+	return idx;
+}
 
-	newnode->pid = node->pid;
-	newnode->uid = node->uid;
-	newnode->inode = node->inode;
-	// Take custody of the memory
-	newnode->cmd = node->cmd;
-	newnode->next = NULL;
+static void inode_index_free(inode_index *idx)
+{
+	size_t i;
+	lnode *cur, *next;
 
-	// if we are at top, fix this up
-	if (l->head == NULL)
-		l->head = newnode;
-	else	// Otherwise add pointer to newnode
-		l->cur->next = newnode;
+	if (idx == NULL)
+		return;
 
-	// make newnode current
-	l->cur = newnode;
+	for (i = 0; i < idx->size; ++i) {
+		for (cur = idx->table[i]; cur != NULL; cur = next) {
+			next = cur->next;
+			free(cur->cmd);
+			free(cur);
+		}
+	}
+	oscap_free(idx->table);
+	oscap_free(idx);
 }
 
-static void list_clear(llist* l)
+static void inode_index_grow(inode_index *idx)
 {
-	lnode* nextnode;
-	register lnode* cur;
-
-	cur = l->head;
-	while (cur) {
-		nextnode=cur->next;
-		free(cur->cmd);
-		free(cur);
-		cur=nextnode;
+	size_t i, size = idx->size * 2;
+	lnode **table = oscap_calloc(size, sizeof(lnode *));
+	lnode *cur, *next, **tail;
+
+	for (i = 0; i < idx->size; ++i) {
+		for (cur = idx->table[i]; cur != NULL; cur = next) {
+			next = cur->next;
+			// keep the order of the nodes within a bucket
+			for (tail = &table[inode_hash(cur->inode, size)]; *tail != NULL; tail = &(*tail)->next)
+				;
+			cur->next = NULL;
+			*tail = cur;
+		}
 	}
-	l->head = NULL;
-	l->cur = NULL;
+	oscap_free(idx->table);
+	idx->table = table;
+	idx->size = size;
 }
 
-static lnode *list_find_inode(llist *l, unsigned long i)
+static lnode *inode_index_find(const inode_index *idx, unsigned long i)
 {
-        register lnode* cur;
+	lnode *cur;
 
-       	cur = l->head;	/* start at the beginning */
-	while (cur) {
-		if (cur->inode == i) {
-			l->cur = cur;
+	for (cur = idx->table[inode_hash(i, idx->size)]; cur != NULL; cur = cur->next) {
+		if (cur->inode == i)
 			return cur;
-		} else
-			cur = cur->next;
 	}
 	return NULL;
 }
 
-static int collect_process_info(llist *l)
+/* Takes custody of node->cmd */
+static void inode_index_add(inode_index *idx, lnode *node)
+{
+	lnode *newnode, **tail;
+
+	for (tail = &idx->table[inode_hash(node->inode, idx->size)]; *tail != NULL; tail = &(*tail)->next) {
+		if ((*tail)->inode == node->inode) {
+			free(node->cmd);
+			return;
+		}
+	}
+
+	newnode = malloc(sizeof(lnode));
+	if (newnode == NULL) {
+		free(node->cmd);
+		return;
+	}
+
+	newnode->pid = node->pid;
+	newnode->uid = node->uid;
+	newnode->inode = node->inode;
+	newnode->cmd = node->cmd;
+	newnode->next = NULL;
+	*tail = newnode;
+
+	if (++idx->count > idx->size)
+		inode_index_grow(idx);
+}
+
+static int collect_process_info(inode_index *l)
 {
 	DIR *d, *f;
 	struct dirent *ent;
@@ -289,7 +329,7 @@ static int collect_process_info(llist *l)
 			node.cmd = strdup(cmd);
 			node.inode = inode;
 			// We make one entry for each socket inode
-			list_append(l, &node);
+			inode_index_add(l, &node);
 		}
 		closedir(f);
 		free(text);
@@ -298,27 +338,27 @@ static int collect_process_info(llist *l)
 	return 0;
 }
 
-static int eval_data(const char *type, const char *local_address,
-	unsigned int local_port)
+static int eval_data(const struct server_info *req, const char *type,
+	const char *local_address, unsigned int local_port)
 {
 	SEXP_t *r0;
 
 	r0 = SEXP_string_newf("%s", type);
-	if (probe_entobj_cmp(req.protocol_ent, r0) != OVAL_RESULT_TRUE) {
+	if (probe_entobj_cmp(req->protocol_ent, r0) != OVAL_RESULT_TRUE) {
 		SEXP_free(r0);
 		return 0;
 	}
 	SEXP_free(r0);
 
 	r0 = SEXP_string_newf("%s", local_address);
-	if (probe_entobj_cmp(req.local_address_ent, r0) != OVAL_RESULT_TRUE) {
+	if (probe_entobj_cmp(req->local_address_ent, r0) != OVAL_RESULT_TRUE) {
 		SEXP_free(r0);
 		return 0;
 	}
 	SEXP_free(r0);
 
 	r0 = SEXP_number_newu_32(local_port);
-	if (probe_entobj_cmp(req.local_port_ent, r0) != OVAL_RESULT_TRUE) {
+	if (probe_entobj_cmp(req->local_port_ent, r0) != OVAL_RESULT_TRUE) {
 		SEXP_free(r0);
 		return 0;
 	}
@@ -327,15 +367,10 @@ static int eval_data(const char *type, const char *local_address,
 	return 1;
 }
 
-static void report_finding(struct result_info *res, llist *l, probe_ctx *ctx)
+static void report_finding(struct result_info *res, const lnode *n, probe_ctx *ctx)
 {
         SEXP_t *item;
         SEXP_t se_lport_mem, se_rport_mem, se_lfull_mem, se_ffull_mem, *se_uid_mem = NULL;
-	lnode *n = NULL;
-
-	if (l) {
-		n = list_get_cur(l);
-	}
 
 	if (n) {
                 item = probe_item_create(OVAL_LINUX_INET_LISTENING_SERVER, NULL,
@@ -391,7 +426,8 @@ static void addr_convert(const char *src, char *dest, int size)
 }
 
 
-static int read_tcp(const char *proc, const char *type, llist *l, probe_ctx *ctx)
+static int read_tcp(const char *proc, const char *type, const struct server_info *req,
+	const inode_index *l, probe_ctx *ctx)
 {
 	int line = 0;
 	FILE *f;
@@ -425,25 +461,22 @@ static int read_tcp(const char *proc, const char *type, llist *l, probe_ctx *ctx
 		addr_convert(local_addr, src, NI_MAXHOST);
 		addr_convert(rem_addr, dest, NI_MAXHOST);
 		dI("Have tcp port: %s:%u\n", src, local_port);
-		if (eval_data(type, src, local_port)) {
+		if (eval_data(req, type, src, local_port)) {
 			struct result_info r;
 			r.proto = type;
 			r.laddr = src;
 			r.lport = local_port;
 			r.raddr = dest;
 			r.rport = rem_port;
-			if (list_find_inode(l, inode)) {
-				report_finding(&r, l, ctx);
-			} else {
-				report_finding(&r, NULL, ctx);
-			}
+			report_finding(&r, inode_index_find(l, inode), ctx);
 		}
 	}
 	fclose(f);
 	return 0;
 }
 
-static int read_udp(const char *proc, const char *type, llist *l, probe_ctx *ctx)
+static int read_udp(const char *proc, const char *type, const struct server_info *req,
+	const inode_index *l, probe_ctx *ctx)
 {
 	int line = 0;
 	FILE *f;
@@ -476,25 +509,22 @@ static int read_udp(const char *proc, const char *type, llist *l, probe_ctx *ctx
 		addr_convert(local_addr, src, NI_MAXHOST);
 		addr_convert(rem_addr, dest, NI_MAXHOST);
 		dI("Have udp port: %s:%u\n", src, local_port);
-		if (eval_data(type, src, local_port)) {
+		if (eval_data(req, type, src, local_port)) {
 			struct result_info r;
 			r.proto = type;
 			r.laddr = src;
 			r.lport = local_port;
 			r.raddr = dest;
 			r.rport = rem_port;
-			if (list_find_inode(l, inode)) {
-				report_finding(&r, l, ctx);
-			} else {
-				report_finding(&r, NULL, ctx);
-			}
+			report_finding(&r, inode_index_find(l, inode), ctx);
 		}
 	}
 	fclose(f);
 	return 0;
 }
 
-static int read_raw(const char *proc, const char *type, llist *l, probe_ctx *ctx)
+static int read_raw(const char *proc, const char *type, const struct server_info *req,
+	const inode_index *l, probe_ctx *ctx)
 {
 	int line = 0;
 	FILE *f;
@@ -527,31 +557,220 @@ static int read_raw(const char *proc, const char *type, llist *l, probe_ctx *ctx
 		addr_convert(local_addr, src, NI_MAXHOST);
 		addr_convert(rem_addr, dest, NI_MAXHOST);
 		dI("Have raw port: %s:%u\n", src, local_port);
-		if (eval_data(type, src, local_port)) {
+		if (eval_data(req, type, src, local_port)) {
 			struct result_info r;
 			r.proto = type;
 			r.laddr = src;
 			r.lport = local_port;
 			r.raddr = dest;
 			r.rport = rem_port;
-			if (list_find_inode(l, inode)) {
-				report_finding(&r, l, ctx);
-			} else {
-				report_finding(&r, NULL, ctx);
-			}
+			report_finding(&r, inode_index_find(l, inode), ctx);
 		}
 	}
 	fclose(f);
 	return 0;
 }
 
+#if defined(HAVE_LINUX_SOCK_DIAG_H) && defined(HAVE_LINUX_INET_DIAG_H)
+/*
+ * Dump the sockets of the given family and protocol using NETLINK_SOCK_DIAG.
+ * This is what ss(8) uses, the kernel hands over binary records instead of
+ * formatting /proc/net/{tcp,udp,raw}[6] as text. Returns -1 if the kernel
+ * doesn't support the query, so that the caller can fall back to procfs.
+ */
+static int read_sock_diag(int family, int protocol, const char *type,
+	const struct server_info *req, const inode_index *l, probe_ctx *ctx)
+{
+	struct {
+		struct nlmsghdr nlh;
+		struct inet_diag_req_v2 r;
+	} msg;
+	struct sockaddr_nl nladdr;
+	long buf[8192 / sizeof(long)];
+	int fd, ret = -1;
+	bool done = false, received = false;
+
+	fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+	if (fd < 0)
+		return -1;
+
+	memset(&nladdr, 0, sizeof(nladdr));
+	nladdr.nl_family = AF_NETLINK;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.nlh.nlmsg_len = sizeof(msg);
+	msg.nlh.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+	msg.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+	msg.nlh.nlmsg_seq = 1;
+	msg.r.sdiag_family = family;
+	msg.r.sdiag_protocol = protocol;
+	msg.r.idiag_states = ~0U;
+	// raw_diag reads the protocol of the raw sockets from the padding,
+	// IPPROTO_RAW stands for all of them
+	if (protocol == IPPROTO_RAW)
+		msg.r.pad = IPPROTO_RAW;
+
+	if (sendto(fd, &msg, sizeof(msg), 0, (struct sockaddr *)&nladdr, sizeof(nladdr)) < 0)
+		goto cleanup;
+
+	while (!done) {
+		struct nlmsghdr *h;
+		ssize_t len = recv(fd, buf, sizeof(buf), 0);
+
+		if (len < 0 && errno == EINTR)
+			continue;
+		if (len <= 0) {
+			ret = received ? 1 : -1;
+			break;
+		}
+
+		for (h = (struct nlmsghdr *)buf; NLMSG_OK(h, (size_t)len); h = NLMSG_NEXT(h, len)) {
+			if (h->nlmsg_type == NLMSG_DONE || h->nlmsg_type == NLMSG_ERROR) {
+				// the error of a dump is carried by NLMSG_DONE, e.g. -ENOENT
+				// if the diag module of the protocol isn't loaded
+				int error = 0;
+
+				if (h->nlmsg_len >= NLMSG_LENGTH(sizeof(int)))
+					error = *(const int *)NLMSG_DATA(h);
+
+				if (error == 0) {
+					ret = 0;
+				} else {
+					errno = -error;
+					dI("sock_diag query for family %d, protocol %d failed: %s\n",
+					   family, protocol, strerror(errno));
+					// nothing was reported yet if the kernel rejected the query
+					ret = received ? 1 : -1;
+				}
+				done = true;
+				break;
+			}
+			if (h->nlmsg_len < NLMSG_LENGTH(sizeof(struct inet_diag_msg)))
+				continue;
+
+			const struct inet_diag_msg *d = NLMSG_DATA(h);
+			char src[NI_MAXHOST], dest[NI_MAXHOST];
+			unsigned local_port = ntohs(d->id.idiag_sport);
+			unsigned rem_port = ntohs(d->id.idiag_dport);
+
+			received = true;
+			inet_ntop(d->idiag_family, d->id.idiag_src, src, NI_MAXHOST);
+			inet_ntop(d->idiag_family, d->id.idiag_dst, dest, NI_MAXHOST);
+			dI("Have %s port: %s:%u\n", type, src, local_port);
+			if (eval_data(req, type, src, local_port)) {
+				struct result_info r;
+				r.proto = type;
+				r.laddr = src;
+				r.lport = local_port;
+				r.raddr = dest;
+				r.rport = rem_port;
+				report_finding(&r, inode_index_find(l, d->idiag_inode), ctx);
+			}
+		}
+	}
+
+cleanup:
+	close(fd);
+	return ret;
+}
+#endif
+
+/*
+ * Report the sockets of one source, from sock_diag when the kernel supports
+ * it, otherwise by parsing the given procfs file.
+ */
+static int read_sockets(int family, int protocol, const char *proc, const char *type,
+	const struct server_info *req, const inode_index *l, probe_ctx *ctx)
+{
+#if defined(HAVE_LINUX_SOCK_DIAG_H) && defined(HAVE_LINUX_INET_DIAG_H)
+	int ret = read_sock_diag(family, protocol, type, req, l, ctx);
+
+	if (ret >= 0)
+		return ret;
+#endif
+	switch (protocol) {
+	case IPPROTO_TCP:
+		return read_tcp(proc, type, req, l, ctx);
+	case IPPROTO_UDP:
+		return read_udp(proc, type, req, l, ctx);
+	default:
+		return read_raw(proc, type, req, l, ctx);
+	}
+}
+
+/*
+ * Return the socket inode index of the session, scan the processes if
+ * there's none yet. The index has to be returned by inode_index_put().
+ */
+static inode_index *inode_index_get(struct inet_probe_data *data)
+{
+	inode_index *idx;
+
+	pthread_mutex_lock(&data->lock);
+	if (data->index == NULL) {
+		idx = inode_index_new();
+		if (collect_process_info(idx) != 0)
+			inode_index_free(idx);
+		else
+			data->index = idx;
+	}
+
+	idx = data->index;
+	if (idx != NULL)
+		++idx->refs;
+	pthread_mutex_unlock(&data->lock);
+
+	return idx;
+}
+
+static void inode_index_put(struct inet_probe_data *data, inode_index *idx)
+{
+	pthread_mutex_lock(&data->lock);
+	if (--idx->refs == 0 && idx != data->index)
+		inode_index_free(idx);
+	pthread_mutex_unlock(&data->lock);
+}
+
+void *probe_init(void)
+{
+	struct inet_probe_data *data = oscap_talloc(struct inet_probe_data);
+
+	pthread_mutex_init(&data->lock, NULL);
+	data->index = NULL;
+
+	return data;
+}
+
+void probe_fini(void *arg)
+{
+	struct inet_probe_data *data = arg;
+
+	inode_index_free(data->index);
+	pthread_mutex_destroy(&data->lock);
+	oscap_free(data);
+}
+
+/* Processes come and go between sessions, scan them again next time */
+void probe_reset(void *arg)
+{
+	struct inet_probe_data *data = arg;
+
+	pthread_mutex_lock(&data->lock);
+	if (data->index != NULL && data->index->refs == 0)
+		inode_index_free(data->index);
+	data->index = NULL;
+	pthread_mutex_unlock(&data->lock);
+}
+
 int probe_main(probe_ctx *ctx, void *arg)
 {
         SEXP_t *object;
 	int err;
-	llist ll;
+	struct server_info req;
+	inode_index *idx;
 
         object = probe_ctx_getobject(ctx);
+	memset(&req, 0, sizeof(req));
 
 	req.protocol_ent = probe_obj_getent(object, "protocol", 1);
 	if (req.protocol_ent == NULL) {
@@ -572,8 +791,8 @@ int probe_main(probe_ctx *ctx, void *arg)
 	}
 
 	// Now start collecting the info
-	list_create(&ll);
-	if (collect_process_info(&ll)) {
+	idx = inode_index_get((struct inet_probe_data *)arg);
+	if (idx == NULL) {
 		SEXP_t *msg;
 
 		msg = probe_msg_creat(OVAL_MESSAGE_LEVEL_ERROR, "Permission error.");
@@ -586,19 +805,19 @@ int probe_main(probe_ctx *ctx, void *arg)
 	}
 
 	// Now we check the tcp socket list...
-	read_tcp("/proc/net/tcp", "tcp", &ll, ctx);
-	read_tcp("/proc/net/tcp6", "tcp", &ll, ctx);
+	read_sockets(AF_INET, IPPROTO_TCP, "/proc/net/tcp", "tcp", &req, idx, ctx);
+	read_sockets(AF_INET6, IPPROTO_TCP, "/proc/net/tcp6", "tcp", &req, idx, ctx);
 
 	// Next udp sockets...
-	read_udp("/proc/net/udp", "udp", &ll, ctx);
-	read_udp("/proc/net/udp6", "udp", &ll, ctx);
+	read_sockets(AF_INET, IPPROTO_UDP, "/proc/net/udp", "udp", &req, idx, ctx);
+	read_sockets(AF_INET6, IPPROTO_UDP, "/proc/net/udp6", "udp", &req, idx, ctx);
 
 	// Next, raw sockets...not exactly part of standard yet. They
 	// can be used to send datagrams, so we will pretend they are udp
-	read_raw("/proc/net/raw", "udp", &ll, ctx);
-	read_raw("/proc/net/raw6", "udp", &ll, ctx);
+	read_sockets(AF_INET, IPPROTO_RAW, "/proc/net/raw", "udp", &req, idx, ctx);
+	read_sockets(AF_INET6, IPPROTO_RAW, "/proc/net/raw6", "udp", &req, idx, ctx);
 
-	list_clear(&ll);
+	inode_index_put((struct inet_probe_data *)arg, idx);
 
 	err = 0;
  cleanup:
@@ -34,8 +34,11 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <errno.h>
+#include <pthread.h>
 #include <assert.h>
 #include <limits.h>
 #include <sys/types.h>
@@ -74,7 +77,7 @@
 #include "probe/entcmp.h"
 
 struct rpmverify_res {
-	char *name;  /**< package name */
+	const char *name;  /**< package name */
 	const char *epoch;
 	const char *version;
 	const char *release;
@@ -90,9 +93,45 @@ struct rpmverify_res {
 #define RPMVERIFY_SKIP_GHOST  0x2000000000000000
 #define RPMVERIFY_RPMATTRMASK 0x00000000ffffffff
 
+/** Package of the reverse file index */
+struct rpmverify_pkg {
+	unsigned int offset; /**< rpmdb header instance */
+	char *name;
+	char *epoch;
+	char *version;
+	char *release;
+	char *arch;
+	char extended_name[1024];
+};
+
+/** File of the reverse file index */
+struct rpmverify_file {
+	char *path;
+	size_t pkg;          /**< index of the package in rpmverify_index.pkg */
+	rpmTag tag;          /**< tag the file info was created from */
+	int fx;              /**< index of the file in the package */
+	rpmfileAttrs fflags; /**< rpm file flags */
+	struct rpmverify_file *hnext; /**< next file in the same hash bucket */
+};
+
+/**
+ * Reverse index from file path to the packages owning the file. It's built
+ * once per probe session by a single pass over the rpmdb, objects then look
+ * up files instead of walking all packages and their files again.
+ */
+struct rpmverify_index {
+	struct rpmverify_pkg *pkg;
+	size_t pkg_count;
+	struct rpmverify_file *file; /**< in rpmdb order */
+	size_t file_count;
+	struct rpmverify_file **bucket;
+	size_t bucket_count;         /**< a power of two */
+};
+
 struct rpmverify_global {
 	rpmts	   rpmts;
 	pthread_mutex_t mutex;
+	struct rpmverify_index *index;
 };
 
 static struct rpmverify_global g_rpm;
@@ -117,33 +156,203 @@ static struct rpmverify_global g_rpm;
 		pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &prev_cancel_state); \
 	} while(0)
 
-/* modify passed-in iterator to test also given entity */
-static int adjust_filter(rpmdbMatchIterator iterator, SEXP_t *ent, rpmTag rpm_tag) {
-	oval_operation_t ent_op;
-	char ent_str[1024];
-	int ret = 0;
+static size_t rpmverify_path_hash(const char *path, size_t size)
+{
+	uint32_t h = 2166136261U;
 
-	if (ent) {
-		ent_op = probe_ent_getoperation(ent, OVAL_OPERATION_EQUALS);
-		PROBE_ENT_STRVAL(ent, ent_str, sizeof ent_str, /* void */, strcpy(ent_str, ""););
+	while (*path != '\0') {
+		h ^= (unsigned char)*path++;
+		h *= 16777619U;
+	}
+	return h & (size - 1);
+}
 
-		switch (ent_op) {
-		case OVAL_OPERATION_EQUALS:
-			if (rpmdbSetIteratorRE (iterator, rpm_tag, RPMMIRE_STRCMP, ent_str) != 0)
-				ret = -1;
+static void rpmverify_index_free(struct rpmverify_index *idx)
+{
+	size_t i;
 
-			break;
-		case OVAL_OPERATION_PATTERN_MATCH:
-			if (rpmdbSetIteratorRE (iterator, rpm_tag, RPMMIRE_REGEX,
-						(const char *)ent_str) != 0)
-				ret = -1;
+	if (idx == NULL)
+		return;
 
-			break;
-		default:
-			ret = 0;
+	for (i = 0; i < idx->pkg_count; ++i) {
+		free(idx->pkg[i].name);
+		free(idx->pkg[i].epoch);
+		free(idx->pkg[i].version);
+		free(idx->pkg[i].release);
+		free(idx->pkg[i].arch);
+	}
+	for (i = 0; i < idx->file_count; ++i)
+		oscap_free(idx->file[i].path);
+
+	oscap_free(idx->pkg);
+	oscap_free(idx->file);
+	oscap_free(idx->bucket);
+	oscap_free(idx);
+}
+
+static struct rpmverify_index *rpmverify_index_new(rpmts ts)
+{
+	struct rpmverify_index *idx;
+	rpmdbMatchIterator match;
+	Header pkgh;
+	size_t pkg_alloc = 0, file_alloc = 0, i;
+
+	idx = oscap_talloc(struct rpmverify_index);
+	memset(idx, 0, sizeof(*idx));
+
+	assume_d(RPMTAG_BASENAMES != 0, NULL);
+	assume_d(RPMTAG_DIRNAMES  != 0, NULL);
+
+	match = rpmtsInitIterator(ts, RPMDBI_PACKAGES, NULL, 0);
+
+	while (match != NULL && (pkgh = rpmdbNextIterator(match)) != NULL) {
+		rpmTag tag[2] = { RPMTAG_BASENAMES, RPMTAG_DIRNAMES };
+		struct rpmverify_pkg *pkg;
+		errmsg_t rpmerr;
+		rpmfi fi;
+		int t;
+
+		if (idx->pkg_count == pkg_alloc) {
+			pkg_alloc = pkg_alloc ? pkg_alloc * 2 : 1024;
+			idx->pkg = oscap_realloc(idx->pkg, pkg_alloc * sizeof(struct rpmverify_pkg));
+		}
+
+		pkg = &idx->pkg[idx->pkg_count++];
+		pkg->offset  = rpmdbGetIteratorOffset(match);
+		pkg->name    = headerFormat(pkgh, "%{NAME}", &rpmerr);
+		pkg->epoch   = headerFormat(pkgh, "%{EPOCH}", &rpmerr);
+		pkg->version = headerFormat(pkgh, "%{VERSION}", &rpmerr);
+		pkg->release = headerFormat(pkgh, "%{RELEASE}", &rpmerr);
+		pkg->arch    = headerFormat(pkgh, "%{ARCH}", &rpmerr);
+		snprintf(pkg->extended_name, sizeof pkg->extended_name, "%s-%s:%s-%s.%s", pkg->name,
+			 oscap_streq(pkg->epoch, "(none)") ? "0" : pkg->epoch,
+			 pkg->version, pkg->release, pkg->arch);
+
+		/*
+		 * Index package files & directories
+		 */
+		for (t = 0; t < 2; ++t) {
+			fi = rpmfiNew(ts, pkgh, tag[t], 1);
+
+			while (rpmfiNext(fi) != -1) {
+				struct rpmverify_file *file;
+
+				if (idx->file_count == file_alloc) {
+					file_alloc = file_alloc ? file_alloc * 2 : 16384;
+					idx->file = oscap_realloc(idx->file, file_alloc * sizeof(struct rpmverify_file));
+				}
+
+				file = &idx->file[idx->file_count++];
+				file->path   = oscap_strdup(rpmfiFN(fi));
+				file->pkg    = idx->pkg_count - 1;
+				file->tag    = tag[t];
+				file->fx     = rpmfiFX(fi);
+				file->fflags = rpmfiFFlags(fi);
+			}
+
+			rpmfiFree(fi);
+		}
+	}
+
+	if (match != NULL)
+		rpmdbFreeIterator(match);
+
+	for (idx->bucket_count = 1024; idx->bucket_count < idx->file_count; idx->bucket_count *= 2)
+		;
+	idx->bucket = oscap_calloc(idx->bucket_count, sizeof(struct rpmverify_file *));
+
+	/* going backwards keeps the files of each bucket in rpmdb order */
+	for (i = idx->file_count; i > 0; --i) {
+		struct rpmverify_file *file = &idx->file[i - 1];
+		size_t h = rpmverify_path_hash(file->path, idx->bucket_count);
+
+		file->hnext = idx->bucket[h];
+		idx->bucket[h] = file;
+	}
+
+	dI("rpmverifyfile index: %zu packages, %zu files\n", idx->pkg_count, idx->file_count);
+	return idx;
+}
+
+/* Next candidate file, the same hash bucket for an exact path, otherwise all files */
+static inline struct rpmverify_file *rpmverify_index_next(struct rpmverify_index *idx,
+							  struct rpmverify_file *f, oval_operation_t file_op)
+{
+	if (file_op == OVAL_OPERATION_EQUALS)
+		return f->hnext;
+
+	return (f + 1 < idx->file + idx->file_count) ? f + 1 : NULL;
+}
+
+static bool rpmverify_pkg_match(const struct rpmverify_pkg *pkg,
+				SEXP_t *name_ent, SEXP_t *epoch_ent, SEXP_t *version_ent, SEXP_t *release_ent, SEXP_t *arch_ent)
+{
+	SEXP_t *ent;
+
+#define COMPARE_ENT(XXX) \
+	if (XXX ## _ent != NULL) { \
+		ent = probe_entval_from_cstr( \
+			probe_ent_getdatatype(XXX ## _ent), pkg->XXX, strlen(pkg->XXX) \
+		); \
+		if (ent != NULL && probe_entobj_cmp(XXX ## _ent, ent) != OVAL_RESULT_TRUE) { \
+			SEXP_free(ent); \
+			return false; \
+		} \
+		SEXP_free(ent); \
+	}
+
+	COMPARE_ENT(name);
+	COMPARE_ENT(epoch);
+	COMPARE_ENT(version);
+	COMPARE_ENT(release);
+	COMPARE_ENT(arch);
+
+	return true;
+}
+
+/*
+ * Verify the selected files, filling in vflags. The files of one package
+ * follow each other in the index, so the header of the package is read
+ * once for all of its selected files.
+ */
+static void rpmverify_verify(rpmts ts, struct rpmverify_index *idx, struct rpmverify_file **file, size_t count,
+			     rpmVerifyAttrs omit, rpmVerifyAttrs *vflags)
+{
+	size_t i, j, k;
+
+	for (i = 0; i < count; i = j) {
+		unsigned int offset = idx->pkg[file[i]->pkg].offset;
+		rpmdbMatchIterator match;
+		Header pkgh;
+		rpmfi fi = NULL;
+
+		for (j = i + 1; j < count && file[j]->pkg == file[i]->pkg && file[j]->tag == file[i]->tag; ++j)
+			;
+
+		match = rpmtsInitIterator(ts, RPMDBI_PACKAGES, &offset, sizeof offset);
+		if (match != NULL && (pkgh = rpmdbNextIterator(match)) != NULL)
+			fi = rpmfiNew(ts, pkgh, file[i]->tag, 1);
+
+		if (fi == NULL)
+			dW("Can't read header #%u\n", offset);
+
+		for (k = i; k < j; ++k) {
+			if (fi == NULL) {
+				vflags[k] = RPMVERIFY_FAILURES;
+				continue;
+			}
+
+			rpmfiSetFX(fi, file[k]->fx);
+
+			if (rpmVerifyFile(ts, fi, &vflags[k], omit) != 0)
+				vflags[k] = RPMVERIFY_FAILURES;
 		}
+
+		if (fi != NULL)
+			rpmfiFree(fi);
+		if (match != NULL)
+			rpmdbFreeIterator(match);
 	}
-	return ret;
 }
 
 static int rpmverify_collect(probe_ctx *ctx,
@@ -152,9 +361,12 @@ static int rpmverify_collect(probe_ctx *ctx,
 			     uint64_t flags,
 			     int (*callback)(probe_ctx *, struct rpmverify_res *))
 {
-	rpmdbMatchIterator match;
 	rpmVerifyAttrs omit = (rpmVerifyAttrs)(flags & RPMVERIFY_RPMATTRMASK);
-	Header pkgh;
+	struct rpmverify_index *idx;
+	struct rpmverify_file *f, **selected = NULL;
+	rpmVerifyAttrs *vflags = NULL;
+	int8_t *pkg_match = NULL; /* -1 unknown, 0 mismatch, 1 match */
+	size_t count = 0, alloc = 0, i;
 	pcre *re = NULL;
 	int  ret = -1;
 
@@ -171,145 +383,122 @@ static int rpmverify_collect(probe_ctx *ctx,
 		}
 	}
 
+	switch(file_op) {
+	case OVAL_OPERATION_EQUALS:
+	case OVAL_OPERATION_NOT_EQUAL:
+	case OVAL_OPERATION_PATTERN_MATCH:
+		break;
+	default:
+		/* unsupported operation */
+		dE("Operation \"%d\" on `filepath' not supported\n", file_op);
+		if (re != NULL)
+			pcre_free(re);
+		return (-1);
+	}
+
 	RPMVERIFY_LOCK;
 
-	match = rpmtsInitIterator (g_rpm.rpmts, RPMDBI_PACKAGES, NULL, 0);
-	if (match == NULL) {
+	if (g_rpm.index == NULL)
+		g_rpm.index = rpmverify_index_new(g_rpm.rpmts);
+
+	idx = g_rpm.index;
+	if (idx == NULL || idx->file_count == 0) {
 		ret = 0;
 		goto ret;
 	}
 
-	if ((ret = adjust_filter(match, name_ent, RPMTAG_NAME)) == -1) {
-		dE("can't adjust filter with name");
-		goto ret;
-	}
-	if ((ret = adjust_filter(match, epoch_ent, RPMTAG_EPOCH)) == -1) {
-		dE("can't adjust filter with epoch");
-		goto ret;
-	}
-	if ((ret = adjust_filter(match, version_ent, RPMTAG_VERSION)) == -1) {
-		dE("can't adjust filter with version");
-		goto ret;
-	}
-	if ((ret = adjust_filter(match, release_ent, RPMTAG_RELEASE)) == -1) {
-		dE("can't adjust filter with version");
-		goto ret;
-	}
-	if ((ret = adjust_filter(match, arch_ent, RPMTAG_ARCH)) == -1) {
-		dE("can't adjust filter with version");
-		goto ret;
-	}
+	pkg_match = oscap_alloc(idx->pkg_count * sizeof(int8_t));
+	memset(pkg_match, -1, idx->pkg_count * sizeof(int8_t));
 
-	assume_d(RPMTAG_BASENAMES != 0, -1);
-	assume_d(RPMTAG_DIRNAMES  != 0, -1);
+	/*
+	 * Select the files, an exact path is looked up in the index, the other
+	 * operations go through all files in rpmdb order.
+	 */
+	if (file_op == OVAL_OPERATION_EQUALS)
+		f = idx->bucket[rpmverify_path_hash(file, idx->bucket_count)];
+	else
+		f = &idx->file[0];
 
-	while ((pkgh = rpmdbNextIterator (match)) != NULL) {
-		SEXP_t *ent;
-		rpmfi  fi;
-		rpmTag tag[2] = { RPMTAG_BASENAMES, RPMTAG_DIRNAMES };
-		struct rpmverify_res res;
-		errmsg_t rpmerr;
-		int i;
+	for (; f != NULL; f = rpmverify_index_next(idx, f, file_op)) {
 
-		/*
-+SEXP_t *probe_ent_from_cstr(const char *name, oval_datatype_t type,
-+                            const char *value, size_t vallen)
-		 */
+		if (((f->fflags & RPMFILE_CONFIG) && (flags & RPMVERIFY_SKIP_CONFIG)) ||
+		    ((f->fflags & RPMFILE_GHOST)  && (flags & RPMVERIFY_SKIP_GHOST)))
+			continue;
 
-#define COMPARE_ENT(XXX) \
-		if (XXX ## _ent != NULL) { \
-			ent = probe_entval_from_cstr( \
-				probe_ent_getdatatype(XXX ## _ent), res.XXX, strlen(res.XXX) \
-			); \
-			if (ent != NULL && probe_entobj_cmp(XXX ## _ent, ent) != OVAL_RESULT_TRUE) { \
-				SEXP_free(ent); \
-				continue; \
-			} \
-			SEXP_free(ent); \
+		switch(file_op) {
+		case OVAL_OPERATION_EQUALS:
+			if (strcmp(f->path, file) != 0)
+				continue;
+			break;
+		case OVAL_OPERATION_NOT_EQUAL:
+			if (strcmp(f->path, file) == 0)
+				continue;
+			break;
+		case OVAL_OPERATION_PATTERN_MATCH:
+			ret = pcre_exec(re, NULL, f->path, strlen(f->path), 0, 0, NULL, 0);
+
+			switch(ret) {
+			case 0: /* match */
+				break;
+			case -1:
+				/* mismatch */
+				continue;
+			default:
+				dE("pcre_exec() failed!\n");
+				ret = -1;
+				goto ret;
+			}
+			break;
+		default:
+			break;
 		}
 
-		res.name = headerFormat(pkgh, "%{NAME}", &rpmerr);
-		COMPARE_ENT(name);
-
-		res.epoch = headerFormat(pkgh, "%{EPOCH}", &rpmerr);
-		COMPARE_ENT(epoch);
-
-		res.version = headerFormat(pkgh, "%{VERSION}", &rpmerr);
-		COMPARE_ENT(version);
-		res.release = headerFormat(pkgh, "%{RELEASE}", &rpmerr);
-		COMPARE_ENT(release);
-		res.arch = headerFormat(pkgh, "%{ARCH}", &rpmerr);
-		COMPARE_ENT(arch);
-		snprintf(res.extended_name, 1024, "%s-%s:%s-%s.%s", res.name,
-			oscap_streq(res.epoch, "(none)") ? "0" : res.epoch,
-			res.version, res.release, res.arch);
-
-		/*
-		 * Inspect package files & directories
-		 */
-		for (i = 0; i < 2; ++i) {
-		  fi = rpmfiNew(g_rpm.rpmts, pkgh, tag[i], 1);
+		if (pkg_match[f->pkg] == -1)
+			pkg_match[f->pkg] = rpmverify_pkg_match(&idx->pkg[f->pkg], name_ent, epoch_ent,
+								version_ent, release_ent, arch_ent);
+		if (!pkg_match[f->pkg])
+			continue;
 
-		  while (rpmfiNext(fi) != -1) {
-		    res.file   = rpmfiFN(fi);
-		    res.fflags = rpmfiFFlags(fi);
-		    res.oflags = omit;
+		if (count == alloc) {
+			alloc = alloc ? alloc * 2 : 64;
+			selected = oscap_realloc(selected, alloc * sizeof(struct rpmverify_file *));
+		}
+		selected[count++] = f;
+	}
 
-		    if (((res.fflags & RPMFILE_CONFIG) && (flags & RPMVERIFY_SKIP_CONFIG)) ||
-			((res.fflags & RPMFILE_GHOST)  && (flags & RPMVERIFY_SKIP_GHOST)))
-		      continue;
+	if (count > 0) {
+		vflags = oscap_alloc(count * sizeof(rpmVerifyAttrs));
+		rpmverify_verify(g_rpm.rpmts, idx, selected, count, omit, vflags);
+	}
 
-		    switch(file_op) {
-		    case OVAL_OPERATION_EQUALS:
-		      if (strcmp(res.file, file) != 0)
-			continue;
-		      res.file = file;
-		      break;
-		    case OVAL_OPERATION_NOT_EQUAL:
-		      if (strcmp(res.file, file) == 0)
-			continue;
-		      break;
-		    case OVAL_OPERATION_PATTERN_MATCH:
-		      ret = pcre_exec(re, NULL, res.file, strlen(res.file), 0, 0, NULL, 0);
+	for (i = 0; i < count; ++i) {
+		const struct rpmverify_pkg *pkg = &idx->pkg[selected[i]->pkg];
+		struct rpmverify_res res;
 
-		      switch(ret) {
-		      case 0: /* match */
+		res.name    = pkg->name;
+		res.epoch   = pkg->epoch;
+		res.version = pkg->version;
+		res.release = pkg->release;
+		res.arch    = pkg->arch;
+		res.file    = file_op == OVAL_OPERATION_EQUALS ? file : selected[i]->path;
+		strcpy(res.extended_name, pkg->extended_name);
+		res.vflags  = vflags[i];
+		res.oflags  = omit;
+		res.fflags  = selected[i]->fflags;
+
+		if (callback(ctx, &res) != 0)
 			break;
-		      case -1:
-			/* mismatch */
-			continue;
-		      default:
-			dE("pcre_exec() failed!\n");
-			ret = -1;
-			goto ret;
-		      }
-		      break;
-		    default:
-		      /* unsupported operation */
-		      dE("Operation \"%d\" on `filepath' not supported\n", file_op);
-		      ret = -1;
-		      goto ret;
-		    }
-
-		    if (rpmVerifyFile(g_rpm.rpmts, fi, &res.vflags, omit) != 0)
-		      res.vflags = RPMVERIFY_FAILURES;
-
-		    if (callback(ctx, &res) != 0) {
-			    ret = 0;
-			    goto ret;
-		    }
-		  }
-
-		  rpmfiFree(fi);
-		}
 	}
 
-	match = rpmdbFreeIterator (match);
-	ret   = 0;
+	ret = 0;
 ret:
 	if (re != NULL)
 		pcre_free(re);
 
+	oscap_free(pkg_match);
+	oscap_free(selected);
+	oscap_free(vflags);
+
 	RPMVERIFY_UNLOCK;
 	return (ret);
 }
@@ -322,6 +511,7 @@ void *probe_init (void)
 	}
 
 	g_rpm.rpmts = rpmtsCreate();
+	g_rpm.index = NULL;
 
 	pthread_mutex_init(&(g_rpm.mutex), NULL);
 
@@ -332,6 +522,7 @@ void probe_fini (void *ptr)
 {
 	struct rpmverify_global *r = (struct rpmverify_global *)ptr;
 
+	rpmverify_index_free(r->index);
 	rpmtsFree(r->rpmts);
 	rpmFreeCrypto();
 	rpmFreeRpmrc();
@@ -342,6 +533,20 @@ void probe_fini (void *ptr)
 	return;
 }
 
+/* The rpmdb may change between sessions, build the index again next time */
+void probe_reset (void *ptr)
+{
+	struct rpmverify_global *r = (struct rpmverify_global *)ptr;
+
+	if (r == NULL)
+		return;
+
+	pthread_mutex_lock(&r->mutex);
+	rpmverify_index_free(r->index);
+	r->index = NULL;
+	pthread_mutex_unlock(&r->mutex);
+}
+
 static int rpmverify_additem(probe_ctx *ctx, struct rpmverify_res *res)
 {
 	SEXP_t *item;
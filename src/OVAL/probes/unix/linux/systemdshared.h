@@ -31,7 +31,11 @@
 #endif
 
 #include <dbus/dbus.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
 #include "common/debug_priv.h"
+#include "common/list.h"
 
 // Old versions of libdbus API don't have DBusBasicValue and DBus8ByteStruct
 // as a public typedefs.
@@ -62,170 +66,6 @@ typedef union
 	int fd;              /**< as Unix file descriptor */
 } _DBusBasicValue;
 
-static char *get_path_by_unit(DBusConnection *conn, const char *unit)
-{
-	DBusMessage *msg = NULL;
-	DBusPendingCall *pending = NULL;
-	_DBusBasicValue path;
-	char *ret = NULL;
-
-	msg = dbus_message_new_method_call(
-		"org.freedesktop.systemd1",
-		"/org/freedesktop/systemd1",
-		"org.freedesktop.systemd1.Manager",
-		// LoadUnit is similar to GetUnit except it will load the unit file
-		// if it hasn't been loaded yet.
-		"LoadUnit"
-	);
-	if (msg == NULL) {
-		dI("Failed to create dbus_message via dbus_message_new_method_call!\n");
-		goto cleanup;
-	}
-
-	DBusMessageIter args;
-
-	dbus_message_iter_init_append(msg, &args);
-	if (!dbus_message_iter_append_basic(&args, DBUS_TYPE_STRING, &unit)) {
-		dI("Failed to append unit '%s' string parameter to dbus message!\n", unit);
-		goto cleanup;
-	}
-
-	if (!dbus_connection_send_with_reply(conn, msg, &pending, -1)) {
-		dI("Failed to send message via dbus!\n");
-		goto cleanup;
-	}
-	if (pending == NULL) {
-		dI("Invalid dbus pending call!\n");
-		goto cleanup;
-	}
-
-	dbus_connection_flush(conn);
-	dbus_message_unref(msg); msg = NULL;
-
-	dbus_pending_call_block(pending);
-	msg = dbus_pending_call_steal_reply(pending);
-	if (msg == NULL) {
-		dI("Failed to steal dbus pending call reply.\n");
-		goto cleanup;
-	}
-	dbus_pending_call_unref(pending); pending = NULL;
-
-	if (!dbus_message_iter_init(msg, &args)) {
-		dI("Failed to initialize iterator over received dbus message.\n");
-		goto cleanup;
-	}
-
-	if (dbus_message_iter_get_arg_type(&args) != DBUS_TYPE_OBJECT_PATH) {
-		dI("Expected string argument in reply. Instead received: %s.\n", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&args)));
-		goto cleanup;
-	}
-
-	dbus_message_iter_get_basic(&args, &path);
-	ret = oscap_strdup(path.str);
-	dbus_message_unref(msg); msg = NULL;
-
-cleanup:
-	if (pending != NULL)
-		dbus_pending_call_unref(pending);
-
-	if (msg != NULL)
-		dbus_message_unref(msg);
-
-	return ret;
-}
-
-static int get_all_systemd_units(DBusConnection* conn, int(*callback)(const char *, void *), void *cbarg)
-{
-	DBusMessage *msg = NULL;
-	DBusPendingCall *pending = NULL;
-	char ret = 1;
-
-	msg = dbus_message_new_method_call(
-		"org.freedesktop.systemd1",
-		"/org/freedesktop/systemd1",
-		"org.freedesktop.systemd1.Manager",
-		"ListUnits"
-	);
-	if (msg == NULL) {
-		dI("Failed to create dbus_message via dbus_message_new_method_call!\n");
-		goto cleanup;
-	}
-
-	DBusMessageIter args, unit_iter;
-
-	// the args should be empty for this call
-	dbus_message_iter_init_append(msg, &args);
-
-	if (!dbus_connection_send_with_reply(conn, msg, &pending, -1)) {
-		dI("Failed to send message via dbus!\n");
-		goto cleanup;
-	}
-	if (pending == NULL) {
-		dI("Invalid dbus pending call!\n");
-		goto cleanup;
-	}
-
-	dbus_connection_flush(conn);
-	dbus_message_unref(msg); msg = NULL;
-
-	dbus_pending_call_block(pending);
-	msg = dbus_pending_call_steal_reply(pending);
-	if (msg == NULL) {
-		dI("Failed to steal dbus pending call reply.\n");
-		goto cleanup;
-	}
-	dbus_pending_call_unref(pending); pending = NULL;
-
-	if (!dbus_message_iter_init(msg, &args)) {
-		dI("Failed to initialize iterator over received dbus message.\n");
-		goto cleanup;
-	}
-
-	if (dbus_message_iter_get_arg_type(&args) != DBUS_TYPE_ARRAY) {
-		dI("Expected array of structs in reply. Instead received: %s.\n", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&args)));
-		goto cleanup;
-	}
-
-	dbus_message_iter_recurse(&args, &unit_iter);
-	do {
-		if (dbus_message_iter_get_arg_type(&unit_iter) != DBUS_TYPE_STRUCT) {
-			dI("Expected unit struct as elements in returned array. Instead received: %s.\n", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&unit_iter)));
-			goto cleanup;
-		}
-
-		DBusMessageIter unit_name;
-		dbus_message_iter_recurse(&unit_iter, &unit_name);
-
-		if (dbus_message_iter_get_arg_type(&unit_name) != DBUS_TYPE_STRING) {
-			dI("Expected string as the first element in the unit struct. Instead received: %s.\n", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&unit_name)));
-			goto cleanup;
-		}
-
-		_DBusBasicValue value;
-		dbus_message_iter_get_basic(&unit_name, &value);
-		char *unit_name_s = oscap_strdup(value.str);
-		int cbret = callback(unit_name_s, cbarg);
-		oscap_free(unit_name_s);
-		if (cbret != 0) {
-			goto cleanup;
-		}
-	}
-	while (dbus_message_iter_next(&unit_iter));
-
-	dbus_message_unref(msg); msg = NULL;
-
-	ret = 0;
-
-cleanup:
-	if (pending != NULL)
-		dbus_pending_call_unref(pending);
-
-	if (msg != NULL)
-		dbus_message_unref(msg);
-
-	return ret;
-}
-
 static char *dbus_value_to_string(DBusMessageIter *iter)
 {
 	const int arg_type = dbus_message_iter_get_arg_type(iter);
@@ -352,3 +192,430 @@ static void disconnect_dbus(DBusConnection *conn)
 	// Connections retrieved via dbus_bus_get shall not be destroyed,
 	// these connections are shared.
 }
+
+/*
+ * Walk the a{sv} reply of org.freedesktop.DBus.Properties.GetAll and call
+ * the callback for each property. Arrays are reported one element at a time.
+ */
+static int dbus_properties_foreach(DBusMessage *msg, int(*callback)(const char *name, const char *value, void *arg), void *cbarg)
+{
+	DBusMessageIter args, property_iter;
+
+	if (dbus_message_get_type(msg) == DBUS_MESSAGE_TYPE_ERROR) {
+		dI("Received dbus error reply: %s.\n", dbus_message_get_error_name(msg));
+		return 1;
+	}
+
+	if (!dbus_message_iter_init(msg, &args)) {
+		dI("Failed to initialize iterator over received dbus message.\n");
+		return 1;
+	}
+
+	if (dbus_message_iter_get_arg_type(&args) != DBUS_TYPE_ARRAY || dbus_message_iter_get_element_type(&args) != DBUS_TYPE_DICT_ENTRY) {
+		dI("Expected array of dict_entry argument in reply. Instead received: %s.\n", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&args)));
+		return 1;
+	}
+
+	dbus_message_iter_recurse(&args, &property_iter);
+	do {
+		DBusMessageIter dict_entry, value_variant;
+		dbus_message_iter_recurse(&property_iter, &dict_entry);
+
+		if (dbus_message_iter_get_arg_type(&dict_entry) != DBUS_TYPE_STRING) {
+			dI("Expected string as key in dict_entry. Instead received: %s.\n", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&dict_entry)));
+			return 1;
+		}
+
+		_DBusBasicValue value;
+		dbus_message_iter_get_basic(&dict_entry, &value);
+		char *property_name = oscap_strdup(value.str);
+
+		if (dbus_message_iter_next(&dict_entry) == false) {
+			dW("Expected another field in dict_entry.");
+			oscap_free(property_name);
+			return 1;
+		}
+
+		if (dbus_message_iter_get_arg_type(&dict_entry) != DBUS_TYPE_VARIANT) {
+			dI("Expected variant as value in dict_entry. Instead received: %s.\n", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&dict_entry)));
+			oscap_free(property_name);
+			return 1;
+		}
+
+		dbus_message_iter_recurse(&dict_entry, &value_variant);
+
+		int cbret = 0;
+		const int arg_type = dbus_message_iter_get_arg_type(&value_variant);
+		// DBUS_TYPE_ARRAY is a special case, we report each element as one value entry
+		if (arg_type == DBUS_TYPE_ARRAY) {
+			DBusMessageIter array;
+			dbus_message_iter_recurse(&value_variant, &array);
+
+			do {
+				char *element = dbus_value_to_string(&array);
+				if (element == NULL)
+					continue;
+
+				const int elementcbret = callback(property_name, element, cbarg);
+				if (elementcbret > cbret)
+					cbret = elementcbret;
+
+				oscap_free(element);
+			}
+			while (dbus_message_iter_next(&array));
+		}
+		else {
+			char *property_value = dbus_value_to_string(&value_variant);
+			cbret = callback(property_name, property_value, cbarg);
+			oscap_free(property_value);
+		}
+
+		oscap_free(property_name);
+		if (cbret != 0)
+			return 1;
+	}
+	while (dbus_message_iter_next(&property_iter));
+
+	return 0;
+}
+
+/*
+ * Snapshot of all units known to systemd together with their
+ * org.freedesktop.systemd1.Unit properties. The snapshot is taken once per
+ * probe session by the first object which needs it and every other object
+ * is served from memory. It is dropped on PROBECMD_RESET, see probe_reset().
+ */
+
+/* Number of GetAll calls waiting for a reply at the same time */
+#define SYSTEMD_PIPELINE_DEPTH 64
+
+struct systemd_property {
+	char *name;
+	char *value;
+};
+
+struct systemd_unit {
+	char *name;
+	char *path;
+	struct systemd_property *properties;
+	size_t property_count;
+	size_t property_alloc;
+};
+
+struct systemd_snapshot {
+	/*
+	 * Units are kept and reported in the order returned by ListUnits,
+	 * the hash table only serves lookups by name.
+	 */
+	struct systemd_unit *units;
+	struct oscap_htable *by_name;
+	size_t count;
+	unsigned int refs;
+};
+
+struct systemd_probe_data {
+	pthread_mutex_t lock;
+	struct systemd_snapshot *snapshot;
+};
+
+static void systemd_snapshot_free(struct systemd_snapshot *snap)
+{
+	size_t i, j;
+
+	if (snap == NULL)
+		return;
+
+	for (i = 0; i < snap->count; ++i) {
+		struct systemd_unit *unit = &snap->units[i];
+
+		for (j = 0; j < unit->property_count; ++j) {
+			oscap_free(unit->properties[j].name);
+			oscap_free(unit->properties[j].value);
+		}
+		oscap_free(unit->properties);
+		oscap_free(unit->name);
+		oscap_free(unit->path);
+	}
+	oscap_free(snap->units);
+	if (snap->by_name != NULL)
+		oscap_htable_free0(snap->by_name);
+	oscap_free(snap);
+}
+
+static DBusMessage *systemd_pending_reply(DBusPendingCall *pending)
+{
+	DBusMessage *msg;
+
+	dbus_pending_call_block(pending);
+	msg = dbus_pending_call_steal_reply(pending);
+	dbus_pending_call_unref(pending);
+
+	if (msg == NULL)
+		dI("Failed to steal dbus pending call reply.\n");
+
+	return msg;
+}
+
+static int systemd_snapshot_list_units(DBusConnection *conn, struct systemd_snapshot *snap)
+{
+	DBusMessage *msg = NULL;
+	DBusPendingCall *pending = NULL;
+	DBusMessageIter args, unit_iter;
+	size_t alloc = 0;
+	int ret = 1;
+
+	msg = dbus_message_new_method_call(
+		"org.freedesktop.systemd1",
+		"/org/freedesktop/systemd1",
+		"org.freedesktop.systemd1.Manager",
+		"ListUnits"
+	);
+	if (msg == NULL) {
+		dI("Failed to create dbus_message via dbus_message_new_method_call!\n");
+		return 1;
+	}
+
+	if (!dbus_connection_send_with_reply(conn, msg, &pending, -1) || pending == NULL) {
+		dI("Failed to send message via dbus!\n");
+		goto cleanup;
+	}
+
+	dbus_connection_flush(conn);
+	dbus_message_unref(msg);
+
+	msg = systemd_pending_reply(pending);
+	if (msg == NULL)
+		goto cleanup;
+
+	if (!dbus_message_iter_init(msg, &args)) {
+		dI("Failed to initialize iterator over received dbus message.\n");
+		goto cleanup;
+	}
+
+	if (dbus_message_iter_get_arg_type(&args) != DBUS_TYPE_ARRAY) {
+		dI("Expected array of structs in reply. Instead received: %s.\n", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&args)));
+		goto cleanup;
+	}
+
+	dbus_message_iter_recurse(&args, &unit_iter);
+	do {
+		DBusMessageIter field;
+		_DBusBasicValue value;
+		int i;
+
+		if (dbus_message_iter_get_arg_type(&unit_iter) != DBUS_TYPE_STRUCT) {
+			dI("Expected unit struct as elements in returned array. Instead received: %s.\n", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&unit_iter)));
+			goto cleanup;
+		}
+
+		dbus_message_iter_recurse(&unit_iter, &field);
+		if (dbus_message_iter_get_arg_type(&field) != DBUS_TYPE_STRING) {
+			dI("Expected string as the first element in the unit struct. Instead received: %s.\n", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&field)));
+			goto cleanup;
+		}
+
+		if (snap->count == alloc) {
+			alloc = alloc ? alloc * 2 : 128;
+			snap->units = oscap_realloc(snap->units, alloc * sizeof(struct systemd_unit));
+		}
+
+		struct systemd_unit *unit = &snap->units[snap->count++];
+		memset(unit, 0, sizeof(*unit));
+
+		dbus_message_iter_get_basic(&field, &value);
+		unit->name = oscap_strdup(value.str);
+
+		// (name, description, load state, active state, sub state,
+		//  followed unit, object path, ...)
+		for (i = 0; i < 6; ++i) {
+			if (!dbus_message_iter_next(&field))
+				break;
+		}
+		if (i == 6 && dbus_message_iter_get_arg_type(&field) == DBUS_TYPE_OBJECT_PATH) {
+			dbus_message_iter_get_basic(&field, &value);
+			unit->path = oscap_strdup(value.str);
+		}
+	}
+	while (dbus_message_iter_next(&unit_iter));
+
+	ret = 0;
+cleanup:
+	if (msg != NULL)
+		dbus_message_unref(msg);
+
+	return ret;
+}
+
+static int systemd_snapshot_property_add(const char *name, const char *value, void *arg)
+{
+	struct systemd_unit *unit = (struct systemd_unit *)arg;
+
+	if (unit->property_count == unit->property_alloc) {
+		unit->property_alloc = unit->property_alloc ? unit->property_alloc * 2 : 64;
+		unit->properties = oscap_realloc(unit->properties,
+						 unit->property_alloc * sizeof(struct systemd_property));
+	}
+
+	unit->properties[unit->property_count].name = oscap_strdup(name);
+	unit->properties[unit->property_count].value = oscap_strdup(value);
+	++unit->property_count;
+
+	return 0;
+}
+
+static DBusPendingCall *systemd_getall_send(DBusConnection *conn, const char *unit_path)
+{
+	DBusMessage *msg;
+	DBusPendingCall *pending = NULL;
+	const char *interface = "org.freedesktop.systemd1.Unit";
+
+	if (unit_path == NULL)
+		return NULL;
+
+	msg = dbus_message_new_method_call(
+		"org.freedesktop.systemd1",
+		unit_path,
+		"org.freedesktop.DBus.Properties",
+		"GetAll"
+	);
+	if (msg == NULL) {
+		dI("Failed to create dbus_message via dbus_message_new_method_call!\n");
+		return NULL;
+	}
+
+	if (!dbus_message_append_args(msg, DBUS_TYPE_STRING, &interface, DBUS_TYPE_INVALID)) {
+		dI("Failed to append interface '%s' string parameter to dbus message!\n", interface);
+	} else if (!dbus_connection_send_with_reply(conn, msg, &pending, -1)) {
+		dI("Failed to send message via dbus!\n");
+		pending = NULL;
+	}
+
+	dbus_message_unref(msg);
+	return pending;
+}
+
+/*
+ * Fetch the properties of all units. Up to SYSTEMD_PIPELINE_DEPTH calls are
+ * sent before waiting for the first reply, so the round trips to systemd
+ * overlap instead of being paid one unit after another.
+ */
+static void systemd_snapshot_load_properties(DBusConnection *conn, struct systemd_snapshot *snap)
+{
+	DBusPendingCall *pending[SYSTEMD_PIPELINE_DEPTH];
+	size_t sent = 0, done = 0;
+
+	while (done < snap->count) {
+		if (sent == done || sent - done < SYSTEMD_PIPELINE_DEPTH / 2) {
+			while (sent < snap->count && sent - done < SYSTEMD_PIPELINE_DEPTH) {
+				pending[sent % SYSTEMD_PIPELINE_DEPTH] = systemd_getall_send(conn, snap->units[sent].path);
+				++sent;
+			}
+			dbus_connection_flush(conn);
+		}
+
+		DBusPendingCall *call = pending[done % SYSTEMD_PIPELINE_DEPTH];
+		if (call != NULL) {
+			DBusMessage *msg = systemd_pending_reply(call);
+
+			if (msg != NULL) {
+				dbus_properties_foreach(msg, systemd_snapshot_property_add, &snap->units[done]);
+				dbus_message_unref(msg);
+			}
+		}
+		++done;
+	}
+}
+
+static struct systemd_snapshot *systemd_snapshot_new(DBusConnection *conn)
+{
+	struct systemd_snapshot *snap = oscap_talloc(struct systemd_snapshot);
+	size_t i;
+
+	memset(snap, 0, sizeof(*snap));
+
+	if (systemd_snapshot_list_units(conn, snap) != 0) {
+		systemd_snapshot_free(snap);
+		return NULL;
+	}
+
+	systemd_snapshot_load_properties(conn, snap);
+
+	snap->by_name = oscap_htable_new();
+	for (i = 0; i < snap->count; ++i)
+		oscap_htable_add(snap->by_name, snap->units[i].name, &snap->units[i]);
+
+	dI("systemd snapshot: %zu units\n", snap->count);
+	return snap;
+}
+
+static struct systemd_unit *systemd_snapshot_find(struct systemd_snapshot *snap, const char *name)
+{
+	return (struct systemd_unit *)oscap_htable_get(snap->by_name, name);
+}
+
+static struct systemd_probe_data *systemd_probe_data_new(void)
+{
+	struct systemd_probe_data *data = oscap_talloc(struct systemd_probe_data);
+
+	pthread_mutex_init(&data->lock, NULL);
+	data->snapshot = NULL;
+
+	return data;
+}
+
+static void systemd_probe_data_free(struct systemd_probe_data *data)
+{
+	if (data == NULL)
+		return;
+
+	systemd_snapshot_free(data->snapshot);
+	pthread_mutex_destroy(&data->lock);
+	oscap_free(data);
+}
+
+/*
+ * Return the snapshot of the current session, take it if there's none yet.
+ * The snapshot has to be returned by systemd_snapshot_put().
+ */
+static struct systemd_snapshot *systemd_snapshot_get(struct systemd_probe_data *data, DBusConnection *conn)
+{
+	struct systemd_snapshot *snap;
+
+	pthread_mutex_lock(&data->lock);
+	if (data->snapshot == NULL)
+		data->snapshot = systemd_snapshot_new(conn);
+
+	snap = data->snapshot;
+	if (snap != NULL)
+		++snap->refs;
+	pthread_mutex_unlock(&data->lock);
+
+	return snap;
+}
+
+static void systemd_snapshot_put(struct systemd_probe_data *data, struct systemd_snapshot *snap)
+{
+	pthread_mutex_lock(&data->lock);
+	if (--snap->refs == 0 && snap != data->snapshot)
+		systemd_snapshot_free(snap);
+	pthread_mutex_unlock(&data->lock);
+}
+
+/*
+ * Forget the snapshot, the next object takes a fresh one. Objects which are
+ * being collected keep the old snapshot until they are done.
+ */
+static void systemd_probe_data_reset(struct systemd_probe_data *data)
+{
+	struct systemd_snapshot *snap;
+
+	if (data == NULL)
+		return;
+
+	pthread_mutex_lock(&data->lock);
+	snap = data->snapshot;
+	data->snapshot = NULL;
+	if (snap != NULL && snap->refs == 0)
+		systemd_snapshot_free(snap);
+	pthread_mutex_unlock(&data->lock);
+}
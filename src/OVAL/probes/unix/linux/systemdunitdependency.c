@@ -36,6 +36,78 @@
 #include "common/list.h"
 #include <string.h>
 
+static char *get_path_by_unit(DBusConnection *conn, const char *unit)
+{
+	DBusMessage *msg = NULL;
+	DBusPendingCall *pending = NULL;
+	_DBusBasicValue path;
+	char *ret = NULL;
+
+	msg = dbus_message_new_method_call(
+		"org.freedesktop.systemd1",
+		"/org/freedesktop/systemd1",
+		"org.freedesktop.systemd1.Manager",
+		// LoadUnit is similar to GetUnit except it will load the unit file
+		// if it hasn't been loaded yet.
+		"LoadUnit"
+	);
+	if (msg == NULL) {
+		dI("Failed to create dbus_message via dbus_message_new_method_call!\n");
+		goto cleanup;
+	}
+
+	DBusMessageIter args;
+
+	dbus_message_iter_init_append(msg, &args);
+	if (!dbus_message_iter_append_basic(&args, DBUS_TYPE_STRING, &unit)) {
+		dI("Failed to append unit '%s' string parameter to dbus message!\n", unit);
+		goto cleanup;
+	}
+
+	if (!dbus_connection_send_with_reply(conn, msg, &pending, -1)) {
+		dI("Failed to send message via dbus!\n");
+		goto cleanup;
+	}
+	if (pending == NULL) {
+		dI("Invalid dbus pending call!\n");
+		goto cleanup;
+	}
+
+	dbus_connection_flush(conn);
+	dbus_message_unref(msg); msg = NULL;
+
+	dbus_pending_call_block(pending);
+	msg = dbus_pending_call_steal_reply(pending);
+	if (msg == NULL) {
+		dI("Failed to steal dbus pending call reply.\n");
+		goto cleanup;
+	}
+	dbus_pending_call_unref(pending); pending = NULL;
+
+	if (!dbus_message_iter_init(msg, &args)) {
+		dI("Failed to initialize iterator over received dbus message.\n");
+		goto cleanup;
+	}
+
+	if (dbus_message_iter_get_arg_type(&args) != DBUS_TYPE_OBJECT_PATH) {
+		dI("Expected string argument in reply. Instead received: %s.\n", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&args)));
+		goto cleanup;
+	}
+
+	dbus_message_iter_get_basic(&args, &path);
+	ret = oscap_strdup(path.str);
+	dbus_message_unref(msg); msg = NULL;
+
+cleanup:
+	if (pending != NULL)
+		dbus_pending_call_unref(pending);
+
+	if (msg != NULL)
+		dbus_message_unref(msg);
+
+	return ret;
+}
+
 static char *get_property_by_unit_path(DBusConnection *conn, const char *unit_path, const char *property)
 {
 	DBusMessage *msg = NULL;
@@ -115,6 +187,7 @@ cleanup:
 
 struct unit_callback_vars {
 	DBusConnection *dbus_conn;
+	struct systemd_snapshot *snapshot;
 	probe_ctx *ctx;
 	SEXP_t *unit_entity;
 };
@@ -134,67 +207,97 @@ static bool is_unit_name_a_target(const char *unit)
 	return strncmp(unit + len - suffix_len, suffix, suffix_len) == 0;
 }
 
-static void get_all_dependencies_by_unit(DBusConnection *conn, const char *unit, int(*callback)(const char *, void *), void *cbarg, bool include_requires, bool include_wants)
+/*
+ * Return the units listed in the given property of the unit as a NULL
+ * terminated array. Units from the snapshot are served from memory, units
+ * which systemd didn't list (not loaded yet) are asked for over dbus.
+ */
+static char **get_unit_dependencies(DBusConnection *conn, struct systemd_snapshot *snapshot, const char *unit, const char *property)
 {
-	if (!unit || strcmp(unit, "(null)") == 0)
+	struct systemd_unit *snapshot_unit = systemd_snapshot_find(snapshot, unit);
+	char **ret;
+	size_t i, count = 0;
+
+	if (snapshot_unit != NULL) {
+		ret = oscap_alloc((snapshot_unit->property_count + 1) * sizeof(char *));
+		for (i = 0; i < snapshot_unit->property_count; ++i) {
+			struct systemd_property *p = &snapshot_unit->properties[i];
+
+			if (strcmp(p->name, property) == 0 && p->value != NULL && p->value[0] != '\0')
+				ret[count++] = oscap_strdup(p->value);
+		}
+		ret[count] = NULL;
+		return ret;
+	}
+
+	char *path = get_path_by_unit(conn, unit);
+	char *value = path != NULL ? get_property_by_unit_path(conn, path, property) : NULL;
+	oscap_free(path);
+
+	if (value == NULL)
+		return NULL;
+
+	char **split = oscap_split(value, ", ");
+	for (i = 0; split[i] != NULL; ++i)
+		;
+	ret = oscap_alloc((i + 1) * sizeof(char *));
+	for (i = 0; split[i] != NULL; ++i) {
+		if (oscap_strcmp(split[i], "") != 0)
+			ret[count++] = oscap_strdup(split[i]);
+	}
+	ret[count] = NULL;
+
+	oscap_free(split);
+	oscap_free(value);
+	return ret;
+}
+
+static void free_unit_dependencies(char **dependencies)
+{
+	if (dependencies == NULL)
 		return;
 
+	for (int i = 0; dependencies[i] != NULL; ++i)
+		oscap_free(dependencies[i]);
+	oscap_free(dependencies);
+}
+
+static int get_all_dependencies_by_unit(DBusConnection *conn, struct systemd_snapshot *snapshot, const char *unit, int(*callback)(const char *, void *), void *cbarg, bool include_requires, bool include_wants)
+{
+	const char *properties[2];
+	int count = 0;
+
+	if (!unit || strcmp(unit, "(null)") == 0)
+		return 0;
+
 	// systemctl list-dependencies only recurses into target units
 	if (!is_unit_name_a_target(unit))
-		return;
+		return 0;
 
-	char *path = get_path_by_unit(conn, unit);
+	if (include_requires)
+		properties[count++] = "Requires";
+	if (include_wants)
+		properties[count++] = "Wants";
 
-	if (include_requires) {
-		char *requires_s = get_property_by_unit_path(conn, path, "Requires");
-		if (requires_s) {
-			char **requires = oscap_split(requires_s, ", ");
-			for (int i = 0; requires[i] != NULL; ++i) {
-				if (oscap_strcmp(requires[i], "") == 0)
-					continue;
-
-				if (callback(requires[i], cbarg) == 0) {
-					get_all_dependencies_by_unit(conn, requires[i],
-									callback, cbarg,
-									include_requires, include_wants);
-				} else {
-					oscap_free(requires);
-					oscap_free(requires_s);
-					oscap_free(path);
-					return;
-				}
-			}
-			oscap_free(requires);
-		}
-		oscap_free(requires_s);
-	}
+	for (int p = 0; p < count; ++p) {
+		char **dependencies = get_unit_dependencies(conn, snapshot, unit, properties[p]);
+
+		if (dependencies == NULL)
+			continue;
 
-	if (include_wants) {
-		char *wants_s = get_property_by_unit_path(conn, path, "Wants");
-		if (wants_s)
-		{
-			char **wants = oscap_split(wants_s, ", ");
-			for (int i = 0; wants[i] != NULL; ++i) {
-				if (oscap_strcmp(wants[i], "") == 0)
-					continue;
-
-				if (callback(wants[i], cbarg) == 0) {
-					get_all_dependencies_by_unit(conn, wants[i],
-									callback, cbarg,
-									include_requires, include_wants);
-				} else {
-					oscap_free(wants);
-					oscap_free(wants_s);
-					oscap_free(path);
-					return;
-				}
+		for (int i = 0; dependencies[i] != NULL; ++i) {
+			if (callback(dependencies[i], cbarg) != 0 ||
+			    get_all_dependencies_by_unit(conn, snapshot, dependencies[i],
+							 callback, cbarg,
+							 include_requires, include_wants) != 0) {
+				free_unit_dependencies(dependencies);
+				return 1;
 			}
-			oscap_free(wants);
 		}
-		oscap_free(wants_s);
+		free_unit_dependencies(dependencies);
 	}
 
-	oscap_free(path);
+	return 0;
 }
 
 static int dependency_callback(const char *dependency, void *cbarg)
@@ -220,7 +323,7 @@ static int unit_callback(const char *unit, void *cbarg)
 					 "unit", OVAL_DATATYPE_SEXP, se_unit,
 					 NULL);
 
-	get_all_dependencies_by_unit(vars->dbus_conn, unit,
+	get_all_dependencies_by_unit(vars->dbus_conn, vars->snapshot, unit,
 				     dependency_callback, item, true, true);
 
 	probe_item_collect(vars->ctx, item);
@@ -229,6 +332,21 @@ static int unit_callback(const char *unit, void *cbarg)
 	return 0;
 }
 
+void *probe_init(void)
+{
+	return systemd_probe_data_new();
+}
+
+void probe_fini(void *probe_arg)
+{
+	systemd_probe_data_free((struct systemd_probe_data *)probe_arg);
+}
+
+void probe_reset(void *probe_arg)
+{
+	systemd_probe_data_reset((struct systemd_probe_data *)probe_arg);
+}
+
 int probe_main(probe_ctx *ctx, void *probe_arg)
 {
 	SEXP_t *unit_entity, *probe_in;
@@ -260,8 +378,15 @@ int probe_main(probe_ctx *ctx, void *probe_arg)
 	vars.dbus_conn = dbus_conn;
 	vars.ctx = ctx;
 	vars.unit_entity = unit_entity;
+	vars.snapshot = systemd_snapshot_get((struct systemd_probe_data *)probe_arg, dbus_conn);
 
-	get_all_systemd_units(dbus_conn, unit_callback, &vars);
+	if (vars.snapshot != NULL) {
+		for (size_t i = 0; i < vars.snapshot->count; ++i) {
+			if (unit_callback(vars.snapshot->units[i].name, &vars) != 0)
+				break;
+		}
+		systemd_snapshot_put((struct systemd_probe_data *)probe_arg, vars.snapshot);
+	}
 
 	SEXP_free(unit_entity);
 	dbus_error_free(&dbus_error);
@@ -95,6 +95,14 @@ struct oval_result_definition * oval_agent_get_result_definition(oval_agent_sess
  */
 int oval_agent_reset_session(oval_agent_session_t * ag_sess);
 
+/**
+ * Query the system_info probe again and replace the system information
+ * of the agent's system characteristics. Useful when the session is going
+ * to be evaluated against another root directory (OSCAP_PROBE_ROOT).
+ * @return 0 on success; -1 error
+ */
+int oval_agent_refresh_sysinfo(oval_agent_session_t *ag_sess);
+
 /**
  * Abort a running probe session
  */
@@ -84,6 +84,26 @@ int oval_probe_query_variable(oval_probe_session_t *sess, struct oval_variable *
 
 void oval_probe_meta_list(FILE *output, int flags);
 
+/**
+ * Start recording collection statistics of every object evaluated by an
+ * external probe. One CSV line per object is appended to the file: object
+ * id, object type, wall time and probe CPU time in microseconds, number of
+ * collected items, bytes sent to and received from the probe, number and
+ * ratio of items found in the probe item cache and whether the result was
+ * taken from the probe result cache or the collection cache. When the probe
+ * session is destroyed, the result cache statistics of every probe (hits,
+ * misses, evictions, entries, bytes and the size limit) are appended as
+ * lines starting with '#'.
+ * @param path statistics file, it is truncated
+ * @return 0 on success, -1 on error
+ */
+int oval_probe_stats_open(const char *path);
+
+/**
+ * Stop recording collection statistics and close the statistics file.
+ */
+void oval_probe_stats_close(void);
+
 const char *oval_probe_ext_getdir(void);
 #endif				/* OVAL_PROBE_H */
 /// @}
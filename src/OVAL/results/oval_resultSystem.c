@@ -351,7 +351,7 @@ int oval_result_system_eval(struct oval_result_system *sys)
 	return 0;
 }
 
-int oval_result_system_eval_definition(struct oval_result_system *sys, const char *id)
+struct oval_result_definition *oval_result_system_prepare_definition(struct oval_result_system *sys, const char *id)
 {
         struct oval_results_model *res_model;
         struct oval_definition_model *definition_model;
@@ -363,7 +363,7 @@ int oval_result_system_eval_definition(struct oval_result_system *sys, const cha
 	oval_definition = oval_definition_model_get_definition(definition_model, id);
 	if (oval_definition == NULL) {
 		oscap_seterr(OSCAP_EFAMILY_OSCAP, "No definition with ID: %s in definition model.", id);
-		return -1;
+		return NULL;
 	}
 
         rslt_definition = oval_result_system_get_definition(sys, id);
@@ -378,6 +378,17 @@ int oval_result_system_eval_definition(struct oval_result_system *sys, const cha
 		oval_result_system_add_definition(sys, rslt_definition);
 	}
 
+	return rslt_definition;
+}
+
+int oval_result_system_eval_definition(struct oval_result_system *sys, const char *id)
+{
+	struct oval_result_definition *rslt_definition;
+
+	rslt_definition = oval_result_system_prepare_definition(sys, id);
+	if (rslt_definition == NULL)
+		return -1;
+
 	oval_result_definition_eval(rslt_definition);
 
 	return 0;
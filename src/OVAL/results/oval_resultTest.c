@@ -43,6 +43,7 @@
 #include "collectVarRefs_impl.h"
 #include "public/oval_types.h"
 #include "common/util.h"
+#include "common/intern.h"
 #include "common/debug_priv.h"
 #include "common/_error.h"
 
@@ -471,6 +472,7 @@ static oval_result_t eval_item(struct oval_syschar_model *syschar_model, struct
 	struct oresults ste_ores;
 	oval_operator_t operator;
 	oval_result_t result = OVAL_RESULT_ERROR;
+	char *text_ent_name = NULL;
 
 	ores_clear(&ste_ores);
 
@@ -510,7 +512,9 @@ static oval_result_t eval_item(struct oval_syschar_model *syschar_model, struct
 			oval_version_t over = oval_state_get_schema_version(state);
 			if (oval_version_cmp(over, OVAL_VERSION(5.4)) >= 0) {
 				/* The OVAL-5.3 does not have textfilecontent_item/text */
-				state_entity_name = "text";
+				if (text_ent_name == NULL)
+					text_ent_name = oscap_intern("text");
+				state_entity_name = text_ent_name;
 			}
 		}
 
@@ -533,8 +537,9 @@ static oval_result_t eval_item(struct oval_syschar_model *syschar_model, struct
 				goto fail;
 			}
 
+			/* entity names are interned, equal names share a pointer */
 			item_entity_name = oval_sysent_get_name(item_entity);
-			if (strcmp(item_entity_name, state_entity_name))
+			if (item_entity_name != state_entity_name)
 				continue;
 
 			found_matching_item = true;
@@ -562,6 +567,7 @@ static oval_result_t eval_item(struct oval_syschar_model *syschar_model, struct
 		ores_add_res(&ste_ores, ste_ent_res);
 	}
 	oval_state_content_iterator_free(state_contents_itr);
+	oscap_intern_release(text_ent_name);
 
 	operator = oval_state_get_operator(state);
 	result = ores_get_result_byopr(&ste_ores, operator);
@@ -570,6 +576,7 @@ static oval_result_t eval_item(struct oval_syschar_model *syschar_model, struct
 
  fail:
 	oval_state_content_iterator_free(state_contents_itr);
+	oscap_intern_release(text_ent_name);
 
 	return OVAL_RESULT_ERROR;
 }
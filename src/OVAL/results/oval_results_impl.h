@@ -75,6 +75,12 @@ struct oval_result_definition *oval_result_system_get_new_definition(struct oval
 								     struct oval_definition *,
 								     int variable_instance);
 struct oval_result_test *oval_result_system_get_test(struct oval_result_system *, char *);
+/**
+ * Get the result definition of definition `id', create it (and its result
+ * tests) if it doesn't exist yet for the current variable instance.
+ * The definition isn't evaluated.
+ */
+struct oval_result_definition *oval_result_system_prepare_definition(struct oval_result_system *, const char *id);
 
 struct oresults {
 	int true_cnt;
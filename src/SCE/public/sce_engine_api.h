@@ -84,6 +84,17 @@ void sce_check_result_set_exit_code(struct sce_check_result* v, int exit_code);
  */
 int sce_check_result_get_exit_code(struct sce_check_result* v);
 
+/**
+ * Sets the time (in seconds) from the start of the script until its output was collected
+ * @memberof sce_check_result
+ */
+void sce_check_result_set_wall_time(struct sce_check_result* v, double wall_time);
+
+/**
+ * @memberof sce_check_result
+ */
+double sce_check_result_get_wall_time(struct sce_check_result* v);
+
 /**
  * Clears the list of passed environment variables
  *
@@ -51,6 +51,10 @@
 #include <limits.h>
 #include <unistd.h>
 #include <libgen.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
 
 struct sce_check_result
 {
@@ -58,6 +62,7 @@ struct sce_check_result
 	char* basename;
 	char* std_out;
 	int exit_code;
+	double wall_time;
 	struct oscap_stringlist* environment_variables;
 	xccdf_test_result_type_t xccdf_result;
 };
@@ -68,6 +73,8 @@ struct sce_check_result* sce_check_result_new(void)
 	ret->href = NULL;
 	ret->basename = NULL;
 	ret->std_out = NULL;
+	ret->exit_code = 0;
+	ret->wall_time = 0;
 	ret->environment_variables = oscap_stringlist_new();
 	ret->xccdf_result = XCCDF_RESULT_UNKNOWN;
 
@@ -140,6 +147,16 @@ int sce_check_result_get_exit_code(struct sce_check_result* v)
 	return v->exit_code;
 }
 
+void sce_check_result_set_wall_time(struct sce_check_result* v, double wall_time)
+{
+	v->wall_time = wall_time;
+}
+
+double sce_check_result_get_wall_time(struct sce_check_result* v)
+{
+	return v->wall_time;
+}
+
 void sce_check_result_reset_environment_variables(struct sce_check_result* v)
 {
 	oscap_stringlist_free(v->environment_variables);
@@ -245,17 +262,90 @@ void sce_session_export_to_directory(struct sce_session* s, const char* director
 	sce_check_result_iterator_free(it);
 }
 
+#define SCE_JOBS_ENV "OSCAP_SCE_JOBS"
+#define SCE_JOBS_MAX 64
+#define SCE_JOBS_DEFAULT_MAX 8
+
+// the first 10 environment entries (0 to 9) are compiled in
+#define SCE_ENV_COMPILED_IN 10
+
+enum sce_job_state
+{
+	SCE_JOB_QUEUED,
+	SCE_JOB_RUNNING,
+	SCE_JOB_DONE
+};
+
+/*
+ * A script run by the engine. Jobs are queued in the order of the rules
+ * and at most sce_pool.jobs of them are running at the same time.
+ */
+struct sce_job
+{
+	char* href;
+	char* path;
+	char** env;
+	size_t env_count;
+	enum sce_job_state state;
+	pid_t pid;
+	int fd;
+	char* output;
+	size_t output_len;
+	size_t output_size;
+	int exit_code; // -1 if the script couldn't be started at all
+	struct timespec start;
+	double wall_time;
+	struct sce_job* next;
+};
+
+struct sce_pool
+{
+	unsigned int jobs;
+	unsigned int running;
+	struct sce_job* head;
+	struct sce_job* tail;
+};
+
 struct sce_parameters
 {
 	char* xccdf_directory;
 	struct sce_session* session;
+	struct sce_pool pool;
 };
 
+static void sce_pool_flush(struct sce_pool* pool);
+
+static unsigned int sce_jobs(void)
+{
+	const char* env = getenv(SCE_JOBS_ENV);
+	char* end;
+	long jobs;
+
+	if (env != NULL)
+	{
+		jobs = strtol(env, &end, 10);
+		if (*env == '\0' || *end != '\0' || jobs < 1)
+			return 1;
+
+		return jobs > SCE_JOBS_MAX ? SCE_JOBS_MAX : jobs;
+	}
+
+	jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	if (jobs < 1)
+		return 1;
+
+	return jobs > SCE_JOBS_DEFAULT_MAX ? SCE_JOBS_DEFAULT_MAX : jobs;
+}
+
 struct sce_parameters* sce_parameters_new(void)
 {
 	struct sce_parameters *ret = oscap_alloc(sizeof(struct sce_parameters));
 	ret->xccdf_directory = NULL;
 	ret->session = NULL;
+	ret->pool.jobs = sce_jobs();
+	ret->pool.running = 0;
+	ret->pool.head = NULL;
+	ret->pool.tail = NULL;
 
 	return ret;
 }
@@ -265,6 +355,8 @@ void sce_parameters_free(struct sce_parameters* v)
 	if (!v)
 		return;
 
+	sce_pool_flush(&v->pool);
+
 	if (v->xccdf_directory)
 		oscap_free(v->xccdf_directory);
 	if (v->session)
@@ -307,50 +399,11 @@ void sce_parameters_allocate_session(struct sce_parameters* v)
 	sce_parameters_set_session(v, sce_session_new());
 }
 
-xccdf_test_result_type_t sce_engine_eval_rule(struct xccdf_policy *policy, const char *rule_id, const char *id, const char *href,
-		struct xccdf_value_binding_iterator *value_binding_it,
-		struct xccdf_check_import_iterator *check_import_it,
-		void *usr)
+// bound values in KEY=VALUE form, ready to be passed as environment variables
+static char** sce_env_new(struct xccdf_value_binding_iterator *value_binding_it, size_t* count)
 {
-	struct sce_parameters* parameters = (struct sce_parameters*)usr;
-	const char* xccdf_directory = parameters->xccdf_directory;
-
-	char* tmp_href = oscap_sprintf("%s/%s", xccdf_directory, href);
-
-	if (access(tmp_href, F_OK))
-	{
-		// we only do this check to provide helpful error message
-		// there is an inherent race condition, the file might
-		// not exist anymore at the time we execve it!
-
-		// the script hasn't been found, perhaps another sce instance
-		// with a different XCCDF directory can find it?
-		oscap_seterr(OSCAP_EFAMILY_SCE, "SCE couldn't find script file '%s'. "
-				"Expected location: '%s'.", href, tmp_href);
-		oscap_free(tmp_href);
-		return XCCDF_RESULT_NOT_CHECKED;
-	}
-
-	if (access(tmp_href, F_OK | X_OK))
-	{
-		// again, only to provide helpful error message
-		oscap_seterr(OSCAP_EFAMILY_SCE, "SCE has found script file '%s' at '%s' "
-				"but it isn't executable!", href, tmp_href);
-		oscap_free(tmp_href);
-		return XCCDF_RESULT_ERROR;
-	}
-
-	// all the result codes are shifted by 100, because otherwise syntax errors in scripts
-	// or even their nonexistence would cause XCCDF_RESULT_PASS to be the result
-
-	char* argvp[1 + 1] = {
-		tmp_href,
-		NULL
-	};
-
-	// bound values in KEY=VALUE form, ready to be passed as environment variables
-	char ** env_values = oscap_alloc(10 * sizeof(char * ));
-	size_t env_value_count = 10;
+	char ** env_values = oscap_alloc(SCE_ENV_COMPILED_IN * sizeof(char * ));
+	size_t env_value_count = SCE_ENV_COMPILED_IN;
 
 	env_values[0] = "PATH=/bin:/sbin:/usr/bin:/usr/sbin";
 
@@ -439,141 +492,461 @@ xccdf_test_result_type_t sce_engine_eval_rule(struct xccdf_policy *policy, const
 	env_values = oscap_realloc(env_values, (env_value_count + 1) * sizeof(char*));
 	env_values[env_value_count] = NULL;
 
+	*count = env_value_count;
+	return env_values;
+}
+
+static void sce_env_free(char** env_values, size_t env_value_count)
+{
+	for (size_t i = SCE_ENV_COMPILED_IN; i < env_value_count; ++i)
+	{
+		oscap_free(env_values[i]);
+	}
+	oscap_free(env_values);
+}
+
+static bool sce_env_equal(char** a, size_t a_count, char** b, size_t b_count)
+{
+	if (a_count != b_count)
+		return false;
+
+	for (size_t i = SCE_ENV_COMPILED_IN; i < a_count; ++i)
+	{
+		if (strcmp(a[i], b[i]) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+// takes ownership of path and env_values
+static struct sce_job* sce_job_new(const char* href, char* path, char** env_values, size_t env_value_count)
+{
+	struct sce_job* ret = oscap_alloc(sizeof(struct sce_job));
+	ret->href = strdup(href);
+	ret->path = path;
+	ret->env = env_values;
+	ret->env_count = env_value_count;
+	ret->state = SCE_JOB_QUEUED;
+	ret->pid = -1;
+	ret->fd = -1;
+	ret->output = NULL;
+	ret->output_len = 0;
+	ret->output_size = 0;
+	ret->exit_code = -1;
+	ret->wall_time = 0;
+	ret->next = NULL;
+
+	return ret;
+}
+
+static void sce_job_free(struct sce_job* job)
+{
+	oscap_free(job->href);
+	oscap_free(job->path);
+	sce_env_free(job->env, job->env_count);
+	oscap_free(job->output);
+	oscap_free(job);
+}
+
+static void sce_job_spawn(struct sce_pool* pool, struct sce_job* job)
+{
 	// We open a pipe for communication with the forked process
 	int pipefd[2];
 	if (pipe(pipefd) == -1)
 	{
 		perror("pipe");
-		// the first 9 values (0 to 8) are compiled in
-		for (size_t i = 9; i < env_value_count; ++i)
-		{
-			oscap_free(env_values[i]);
-		}
-		oscap_free(env_values);
-		return XCCDF_RESULT_ERROR;
+		job->state = SCE_JOB_DONE;
+		return;
 	}
 
+	// scripts started later must not inherit the reading end, they would
+	// keep it open after we are done with this script
+	fcntl(pipefd[0], F_SETFD, FD_CLOEXEC);
+
+	clock_gettime(CLOCK_MONOTONIC, &job->start);
+
 	// FIXME: We definitely want to impose security restrictions in the forked child process in the future.
 	//        This would prevent scripts from writing to files or deleting them.
 
-	int fork_result = fork();
-	if (fork_result >= 0)
+	pid_t fork_result = fork();
+	if (fork_result < 0)
 	{
-		// fork successful
+		close(pipefd[0]);
+		close(pipefd[1]);
+		job->state = SCE_JOB_DONE;
+		return;
+	}
 
-		if (fork_result == 0)
-		{
-		    // we won't read from the pipe, so close the reading fd
-		    close(pipefd[0]);
+	if (fork_result == 0)
+	{
+		// we won't read from the pipe, so close the reading fd
+		close(pipefd[0]);
 
-		    // forward stdout and stderr to the opened pipe
-			dup2(pipefd[1], fileno(stdout));
-			dup2(pipefd[1], fileno(stderr));
+		// forward stdout and stderr to the opened pipe
+		dup2(pipefd[1], fileno(stdout));
+		dup2(pipefd[1], fileno(stderr));
 
-			// we duplicated the file description twice, we can close the original
-			// one now, stdout and stderr will be closed properly after the execved
-			// script/executable finishes
-			close(pipefd[1]);
+		// we duplicated the file description twice, we can close the original
+		// one now, stdout and stderr will be closed properly after the execved
+		// script/executable finishes
+		close(pipefd[1]);
 
-			// before we execute the script, lets make sure we get SIGTERM when
-			// oscap is killed, crashes or otherwise terminates
+		// before we execute the script, lets make sure we get SIGTERM when
+		// oscap is killed, crashes or otherwise terminates
 #ifdef PR_SET_PDEATHSIG
-			// requires Linux 2.1.57 or later
-			prctl(PR_SET_PDEATHSIG, SIGTERM);
+		// requires Linux 2.1.57 or later
+		prctl(PR_SET_PDEATHSIG, SIGTERM);
 #else
-			// TODO: Please provide alternatives
+		// TODO: Please provide alternatives
 #endif
 
-			// we are the child process
-			execve(tmp_href, argvp, env_values);
+		char* argvp[1 + 1] = {
+			job->path,
+			NULL
+		};
+
+		// we are the child process
+		execve(job->path, argvp, job->env);
+
+		// no need to check the return value of execve, if it returned at all we are in trouble
+		printf("Unexpected error when executing script '%s'. Error message follows.\n", job->href);
+		perror("execve");
+
+		// the parent process considers us a script check, we have to return a value that will mean XCCDF_RESULT_ERROR
+		exit(103);
+	}
+
+	// we won't write to the pipe, so close the writing fd
+	close(pipefd[1]);
+
+	job->pid = fork_result;
+	job->fd = pipefd[0];
+	job->state = SCE_JOB_RUNNING;
+	pool->running++;
+}
+
+// returns false once the script closed its output
+static bool sce_job_read(struct sce_job* job)
+{
+	if (job->output_size - job->output_len < 1024)
+	{
+		job->output_size = job->output_size == 0 ? 4096 : job->output_size * 2;
+		job->output = oscap_realloc(job->output, job->output_size);
+	}
+
+	ssize_t ret = read(job->fd, job->output + job->output_len, job->output_size - job->output_len - 1);
+	if (ret > 0)
+	{
+		job->output_len += ret;
+		return true;
+	}
+
+	return ret == -1 && errno == EINTR;
+}
+
+static void sce_job_finish(struct sce_pool* pool, struct sce_job* job)
+{
+	close(job->fd);
+	job->fd = -1;
+
+	int wstatus;
+	while (waitpid(job->pid, &wstatus, 0) == -1 && errno == EINTR);
+	job->exit_code = WEXITSTATUS(wstatus);
 
-			// no need to check the return value of execve, if it returned at all we are in trouble
-			printf("Unexpected error when executing script '%s'. Error message follows.\n", href);
-			perror("execve");
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	job->wall_time = (now.tv_sec - job->start.tv_sec) + (now.tv_nsec - job->start.tv_nsec) / 1e9;
 
-			// the parent process considers us a script check, we have to return a value that will mean XCCDF_RESULT_ERROR
-			exit(103);
+	job->state = SCE_JOB_DONE;
+	pool->running--;
+}
+
+// the output of the script with & escaped, the rest is handled by libxml
+static char* sce_job_get_stdout(struct sce_job* job)
+{
+	size_t amps = 0;
+	for (size_t i = 0; i < job->output_len; ++i)
+	{
+		if (job->output[i] == '&')
+			amps++;
+	}
+
+	char* ret = oscap_alloc(job->output_len + 4 * amps + 1);
+	char* dst = ret;
+	for (size_t i = 0; i < job->output_len; ++i)
+	{
+		if (job->output[i] == '&')
+		{
+			memcpy(dst, "&amp;", 5);
+			dst += 5;
 		}
 		else
-		{
-			// we won't write to the pipe, so close the writing fd
-			close(pipefd[1]);
+			*dst++ = job->output[i];
+	}
+	*dst = '\0';
 
-			char* stdout_buffer = oscap_acquire_pipe_to_string(pipefd[0]);
+	return ret;
+}
 
-			// we are the parent process
-			int wstatus;
-			waitpid(fork_result, &wstatus, 0);
+static void sce_pool_append(struct sce_pool* pool, struct sce_job* job)
+{
+	if (pool->tail)
+		pool->tail->next = job;
+	else
+		pool->head = job;
+	pool->tail = job;
+}
 
-			// we subtract 100 here to shift the exit code to xccdf_test_result_type_t enum range
-			int raw_result = WEXITSTATUS(wstatus) - 100;
-			if (raw_result <= 0 || raw_result > XCCDF_RESULT_FIXED)
-			{
-				// the script returned invalid exit code, we need to safeguard us against that
-				raw_result = XCCDF_RESULT_ERROR;
-			}
+static void sce_pool_unlink(struct sce_pool* pool, struct sce_job* job)
+{
+	struct sce_job* prev = NULL;
+	for (struct sce_job* it = pool->head; it != job; it = it->next)
+		prev = it;
 
-			struct sce_session* session = sce_parameters_get_session(parameters);
-			if (session)
-			{
-				struct sce_check_result* check_result = sce_check_result_new();
-				sce_check_result_set_href(check_result, tmp_href);
-				sce_check_result_set_basename(check_result, basename(tmp_href));
-				sce_check_result_set_stdout(check_result, stdout_buffer);
-				sce_check_result_set_exit_code(check_result, WEXITSTATUS(wstatus));
-				sce_check_result_set_xccdf_result(check_result, (xccdf_test_result_type_t)raw_result);
-
-				for (size_t i = 0; i < env_value_count; ++i)
-				{
-					sce_check_result_add_environment_variable(check_result, env_values[i]);
-				}
-
-				sce_session_add_check_result(session, check_result);
-			}
+	if (prev)
+		prev->next = job->next;
+	else
+		pool->head = job->next;
+	if (pool->tail == job)
+		pool->tail = prev;
+	job->next = NULL;
+}
 
-			// the first 10 values (0 to 9) are compiled in
-			for (size_t i = 10; i < env_value_count; ++i)
+static struct sce_job* sce_pool_find(struct sce_pool* pool, const char* path, char** env_values, size_t env_value_count)
+{
+	for (struct sce_job* it = pool->head; it != NULL; it = it->next)
+	{
+		if (strcmp(it->path, path) == 0 && sce_env_equal(it->env, it->env_count, env_values, env_value_count))
+			return it;
+	}
+
+	return NULL;
+}
+
+// start queued scripts while there are free slots, `first' goes before the others
+static void sce_pool_start(struct sce_pool* pool, struct sce_job* first)
+{
+	if (first != NULL && first->state == SCE_JOB_QUEUED && pool->running < pool->jobs)
+		sce_job_spawn(pool, first);
+
+	for (struct sce_job* it = pool->head; it != NULL && pool->running < pool->jobs; it = it->next)
+	{
+		if (it->state == SCE_JOB_QUEUED)
+			sce_job_spawn(pool, it);
+	}
+}
+
+// read the output of all running scripts until the given one is done
+static void sce_pool_wait(struct sce_pool* pool, struct sce_job* job)
+{
+	while (job->state != SCE_JOB_DONE)
+	{
+		sce_pool_start(pool, job);
+		if (pool->running == 0)
+			break;
+
+		struct pollfd fds[pool->running];
+		struct sce_job* polled[pool->running];
+		nfds_t count = 0;
+		for (struct sce_job* it = pool->head; it != NULL; it = it->next)
+		{
+			if (it->state == SCE_JOB_RUNNING)
 			{
-				oscap_free(env_values[i]);
+				fds[count].fd = it->fd;
+				fds[count].events = POLLIN;
+				polled[count] = it;
+				count++;
 			}
-			oscap_free(env_values);
+		}
 
-			// lets interpret the check imports passed to us
-			xccdf_check_import_iterator_reset(check_import_it);
-			while (xccdf_check_import_iterator_has_more(check_import_it))
-			{
-				struct xccdf_check_import * check_import = xccdf_check_import_iterator_next(check_import_it);
-				const char *name = xccdf_check_import_get_name(check_import);
+		if (poll(fds, count, -1) == -1)
+		{
+			if (errno == EINTR)
+				continue;
 
-				if (strcmp(name, "stdout") == 0)
-				{
-					xccdf_check_import_set_content(check_import, stdout_buffer);
-				}
-			}
+			// fall back to reading the scripts one by one
+			perror("poll");
+			for (nfds_t i = 0; i < count; ++i)
+				fds[i].revents = POLLIN;
+		}
+
+		for (nfds_t i = 0; i < count; ++i)
+		{
+			if (fds[i].revents != 0 && !sce_job_read(polled[i]))
+				sce_job_finish(pool, polled[i]);
+		}
+	}
+}
 
-			oscap_free(tmp_href);
-			oscap_free(stdout_buffer);
+// drop all jobs, the running scripts are terminated
+static void sce_pool_flush(struct sce_pool* pool)
+{
+	while (pool->head != NULL)
+	{
+		struct sce_job* job = pool->head;
+		pool->head = job->next;
 
-			return (xccdf_test_result_type_t)raw_result;
+		if (job->state == SCE_JOB_RUNNING)
+		{
+			kill(job->pid, SIGTERM);
+			sce_job_finish(pool, job);
 		}
+		sce_job_free(job);
+	}
+	pool->tail = NULL;
+}
+
+static void sce_engine_prefetch_rule(struct xccdf_policy *policy, const char *id, const char *href,
+		struct xccdf_value_binding_iterator *value_binding_it, void *usr)
+{
+	struct sce_parameters* parameters = (struct sce_parameters*)usr;
+
+	if (href == NULL)
+	{
+		// the evaluation is over, drop the scripts nobody asked for
+		sce_pool_flush(&parameters->pool);
+		return;
+	}
+
+	char* tmp_href = oscap_sprintf("%s/%s", parameters->xccdf_directory, href);
+
+	// scripts which can't be executed are left for sce_engine_eval_rule to report
+	if (access(tmp_href, F_OK | X_OK))
+	{
+		oscap_free(tmp_href);
+		return;
+	}
+
+	size_t env_value_count;
+	char** env_values = sce_env_new(value_binding_it, &env_value_count);
+
+	sce_pool_append(&parameters->pool, sce_job_new(href, tmp_href, env_values, env_value_count));
+	sce_pool_start(&parameters->pool, NULL);
+}
+
+xccdf_test_result_type_t sce_engine_eval_rule(struct xccdf_policy *policy, const char *rule_id, const char *id, const char *href,
+		struct xccdf_value_binding_iterator *value_binding_it,
+		struct xccdf_check_import_iterator *check_import_it,
+		void *usr)
+{
+	struct sce_parameters* parameters = (struct sce_parameters*)usr;
+	const char* xccdf_directory = parameters->xccdf_directory;
+
+	char* tmp_href = oscap_sprintf("%s/%s", xccdf_directory, href);
+
+	if (access(tmp_href, F_OK))
+	{
+		// we only do this check to provide helpful error message
+		// there is an inherent race condition, the file might
+		// not exist anymore at the time we execve it!
+
+		// the script hasn't been found, perhaps another sce instance
+		// with a different XCCDF directory can find it?
+		oscap_seterr(OSCAP_EFAMILY_SCE, "SCE couldn't find script file '%s'. "
+				"Expected location: '%s'.", href, tmp_href);
+		oscap_free(tmp_href);
+		return XCCDF_RESULT_NOT_CHECKED;
+	}
+
+	if (access(tmp_href, F_OK | X_OK))
+	{
+		// again, only to provide helpful error message
+		oscap_seterr(OSCAP_EFAMILY_SCE, "SCE has found script file '%s' at '%s' "
+				"but it isn't executable!", href, tmp_href);
+		oscap_free(tmp_href);
+		return XCCDF_RESULT_ERROR;
+	}
+
+	// all the result codes are shifted by 100, because otherwise syntax errors in scripts
+	// or even their nonexistence would cause XCCDF_RESULT_PASS to be the result
+
+	size_t env_value_count;
+	char** env_values = sce_env_new(value_binding_it, &env_value_count);
+
+	struct sce_pool* pool = &parameters->pool;
+	struct sce_job* job = sce_pool_find(pool, tmp_href, env_values, env_value_count);
+	if (job != NULL)
+	{
+		// the script has been started by sce_engine_prefetch_rule already
+		sce_env_free(env_values, env_value_count);
+		oscap_free(tmp_href);
 	}
 	else
 	{
-		// the first 9 values (0 to 8) are compiled in
-		for (size_t i = 9; i < env_value_count; ++i)
+		job = sce_job_new(href, tmp_href, env_values, env_value_count);
+		sce_pool_append(pool, job);
+	}
+
+	sce_pool_wait(pool, job);
+	sce_pool_unlink(pool, job);
+
+	if (job->exit_code == -1)
+	{
+		// neither pipe nor fork worked out
+		sce_job_free(job);
+		return XCCDF_RESULT_ERROR;
+	}
+
+	char* stdout_buffer = sce_job_get_stdout(job);
+
+	// we subtract 100 here to shift the exit code to xccdf_test_result_type_t enum range
+	int raw_result = job->exit_code - 100;
+	if (raw_result <= 0 || raw_result > XCCDF_RESULT_FIXED)
+	{
+		// the script returned invalid exit code, we need to safeguard us against that
+		raw_result = XCCDF_RESULT_ERROR;
+	}
+
+	struct sce_session* session = sce_parameters_get_session(parameters);
+	if (session)
+	{
+		struct sce_check_result* check_result = sce_check_result_new();
+		sce_check_result_set_href(check_result, job->path);
+		sce_check_result_set_basename(check_result, basename(job->path));
+		sce_check_result_set_stdout(check_result, stdout_buffer);
+		sce_check_result_set_exit_code(check_result, job->exit_code);
+		sce_check_result_set_wall_time(check_result, job->wall_time);
+		sce_check_result_set_xccdf_result(check_result, (xccdf_test_result_type_t)raw_result);
+
+		for (size_t i = 0; i < job->env_count; ++i)
 		{
-			oscap_free(env_values[i]);
+			sce_check_result_add_environment_variable(check_result, job->env[i]);
 		}
-		oscap_free(env_values);
 
-		close(pipefd[0]);
-		close(pipefd[1]);
-		return XCCDF_RESULT_ERROR;
+		sce_session_add_check_result(session, check_result);
+	}
+
+	sce_job_free(job);
+
+	// lets interpret the check imports passed to us
+	xccdf_check_import_iterator_reset(check_import_it);
+	while (xccdf_check_import_iterator_has_more(check_import_it))
+	{
+		struct xccdf_check_import * check_import = xccdf_check_import_iterator_next(check_import_it);
+		const char *name = xccdf_check_import_get_name(check_import);
+
+		if (strcmp(name, "stdout") == 0)
+		{
+			xccdf_check_import_set_content(check_import, stdout_buffer);
+		}
 	}
+
+	oscap_free(stdout_buffer);
+
+	return (xccdf_test_result_type_t)raw_result;
 }
 
 bool xccdf_policy_model_register_engine_sce(struct xccdf_policy_model * model, struct sce_parameters *parameters)
 {
-	return xccdf_policy_model_register_engine_and_query_callback(model,
-		"http://open-scap.org/page/SCE", sce_engine_eval_rule, (void*)parameters, NULL);
+	if (!xccdf_policy_model_register_engine_and_query_callback(model,
+			"http://open-scap.org/page/SCE", sce_engine_eval_rule, (void*)parameters, NULL))
+		return false;
+
+	// with a single job there is nothing to gain by starting the scripts ahead of time
+	if (parameters->pool.jobs > 1)
+		xccdf_policy_model_register_engine_prefetch(model,
+			"http://open-scap.org/page/SCE", (void*)parameters, sce_engine_prefetch_rule);
+
+	return true;
 }
@@ -94,6 +94,15 @@ struct xccdf_benchmark *xccdf_benchmark_import_source(struct oscap_source *sourc
 	return benchmark;
 }
 
+struct xccdf_benchmark *xccdf_benchmark_import_source_lazy(struct oscap_source *source)
+{
+	/* The reader walks the document of the source, the texts keep its elements. */
+	bool previous = oscap_text_set_lazy_parse(true);
+	struct xccdf_benchmark *benchmark = xccdf_benchmark_import_source(source);
+	oscap_text_set_lazy_parse(previous);
+	return benchmark;
+}
+
 struct xccdf_benchmark *xccdf_benchmark_new(void)
 {
 	struct xccdf_item *bench = xccdf_item_new(XCCDF_BENCHMARK, NULL);
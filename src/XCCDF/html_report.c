@@ -0,0 +1,1035 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <libxml/tree.h>
+
+#include <oscap.h>
+#include <oscap_text.h>
+#include <oscap_reference.h>
+#include <oscap_source.h>
+#include <OVAL/public/oval_results.h>
+#include <OVAL/public/oval_system_characteristics.h>
+
+#include "common/_error.h"
+#include "common/list.h"
+#include "common/oscapxml.h"
+#include "common/util.h"
+#include "source/oscap_source_priv.h"
+#include "XCCDF_POLICY/xccdf_policy_priv.h"
+#include "helpers.h"
+#include "item.h"
+#include "html_report_priv.h"
+
+/* Maximum number of OVAL items shown for one test, same as in xccdf-report-oval-details.xsl */
+#define HTML_REPORT_MAX_ITEMS 100
+
+struct html_report_counts {
+	unsigned int fail;
+	unsigned int error;
+	unsigned int unknown;
+	unsigned int notchecked;
+};
+
+struct html_report {
+	FILE *fp;
+	struct xccdf_policy *policy;
+	struct xccdf_benchmark *benchmark;
+	struct xccdf_result *result;
+	struct oval_agent_session **agents;
+	struct oscap_htable *rule_results;	///< rule id -> xccdf_rule_result
+	struct oscap_htable *group_counts;	///< group id -> html_report_counts
+	unsigned int rule_result_seq;		///< sequence used to give each rule-result an unique HTML id
+};
+
+static void _html_escape(FILE *fp, const char *str)
+{
+	if (str == NULL)
+		return;
+
+	for (const char *c = str; *c != '\0'; ++c) {
+		switch (*c) {
+		case '&': fputs("&amp;", fp); break;
+		case '<': fputs("&lt;", fp); break;
+		case '>': fputs("&gt;", fp); break;
+		case '"': fputs("&quot;", fp); break;
+		case '\'': fputs("&#39;", fp); break;
+		default: fputc(*c, fp);
+		}
+	}
+}
+
+/* Escape string so it can be placed to a JSON string literal inside an HTML attribute. */
+static void _html_json_escape(FILE *fp, const char *str)
+{
+	if (str == NULL)
+		return;
+
+	for (const char *c = str; *c != '\0'; ++c) {
+		if (*c == '"' || *c == '\\')
+			fputs(*c == '"' ? "\\&quot;" : "\\\\", fp);
+		else if (*c == '&')
+			fputs("&amp;", fp);
+		else if (*c == '<')
+			fputs("&lt;", fp);
+		else if (*c == '\'')
+			fputs("&#39;", fp);
+		else
+			fputc(*c, fp);
+	}
+}
+
+/* Write an oscap_text. XHTML content is written as is after xccdf:sub substitution. */
+static void _html_write_text(struct html_report *report, const struct oscap_text *text)
+{
+	if (text == NULL)
+		return;
+
+	if (!oscap_text_get_is_html(text)) {
+		_html_escape(report->fp, oscap_text_get_text(text));
+		return;
+	}
+
+	char *resolved = NULL;
+	if (report->policy != NULL && oscap_text_get_can_substitute(text))
+		resolved = xccdf_policy_substitute(oscap_text_get_text(text), report->policy);
+	fputs(resolved != NULL ? resolved : oscap_text_get_text(text), report->fp);
+	oscap_free(resolved);
+}
+
+static void _html_write_textlist(struct html_report *report, struct oscap_text_iterator *texts)
+{
+	_html_write_text(report, oscap_textlist_get_preferred_text(texts, NULL));
+	oscap_text_iterator_free(texts);
+}
+
+static void _html_write_item_title(struct html_report *report, const struct xccdf_item *item)
+{
+	char *title = oscap_textlist_get_preferred_plaintext(xccdf_item_get_title(item), NULL);
+	_html_escape(report->fp, title != NULL ? title : xccdf_item_get_id(item));
+	oscap_free(title);
+}
+
+/*
+ * CSS and JavaScript bundled with the report are kept in xccdf-resources.xsl
+ * so that both report engines share the very same copy of them.
+ */
+static int _html_write_resources(FILE *fp)
+{
+	char *path = oscap_sprintf("%s/%s", oscap_path_to_xslt(), "xccdf-resources.xsl");
+	struct oscap_source *source = oscap_source_new_from_file(path);
+	oscap_free(path);
+	xmlDoc *doc = oscap_source_get_xmlDoc(source);
+	if (doc == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_XML, "Could not read report resources from '%s'",
+				oscap_source_readable_origin(source));
+		oscap_source_free(source);
+		return -1;
+	}
+
+	char *css = NULL, *js = NULL;
+	for (xmlNode *node = xmlDocGetRootElement(doc)->children; node != NULL; node = node->next) {
+		if (node->type != XML_ELEMENT_NODE)
+			continue;
+		char *name = (char *) xmlGetProp(node, BAD_CAST "name");
+		if (oscap_streq(name, "css-sources") && css == NULL)
+			css = (char *) xmlNodeGetContent(node);
+		else if (oscap_streq(name, "js-sources") && js == NULL)
+			js = (char *) xmlNodeGetContent(node);
+		xmlFree(name);
+	}
+	oscap_source_free(source);
+
+	fprintf(fp, "<style>%s</style>\n<script>%s</script>\n", css != NULL ? css : "", js != NULL ? js : "");
+	xmlFree(css);
+	xmlFree(js);
+	return 0;
+}
+
+static const char *_html_rule_result_text(struct html_report *report, const char *rule_id)
+{
+	struct xccdf_rule_result *rr = oscap_htable_get(report->rule_results, rule_id);
+	return rr == NULL ? "" : xccdf_test_result_type_get_text(xccdf_rule_result_get_result(rr));
+}
+
+static const char *_html_rule_result_severity(struct xccdf_rule_result *rr)
+{
+	const char *severity = rr == NULL ? NULL : oscap_enum_to_string(XCCDF_LEVEL_MAP, xccdf_rule_result_get_severity(rr));
+	return severity != NULL ? severity : "";
+}
+
+static const char *_html_rule_result_tooltip(xccdf_test_result_type_t result)
+{
+	switch (result) {
+	case XCCDF_RESULT_PASS:
+		return "The target system or system component satisfied all the conditions of the rule.";
+	case XCCDF_RESULT_FAIL:
+		return "The target system or system component did not satisfy every condition of the rule.";
+	case XCCDF_RESULT_ERROR:
+		return "The checking engine could not complete the evaluation, therefore the status of the target's compliance with the rule is not certain. This could happen, for example, if a testing tool was run with insufficient privileges and could not gather all of the necessary information.";
+	case XCCDF_RESULT_UNKNOWN:
+		return "The testing tool encountered some problem and the result is unknown.";
+	case XCCDF_RESULT_NOT_APPLICABLE:
+		return "The rule was not applicable to the target machine of the test. For example, the rule might have been specific to a different version of the target OS, or it might have been a test against a platform feature that was not installed.";
+	case XCCDF_RESULT_NOT_CHECKED:
+		return "The rule was not evaluated by the checking engine. This status is designed for rules that have no check properties or have check properties with unsupported check system.";
+	case XCCDF_RESULT_NOT_SELECTED:
+		return "The rule was not selected in the benchmark.";
+	case XCCDF_RESULT_INFORMATIONAL:
+		return "The rule was checked, but the output from the checking engine is simply information for auditors or administrators; it is not a compliance category.";
+	case XCCDF_RESULT_FIXED:
+		return "The rule had failed, but was then fixed (possibly by a tool that can automatically apply remediation, or possibly by the human auditor).";
+	default:
+		return "";
+	}
+}
+
+static void _html_count_result(struct html_report_counts *counts, xccdf_test_result_type_t result)
+{
+	switch (result) {
+	case XCCDF_RESULT_FAIL: counts->fail++; break;
+	case XCCDF_RESULT_ERROR: counts->error++; break;
+	case XCCDF_RESULT_UNKNOWN: counts->unknown++; break;
+	case XCCDF_RESULT_NOT_CHECKED: counts->notchecked++; break;
+	default: break;
+	}
+}
+
+/* Single post-order pass computing the number of problematic rules under every group. */
+static void _html_count_contained(struct html_report *report, struct xccdf_item_iterator *content, struct html_report_counts *counts)
+{
+	while (xccdf_item_iterator_has_more(content)) {
+		struct xccdf_item *item = xccdf_item_iterator_next(content);
+		if (xccdf_item_get_type(item) == XCCDF_RULE) {
+			struct xccdf_rule_result *rr = oscap_htable_get(report->rule_results, xccdf_item_get_id(item));
+			if (rr != NULL)
+				_html_count_result(counts, xccdf_rule_result_get_result(rr));
+		} else if (xccdf_item_get_type(item) == XCCDF_GROUP) {
+			struct html_report_counts *group = oscap_calloc(1, sizeof(struct html_report_counts));
+			_html_count_contained(report, xccdf_group_get_content(XGROUP(item)), group);
+			counts->fail += group->fail;
+			counts->error += group->error;
+			counts->unknown += group->unknown;
+			counts->notchecked += group->notchecked;
+			if (!oscap_htable_add(report->group_counts, xccdf_item_get_id(item), group))
+				oscap_free(group);
+		}
+	}
+	xccdf_item_iterator_free(content);
+}
+
+static void _html_write_header(struct html_report *report)
+{
+	FILE *fp = report->fp;
+
+	fputs("<!DOCTYPE html>\n<html lang=\"en\"><head>\n"
+		"<meta charset=\"utf-8\"/>\n"
+		"<meta http-equiv=\"X-UA-Compatible\" content=\"IE=edge\"/>\n"
+		"<meta name=\"viewport\" content=\"width=device-width, initial-scale=1\"/>\n"
+		"<title>", fp);
+	_html_escape(fp, xccdf_result_get_id(report->result));
+	fputs(" | OpenSCAP Evaluation Report</title>\n", fp);
+}
+
+static void _html_write_introduction(struct html_report *report, struct xccdf_profile *profile)
+{
+	FILE *fp = report->fp;
+
+	fputs("<div id=\"introduction\"><div class=\"row\">\n<h2>", fp);
+	_html_write_textlist(report, xccdf_benchmark_get_title(report->benchmark));
+	fputs("</h2>\n", fp);
+	if (profile != NULL) {
+		fputs("<blockquote>with profile <mark>", fp);
+		_html_write_textlist(report, xccdf_profile_get_title(profile));
+		fputs("</mark>\n<div class=\"col-md-12 well well-lg\">", fp);
+		_html_write_textlist(report, xccdf_profile_get_description(profile));
+		fputs("</div></blockquote>\n", fp);
+	}
+	fputs("<div class=\"col-md-12 well well-lg\"><div class=\"description\">", fp);
+	_html_write_textlist(report, xccdf_benchmark_get_description(report->benchmark));
+	fputs("</div></div>\n</div></div>\n", fp);
+}
+
+static void _html_write_characteristics(struct html_report *report)
+{
+	FILE *fp = report->fp;
+	struct xccdf_result *result = report->result;
+
+	fputs("<div id=\"characteristics\"><h2>Evaluation Characteristics</h2><div class=\"row\">\n"
+		"<div class=\"col-md-5 well well-lg horizontal-scroll\"><table class=\"table table-bordered\">\n"
+		"<tr><th>Target machine</th><td>", fp);
+	struct oscap_string_iterator *targets = xccdf_result_get_targets(result);
+	if (oscap_string_iterator_has_more(targets))
+		_html_escape(fp, oscap_string_iterator_next(targets));
+	oscap_string_iterator_free(targets);
+	fputs("</td></tr>\n", fp);
+
+	if (xccdf_result_get_benchmark_uri(result) != NULL) {
+		fputs("<tr><th>Benchmark URL</th><td>", fp);
+		_html_escape(fp, xccdf_result_get_benchmark_uri(result));
+		fputs("</td></tr>\n<tr><th>Benchmark ID</th><td>", fp);
+		_html_escape(fp, xccdf_benchmark_get_id(report->benchmark));
+		fputs("</td></tr>\n", fp);
+	}
+	if (xccdf_result_get_profile(result) != NULL) {
+		fputs("<tr><th>Profile ID</th><td>", fp);
+		_html_escape(fp, xccdf_result_get_profile(result));
+		fputs("</td></tr>\n", fp);
+	}
+
+	fputs("<tr><th>Started at</th><td>", fp);
+	_html_escape(fp, xccdf_result_get_start_time(result) != NULL ? xccdf_result_get_start_time(result) : "unknown time");
+	fputs("</td></tr>\n<tr><th>Finished at</th><td>", fp);
+	_html_escape(fp, xccdf_result_get_end_time(result));
+	fputs("</td></tr>\n<tr><th>Performed by</th><td>", fp);
+	struct xccdf_identity_iterator *identities = xccdf_result_get_identities(result);
+	if (xccdf_identity_iterator_has_more(identities))
+		_html_escape(fp, xccdf_identity_get_name(xccdf_identity_iterator_next(identities)));
+	else
+		fputs("unknown user", fp);
+	xccdf_identity_iterator_free(identities);
+	fputs("</td></tr>\n</table></div>\n", fp);
+
+	/* applicable platforms first, then the rest */
+	fputs("<div class=\"col-md-3 horizontal-scroll\"><h4>CPE Platforms</h4><ul class=\"list-group\">\n", fp);
+	for (int applicable = 1; applicable >= 0; --applicable) {
+		struct oscap_string_iterator *platforms = xccdf_benchmark_get_platforms(report->benchmark);
+		while (oscap_string_iterator_has_more(platforms)) {
+			const char *platform = oscap_string_iterator_next(platforms);
+			bool found = false;
+			struct oscap_string_iterator *tested = xccdf_result_get_platforms(result);
+			while (!found && oscap_string_iterator_has_more(tested))
+				found = oscap_streq(platform, oscap_string_iterator_next(tested));
+			oscap_string_iterator_free(tested);
+			if (found != (applicable == 1))
+				continue;
+
+			fputs("<li class=\"list-group-item\">", fp);
+			if (found) {
+				fputs("<span class=\"label label-success\" title=\"CPE platform ", fp);
+				_html_escape(fp, platform);
+				fputs(" was found applicable on the evaluated machine\">", fp);
+			} else
+				fputs("<span class=\"label label-default\" title=\"This CPE platform was not applicable on the evaluated machine\">", fp);
+			_html_escape(fp, platform);
+			fputs("</span></li>\n", fp);
+		}
+		oscap_string_iterator_free(platforms);
+	}
+	fputs("</ul></div>\n", fp);
+
+	fputs("<div class=\"col-md-4 horizontal-scroll\"><h4>Addresses</h4><ul class=\"list-group\">\n", fp);
+	struct oscap_htable *seen = oscap_htable_new();
+	struct oscap_string_iterator *addresses = xccdf_result_get_target_addresses(result);
+	while (oscap_string_iterator_has_more(addresses)) {
+		const char *address = oscap_string_iterator_next(addresses);
+		if (!oscap_htable_add(seen, address, (void *) address))
+			continue;
+		fputs("<li class=\"list-group-item\">", fp);
+		if (strchr(address, ':') != NULL)
+			fputs("<span class=\"label label-info\">IPv6</span>", fp);
+		else if (strchr(address, '.') != NULL)
+			fputs("<span class=\"label label-primary\">IPv4</span>", fp);
+		fputs("&#160;", fp);
+		_html_escape(fp, address);
+		fputs("</li>\n", fp);
+	}
+	oscap_string_iterator_free(addresses);
+	struct xccdf_target_fact_iterator *facts = xccdf_result_get_target_facts(result);
+	while (xccdf_target_fact_iterator_has_more(facts)) {
+		struct xccdf_target_fact *fact = xccdf_target_fact_iterator_next(facts);
+		const char *mac = xccdf_target_fact_get_value(fact);
+		if (!oscap_streq(xccdf_target_fact_get_name(fact), "urn:xccdf:fact:ethernet:MAC") || mac == NULL ||
+				!oscap_htable_add(seen, mac, (void *) mac))
+			continue;
+		fputs("<li class=\"list-group-item\"><span class=\"label label-default\">MAC</span>&#160;", fp);
+		_html_escape(fp, mac);
+		fputs("</li>\n", fp);
+	}
+	xccdf_target_fact_iterator_free(facts);
+	oscap_htable_free0(seen);
+	fputs("</ul></div>\n</div></div>\n", fp);
+}
+
+static void _html_write_progress_bar(FILE *fp, const char *class, unsigned int count, unsigned int total, const char *label)
+{
+	fprintf(fp, "<div class=\"progress-bar progress-bar-%s\" style=\"width: %f%%\">%u %s</div>\n",
+			class, total == 0 ? 0.0 : (double) count / total * 100, count, label);
+}
+
+static void _html_write_compliance_and_scoring(struct html_report *report)
+{
+	FILE *fp = report->fp;
+	unsigned int total = 0, ignored = 0, passed = 0, failed = 0, uncertain = 0;
+	unsigned int high = 0, medium = 0, low = 0;
+
+	struct xccdf_rule_result_iterator *rr_it = xccdf_result_get_rule_results(report->result);
+	while (xccdf_rule_result_iterator_has_more(rr_it)) {
+		struct xccdf_rule_result *rr = xccdf_rule_result_iterator_next(rr_it);
+		total++;
+		switch (xccdf_rule_result_get_result(rr)) {
+		case XCCDF_RESULT_NOT_SELECTED:
+		case XCCDF_RESULT_NOT_APPLICABLE:
+			ignored++;
+			break;
+		case XCCDF_RESULT_PASS:
+		case XCCDF_RESULT_FIXED:
+			passed++;
+			break;
+		case XCCDF_RESULT_FAIL:
+			failed++;
+			switch (xccdf_rule_result_get_severity(rr)) {
+			case XCCDF_HIGH: high++; break;
+			case XCCDF_MEDIUM: medium++; break;
+			case XCCDF_LOW: low++; break;
+			default: break;
+			}
+			break;
+		case XCCDF_RESULT_ERROR:
+		case XCCDF_RESULT_UNKNOWN:
+			uncertain++;
+			break;
+		default:
+			break;
+		}
+	}
+	xccdf_rule_result_iterator_free(rr_it);
+
+	fputs("<div id=\"compliance-and-scoring\"><h2>Compliance and Scoring</h2>\n", fp);
+	if (failed > 0) {
+		fprintf(fp, "<div class=\"alert alert-danger\"><strong>The target system did not satisfy the conditions of %u rules!</strong>", failed);
+		if (uncertain > 0)
+			fprintf(fp, " Furthermore, the results of %u rules were inconclusive.", uncertain);
+		fputs(" Please review rule results and consider applying remediation.</div>\n", fp);
+	} else if (uncertain > 0) {
+		fprintf(fp, "<div class=\"alert alert-warning\"><strong>There were no failed rules, but the results of %u rules were inconclusive!</strong>"
+			" Please review rule results and consider applying remediation.</div>\n", uncertain);
+	} else {
+		fputs("<div class=\"alert alert-success\"><strong>There were no failed or uncertain rules.</strong> It seems that no action is necessary.</div>\n", fp);
+	}
+
+	unsigned int considered = total - ignored;
+	fprintf(fp, "<h3>Rule results</h3>\n<div class=\"progress\" title=\"Displays proportion of passed/fixed, failed/error, "
+		"and other rules (in that order). There were %u rules taken into account.\">\n", considered);
+	_html_write_progress_bar(fp, "success", passed, considered, "passed");
+	_html_write_progress_bar(fp, "danger", failed, considered, "failed");
+	_html_write_progress_bar(fp, "warning", considered - passed - failed, considered, "other");
+	fputs("</div>\n", fp);
+
+	fprintf(fp, "<h3>Severity of failed rules</h3>\n<div class=\"progress\" title=\"Displays proportion of high, medium, low, "
+		"and other severity failed rules (in that order). There were %u total failed rules.\">\n", failed);
+	_html_write_progress_bar(fp, "success", failed - high - medium - low, failed, "other");
+	_html_write_progress_bar(fp, "info", low, failed, "low");
+	_html_write_progress_bar(fp, "warning", medium, failed, "medium");
+	_html_write_progress_bar(fp, "danger", high, failed, "high");
+	fputs("</div>\n", fp);
+
+	fputs("<h3 title=\"As per the XCCDF specification\">Score</h3>\n<table class=\"table table-striped table-bordered\">"
+		"<thead><tr><th>Scoring system</th><th class=\"text-center\">Score</th><th class=\"text-center\">Maximum</th>"
+		"<th class=\"text-center\" style=\"width: 40%\">Percent</th></tr></thead>\n<tbody>\n", fp);
+	struct xccdf_score_iterator *scores = xccdf_result_get_scores(report->result);
+	while (xccdf_score_iterator_has_more(scores)) {
+		struct xccdf_score *score = xccdf_score_iterator_next(scores);
+		float maximum = xccdf_score_get_maximum(score);
+		float percent = maximum == 0 ? 0 : xccdf_score_get_score(score) / maximum * 100;
+		fputs("<tr><td>", fp);
+		_html_escape(fp, xccdf_score_get_system(score));
+		fprintf(fp, "</td><td class=\"text-center\">%f</td><td class=\"text-center\">%f</td><td><div class=\"progress\">"
+			"<div class=\"progress-bar progress-bar-success\" style=\"width: %f%%\">", xccdf_score_get_score(score), maximum, percent);
+		if (percent >= 50)
+			fprintf(fp, "%.2f%%", percent);
+		fprintf(fp, "</div><div class=\"progress-bar progress-bar-danger\" style=\"width: %f%%\">", 100 - percent);
+		if (percent < 50)
+			fprintf(fp, "%.2f%%", percent);
+		fputs("</div></div></td></tr>\n", fp);
+	}
+	xccdf_score_iterator_free(scores);
+	fputs("</tbody></table></div>\n", fp);
+}
+
+static void _html_write_references_json(struct html_report *report, struct xccdf_item *item)
+{
+	/* collect references grouped by href, keeping the order of their first appearance */
+	struct oscap_htable *by_href = oscap_htable_new();
+	struct oscap_list *hrefs = oscap_list_new();
+	struct oscap_reference_iterator *refs = xccdf_item_get_references(item);
+	while (oscap_reference_iterator_has_more(refs)) {
+		struct oscap_reference *ref = oscap_reference_iterator_next(refs);
+		const char *href = oscap_reference_get_href(ref);
+		if (href == NULL || *href == '\0')
+			continue;
+		struct oscap_list *group = oscap_htable_get(by_href, href);
+		if (group == NULL) {
+			group = oscap_list_new();
+			oscap_htable_add(by_href, href, group);
+			oscap_list_add(hrefs, (void *) href);
+		}
+		oscap_list_add(group, ref);
+	}
+	oscap_reference_iterator_free(refs);
+
+	fputc('{', report->fp);
+	struct oscap_iterator *href_it = oscap_iterator_new(hrefs);
+	for (bool first = true; oscap_iterator_has_more(href_it); first = false) {
+		const char *href = oscap_iterator_next(href_it);
+		fprintf(report->fp, "%s&quot;", first ? "" : ",");
+		_html_json_escape(report->fp, href);
+		fputs("&quot;:[", report->fp);
+		struct oscap_iterator *ref_it = oscap_iterator_new(oscap_htable_get(by_href, href));
+		for (bool first_ref = true; oscap_iterator_has_more(ref_it); first_ref = false) {
+			const char *title = oscap_reference_get_title(oscap_iterator_next(ref_it));
+			fprintf(report->fp, "%s&quot;", first_ref ? "" : ",");
+			_html_json_escape(report->fp, oscap_streq(title, NULL) ? "unknown" : title);
+			fputs("&quot;", report->fp);
+		}
+		oscap_iterator_free(ref_it);
+		fputc(']', report->fp);
+	}
+	oscap_iterator_free(href_it);
+	fputc('}', report->fp);
+
+	oscap_list_free0(hrefs);
+	oscap_htable_free(by_href, (oscap_destruct_func) oscap_list_free0);
+}
+
+static void _html_write_overview_rule(struct html_report *report, struct xccdf_item *item, unsigned int indent)
+{
+	FILE *fp = report->fp;
+	const char *id = xccdf_item_get_id(item);
+	struct xccdf_rule_result *rr = oscap_htable_get(report->rule_results, id);
+	xccdf_test_result_type_t result = rr == NULL ? 0 : xccdf_rule_result_get_result(rr);
+	const char *result_text = _html_rule_result_text(report, id);
+	unsigned int seq = ++report->rule_result_seq;
+
+	fputs("<tr data-tt-id=\"", fp);
+	_html_escape(fp, id);
+	fprintf(fp, "\" class=\"rule-overview-leaf rule-overview-leaf-%s", result_text);
+	if (result == XCCDF_RESULT_FAIL || result == XCCDF_RESULT_ERROR || result == XCCDF_RESULT_UNKNOWN)
+		fputs(" rule-overview-needs-attention", fp);
+	fputs(" rule-overview-leaf-id-", fp);
+	_html_escape(fp, id);
+	fprintf(fp, "\" id=\"rule-overview-leaf-idm%u\" data-tt-parent-id=\"", seq);
+	_html_escape(fp, xccdf_item_get_id(xccdf_item_get_parent(item)));
+	fputs("\" data-references=\"", fp);
+	_html_write_references_json(report, item);
+	fprintf(fp, "\">\n<td style=\"padding-left: %upx\"><a href=\"#rule-detail-idm%u\" onclick=\"return openRuleDetailsDialog('idm%u')\">",
+			indent * 19, seq, seq);
+	_html_write_item_title(report, item);
+	fputs("</a>", fp);
+	if (rr != NULL) {
+		struct xccdf_override_iterator *overrides = xccdf_rule_result_get_overrides(rr);
+		if (xccdf_override_iterator_has_more(overrides))
+			fputs("&#160;<span class=\"label label-warning\">waived</span>", fp);
+		xccdf_override_iterator_free(overrides);
+	}
+	fprintf(fp, "</td>\n<td class=\"rule-severity\" style=\"text-align: center\">%s</td>\n"
+		"<td class=\"rule-result rule-result-%s\"><div><abbr title=\"%s\">%s</abbr></div></td></tr>\n",
+		_html_rule_result_severity(rr), result_text, _html_rule_result_tooltip(result), result_text);
+}
+
+static void _html_write_overview_group(struct html_report *report, struct xccdf_item *item, unsigned int indent)
+{
+	FILE *fp = report->fp;
+	const char *id = xccdf_item_get_id(item);
+	bool is_benchmark = xccdf_item_get_type(item) == XCCDF_BENCHMARK;
+
+	struct html_report_counts empty = { 0, 0, 0, 0 };
+	struct html_report_counts *counts = is_benchmark ? NULL : oscap_htable_get(report->group_counts, id);
+	if (counts == NULL)
+		counts = &empty;
+
+	fputs("<tr data-tt-id=\"", fp);
+	_html_escape(fp, id);
+	fputs("\" class=\"rule-overview-inner-node rule-overview-inner-node-id-", fp);
+	_html_escape(fp, id);
+	fputc('"', fp);
+	if (!is_benchmark) {
+		fputs(" data-tt-parent-id=\"", fp);
+		_html_escape(fp, xccdf_item_get_id(xccdf_item_get_parent(item)));
+		fputc('"', fp);
+	}
+	fprintf(fp, ">\n<td colspan=\"3\" style=\"padding-left: %upx\">", indent * 19);
+	if (is_benchmark || counts->fail + counts->error + counts->unknown + counts->notchecked > 0) {
+		fputs("<strong>", fp);
+		if (is_benchmark)
+			_html_write_textlist(report, xccdf_benchmark_get_title(report->benchmark));
+		else
+			_html_write_item_title(report, item);
+		fputs("</strong>", fp);
+		if (counts->fail > 0)
+			fprintf(fp, "&#160;<span class=\"badge\">%ux fail</span>", counts->fail);
+		if (counts->error > 0)
+			fprintf(fp, "&#160;<span class=\"badge\">%ux error</span>", counts->error);
+		if (counts->unknown > 0)
+			fprintf(fp, "&#160;<span class=\"badge\">%ux unknown</span>", counts->unknown);
+		if (counts->notchecked > 0)
+			fprintf(fp, "&#160;<span class=\"badge\">%ux notchecked</span>", counts->notchecked);
+	} else {
+		_html_write_item_title(report, item);
+		fputs("<script>$(document).ready(function(){$('.treetable').treetable(\"collapseNode\",\"", fp);
+		_html_escape(fp, id);
+		fputs("\");});</script>", fp);
+	}
+	fputs("</td></tr>\n", fp);
+
+	struct xccdf_item_iterator *content = is_benchmark ?
+		xccdf_benchmark_get_content(report->benchmark) : xccdf_group_get_content(XGROUP(item));
+	/* groups first, then rules, same as the XSLT */
+	for (int pass = 0; pass < 2; ++pass) {
+		while (xccdf_item_iterator_has_more(content)) {
+			struct xccdf_item *child = xccdf_item_iterator_next(content);
+			if (pass == 0 && xccdf_item_get_type(child) == XCCDF_GROUP)
+				_html_write_overview_group(report, child, indent + 1);
+			else if (pass == 1 && xccdf_item_get_type(child) == XCCDF_RULE)
+				_html_write_overview_rule(report, child, indent + 1);
+		}
+		xccdf_item_iterator_reset(content);
+	}
+	xccdf_item_iterator_free(content);
+}
+
+static void _html_write_rule_overview(struct html_report *report)
+{
+	static const char *toggles[3][3] = {
+		{ "pass", "fixed", "informational" },
+		{ "fail", "error", "unknown" },
+		{ "notchecked", "notselected", "notapplicable" }
+	};
+	static const char *toggle_classes[3] = { "success", "danger", "other" };
+	FILE *fp = report->fp;
+
+	fputs("<div id=\"rule-overview\"><h2>Rule Overview</h2>\n<div class=\"form-group js-only\"><div class=\"row\">"
+		"<div title=\"Filter rules by their XCCDF result\">\n", fp);
+	for (int col = 0; col < 3; ++col) {
+		fprintf(fp, "<div class=\"col-sm-2 toggle-rule-display-%s\">\n", toggle_classes[col]);
+		for (int row = 0; row < 3; ++row) {
+			fprintf(fp, "<div class=\"checkbox\"><label><input class=\"toggle-rule-display\" type=\"checkbox\" "
+				"onclick=\"toggleRuleDisplay(this)\"%s value=\"%s\"/>%s</label></div>\n",
+				oscap_streq(toggles[col][row], "notselected") ? "" : " checked=\"checked\"",
+				toggles[col][row], toggles[col][row]);
+		}
+		fputs("</div>\n", fp);
+	}
+	fputs("</div>\n<div class=\"col-sm-6\"><div class=\"input-group\">"
+		"<input type=\"text\" class=\"form-control\" placeholder=\"Search through XCCDF rules\" id=\"search-input\" oninput=\"ruleSearch()\"/>"
+		"<div class=\"input-group-btn\"><button class=\"btn btn-default\" onclick=\"ruleSearch()\">Search</button></div></div>\n"
+		"<p id=\"search-matches\"></p>\nGroup rules by:\n<select name=\"groupby\" onchange=\"groupRulesBy(value)\">"
+		"<option value=\"default\" selected=\"selected\">Default</option>"
+		"<option value=\"severity\">Severity</option><option value=\"result\">Result</option></select>\n"
+		"</div></div></div>\n", fp);
+
+	fputs("<table class=\"treetable table table-bordered\"><thead><tr><th>Title</th>"
+		"<th style=\"width: 120px; text-align: center\">Severity</th>"
+		"<th style=\"width: 120px; text-align: center\">Result</th></tr></thead>\n<tbody>\n", fp);
+	report->rule_result_seq = 0;
+	_html_write_overview_group(report, XITEM(report->benchmark), 0);
+	fputs("</tbody></table></div>\n", fp);
+}
+
+static struct oval_agent_session *_html_find_agent(struct html_report *report, const char *href)
+{
+	if (report->agents == NULL || href == NULL)
+		return NULL;
+	for (int i = 0; report->agents[i] != NULL; ++i) {
+		if (oscap_streq(oval_agent_get_filename(report->agents[i]), href))
+			return report->agents[i];
+	}
+	return NULL;
+}
+
+static void _html_write_oval_test(struct html_report *report, struct oval_result_test *test, bool satisfying)
+{
+	FILE *fp = report->fp;
+	struct oval_result_item_iterator *items = oval_result_test_get_items(test);
+	if (!oval_result_item_iterator_has_more(items)) {
+		oval_result_item_iterator_free(items);
+		return;
+	}
+
+	struct oval_test *definition_test = oval_result_test_get_test(test);
+	const char *comment = oval_test_get_comment(definition_test);
+	fprintf(fp, "<h4>Items found %s <span class=\"label label-primary\">", satisfying ? "satisfying" : "violating");
+	if (comment != NULL)
+		_html_escape(fp, comment);
+	else {
+		fputs("OVAL test ", fp);
+		_html_escape(fp, oval_test_get_id(definition_test));
+	}
+	fputs("</span>:</h4>\n<table class=\"table table-striped table-bordered\">\n", fp);
+
+	unsigned int count = 0;
+	while (oval_result_item_iterator_has_more(items)) {
+		struct oval_sysitem *sysitem = oval_result_item_get_sysitem(oval_result_item_iterator_next(items));
+		if (++count > HTML_REPORT_MAX_ITEMS)
+			continue;
+
+		/* table head is made from the entities of the first item */
+		if (count == 1) {
+			fputs("<thead><tr>", fp);
+			struct oval_sysent_iterator *ents = oval_sysitem_get_sysents(sysitem);
+			while (oval_sysent_iterator_has_more(ents)) {
+				fputs("<th>", fp);
+				_html_escape(fp, oval_sysent_get_name(oval_sysent_iterator_next(ents)));
+				fputs("</th>", fp);
+			}
+			oval_sysent_iterator_free(ents);
+			fputs("</tr></thead>\n<tbody>\n", fp);
+		}
+
+		fputs("<tr>", fp);
+		struct oval_sysent_iterator *ents = oval_sysitem_get_sysents(sysitem);
+		while (oval_sysent_iterator_has_more(ents)) {
+			fputs("<td>", fp);
+			_html_escape(fp, oval_sysent_get_value(oval_sysent_iterator_next(ents)));
+			fputs("</td>", fp);
+		}
+		oval_sysent_iterator_free(ents);
+		fputs("</tr>\n", fp);
+	}
+	oval_result_item_iterator_free(items);
+	fputs("</tbody></table>\n", fp);
+	if (count > HTML_REPORT_MAX_ITEMS)
+		fprintf(fp, "... and %u more items.\n", count - HTML_REPORT_MAX_ITEMS);
+}
+
+static void _html_write_oval_criteria(struct html_report *report, struct oval_result_criteria_node *node, bool satisfying)
+{
+	if (node == NULL)
+		return;
+
+	switch (oval_result_criteria_node_get_type(node)) {
+	case OVAL_NODETYPE_CRITERIA: {
+		struct oval_result_criteria_node_iterator *subnodes = oval_result_criteria_node_get_subnodes(node);
+		while (oval_result_criteria_node_iterator_has_more(subnodes))
+			_html_write_oval_criteria(report, oval_result_criteria_node_iterator_next(subnodes), satisfying);
+		oval_result_criteria_node_iterator_free(subnodes);
+		break;
+	}
+	case OVAL_NODETYPE_CRITERION:
+		_html_write_oval_test(report, oval_result_criteria_node_get_test(node), satisfying);
+		break;
+	case OVAL_NODETYPE_EXTENDDEF: {
+		struct oval_result_definition *extends = oval_result_criteria_node_get_extends(node);
+		if (extends != NULL)
+			_html_write_oval_criteria(report, oval_result_definition_get_criteria(extends), satisfying);
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+static void _html_write_oval_details(struct html_report *report, struct xccdf_check *check, xccdf_test_result_type_t result)
+{
+	FILE *fp = report->fp;
+	struct xccdf_check_content_ref_iterator *refs = xccdf_check_get_content_refs(check);
+	while (xccdf_check_content_ref_iterator_has_more(refs)) {
+		struct xccdf_check_content_ref *ref = xccdf_check_content_ref_iterator_next(refs);
+		const char *href = xccdf_check_content_ref_get_href(ref);
+		const char *name = xccdf_check_content_ref_get_name(ref);
+		struct oval_agent_session *agent = _html_find_agent(report, href);
+		if (agent == NULL || name == NULL)
+			continue;
+
+		struct oval_result_system_iterator *systems = oval_results_model_get_systems(oval_agent_get_results_model(agent));
+		struct oval_result_definition *definition = NULL;
+		if (oval_result_system_iterator_has_more(systems))
+			definition = oval_result_system_get_definition(oval_result_system_iterator_next(systems), name);
+		oval_result_system_iterator_free(systems);
+		if (definition == NULL)
+			continue;
+
+		fputs("<tr><td colspan=\"2\"><div class=\"check-system-details\">"
+			"<span class=\"label label-default\"><abbr title=\"OVAL details taken from OVAL session '", fp);
+		_html_escape(fp, href);
+		fputs("'\">OVAL details</abbr></span>\n<div class=\"panel panel-default\"><div class=\"panel-body\">\n", fp);
+		_html_write_oval_criteria(report, oval_result_definition_get_criteria(definition), result == XCCDF_RESULT_PASS);
+		fputs("</div></div></div></td></tr>\n", fp);
+	}
+	xccdf_check_content_ref_iterator_free(refs);
+}
+
+static void _html_write_detail_rule(struct html_report *report, struct xccdf_item *item)
+{
+	FILE *fp = report->fp;
+	const char *id = xccdf_item_get_id(item);
+	struct xccdf_rule_result *rr = oscap_htable_get(report->rule_results, id);
+	xccdf_test_result_type_t result = rr == NULL ? 0 : xccdf_rule_result_get_result(rr);
+	const char *result_text = _html_rule_result_text(report, id);
+	unsigned int seq = ++report->rule_result_seq;
+
+	fprintf(fp, "<div class=\"panel panel-default rule-detail rule-detail-%s rule-detail-id-", result_text);
+	_html_escape(fp, id);
+	fprintf(fp, "\" id=\"rule-detail-idm%u\">\n<div class=\"keywords sr-only\">", seq);
+	_html_write_item_title(report, item);
+	fputc(' ', fp);
+	_html_escape(fp, id);
+	fprintf(fp, " %s ", _html_rule_result_severity(rr));
+	struct xccdf_ident_iterator *idents = xccdf_rule_get_idents(XRULE(item));
+	while (xccdf_ident_iterator_has_more(idents)) {
+		_html_escape(fp, xccdf_ident_get_id(xccdf_ident_iterator_next(idents)));
+		fputc(' ', fp);
+	}
+	xccdf_ident_iterator_reset(idents);
+	fputs("</div>\n<div class=\"panel-heading\"><h3 class=\"panel-title\">", fp);
+	_html_write_item_title(report, item);
+	fputs("</h3></div>\n<div class=\"panel-body\"><table class=\"table table-striped table-bordered\"><tbody>\n"
+		"<tr><td class=\"col-md-3\">Rule ID</td><td class=\"rule-id col-md-9\">", fp);
+	_html_escape(fp, id);
+	fprintf(fp, "</td></tr>\n<tr><td>Result</td><td class=\"rule-result rule-result-%s\"><div><abbr title=\"%s\">%s</abbr></div></td></tr>\n",
+			result_text, _html_rule_result_tooltip(result), result_text);
+	fputs("<tr><td>Time</td><td>", fp);
+	if (rr != NULL)
+		_html_escape(fp, xccdf_rule_result_get_time(rr));
+	fprintf(fp, "</td></tr>\n<tr><td>Severity</td><td>%s</td></tr>\n", _html_rule_result_severity(rr));
+
+	fputs("<tr><td>Identifiers and References</td><td class=\"identifiers\">", fp);
+	if (xccdf_ident_iterator_has_more(idents)) {
+		fputs("<p><span class=\"label label-default\">identifiers:</span>&#160;", fp);
+		for (bool first = true; xccdf_ident_iterator_has_more(idents); first = false) {
+			struct xccdf_ident *ident = xccdf_ident_iterator_next(idents);
+			fputs(first ? "<abbr title=\"" : ", <abbr title=\"", fp);
+			_html_escape(fp, xccdf_ident_get_system(ident));
+			fputs("\">", fp);
+			_html_escape(fp, xccdf_ident_get_id(ident));
+			fputs("</abbr>", fp);
+		}
+		fputs("</p>", fp);
+	}
+	xccdf_ident_iterator_free(idents);
+	struct oscap_reference_iterator *refs = xccdf_item_get_references(item);
+	if (oscap_reference_iterator_has_more(refs)) {
+		fputs("<p><span class=\"label label-default\">references:</span>&#160;", fp);
+		for (bool first = true; oscap_reference_iterator_has_more(refs); first = false) {
+			struct oscap_reference *ref = oscap_reference_iterator_next(refs);
+			const char *title = oscap_reference_get_title(ref);
+			fputs(first ? "<abbr title=\"" : ", <abbr title=\"", fp);
+			_html_escape(fp, oscap_reference_get_href(ref));
+			fputs("\">", fp);
+			_html_escape(fp, title != NULL ? title : oscap_reference_get_href(ref));
+			fputs("</abbr>", fp);
+		}
+		fputs("</p>", fp);
+	}
+	oscap_reference_iterator_free(refs);
+	fputs("</td></tr>\n", fp);
+
+	if (rr != NULL) {
+		struct xccdf_override_iterator *overrides = xccdf_rule_result_get_overrides(rr);
+		if (xccdf_override_iterator_has_more(overrides)) {
+			fputs("<tr><td colspan=\"2\">", fp);
+			while (xccdf_override_iterator_has_more(overrides)) {
+				struct xccdf_override *override = xccdf_override_iterator_next(overrides);
+				const char *old_result = xccdf_test_result_type_get_text(xccdf_override_get_old_result(override));
+				fputs("<div class=\"alert alert-warning waiver\">This rule has been waived by <strong>", fp);
+				_html_escape(fp, xccdf_override_get_authority(override));
+				fputs("</strong> at <strong>", fp);
+				_html_escape(fp, xccdf_override_get_time(override));
+				fputs("</strong>.<blockquote>", fp);
+				_html_write_text(report, xccdf_override_get_remark(override));
+				fprintf(fp, "</blockquote><small>The previous result was <span class=\"rule-result rule-result-%s\">&#160;%s&#160;</span>.</small></div>\n",
+						old_result, old_result);
+			}
+			fputs("</td></tr>\n", fp);
+		}
+		xccdf_override_iterator_free(overrides);
+	}
+
+	struct oscap_text_iterator *description = xccdf_item_get_description(item);
+	if (oscap_text_iterator_has_more(description)) {
+		fputs("<tr><td>Description</td><td><div class=\"description\"><p>", fp);
+		_html_write_textlist(report, description);
+		fputs("</p></div></td></tr>\n", fp);
+	} else
+		oscap_text_iterator_free(description);
+
+	struct oscap_text_iterator *rationale = xccdf_item_get_rationale(item);
+	if (oscap_text_iterator_has_more(rationale)) {
+		fputs("<tr><td>Rationale</td><td><div class=\"rationale\"><p>", fp);
+		_html_write_textlist(report, rationale);
+		fputs("</p></div></td></tr>\n", fp);
+	} else
+		oscap_text_iterator_free(rationale);
+
+	struct xccdf_warning_iterator *warnings = xccdf_item_get_warnings(item);
+	if (xccdf_warning_iterator_has_more(warnings)) {
+		fputs("<tr><td>Warnings</td><td>", fp);
+		while (xccdf_warning_iterator_has_more(warnings)) {
+			fputs("<div class=\"panel panel-warning\"><div class=\"panel-heading\"><span class=\"label label-warning\">warning</span>&#160;", fp);
+			_html_write_text(report, xccdf_warning_get_text(xccdf_warning_iterator_next(warnings)));
+			fputs("</div></div>\n", fp);
+		}
+		fputs("</td></tr>\n", fp);
+	}
+	xccdf_warning_iterator_free(warnings);
+
+	if (rr != NULL) {
+		struct xccdf_check_iterator *checks = xccdf_rule_result_get_checks(rr);
+		while (xccdf_check_iterator_has_more(checks)) {
+			struct xccdf_check *check = xccdf_check_iterator_next(checks);
+			if (oscap_streq(xccdf_check_get_system(check), "http://oval.mitre.org/XMLSchema/oval-definitions-5"))
+				_html_write_oval_details(report, check, result);
+		}
+		xccdf_check_iterator_free(checks);
+
+		struct xccdf_message_iterator *messages = xccdf_rule_result_get_messages(rr);
+		if (xccdf_message_iterator_has_more(messages)) {
+			fputs("<tr><td colspan=\"2\"><div class=\"evaluation-messages\"><span class=\"label label-default\">"
+				"<abbr title=\"Messages taken from rule-result\">Evaluation messages</abbr></span>\n"
+				"<div class=\"panel panel-default\"><div class=\"panel-body\">\n", fp);
+			while (xccdf_message_iterator_has_more(messages)) {
+				struct xccdf_message *message = xccdf_message_iterator_next(messages);
+				const char *severity = oscap_enum_to_string(XCCDF_LEVEL_MAP, xccdf_message_get_severity(message));
+				if (severity != NULL)
+					fprintf(fp, "<span class=\"label label-primary\">%s</span>&#160;", severity);
+				fputs("<pre>", fp);
+				_html_escape(fp, xccdf_message_get_content(message));
+				fputs("</pre>\n", fp);
+			}
+			fputs("</div></div></div></td></tr>\n", fp);
+		}
+		xccdf_message_iterator_free(messages);
+	}
+
+	if (result == XCCDF_RESULT_FAIL || result == XCCDF_RESULT_ERROR || result == XCCDF_RESULT_UNKNOWN) {
+		struct xccdf_fixtext_iterator *fixtexts = xccdf_rule_get_fixtexts(XRULE(item));
+		while (xccdf_fixtext_iterator_has_more(fixtexts)) {
+			fputs("<tr><td colspan=\"2\"><div class=\"remediation-description\"><span class=\"label label-success\">Remediation description:</span>"
+				"<div class=\"panel panel-default\"><div class=\"panel-body\">", fp);
+			_html_write_text(report, xccdf_fixtext_get_text(xccdf_fixtext_iterator_next(fixtexts)));
+			fputs("</div></div></div></td></tr>\n", fp);
+		}
+		xccdf_fixtext_iterator_free(fixtexts);
+
+		struct xccdf_fix_iterator *fixes = xccdf_rule_get_fixes(XRULE(item));
+		while (xccdf_fix_iterator_has_more(fixes)) {
+			struct xccdf_fix *fix = xccdf_fix_iterator_next(fixes);
+			fputs("<tr><td colspan=\"2\"><div class=\"remediation\"><span class=\"label label-success\">Remediation script:</span>"
+				"<pre><code>", fp);
+			_html_escape(fp, xccdf_fix_get_content(fix));
+			fputs("</code></pre></div></td></tr>\n", fp);
+		}
+		xccdf_fix_iterator_free(fixes);
+	}
+
+	fputs("</tbody></table></div></div>\n", fp);
+}
+
+static void _html_write_details_group(struct html_report *report, struct xccdf_item_iterator *content)
+{
+	for (int pass = 0; pass < 2; ++pass) {
+		while (xccdf_item_iterator_has_more(content)) {
+			struct xccdf_item *child = xccdf_item_iterator_next(content);
+			if (pass == 0 && xccdf_item_get_type(child) == XCCDF_GROUP)
+				_html_write_details_group(report, xccdf_group_get_content(XGROUP(child)));
+			else if (pass == 1 && xccdf_item_get_type(child) == XCCDF_RULE)
+				_html_write_detail_rule(report, child);
+		}
+		xccdf_item_iterator_reset(content);
+	}
+	xccdf_item_iterator_free(content);
+}
+
+static void _html_write_result_details(struct html_report *report)
+{
+	fputs("<div class=\"js-only\"><button type=\"button\" class=\"btn btn-info\" onclick=\"return toggleResultDetails(this)\">"
+		"Show all result details</button></div>\n<div id=\"result-details\"><h2>Result Details</h2>\n", report->fp);
+	report->rule_result_seq = 0;
+	_html_write_details_group(report, xccdf_benchmark_get_content(report->benchmark));
+	fputs("</div>\n", report->fp);
+}
+
+static void _html_write_branding(FILE *fp)
+{
+	fputs("<nav class=\"navbar navbar-default\" role=\"navigation\"><div class=\"navbar-header\" style=\"float: none\">"
+		"<a class=\"navbar-brand\" href=\"#\">"
+		"<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\" width=\"52\" height=\"52\" id=\"svg2\"><g transform=\"matrix(0.75266991,0,0,0.75266991,-17.752968,-104.57468)\" id=\"g32\"><path d=\"m 24.7,173.5 c 0,-9 3.5,-17.5 9.9,-23.9 6.8,-6.8 15.7,-10.4 25,-10 8.6,0.3 16.9,3.9 22.9,9.8 6.4,6.4 9.9,14.9 10,23.8 0.1,9.1 -3.5,17.8 -10,24.3 -13.2,13.2 -34.7,13.1 -48,-0.1 -1.5,-1.5 -1.9,-4.2 0.2,-6.2 l 9,-9 c -2,-3.6 -4.9,-13.1 2.6,-20.7 7.6,-7.6 18.6,-6 24.4,-0.2 3.3,3.3 5.100,7.6 5.1,12.1 0.1,4.6 -1.8,9.1 -5.3,12.5 -4.2,4.2 -10.2,5.8 -16.1,4.4 -1.5,-0.4 -2.4,-1.9 -2.1,-3.4 0.4,-1.5 1.9,-2.4 3.4,-2.1 4.1,1 8,-0.1 10.9,-2.9 2.3,-2.3 3.6,-5.3 3.6,-8.4 0,0 0,-0.1 0,-0.1 0,-3 -1.3,-5.9 -3.5,-8.2 -3.9,-3.9 -11.3,-4.9 -16.5,0.2 -6.3,6.3 -1.6,14.1 -1.6,14.2 1.5,2.4 0.7,5 -0.9,6.3 l -8.4,8.4 c 9.9,8.9 27.2,11.2 39.1,-0.8 5.4,-5.4 8.4,-12.5 8.4,-20 0,-0.1 0,-0.2 0,-0.3 -0.1,-7.5 -3,-14.6 -8.4,-19.9 -5,-5 -11.9,-8 -19.1,-8.2 -7.8,-0.3 -15.2,2.7 -20.9,8.4 -8.7,8.7 -8.7,19 -7.9,24.3 0.3,2.4 1.1,4.9 2.2,7.3 0.6,1.4 0,3.1 -1.4,3.7 -1.4,0.6 -3.1,0 -3.7,-1.4 -1.3,-2.9 -2.2,-5.8 -2.6,-8.7 -0.3,-1.7 -0.4,-3.5 -0.4,-5.2 z\" id=\"path34\" style=\"fill:#12497f\"/></g></svg>"
+		"</a><div><h1>OpenSCAP Evaluation Report</h1></div></div></nav>\n", fp);
+}
+
+int xccdf_result_export_html_report(struct xccdf_policy *policy, struct xccdf_result *result,
+		struct oval_agent_session **agents, const char *outfile)
+{
+	if (policy == NULL || result == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "No XCCDF results to generate the report from.");
+		return -1;
+	}
+
+	FILE *fp = outfile != NULL ? fopen(outfile, "w") : stdout;
+	if (fp == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Could not open output file '%s': %s", outfile, strerror(errno));
+		return -1;
+	}
+
+	struct html_report report = {
+		.fp = fp,
+		.policy = policy,
+		.benchmark = xccdf_policy_get_benchmark(policy),
+		.result = result,
+		.agents = agents,
+		.rule_results = oscap_htable_new(),
+		.group_counts = oscap_htable_new(),
+		.rule_result_seq = 0
+	};
+
+	struct xccdf_rule_result_iterator *rr_it = xccdf_result_get_rule_results(result);
+	while (xccdf_rule_result_iterator_has_more(rr_it)) {
+		struct xccdf_rule_result *rr = xccdf_rule_result_iterator_next(rr_it);
+		/* the last result of a rule wins, same as in the exported document */
+		oscap_htable_detach(report.rule_results, xccdf_rule_result_get_idref(rr));
+		oscap_htable_add(report.rule_results, xccdf_rule_result_get_idref(rr), rr);
+	}
+	xccdf_rule_result_iterator_free(rr_it);
+
+	struct html_report_counts total = { 0, 0, 0, 0 };
+	_html_count_contained(&report, xccdf_benchmark_get_content(report.benchmark), &total);
+
+	int ret = 0;
+	_html_write_header(&report);
+	if (_html_write_resources(fp) != 0) {
+		ret = -1;
+		goto cleanup;
+	}
+	fputs("</head>\n<body>\n", fp);
+	_html_write_branding(fp);
+	fputs("<div class=\"container\"><div id=\"content\">\n", fp);
+	_html_write_introduction(&report, xccdf_policy_get_profile(policy));
+	_html_write_characteristics(&report);
+	_html_write_compliance_and_scoring(&report);
+	_html_write_rule_overview(&report);
+	_html_write_result_details(&report);
+	fputs("</div></div>\n", fp);
+	fprintf(fp, "<footer id=\"footer\"><div class=\"container\"><p class=\"muted credit\">"
+		"Generated using <a href=\"http://open-scap.org\">OpenSCAP</a> %s</p></div></footer>\n"
+		"</body></html>\n", oscap_get_version());
+
+cleanup:
+	oscap_htable_free0(report.rule_results);
+	oscap_htable_free(report.group_counts, oscap_free);
+	if (outfile != NULL)
+		fclose(fp);
+	return ret;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef XCCDF_HTML_REPORT_PRIV_H
+#define XCCDF_HTML_REPORT_PRIV_H
+
+#include "common/util.h"
+#include "public/xccdf_benchmark.h"
+#include "XCCDF_POLICY/public/xccdf_policy.h"
+#include "OVAL/public/oval_agent_api.h"
+
+OSCAP_HIDDEN_START;
+
+/**
+ * Write HTML report of the given TestResult without building any intermediate
+ * XML document. The output mirrors the layout of xccdf-report.xsl, the
+ * rule results are read directly from the in-memory result and the OVAL
+ * details are taken from the results models of the given agent sessions.
+ * @param policy XCCDF policy the result was produced by
+ * @param result XCCDF TestResult to render
+ * @param agents NULL terminated array of OVAL agent sessions used for evaluation (may be NULL)
+ * @param outfile path of the HTML file to write, NULL means stdout
+ * @returns 0 on success, -1 on error
+ */
+int xccdf_result_export_html_report(struct xccdf_policy *policy, struct xccdf_result *result,
+		struct oval_agent_session **agents, const char *outfile);
+
+OSCAP_HIDDEN_END;
+
+#endif
@@ -717,6 +717,17 @@ OSCAP_DEPRECATED(struct xccdf_benchmark* xccdf_benchmark_import(const char *file
  */
 struct xccdf_benchmark* xccdf_benchmark_import_source(struct oscap_source *source);
 
+/**
+ * Import the content from oscap_source into a benchmark, leaving the
+ * human-readable texts (titles, descriptions, rationales, warnings, fixtexts
+ * and the like) in the XML document of the source until they are accessed.
+ * The source must not be freed before the benchmark.
+ * @memberof xccdf_benchmark
+ * @param source The oscap_source to import from
+ * @returns newly created benchmark element or NULL
+ */
+struct xccdf_benchmark* xccdf_benchmark_import_source_lazy(struct oscap_source *source);
+
 /**
  * Export a benchmark to an XML stream
  * @memberof xccdf_benchmark
@@ -135,6 +135,19 @@ void xccdf_session_set_benchmark_id(struct xccdf_session *session, const char *b
  */
 const char *xccdf_session_get_benchmark_id(struct xccdf_session *session);
 
+/**
+ * Set path to the compiled image of the DataStream (see ds_sds_session_compile).
+ * The checklist, its OVAL definitions and the CPE dictionaries are taken from
+ * the image if it was compiled from the current content of the DataStream with
+ * the requested datastream_id and component_id, otherwise the DataStream is
+ * loaded as usual. The image is not used when benchmark_id is requested.
+ * This function is applicable only before session loads.
+ * @memberof xccdf_session
+ * @param session XCCDF Session
+ * @param compiled_file File path to the compiled image or NULL
+ */
+void xccdf_session_set_compiled_content(struct xccdf_session *session, const char *compiled_file);
+
 /**
  * Set path to custom CPE dictionary for the session. This function is applicable
  * only before session loads. It has no effect if run afterwards.
@@ -200,6 +213,20 @@ void xccdf_session_set_custom_oval_eval_fn(struct xccdf_session *session, xccdf_
  */
 bool xccdf_session_set_product_cpe(struct xccdf_session *session, const char *product_cpe);
 
+/**
+ * Set root directory of the system to scan. The root is passed to probes in
+ * the OSCAP_PROBE_ROOT environment variable. Probes which have been already
+ * started by the session are terminated and the system information is queried
+ * again before the next evaluation. The loaded content is kept untouched,
+ * so it can be loaded once and evaluated against several roots from forked
+ * processes.
+ * @memberof xccdf_session
+ * @param session XCCDF Session
+ * @param probe_root path to the root directory, NULL means the running system
+ * @returns true on success
+ */
+bool xccdf_session_set_probe_root(struct xccdf_session *session, const char *probe_root);
+
 /**
  * Set whether the OVAL result files shall be exported.
  * @memberof xccdf_session
@@ -259,6 +286,17 @@ bool xccdf_session_set_arf_export(struct xccdf_session *session, const char *arf
  */
 bool xccdf_session_set_report_export(struct xccdf_session *session, const char *report_file);
 
+/**
+ * Select the engine used to generate HTML Report. The "xslt" engine (default)
+ * transforms exported XCCDF results by xccdf-report.xsl, the "native" engine
+ * writes the report directly from the evaluated session.
+ * @memberof xccdf_session
+ * @param session XCCDF Session
+ * @param engine either "xslt" or "native", NULL means default
+ * @returns true on success, false if the engine is not known
+ */
+bool xccdf_session_set_report_engine(struct xccdf_session *session, const char *engine);
+
 /**
  * Select XCCDF Profile for evaluation.
  * @memberof xccdf_session
@@ -268,6 +306,21 @@ bool xccdf_session_set_report_export(struct xccdf_session *session, const char *
  */
 bool xccdf_session_set_profile_id(struct xccdf_session *session, const char *profile_id);
 
+/**
+ * Select several XCCDF Profiles to be evaluated in one pass.
+ * The first profile becomes the selected profile, as if set by
+ * xccdf_session_set_profile_id(). xccdf_session_evaluate() then evaluates
+ * each of the profiles over the same OVAL sessions, so the objects shared by
+ * the profiles are collected only once, and the exported XCCDF results and
+ * ARF contain one TestResult per profile. The HTML report, the base score and
+ * remediation are about the first profile only.
+ * @memberof xccdf_session
+ * @param session XCCDF Session
+ * @param profile_ids NULL-terminated array of profile IDs
+ * @returns true on success, false if any of the profiles was not found
+ */
+bool xccdf_session_set_profile_ids(struct xccdf_session *session, const char **profile_ids);
+
 /**
  * Retrieves ID of the profile that we will evaluate with, or NULL.
  * @memberof xccdf_session
@@ -462,6 +515,7 @@ unsigned int xccdf_session_get_cpe_oval_agents_count(const struct xccdf_session
 
 /**
  * Query if the result of evaluation contains FAIL, ERROR, or UNKNOWN rule-result elements.
+ * When several profiles were evaluated, results of all of them are queried.
  * @memberof xccdf_session
  * @param session XCCDF Session
  * @returns Exists such rule-result r . r = FAIL | r = UNKNOWN | r = ERROR
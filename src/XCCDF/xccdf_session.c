@@ -19,6 +19,8 @@
  */
 #include <string.h>
 #include <limits.h>
+#include <errno.h>
+#include <pthread.h>
 
 #ifdef HAVE_CONFIG_H
 #include <config.h>
@@ -27,6 +29,7 @@
 #include <libgen.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <libxml/parser.h>
 
 #include <oscap.h>
 #include "oscap_source.h"
@@ -39,6 +42,7 @@
 #include "common/list.h"
 #include "common/oscapxml.h"
 #include "common/_error.h"
+#include "common/debug_priv.h"
 #include "CPE/cpe_session_priv.h"
 #include "DS/public/scap_ds.h"
 #include "DS/public/ds_sds_session.h"
@@ -47,6 +51,7 @@
 #include "OVAL/results/oval_results_impl.h"
 #include "source/xslt_priv.h"
 #include "XCCDF/xccdf_impl.h"
+#include "XCCDF/html_report_priv.h"
 #include "XCCDF_POLICY/public/xccdf_policy.h"
 #include "XCCDF_POLICY/xccdf_policy_priv.h"
 #include "XCCDF_POLICY/xccdf_policy_model_priv.h"
@@ -68,7 +73,9 @@ struct xccdf_session {
 		struct oscap_source *source;            ///< oscap_source representing the XCCDF file
 		struct xccdf_policy_model *policy_model;///< Active policy model.
 		char *profile_id;			///< Last selected profile.
+		char **other_profile_ids;		///< Profiles evaluated together with profile_id.
 		struct xccdf_result *result;		///< XCCDF Result model.
+		struct xccdf_result **other_results;	///< Results of other_profile_ids from the latest evaluation.
 		float base_score;			///< Basec score of the latest evaluation.
 		struct oscap_source *result_source;     ///< oscap_source for the exported XCCDF result
 	} xccdf;
@@ -77,6 +84,7 @@ struct xccdf_session {
 		char *user_datastream_id;		///< Datastream id requested by user (only applicable for sds).
 		char *user_component_id;		///< Component id requested by user (only applicable for sds).
 		char *user_benchmark_id;		///< Benchmark id requested by user (only applicable for sds).
+		char *compiled_file;			///< Compiled image of the datastream (only applicable for sds).
 	} ds;
 	struct {
 		bool fetch_remote_resources;		///< Allows download of remote resources (not applicable when user sets custom oval files)
@@ -87,11 +95,13 @@ struct xccdf_session {
 		xccdf_policy_engine_eval_fn user_eval_fn;///< Custom OVAL engine callback
 		char *product_cpe;			///< CPE of scanner product.
 		struct oscap_htable *result_sources;    ///< mapping 'filepath' to oscap_source for OVAL results
+		bool sysinfo_outdated;			///< Shall be the system info queried again before evaluation?
 	} oval;
 	struct {
 		char *arf_file;				///< Path to ARF file to export
 		char *xccdf_file;			///< Path to XCCDF file to export
 		char *report_file;			///< Path to HTML file to eport
+		bool native_report;			///< Shall be the HTML report written without XSLT?
 		bool oval_results;			///< Shall be the OVAL results files exported?
 		bool oval_variables;			///< Shall be the OVAL variable files exported?
 		bool check_engine_plugins_results; ///< Shall the check engine plugins results be exported?
@@ -111,6 +121,11 @@ static int _xccdf_session_autonegotiate_tailoring_file(struct xccdf_session *ses
 static void _oval_content_resources_free(struct oval_content_resource **resources);
 static void _xccdf_session_free_oval_agents(struct xccdf_session *session);
 static void _xccdf_session_free_oval_result_sources(struct xccdf_session *session);
+static void _xccdf_session_free_other_profiles(struct xccdf_session *session);
+
+#define XCCDF_SESSION_LOAD_JOBS_ENV "OSCAP_LOAD_JOBS"
+#define XCCDF_SESSION_LOAD_JOBS_MAX 64
+#define XCCDF_SESSION_LOAD_JOBS_DEFAULT_MAX 8
 
 static const char *oscap_productname = "cpe:/a:open-scap:oscap";
 static const char *oval_sysname = "http://oval.mitre.org/XMLSchema/oval-definitions-5";
@@ -199,6 +214,7 @@ void xccdf_session_free(struct xccdf_session *session)
 	if (session == NULL)
 		return;
 	oscap_free(session->xccdf.profile_id);
+	_xccdf_session_free_other_profiles(session);
 	oscap_free(session->export.xccdf_file);
 	oscap_free(session->export.report_file);
 	oscap_free(session->export.arf_file);
@@ -216,6 +232,7 @@ void xccdf_session_free(struct xccdf_session *session)
 	oscap_free(session->ds.user_datastream_id);
 	oscap_free(session->ds.user_component_id);
 	oscap_free(session->ds.user_benchmark_id);
+	oscap_free(session->ds.compiled_file);
 	ds_sds_session_free(session->ds.session);
 	if (session->temp_dir != NULL)
 		oscap_acquire_cleanup_dir((char **) &(session->temp_dir));
@@ -280,6 +297,12 @@ const char *xccdf_session_get_benchmark_id(struct xccdf_session *session)
 	return session->ds.user_benchmark_id;
 }
 
+void xccdf_session_set_compiled_content(struct xccdf_session *session, const char *compiled_file)
+{
+	oscap_free(session->ds.compiled_file);
+	session->ds.compiled_file = oscap_strdup(compiled_file);
+}
+
 void xccdf_session_set_user_cpe(struct xccdf_session *session, const char *user_cpe)
 {
 	oscap_free(session->user_cpe);
@@ -317,6 +340,27 @@ bool xccdf_session_set_product_cpe(struct xccdf_session *session, const char *pr
 	return true;
 }
 
+bool xccdf_session_set_probe_root(struct xccdf_session *session, const char *probe_root)
+{
+	if (probe_root != NULL) {
+		if (setenv("OSCAP_PROBE_ROOT", probe_root, 1) != 0) {
+			oscap_seterr(OSCAP_EFAMILY_GLIBC, "Failed to set the OSCAP_PROBE_ROOT environment variable.");
+			return false;
+		}
+	}
+	else
+		unsetenv("OSCAP_PROBE_ROOT");
+
+	/* Probes already running were started with the previous root,
+	 * terminate them so that they are started again on demand. */
+	if (session->oval.agents != NULL) {
+		for (int i = 0; session->oval.agents[i] != NULL; ++i)
+			oval_agent_reset_session(session->oval.agents[i]);
+		session->oval.sysinfo_outdated = true;
+	}
+	return true;
+}
+
 void xccdf_session_set_oval_results_export(struct xccdf_session *session, bool to_export_oval_results)
 {
 	session->export.oval_results = to_export_oval_results;
@@ -358,12 +402,66 @@ bool xccdf_session_set_report_export(struct xccdf_session *session, const char *
 	return true;
 }
 
+bool xccdf_session_set_report_engine(struct xccdf_session *session, const char *engine)
+{
+	if (engine == NULL || oscap_streq(engine, "xslt"))
+		session->export.native_report = false;
+	else if (oscap_streq(engine, "native"))
+		session->export.native_report = true;
+	else {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Unknown report engine '%s'. Use either 'xslt' or 'native'.", engine);
+		return false;
+	}
+	return true;
+}
+
 bool xccdf_session_set_profile_id(struct xccdf_session *session, const char *profile_id)
 {
 	if (xccdf_policy_model_get_policy_by_id(session->xccdf.policy_model, profile_id) == NULL)
 		return false;
 	oscap_free(session->xccdf.profile_id);
 	session->xccdf.profile_id = oscap_strdup(profile_id);
+	_xccdf_session_free_other_profiles(session);
+	return true;
+}
+
+static void _xccdf_session_free_other_profiles(struct xccdf_session *session)
+{
+	if (session->xccdf.other_profile_ids != NULL) {
+		for (int i = 0; session->xccdf.other_profile_ids[i] != NULL; ++i)
+			oscap_free(session->xccdf.other_profile_ids[i]);
+		oscap_free(session->xccdf.other_profile_ids);
+		session->xccdf.other_profile_ids = NULL;
+	}
+	/* the results themselves are owned by their policies */
+	oscap_free(session->xccdf.other_results);
+	session->xccdf.other_results = NULL;
+}
+
+bool xccdf_session_set_profile_ids(struct xccdf_session *session, const char **profile_ids)
+{
+	if (profile_ids == NULL || profile_ids[0] == NULL)
+		return xccdf_session_set_profile_id(session, NULL);
+
+	size_t count = 0;
+	for (; profile_ids[count] != NULL; ++count)
+		if (xccdf_policy_model_get_policy_by_id(session->xccdf.policy_model, profile_ids[count]) == NULL)
+			return false;
+
+	if (!xccdf_session_set_profile_id(session, profile_ids[0]))
+		return false;
+
+	char **others = oscap_calloc(count, sizeof(char *));
+	size_t others_count = 0;
+	for (size_t i = 1; i < count; ++i) {
+		/* each profile is evaluated once */
+		bool duplicate = oscap_streq(profile_ids[i], profile_ids[0]);
+		for (size_t j = 0; !duplicate && j < others_count; ++j)
+			duplicate = oscap_streq(profile_ids[i], others[j]);
+		if (!duplicate)
+			others[others_count++] = oscap_strdup(profile_ids[i]);
+	}
+	session->xccdf.other_profile_ids = others;
 	return true;
 }
 
@@ -417,6 +515,32 @@ static int _reporter(const char *file, int line, const char *msg, void *arg)
 	return 0;
 }
 
+/**
+ * Take the checklist from the compiled image of the datastream.
+ * @returns 0 if the image was used, 1 if it is not set or out of date, -1 on error
+ */
+static int _xccdf_session_load_compiled(struct xccdf_session *session)
+{
+	if (session->ds.compiled_file == NULL || session->ds.user_benchmark_id != NULL)
+		return 1;
+
+	int ret = ds_sds_session_load_compiled(xccdf_session_get_ds_sds_session(session), session->ds.compiled_file,
+			session->ds.user_datastream_id, session->ds.user_component_id);
+	if (ret == 0) {
+		session->xccdf.source = ds_sds_session_get_component_by_href(xccdf_session_get_ds_sds_session(session), "xccdf.xml");
+		if (session->xccdf.source == NULL) {
+			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Compiled content '%s' doesn't contain any checklist.", session->ds.compiled_file);
+			return -1;
+		}
+	}
+	else if (ret == 1 && session->oval.progress != NULL) {
+		session->oval.progress(true, "WARNING: Compiled content '%s' is out of date or was compiled "
+				"for a different checklist, loading '%s' instead.\n", session->ds.compiled_file,
+				oscap_source_readable_origin(session->source));
+	}
+	return ret;
+}
+
 int xccdf_session_load_xccdf(struct xccdf_session *session)
 {
 	struct xccdf_benchmark *benchmark = NULL;
@@ -428,17 +552,24 @@ int xccdf_session_load_xccdf(struct xccdf_session *session)
 	session->xccdf.source = NULL;
 
 	if (xccdf_session_is_sds(session)) {
-		if (session->validate) {
-			if (oscap_source_validate(session->source, _reporter, NULL)) {
-				oscap_seterr(OSCAP_EFAMILY_OSCAP, "Invalid %s (%s) content in %s",
-						oscap_document_type_to_string(oscap_source_get_scap_type(session->source)),
-						oscap_source_get_schema_version(session->source),
-						oscap_source_readable_origin(session->source));
-				goto cleanup;
+		int compiled = _xccdf_session_load_compiled(session);
+		if (compiled < 0) {
+			goto cleanup;
+		}
+		/* The datastream has been validated when it was compiled */
+		if (compiled > 0) {
+			if (session->validate) {
+				if (oscap_source_validate(session->source, _reporter, NULL)) {
+					oscap_seterr(OSCAP_EFAMILY_OSCAP, "Invalid %s (%s) content in %s",
+							oscap_document_type_to_string(oscap_source_get_scap_type(session->source)),
+							oscap_source_get_schema_version(session->source),
+							oscap_source_readable_origin(session->source));
+					goto cleanup;
+				}
 			}
+			session->xccdf.source = ds_sds_session_select_checklist(xccdf_session_get_ds_sds_session(session), session->ds.user_datastream_id,
+					session->ds.user_component_id, session->ds.user_benchmark_id);
 		}
-		session->xccdf.source = ds_sds_session_select_checklist(xccdf_session_get_ds_sds_session(session), session->ds.user_datastream_id,
-				session->ds.user_component_id, session->ds.user_benchmark_id);
 		if (session->xccdf.source == NULL) {
 			goto cleanup;
 		}
@@ -459,8 +590,9 @@ int xccdf_session_load_xccdf(struct xccdf_session *session)
 		}
 	}
 
-	/* Load XCCDF model and XCCDF Policy model */
-	benchmark = xccdf_benchmark_import_source(session->xccdf.source);
+	/* Load XCCDF model and XCCDF Policy model. The source is kept by the
+	 * session, so the texts are parsed when the output asks for them. */
+	benchmark = xccdf_benchmark_import_source_lazy(session->xccdf.source);
 	if (benchmark == NULL) {
 		goto cleanup;
 	}
@@ -479,69 +611,256 @@ static inline void _connect_cpe_session_with_sds(struct xccdf_session *session)
 	cpe_session_set_cache(cpe_session, sources_cache);
 }
 
+/*
+ * OVAL components and CPE dictionaries are validated and imported by a pool
+ * of threads, each of them into its own model. The jobs share the parsed XSD
+ * schemas, which are cached under a lock, the interned strings and libxml2.
+ * The parsed document and the detected type are cached in the source, so
+ * each job needs a source of its own. The models are registered afterwards,
+ * in the order of the sources.
+ */
+struct xccdf_session_load_job {
+	struct oscap_source *source;
+	bool validate;				///< Shall the source be validated?
+	bool import_oval;			///< Shall the source be imported to an OVAL definition model?
+	bool import_cpe;			///< Shall the source be imported to a CPE dictionary or lang model?
+	int result;				///< 0 on success, 1 if validation failed, 2 if import failed
+	char *error;				///< Errors raised by the job
+	struct oval_definition_model *def_model;
+	struct cpe_dict_model *cpe_dict;
+	struct cpe_lang_model *cpe_lang_model;
+};
+
+struct xccdf_session_load_pool {
+	struct xccdf_session_load_job *jobs;
+	size_t count;
+	volatile size_t next;
+	volatile int failed;
+};
+
+static unsigned int _xccdf_session_load_jobs(void)
+{
+	const char *env = getenv(XCCDF_SESSION_LOAD_JOBS_ENV);
+	char *end;
+	long jobs;
+
+	if (env != NULL) {
+		jobs = strtol(env, &end, 10);
+
+		if (*env == '\0' || *end != '\0' || jobs < 1) {
+			dW("Invalid value of %s: \"%s\", loading sequentially.\n", XCCDF_SESSION_LOAD_JOBS_ENV, env);
+			return 1;
+		}
+		return jobs > XCCDF_SESSION_LOAD_JOBS_MAX ? XCCDF_SESSION_LOAD_JOBS_MAX : jobs;
+	}
+
+	jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	if (jobs < 1)
+		return 1;
+	return jobs > XCCDF_SESSION_LOAD_JOBS_DEFAULT_MAX ? XCCDF_SESSION_LOAD_JOBS_DEFAULT_MAX : jobs;
+}
+
+/* Does any source appear in more than one job of the pool? */
+static bool _xccdf_session_load_pool_shares_source(struct xccdf_session_load_pool *pool)
+{
+	for (size_t i = 1; i < pool->count; i++) {
+		for (size_t j = 0; j < i; j++) {
+			if (pool->jobs[i].source == pool->jobs[j].source)
+				return true;
+		}
+	}
+	return false;
+}
+
+static void *_xccdf_session_load_worker(void *arg)
+{
+	struct xccdf_session_load_pool *pool = arg;
+	size_t idx;
+
+	/* Stop as soon as any component failed, its error is reported alone. */
+	while (!pool->failed && (idx = __sync_fetch_and_add(&pool->next, 1)) < pool->count) {
+		struct xccdf_session_load_job *job = &pool->jobs[idx];
+
+		if (job->validate && oscap_source_validate(job->source, _reporter, NULL) != 0)
+			job->result = 1;
+		else if (job->import_oval && (job->def_model = oval_definition_model_import_source(job->source)) == NULL)
+			job->result = 2;
+		else if (job->import_cpe && !cpe_session_import_cpe_autodetect_source(job->source, &job->cpe_dict, &job->cpe_lang_model))
+			job->result = 2;
+
+		if (job->result != 0) {
+			/* errors are thread-local, hand them over to the caller */
+			job->error = oscap_err_get_full_error();
+			pool->failed = 1;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Run the jobs of the pool, the calling thread being one of the workers.
+ * If a thread can't be created, the jobs are done by the threads that were.
+ */
+static void _xccdf_session_load_run(struct xccdf_session_load_pool *pool)
+{
+	unsigned int jobs = _xccdf_session_load_jobs();
+	pthread_t *threads;
+	unsigned int i, n;
+
+	if (jobs > pool->count)
+		jobs = pool->count;
+	if (jobs < 1 || (jobs > 1 && _xccdf_session_load_pool_shares_source(pool)))
+		jobs = 1;
+	/* libxml2 has to be initialized before it is used by several threads,
+	 * oscap_init() may not have been called by the application. */
+	if (jobs > 1)
+		xmlInitParser();
+
+	threads = oscap_alloc(sizeof(pthread_t) * jobs);
+	for (n = 0; n < jobs - 1; ++n) {
+		int err = pthread_create(&threads[n], NULL, _xccdf_session_load_worker, pool);
+
+		if (err != 0) {
+			dW("Can't create a loading thread: %d, %s.\n", err, strerror(err));
+			break;
+		}
+	}
+
+	_xccdf_session_load_worker(pool);
+
+	for (i = 0; i < n; ++i)
+		pthread_join(threads[i], NULL);
+	oscap_free(threads);
+}
+
+static struct xccdf_session_load_job *_xccdf_session_load_pool_add(struct xccdf_session_load_pool *pool, struct oscap_source *source, bool validate)
+{
+	struct xccdf_session_load_job *job;
+
+	pool->jobs = oscap_realloc(pool->jobs, (pool->count + 1) * sizeof(struct xccdf_session_load_job));
+	job = &pool->jobs[pool->count++];
+	memset(job, 0, sizeof(struct xccdf_session_load_job));
+	job->source = source;
+	job->validate = validate;
+	return job;
+}
+
+/*
+ * Re-raise the errors of the first job, in the order of the sources, which
+ * failed. The jobs are taken in that order, so every job before a failed one
+ * has been done. Returns the index of the job or -1.
+ */
+static int _xccdf_session_load_pool_error(struct xccdf_session_load_pool *pool)
+{
+	for (size_t idx = 0; idx < pool->count; idx++) {
+		if (pool->jobs[idx].result != 0) {
+			if (pool->jobs[idx].error != NULL)
+				oscap_seterr(OSCAP_EFAMILY_OSCAP, "%s", pool->jobs[idx].error);
+			return idx;
+		}
+	}
+	return -1;
+}
+
+static void _xccdf_session_load_pool_free(struct xccdf_session_load_pool *pool)
+{
+	for (size_t idx = 0; idx < pool->count; idx++) {
+		oval_definition_model_free(pool->jobs[idx].def_model);
+		cpe_dict_model_free(pool->jobs[idx].cpe_dict);
+		cpe_lang_model_free(pool->jobs[idx].cpe_lang_model);
+		oscap_free(pool->jobs[idx].error);
+	}
+	oscap_free(pool->jobs);
+}
+
 int xccdf_session_load_cpe(struct xccdf_session *session)
 {
+	struct xccdf_session_load_pool pool = { NULL, 0, 0, 0 };
+	struct oscap_source *user_source = NULL;
+	int failed_idx;
+	int ret = 0;
+
 	if (session == NULL || session->xccdf.policy_model == NULL)
 		return 1;
 
 	/* Use custom CPE dict if given */
 	if (session->user_cpe != NULL) {
-		struct oscap_source *source = oscap_source_new_from_file(session->user_cpe);
-		if (oscap_source_validate(source, _reporter, NULL) != 0) {
-			oscap_source_free(source);
-			return 1;
-		}
-		if (!xccdf_policy_model_add_cpe_autodetect_source(session->xccdf.policy_model, source)) {
-			oscap_source_free(source);
-			return 1;
-		}
-		oscap_source_free(source);
+		user_source = oscap_source_new_from_file(session->user_cpe);
+		_xccdf_session_load_pool_add(&pool, user_source, true)->import_cpe = true;
 	}
 
 	if (xccdf_session_is_sds(session)) {
-		struct ds_sds_index *sds_idx = xccdf_session_get_sds_idx(session);
-		if (sds_idx == NULL) {
-			return -1;
-		}
-		struct ds_stream_index* stream_idx = ds_sds_index_get_stream(sds_idx, xccdf_session_get_datastream_id(session));
-		struct oscap_string_iterator* cpe_it = ds_stream_index_get_dictionaries(stream_idx);
+		struct oscap_string_iterator *cpe_it = ds_sds_session_get_compiled_dictionaries(xccdf_session_get_ds_sds_session(session));
 
-		// This potentially allows us to skip yet another decompose if we are sure
-		// there are no CPE dictionaries or language models inside the datastream.
-		if (oscap_string_iterator_has_more(cpe_it)) {
-			if (ds_sds_session_register_component_with_dependencies(xccdf_session_get_ds_sds_session(session),
-					"dictionaries", NULL, NULL) != 0) {
-				oscap_seterr(OSCAP_EFAMILY_OSCAP, "Can't decompose CPE dictionaries from datastream '%s' "
-						"from file '%s'!\n", xccdf_session_get_datastream_id(session),
-						oscap_source_readable_origin(session->source));
-				oscap_string_iterator_free(cpe_it);
-				return 1;
+		if (cpe_it == NULL) {
+			struct ds_sds_index *sds_idx = xccdf_session_get_sds_idx(session);
+			if (sds_idx == NULL) {
+				ret = -1;
+				goto cleanup;
+			}
+			struct ds_stream_index* stream_idx = ds_sds_index_get_stream(sds_idx, xccdf_session_get_datastream_id(session));
+			cpe_it = ds_stream_index_get_dictionaries(stream_idx);
+
+			// This potentially allows us to skip yet another decompose if we are sure
+			// there are no CPE dictionaries or language models inside the datastream.
+			if (oscap_string_iterator_has_more(cpe_it)) {
+				if (ds_sds_session_register_component_with_dependencies(xccdf_session_get_ds_sds_session(session),
+						"dictionaries", NULL, NULL) != 0) {
+					oscap_seterr(OSCAP_EFAMILY_OSCAP, "Can't decompose CPE dictionaries from datastream '%s' "
+							"from file '%s'!\n", xccdf_session_get_datastream_id(session),
+							oscap_source_readable_origin(session->source));
+					oscap_string_iterator_free(cpe_it);
+					ret = 1;
+					goto cleanup;
+				}
 			}
+		}
+		if (oscap_string_iterator_has_more(cpe_it)) {
 			_connect_cpe_session_with_sds(session);
 			while (oscap_string_iterator_has_more(cpe_it)) {
 				const char* cpe_filename = oscap_string_iterator_next(cpe_it);
 
 				struct oscap_source *source = ds_sds_session_get_component_by_href(xccdf_session_get_ds_sds_session(session), cpe_filename);
-
-				if (session->full_validation) {
-					if (oscap_source_validate(source, _reporter, NULL) != 0) {
-						oscap_seterr(OSCAP_EFAMILY_OSCAP, "Invalid %s (%s) content in %s",
-							oscap_document_type_to_string(oscap_source_get_scap_type(source)),
-							oscap_source_get_schema_version(source),
-							oscap_source_readable_origin(source));
-						oscap_string_iterator_free(cpe_it);
-						return 1;
-					}
-				}
-				if (!xccdf_policy_model_add_cpe_autodetect_source(session->xccdf.policy_model, source)) {
-					oscap_string_iterator_free(cpe_it);
-					return 1;
-				}
+				_xccdf_session_load_pool_add(&pool, source, session->full_validation)->import_cpe = true;
 			}
 		}
 		oscap_string_iterator_free(cpe_it);
 	}
-	return 0;
+
+	if (pool.count == 0)
+		goto cleanup;
+
+	/* source -> CPE dictionary or lang model */
+	_xccdf_session_load_run(&pool);
+
+	if ((failed_idx = _xccdf_session_load_pool_error(&pool)) != -1) {
+		struct oscap_source *source = pool.jobs[failed_idx].source;
+		if (pool.jobs[failed_idx].result == 1 && source != user_source)
+			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Invalid %s (%s) content in %s",
+				oscap_document_type_to_string(oscap_source_get_scap_type(source)),
+				oscap_source_get_schema_version(source),
+				oscap_source_readable_origin(source));
+		ret = 1;
+		goto cleanup;
+	}
+
+	struct cpe_session *cpe_session = xccdf_policy_model_get_cpe_session(session->xccdf.policy_model);
+	for (size_t idx = 0; idx < pool.count; idx++) {
+		struct xccdf_session_load_job *job = &pool.jobs[idx];
+		bool added = cpe_session_add_cpe_models(cpe_session, job->cpe_dict, job->cpe_lang_model);
+		/* the session owns the models now */
+		job->cpe_dict = NULL;
+		job->cpe_lang_model = NULL;
+		if (!added) {
+			ret = 1;
+			goto cleanup;
+		}
+	}
+
+cleanup:
+	_xccdf_session_load_pool_free(&pool);
+	oscap_source_free(user_source);
+	return ret;
 }
 
 static void _oval_content_resources_free(struct oval_content_resource **resources)
@@ -701,6 +1020,8 @@ static void _xccdf_session_free_oval_agents(struct xccdf_session *session)
 int xccdf_session_load_oval(struct xccdf_session *session)
 {
 	struct oval_content_resource **contents = NULL;
+	struct xccdf_session_load_pool pool = { NULL, 0, 0, 0 };
+	int failed_idx;
 
 	_xccdf_session_free_oval_agents(session);
 
@@ -712,38 +1033,44 @@ int xccdf_session_load_oval(struct xccdf_session *session)
 	}
 
 	contents = session->oval.custom_resources != NULL ? session->oval.custom_resources : session->oval.resources;
+	if (contents[0] == NULL)
+		return 0;
 
 	/* Validate OVAL files. Only validate if the file doesn't come from a datastream
 	 * or if full validation was explicitly requested.
 	 */
-	if (session->validate && (!xccdf_session_is_sds(session) || session->full_validation)) {
-		for (int idx=0; contents[idx]; idx++) {
-			if (oscap_source_validate(contents[idx]->source, _reporter, NULL) != 0) {
-				oscap_seterr(OSCAP_EFAMILY_OSCAP, "Invalid %s (%s) content in %s",
-						oscap_document_type_to_string(oscap_source_get_scap_type(session->source)),
-						oscap_source_get_schema_version(session->source),
-						contents[idx]->href);
-				return 1;
-			}
-		}
-	}
+	bool validate = session->validate && (!xccdf_session_is_sds(session) || session->full_validation);
+	for (int idx=0; contents[idx]; idx++)
+		_xccdf_session_load_pool_add(&pool, contents[idx]->source, validate)->import_oval = true;
+
+	/* file -> def_model */
+	_xccdf_session_load_run(&pool);
 
-	for (int idx=0; contents[idx]; idx++) {
-		/* file -> def_model */
-		struct oval_definition_model *tmp_def_model = oval_definition_model_import_source(contents[idx]->source);
-		if (tmp_def_model == NULL) {
+	if ((failed_idx = _xccdf_session_load_pool_error(&pool)) != -1) {
+		if (pool.jobs[failed_idx].result == 1)
+			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Invalid %s (%s) content in %s",
+					oscap_document_type_to_string(oscap_source_get_scap_type(session->source)),
+					oscap_source_get_schema_version(session->source),
+					contents[failed_idx]->href);
+		else
 			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Failed to create OVAL definition model from: '%s'.",
-				oscap_source_readable_origin(contents[idx]->source));
-			return 1;
-		}
+				oscap_source_readable_origin(contents[failed_idx]->source));
+		_xccdf_session_load_pool_free(&pool);
+		return 1;
+	}
+
+	for (size_t idx = 0; idx < pool.count; idx++) {
+		struct oval_definition_model *tmp_def_model = pool.jobs[idx].def_model;
 
 		/* def_model -> session */
 		struct oval_agent_session *tmp_sess = oval_agent_new_session(tmp_def_model, contents[idx]->href);
 		if (tmp_sess == NULL) {
 			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Failed to create new OVAL agent session for: '%s'.", contents[idx]->href);
-			oval_definition_model_free(tmp_def_model);
+			_xccdf_session_load_pool_free(&pool);
 			return 2;
 		}
+		/* the model is owned by the agent session now */
+		pool.jobs[idx].def_model = NULL;
 
 		/* store our name in the generated documents */
 		oval_agent_set_product_name(tmp_sess, session->oval.product_cpe != NULL ?
@@ -762,6 +1089,7 @@ int xccdf_session_load_oval(struct xccdf_session *session)
 		else
 			xccdf_policy_model_register_engine_oval(session->xccdf.policy_model, tmp_sess);
 	}
+	_xccdf_session_load_pool_free(&pool);
 	return 0;
 }
 
@@ -866,41 +1194,84 @@ int xccdf_session_load_tailoring(struct xccdf_session *session)
 	return xccdf_policy_model_set_tailoring(session->xccdf.policy_model, tailoring) ? 0 : 1;
 }
 
-int xccdf_session_evaluate(struct xccdf_session *session)
+static struct xccdf_result *_xccdf_session_evaluate_policy(struct xccdf_session *session, struct xccdf_policy *policy, float *base_score)
 {
-	struct xccdf_policy *policy = xccdf_session_get_xccdf_policy(session);
-	if (policy == NULL) {
-		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Cannot build xccdf_policy.");
-		return 1;
-	}
-
-	session->xccdf.result = xccdf_policy_evaluate(policy);
-	if (session->xccdf.result == NULL)
-		return 1;
+	struct xccdf_result *result = xccdf_policy_evaluate(policy);
+	if (result == NULL)
+		return NULL;
 
 	/* Write results into XCCDF Test Result model */
-	xccdf_result_set_benchmark_uri(session->xccdf.result, oscap_source_readable_origin(session->source));
+	xccdf_result_set_benchmark_uri(result, oscap_source_readable_origin(session->source));
 	struct oscap_text *title = oscap_text_new();
 	oscap_text_set_text(title, "OSCAP Scan Result");
-	xccdf_result_add_title(session->xccdf.result, title);
+	xccdf_result_add_title(result, title);
 	struct xccdf_benchmark *benchmark = xccdf_policy_get_benchmark(policy);
-	xccdf_result_set_version(session->xccdf.result,
+	xccdf_result_set_version(result,
 			benchmark != NULL ? xccdf_benchmark_get_version(benchmark) : NULL);
 
-	xccdf_result_fill_sysinfo(session->xccdf.result);
+	xccdf_result_fill_sysinfo(result);
 
 	struct xccdf_model_iterator *model_it = xccdf_benchmark_get_models(xccdf_policy_model_get_benchmark(session->xccdf.policy_model));
 	while (xccdf_model_iterator_has_more(model_it)) {
 		struct xccdf_model *model = xccdf_model_iterator_next(model_it);
 		const char *score_model = xccdf_model_get_system(model);
-		struct xccdf_score *score = xccdf_policy_get_score(policy, session->xccdf.result, score_model);
-		xccdf_result_add_score(session->xccdf.result, score);
+		struct xccdf_score *score = xccdf_policy_get_score(policy, result, score_model);
+		xccdf_result_add_score(result, score);
 
 		/* record default base score for later use */
 		if (!strcmp(score_model, "urn:xccdf:scoring:default"))
-			session->xccdf.base_score = xccdf_score_get_score(score);
+			*base_score = xccdf_score_get_score(score);
 	}
 	xccdf_model_iterator_free(model_it);
+	return result;
+}
+
+int xccdf_session_evaluate(struct xccdf_session *session)
+{
+	struct xccdf_policy *policy = xccdf_session_get_xccdf_policy(session);
+	if (policy == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Cannot build xccdf_policy.");
+		return 1;
+	}
+
+	if (session->oval.sysinfo_outdated && session->oval.agents != NULL) {
+		for (int i = 0; session->oval.agents[i] != NULL; ++i) {
+			if (oval_agent_refresh_sysinfo(session->oval.agents[i]) != 0)
+				return 1;
+		}
+		session->oval.sysinfo_outdated = false;
+	}
+
+	session->xccdf.result = _xccdf_session_evaluate_policy(session, policy, &session->xccdf.base_score);
+	if (session->xccdf.result == NULL)
+		return 1;
+
+	/*
+	 * The other profiles are evaluated over the same OVAL agent sessions,
+	 * the objects collected for the first profile are not collected again.
+	 */
+	oscap_free(session->xccdf.other_results);
+	session->xccdf.other_results = NULL;
+	if (session->xccdf.other_profile_ids != NULL) {
+		size_t count = 0;
+		while (session->xccdf.other_profile_ids[count] != NULL)
+			++count;
+		session->xccdf.other_results = oscap_calloc(count + 1, sizeof(struct xccdf_result *));
+
+		for (size_t i = 0; i < count; ++i) {
+			float base_score;
+			struct xccdf_policy *other = xccdf_policy_model_get_policy_by_id(
+					session->xccdf.policy_model, session->xccdf.other_profile_ids[i]);
+			if (other == NULL) {
+				oscap_seterr(OSCAP_EFAMILY_OSCAP, "Cannot build xccdf_policy for profile '%s'.",
+						session->xccdf.other_profile_ids[i]);
+				return 1;
+			}
+			session->xccdf.other_results[i] = _xccdf_session_evaluate_policy(session, other, &base_score);
+			if (session->xccdf.other_results[i] == NULL)
+				return 1;
+		}
+	}
 	return 0;
 }
 
@@ -954,7 +1325,8 @@ static int _build_xccdf_result_source(struct xccdf_session *session)
 	}
 
 	/* Build oscap_source of XCCDF TestResult only when needed */
-	if (session->export.xccdf_file != NULL || session->export.report_file != NULL || session->export.arf_file != NULL) {
+	if (session->export.xccdf_file != NULL || session->export.arf_file != NULL ||
+			(session->export.report_file != NULL && !session->export.native_report)) {
 		if (session->xccdf.result == NULL) {
 			// Attempt to export session before evaluation
 			oscap_seterr(OSCAP_EFAMILY_OSCAP, "No XCCDF results to export.");
@@ -962,6 +1334,10 @@ static int _build_xccdf_result_source(struct xccdf_session *session)
 		}
 		xccdf_benchmark_add_result(xccdf_policy_model_get_benchmark(session->xccdf.policy_model),
 				xccdf_result_clone(session->xccdf.result));
+		/* one TestResult per evaluated profile */
+		for (int i = 0; session->xccdf.other_results != NULL && session->xccdf.other_results[i] != NULL; ++i)
+			xccdf_benchmark_add_result(xccdf_policy_model_get_benchmark(session->xccdf.policy_model),
+					xccdf_result_clone(session->xccdf.other_results[i]));
 		session->xccdf.result_source = xccdf_benchmark_export_source(
 				xccdf_policy_model_get_benchmark(session->xccdf.policy_model), session->export.xccdf_file);
 
@@ -993,7 +1369,17 @@ int xccdf_session_export_xccdf(struct xccdf_session *session)
 	}
 
 	/* generate report */
-	if (session->export.report_file != NULL)
+	if (session->export.report_file != NULL && session->export.native_report) {
+		if (session->xccdf.result == NULL) {
+			oscap_seterr(OSCAP_EFAMILY_OSCAP, "No XCCDF results to export.");
+			return 1;
+		}
+		/* Stream the report straight from the in-memory model, no XML round-trip */
+		if (xccdf_result_export_html_report(xccdf_session_get_xccdf_policy(session),
+				session->xccdf.result, session->oval.agents, session->export.report_file) != 0)
+			return 1;
+	}
+	else if (session->export.report_file != NULL)
 		_xccdf_gen_report(session->xccdf.result_source,
 				xccdf_result_get_id(session->xccdf.result),
 				session->export.report_file,
@@ -1275,25 +1661,22 @@ int xccdf_session_export_arf(struct xccdf_session *session)
 			free(sds_path);
 		}
 
-		struct oscap_source *arf_source = ds_rds_create_source(sds_source, session->xccdf.result_source, session->oval.result_sources, session->export.arf_file);
+		int ret = ds_rds_create_from_sources(sds_source, session->xccdf.result_source, session->oval.result_sources, session->export.arf_file);
 		if (!xccdf_session_is_sds(session)) {
 			oscap_source_free(sds_source);
 		}
-		if (arf_source == NULL) {
+		if (ret != 0) {
 			return 1;
 		}
 
-		if (oscap_source_save_as(arf_source, NULL) != 0) {
-			oscap_source_free(arf_source);
-			return 1;
-		}
 		if (session->full_validation) {
+			struct oscap_source *arf_source = oscap_source_new_from_file(session->export.arf_file);
 			if (oscap_source_validate(arf_source, _reporter, NULL) != 0) {
 				oscap_source_free(arf_source);
 				return 1;
 			}
+			oscap_source_free(arf_source);
 		}
-		oscap_source_free(arf_source);
 	}
 	return 0;
 }
@@ -1337,9 +1720,9 @@ unsigned int xccdf_session_get_cpe_oval_agents_count(const struct xccdf_session
 	return i;
 }
 
-bool xccdf_session_contains_fail_result(const struct xccdf_session *session)
+static bool _xccdf_result_contains_fail(const struct xccdf_result *result)
 {
-	struct xccdf_rule_result_iterator *res_it = xccdf_result_get_rule_results(session->xccdf.result);
+	struct xccdf_rule_result_iterator *res_it = xccdf_result_get_rule_results(result);
 	while (xccdf_rule_result_iterator_has_more(res_it)) {
 		struct xccdf_rule_result *res = xccdf_rule_result_iterator_next(res_it);
 		xccdf_test_result_type_t rule_result = xccdf_rule_result_get_result(res);
@@ -1354,6 +1737,16 @@ bool xccdf_session_contains_fail_result(const struct xccdf_session *session)
 	return false;
 }
 
+bool xccdf_session_contains_fail_result(const struct xccdf_session *session)
+{
+	if (_xccdf_result_contains_fail(session->xccdf.result))
+		return true;
+	for (int i = 0; session->xccdf.other_results != NULL && session->xccdf.other_results[i] != NULL; ++i)
+		if (_xccdf_result_contains_fail(session->xccdf.other_results[i]))
+			return true;
+	return false;
+}
+
 int xccdf_session_remediate(struct xccdf_session *session)
 {
 	int res = 0;
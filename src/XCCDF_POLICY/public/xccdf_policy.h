@@ -97,6 +97,18 @@ typedef void *(*xccdf_policy_engine_query_fn) (void *, xccdf_policy_engine_query
  */
 typedef xccdf_test_result_type_t (*xccdf_policy_engine_eval_fn) (struct xccdf_policy *policy, const char *rule_id, const char *definition_id, const char *href_if, struct xccdf_value_binding_iterator *value_binding_it, struct xccdf_check_import_iterator *check_imports_it, void *user_data);
 
+/**
+ * Type of function which lets a checking engine start the evaluation of checks ahead of time.
+ *
+ * Before the rules are evaluated, xccdf_policy_evaluate passes the first check-content-ref
+ * of the check of each selected and applicable rule to the function, with the same
+ * arguments the xccdf_policy_engine_eval_fn will get later for that check. The engine
+ * may then evaluate the checks in background and hand out the results when asked for
+ * them. Once the evaluation is over the function is called once more with NULL href,
+ * the engine shall drop everything it has started and hasn't been asked for.
+ */
+typedef void (*xccdf_policy_engine_prefetch_fn) (struct xccdf_policy *policy, const char *definition_id, const char *href, struct xccdf_value_binding_iterator *value_binding_it, void *user_data);
+
 /************************************************************/
 
 /**
@@ -265,6 +277,17 @@ OSCAP_DEPRECATED(bool xccdf_policy_model_register_engine_callback(struct xccdf_p
  */
 bool xccdf_policy_model_register_engine_and_query_callback(struct xccdf_policy_model *model, char *sys, xccdf_policy_engine_eval_fn eval_fn, void *usr, xccdf_policy_engine_query_fn query_fn);
 
+/**
+ * Function to register prefetch callback for already registered checking system
+ * @param model XCCDF Policy Model
+ * @param sys String representing given checking system
+ * @param usr user data the checking system has been registered with
+ * @param prefetch_fn Callback - pointer to function called by XCCDF Policy system before rules are evaluated
+ * @memberof xccdf_policy_model
+ * @return true if the checking system has been found, false otherwise
+ */
+bool xccdf_policy_model_register_engine_prefetch(struct xccdf_policy_model *model, const char *sys, void *usr, xccdf_policy_engine_prefetch_fn prefetch_fn);
+
 typedef int (*policy_reporter_output)(struct xccdf_rule_result *, void *);
 
 /**
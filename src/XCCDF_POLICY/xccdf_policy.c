@@ -1111,6 +1111,99 @@ static int xccdf_policy_item_evaluate(struct xccdf_policy * policy, struct xccdf
     return ret;
 }
 
+/**
+ * Pass the check of given rule to the checking engines which can evaluate it ahead of time.
+ * Only the first check-content-ref of a simple check is passed, complex checks and
+ * the alternative check-content-refs are left for the evaluation itself.
+ */
+static void _xccdf_policy_rule_prefetch(struct xccdf_policy *policy, const struct xccdf_rule *rule)
+{
+	const char *rule_id = xccdf_rule_get_id(rule);
+	if (!xccdf_policy_is_item_selected(policy, rule_id))
+		return;
+
+	struct xccdf_refine_rule_internal *r_rule = oscap_htable_get(policy->refine_rules_internal, rule_id);
+	if (xccdf_get_final_role(rule, r_rule) == XCCDF_ROLE_UNCHECKED)
+		return;
+	if (!xccdf_policy_model_item_is_applicable(policy->model, (struct xccdf_item *) rule))
+		return;
+
+	const struct xccdf_check *check = _xccdf_policy_rule_get_applicable_check(policy, (struct xccdf_item *) rule);
+	if (check == NULL || xccdf_check_get_complex(check))
+		return;
+
+	const char *system_name = xccdf_check_get_system(check);
+	struct oscap_iterator *cb_it = _xccdf_policy_get_engines_by_sysname(policy, system_name);
+	bool can_prefetch = false;
+	while (oscap_iterator_has_more(cb_it) && !can_prefetch)
+		can_prefetch = xccdf_policy_engine_can_prefetch(oscap_iterator_next(cb_it));
+	if (!can_prefetch) {
+		oscap_iterator_free(cb_it);
+		return;
+	}
+
+	struct xccdf_check_content_ref_iterator *content_it = xccdf_check_get_content_refs(check);
+	if (xccdf_check_content_ref_iterator_has_more(content_it)) {
+		struct xccdf_check_content_ref *content = xccdf_check_content_ref_iterator_next(content_it);
+		struct oscap_list *bindings = xccdf_policy_check_get_value_bindings(policy, xccdf_check_get_exports(check));
+		if (bindings != NULL) {
+			oscap_iterator_reset(cb_it);
+			while (oscap_iterator_has_more(cb_it)) {
+				struct xccdf_policy_engine *engine = oscap_iterator_next(cb_it);
+				xccdf_policy_engine_prefetch(engine, policy, xccdf_check_content_ref_get_name(content),
+						xccdf_check_content_ref_get_href(content), bindings);
+			}
+			oscap_list_free(bindings, (oscap_destruct_func) xccdf_value_binding_free);
+		}
+	}
+	xccdf_check_content_ref_iterator_free(content_it);
+	oscap_iterator_free(cb_it);
+}
+
+static void _xccdf_policy_item_prefetch(struct xccdf_policy *policy, struct xccdf_item *item)
+{
+	switch (xccdf_item_get_type(item)) {
+	case XCCDF_RULE:
+		_xccdf_policy_rule_prefetch(policy, (struct xccdf_rule *) item);
+		break;
+	case XCCDF_GROUP: {
+		struct xccdf_item_iterator *child_it = xccdf_group_get_content((const struct xccdf_group *) item);
+		while (xccdf_item_iterator_has_more(child_it))
+			_xccdf_policy_item_prefetch(policy, xccdf_item_iterator_next(child_it));
+		xccdf_item_iterator_free(child_it);
+	} break;
+	default:
+		break;
+	}
+}
+
+/**
+ * Let the checking engines start the evaluation of the checks of the benchmark
+ * (prefetch == true), or drop what has been started and not used (prefetch == false).
+ */
+static void _xccdf_policy_prefetch(struct xccdf_policy *policy, struct xccdf_benchmark *benchmark, bool prefetch)
+{
+	bool can_prefetch = false;
+	struct oscap_iterator *cb_it = oscap_iterator_new(policy->model->engines);
+	while (oscap_iterator_has_more(cb_it)) {
+		struct xccdf_policy_engine *engine = oscap_iterator_next(cb_it);
+		if (!xccdf_policy_engine_can_prefetch(engine))
+			continue;
+		can_prefetch = true;
+		if (!prefetch)
+			xccdf_policy_engine_prefetch(engine, policy, NULL, NULL, NULL);
+	}
+	oscap_iterator_free(cb_it);
+
+	if (!can_prefetch || !prefetch)
+		return;
+
+	struct xccdf_item_iterator *item_it = xccdf_benchmark_get_content(benchmark);
+	while (xccdf_item_iterator_has_more(item_it))
+		_xccdf_policy_item_prefetch(policy, xccdf_item_iterator_next(item_it));
+	xccdf_item_iterator_free(item_it);
+}
+
 struct oscap_file_entry {
 	char* system_name;
 	char* file;
@@ -1545,6 +1638,21 @@ xccdf_policy_model_register_engine_and_query_callback(struct xccdf_policy_model
 	return oscap_list_add(model->engines, engine);
 }
 
+bool
+xccdf_policy_model_register_engine_prefetch(struct xccdf_policy_model *model, const char *sys, void *usr, xccdf_policy_engine_prefetch_fn prefetch_fn)
+{
+	__attribute__nonnull__(model);
+	bool ret = false;
+	struct oscap_iterator *cb_it = oscap_iterator_new_filter(model->engines, (oscap_filter_func) xccdf_policy_engine_filter, (void *) sys);
+	while (oscap_iterator_has_more(cb_it)) {
+		struct xccdf_policy_engine *engine = oscap_iterator_next(cb_it);
+		if (xccdf_policy_engine_set_prefetch(engine, usr, prefetch_fn))
+			ret = true;
+	}
+	oscap_iterator_free(cb_it);
+	return ret;
+}
+
 void xccdf_policy_model_unregister_engines(struct xccdf_policy_model *model, const char *sys)
 {
 	__attribute__nonnull__(model);
@@ -2053,12 +2161,15 @@ struct xccdf_result * xccdf_policy_evaluate(struct xccdf_policy * policy)
 
 	/** We need to process document top-down order.
 	 * See conflicts/requires and Item Processing Algorithm */
+	_xccdf_policy_prefetch(policy, benchmark, true);
+
 	struct xccdf_item_iterator *item_it = xccdf_benchmark_get_content(benchmark);
 	while (xccdf_item_iterator_has_more(item_it)) {
 		struct xccdf_item *item = xccdf_item_iterator_next(item_it);
 		ret = xccdf_policy_item_evaluate(policy, item, result);
 		if (ret == -1) {
 			xccdf_item_iterator_free(item_it);
+			_xccdf_policy_prefetch(policy, benchmark, false);
 			xccdf_result_free(result);
 			return NULL;
 		}
@@ -2066,6 +2177,7 @@ struct xccdf_result * xccdf_policy_evaluate(struct xccdf_policy * policy)
 			break;
 	}
 	xccdf_item_iterator_free(item_it);
+	_xccdf_policy_prefetch(policy, benchmark, false);
 
 	xccdf_policy_add_final_setvalues(policy, xccdf_benchmark_to_item(benchmark), result);
 
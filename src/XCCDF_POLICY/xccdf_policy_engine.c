@@ -35,6 +35,7 @@ struct xccdf_policy_engine {
 	xccdf_policy_engine_eval_fn callback;   ///< format of callback function
 	void * usr;                             ///< User data structure
 	xccdf_policy_engine_query_fn query_fn;  ///< query callback function
+	xccdf_policy_engine_prefetch_fn prefetch_fn; ///< prefetch callback function
 };
 
 struct xccdf_policy_engine *xccdf_policy_engine_new(char *sys, xccdf_policy_engine_eval_fn eval_fn, void *usr, xccdf_policy_engine_query_fn query_fn)
@@ -45,6 +46,7 @@ struct xccdf_policy_engine *xccdf_policy_engine_new(char *sys, xccdf_policy_engi
 		engine->callback = eval_fn;
 		engine->usr = usr;
 		engine->query_fn = query_fn;
+		engine->prefetch_fn = NULL;
 	}
 	return engine;
 }
@@ -75,3 +77,27 @@ struct oscap_stringlist *xccdf_policy_engine_query(struct xccdf_policy_engine *e
 		return NULL;
 	return (struct oscap_stringlist *) engine->query_fn(engine->usr, query_type, query_data);
 }
+
+bool xccdf_policy_engine_set_prefetch(struct xccdf_policy_engine *engine, void *usr, xccdf_policy_engine_prefetch_fn prefetch_fn)
+{
+	if (engine->usr != usr)
+		return false;
+	engine->prefetch_fn = prefetch_fn;
+	return true;
+}
+
+bool xccdf_policy_engine_can_prefetch(struct xccdf_policy_engine *engine)
+{
+	return engine->prefetch_fn != NULL;
+}
+
+void xccdf_policy_engine_prefetch(struct xccdf_policy_engine *engine, struct xccdf_policy *policy, const char *definition_id, const char *href_id, struct oscap_list *value_bindings)
+{
+	if (engine->prefetch_fn == NULL)
+		return;
+	struct xccdf_value_binding_iterator *binding_it = value_bindings == NULL ? NULL :
+		(struct xccdf_value_binding_iterator *) oscap_iterator_new(value_bindings);
+	engine->prefetch_fn(policy, definition_id, href_id, binding_it, engine->usr);
+	if (binding_it != NULL)
+		xccdf_value_binding_iterator_free(binding_it);
+}
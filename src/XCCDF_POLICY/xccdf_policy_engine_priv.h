@@ -77,6 +77,33 @@ xccdf_test_result_type_t xccdf_policy_engine_eval(struct xccdf_policy_engine *en
  */
 struct oscap_stringlist *xccdf_policy_engine_query(struct xccdf_policy_engine *engine, xccdf_policy_engine_query_t query_type, void *query_data);
 
+/**
+ * Set the prefetch function of the given checking engine
+ * @memberof xccdf_policy_engine
+ * @param engine Checking engine
+ * @param usr User data the engine has been created with
+ * @param prefetch_fn The prefetch function
+ * @returns true if the engine has been created with the given user data
+ */
+bool xccdf_policy_engine_set_prefetch(struct xccdf_policy_engine *engine, void *usr, xccdf_policy_engine_prefetch_fn prefetch_fn);
+
+/**
+ * Find out whether the given checking engine has a prefetch function
+ * @memberof xccdf_policy_engine
+ */
+bool xccdf_policy_engine_can_prefetch(struct xccdf_policy_engine *engine);
+
+/**
+ * Execute the prefetch function of the given checking engine, if any
+ * @memberof xccdf_policy_engine
+ * @param engine Checking engine
+ * @param policy XCCDF Policy
+ * @param definition_id ID of definition to evaluate
+ * @param href_id The @href attribute of check-content-ref, NULL once the evaluation is over
+ * @param value_bindings Value binding
+ */
+void xccdf_policy_engine_prefetch(struct xccdf_policy_engine *engine, struct xccdf_policy *policy, const char *definition_id, const char *href_id, struct oscap_list *value_bindings);
+
 OSCAP_HIDDEN_END;
 
 #endif
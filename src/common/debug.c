@@ -30,40 +30,86 @@
 # include <stdarg.h>
 # include <string.h>
 # include <stdlib.h>
+# include <stdint.h>
+# include <stdbool.h>
+# include <errno.h>
+# include <fcntl.h>
+# include <signal.h>
 # include <sys/types.h>
-# include <sys/file.h>
+# include <sys/stat.h>
 # include <unistd.h>
 # include <time.h>
+# include <pthread.h>
+# include <sched.h>
 
 # include <sexp.h>
 # include <sexp-output.h>
 
 # include "debug_priv.h"
+# include "debug_trace.h"
 
 #ifndef PATH_SEPARATOR
 # define PATH_SEPARATOR '/'
 #endif
 
-#  if defined(OSCAP_THREAD_SAFE)
-#   include <pthread.h>
-static pthread_mutex_t __debuglog_mutex = PTHREAD_MUTEX_INITIALIZER;
-#  endif
-static FILE *__debuglog_fp = NULL;
+/*
+ * Every thread formats its messages into its own ring buffer and the flusher
+ * thread writes the buffers to the trace file, see debug_trace.h. Logging
+ * doesn't take any lock. When the buffer of a thread stays full even after
+ * yielding to the flusher, its messages are dropped and only their number
+ * gets to the trace.
+ */
+
+#define DEBUGLOG_MSG_MAX       (OSCAP_DEBUG_BUFFER_SIZE / 4)
+#define DEBUGLOG_FLUSH_NSEC    10000000
+#define DEBUGLOG_FULL_RETRIES  16
+#define DEBUGLOG_WRITE_BUFFER  65536
+#define DEBUGLOG_PAD           0xff
+#define DEBUGLOG_ALIGN(size)   (((size) + 7) & ~((size_t) 7))
+
+struct debuglog_entry {
+	uint32_t size;                  ///< size of the entry including the message, aligned
+	uint8_t  type;                  ///< OSCAP_DEBUG_TRACE_* or DEBUGLOG_PAD
+	uint8_t  level;
+	uint32_t line;
+	uint32_t msg_len;
+	uint64_t seq;
+	const char *file;
+	const char *fn;
+	char msg[];
+};
+
+struct debuglog_buffer {
+	char *data;                     ///< ring of debuglog_entry structures
+	volatile uint64_t head;         ///< written by the owner thread only
+	volatile uint64_t tail;         ///< written by the flusher only
+	uint32_t lost;                  ///< entries dropped since the last one written
+	uint64_t thread;
+	volatile int finished;          ///< the owner thread has exited
+	struct debuglog_buffer *next;
+};
+
 int __debuglog_level  = -1;
 static int __debuglog_pstrip = -1;
 
-#if defined(OSCAP_THREAD_SAFE)
-# define __LOCK_FP    do { if (pthread_mutex_lock   (&__debuglog_mutex) != 0) abort(); } while(0)
-# define __UNLOCK_FP  do { if (pthread_mutex_unlock (&__debuglog_mutex) != 0) abort(); } while(0)
-#else
-# define __LOCK_FP   while(0)
-# define __UNLOCK_FP while(0)
-#endif
-
-static void __oscap_debuglog_close(void)
-{
-        fclose(__debuglog_fp);
-}
+static pthread_mutex_t __debuglog_mutex = PTHREAD_MUTEX_INITIALIZER;
+static volatile int __debuglog_state = 0;       ///< 0 - not started, 1 - logging, -1 - disabled
+static bool __debuglog_registered = false;
+static bool __debuglog_key_created = false;
+static pthread_key_t __debuglog_key;
+static pthread_t __debuglog_flusher;
+static pthread_mutex_t __debuglog_flusher_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t __debuglog_flusher_cond = PTHREAD_COND_INITIALIZER;
+static bool __debuglog_flusher_running = false;
+static volatile int __debuglog_stop = 0;
+
+static struct debuglog_buffer *volatile __debuglog_buffers = NULL;
+static __thread struct debuglog_buffer *__debuglog_buffer = NULL;
+static volatile uint64_t __debuglog_seq = 0;
+
+static int __debuglog_fd = -1;
+static char __debuglog_wbuf[DEBUGLOG_WRITE_BUFFER];
+static size_t __debuglog_wbuf_len = 0;
 
 static const char *__oscap_path_rstrip(const char *path, int num)
 {
@@ -81,61 +127,246 @@ static const char *__oscap_path_rstrip(const char *path, int num)
 	return (path);
 }
 
-static void __oscap_vdlprintf(int level, const char *file, const char *fn, size_t line, const char *fmt, va_list ap)
+static void __oscap_debuglog_out_flush(void)
 {
-	char  l;
-	const char *f;
-
-	__LOCK_FP;
-
-	if (__debuglog_level == -1) {
-		char *env;
+	size_t written = 0;
+
+	while (__debuglog_fd != -1 && written < __debuglog_wbuf_len) {
+		ssize_t ret = write(__debuglog_fd, __debuglog_wbuf + written, __debuglog_wbuf_len - written);
+		if (ret == -1) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		written += ret;
+	}
+	__debuglog_wbuf_len = 0;
+}
 
-		env = getenv(OSCAP_DEBUG_LEVEL_ENV);
-		if (env == NULL)
-			__debuglog_level = DBG_I;
-		else
-			__debuglog_level = atoi(env);
+static void __oscap_debuglog_out(const void *data, size_t len)
+{
+	while (len > 0) {
+		size_t chunk = DEBUGLOG_WRITE_BUFFER - __debuglog_wbuf_len;
+
+		if (chunk > len)
+			chunk = len;
+		memcpy(__debuglog_wbuf + __debuglog_wbuf_len, data, chunk);
+		__debuglog_wbuf_len += chunk;
+		data = (const char *) data + chunk;
+		len -= chunk;
+
+		if (__debuglog_wbuf_len == DEBUGLOG_WRITE_BUFFER)
+			__oscap_debuglog_out_flush();
 	}
-	if (__debuglog_level < level) {
-		__UNLOCK_FP;
-		return;
+}
+
+/*
+ * Write the entries of the buffer to the trace file and free the space.
+ * Called by the flusher only.
+ */
+static void __oscap_debuglog_drain(struct debuglog_buffer *buf)
+{
+	uint64_t head = buf->head;
+	uint64_t tail = buf->tail;
+
+	__sync_synchronize();
+
+	while (tail != head) {
+		const struct debuglog_entry *entry = (const struct debuglog_entry *) (buf->data + tail % OSCAP_DEBUG_BUFFER_SIZE);
+
+		if (entry->type != DEBUGLOG_PAD) {
+			struct oscap_debug_trace_record rec;
+			const char *file = entry->file != NULL ? entry->file : "";
+			const char *fn = entry->fn != NULL ? entry->fn : "";
+
+			if (__debuglog_pstrip != 0)
+				file = __oscap_path_rstrip(file, __debuglog_pstrip);
+
+			memset(&rec, 0, sizeof rec);
+			rec.type = entry->type;
+			rec.level = entry->level;
+			rec.file_len = strlen(file);
+			rec.fn_len = strlen(fn);
+			rec.line = entry->line;
+			rec.msg_len = entry->msg_len;
+			rec.seq = entry->seq;
+			rec.thread = buf->thread;
+
+			__oscap_debuglog_out(&rec, sizeof rec);
+			__oscap_debuglog_out(file, rec.file_len);
+			__oscap_debuglog_out(fn, rec.fn_len);
+			__oscap_debuglog_out(entry->msg, rec.msg_len);
+		}
+		tail += entry->size;
 	}
-	if (__debuglog_fp == NULL) {
-		char *logfile, pathbuf[4096];
-		char *st;
-		time_t ut;
 
-		logfile = getenv(OSCAP_DEBUG_FILE_ENV);
+	__sync_synchronize();
+	buf->tail = tail;
+}
 
-		if (logfile == NULL)
-			logfile = OSCAP_DEBUG_FILE;
+static void __oscap_debuglog_drain_lost(struct debuglog_buffer *buf)
+{
+	struct oscap_debug_trace_record rec;
+
+	memset(&rec, 0, sizeof rec);
+	rec.type = OSCAP_DEBUG_TRACE_LOST;
+	rec.level = DBG_W;
+	rec.line = buf->lost;
+	rec.seq = __sync_fetch_and_add(&__debuglog_seq, 1);
+	rec.thread = buf->thread;
+	__oscap_debuglog_out(&rec, sizeof rec);
+}
 
-		if (snprintf(pathbuf, sizeof pathbuf, "%s.%u",
-			     logfile, (unsigned int)getpid()) >= (signed int) sizeof pathbuf)
-		{
-                        __UNLOCK_FP;
-			return;
+/*
+ * Drain all buffers, the buffers of exited threads are freed.
+ * Called by the flusher only, `final' is set when the process exits.
+ */
+static void __oscap_debuglog_flush(bool final)
+{
+	struct debuglog_buffer *prev = NULL;
+	struct debuglog_buffer *buf = __debuglog_buffers;
+
+	while (buf != NULL) {
+		struct debuglog_buffer *next = buf->next;
+		int finished = buf->finished;
+
+		__sync_synchronize();
+		__oscap_debuglog_drain(buf);
+
+		if ((finished || final) && buf->lost > 0) {
+			__oscap_debuglog_drain_lost(buf);
+			buf->lost = 0;
+		}
+		if (!finished) {
+			prev = buf;
+			buf = next;
+			continue;
+		}
+		/* Nobody writes to the buffer anymore. New buffers are pushed
+		 * to the front of the list, the rest of it belongs to us. */
+		if (prev == NULL && !__sync_bool_compare_and_swap(&__debuglog_buffers, buf, next)) {
+			prev = __debuglog_buffers;
+			while (prev->next != buf)
+				prev = prev->next;
 		}
+		if (prev != NULL)
+			prev->next = next;
+		free(buf->data);
+		free(buf);
+		buf = next;
+	}
 
-                __debuglog_fp = fopen (pathbuf, "w");
+	__oscap_debuglog_out_flush();
+}
 
-		if (__debuglog_fp == NULL) {
-			__UNLOCK_FP;
-			return;
+static void *__oscap_debuglog_flusher_fn(void *arg)
+{
+	struct timespec deadline;
+
+	pthread_mutex_lock(&__debuglog_flusher_mutex);
+	while (!__debuglog_stop) {
+		pthread_mutex_unlock(&__debuglog_flusher_mutex);
+		__oscap_debuglog_flush(false);
+		pthread_mutex_lock(&__debuglog_flusher_mutex);
+
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_nsec += DEBUGLOG_FLUSH_NSEC;
+		if (deadline.tv_nsec >= 1000000000) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000;
 		}
+		if (!__debuglog_stop)
+			pthread_cond_timedwait(&__debuglog_flusher_cond, &__debuglog_flusher_mutex, &deadline);
+	}
+	pthread_mutex_unlock(&__debuglog_flusher_mutex);
 
-		setbuf(__debuglog_fp, NULL);
+	return NULL;
+}
 
-		ut = time(NULL);
-		st = ctime(&ut);
+static void __oscap_debuglog_close(void)
+{
+	pthread_mutex_lock(&__debuglog_mutex);
+	if (__debuglog_flusher_running) {
+		pthread_mutex_lock(&__debuglog_flusher_mutex);
+		__debuglog_stop = 1;
+		pthread_cond_signal(&__debuglog_flusher_cond);
+		pthread_mutex_unlock(&__debuglog_flusher_mutex);
+		pthread_join(__debuglog_flusher, NULL);
+		__debuglog_flusher_running = false;
+	}
+	if (__debuglog_state == 1) {
+		__oscap_debuglog_flush(true);
+		close(__debuglog_fd);
+		__debuglog_fd = -1;
+		// anything logged from now on is dropped
+		__debuglog_state = -1;
+	}
+	pthread_mutex_unlock(&__debuglog_mutex);
+}
+
+static void __oscap_debuglog_atfork_child(void)
+{
+	/* The buffers, the trace file and the flusher belong to the parent,
+	 * the child starts its own trace when it logs anything. */
+	if (__debuglog_fd != -1)
+		close(__debuglog_fd);
+	__debuglog_fd = -1;
+	__debuglog_wbuf_len = 0;
+	__debuglog_buffers = NULL;
+	__debuglog_buffer = NULL;
+	if (__debuglog_key_created)
+		pthread_setspecific(__debuglog_key, NULL);
+	__debuglog_flusher_running = false;
+	__debuglog_stop = 0;
+	__debuglog_state = 0;
+	pthread_mutex_init(&__debuglog_mutex, NULL);
+	pthread_mutex_init(&__debuglog_flusher_mutex, NULL);
+	pthread_cond_init(&__debuglog_flusher_cond, NULL);
+}
+
+static void __oscap_debuglog_thread_exit(void *arg)
+{
+	struct debuglog_buffer *buf = arg;
+
+	/* The flusher frees the buffer once it is drained, a message logged
+	 * by a later destructor of this thread gets a new one. */
+	__debuglog_buffer = NULL;
+	__sync_synchronize();
+	buf->finished = 1;
+}
+
+static int __oscap_debuglog_start(void)
+{
+	if (__debuglog_state != 0)
+		return __debuglog_state;
 
-		fprintf(__debuglog_fp, "\n=============== LOG: %.24s ===============\n", st);
-                atexit(&__oscap_debuglog_close);
+	pthread_mutex_lock(&__debuglog_mutex);
+	if (__debuglog_state == 0) {
+		char *logfile, pathbuf[4096];
+
+		__debuglog_state = -1;
+		logfile = getenv(OSCAP_DEBUG_FILE_ENV);
+
+		if (logfile == NULL)
+			logfile = OSCAP_DEBUG_FILE;
+
+		if (snprintf(pathbuf, sizeof pathbuf, "%s.%u",
+			     logfile, (unsigned int)getpid()) < (signed int) sizeof pathbuf)
+			__debuglog_fd = open(pathbuf, O_WRONLY | O_CREAT | O_TRUNC,
+					     S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
 	}
-	if (__debuglog_pstrip == -1) {
+	if (__debuglog_state == -1 && __debuglog_fd != -1) {
+		struct oscap_debug_trace_header header;
+		sigset_t sigmask, sigmask_old;
 		char *pstrip;
 
+		memset(&header, 0, sizeof header);
+		memcpy(header.magic, OSCAP_DEBUG_TRACE_MAGIC, sizeof header.magic);
+		header.pid = getpid();
+		header.time = time(NULL);
+		__oscap_debuglog_out(&header, sizeof header);
+		__oscap_debuglog_out_flush();
+
 		pstrip = getenv(OSCAP_DEBUG_PATHSTRIP_ENV);
 
 		if (pstrip == NULL)
@@ -143,135 +374,252 @@ static void __oscap_vdlprintf(int level, const char *file, const char *fn, size_
 		else
 			__debuglog_pstrip = atol(pstrip);
 
+		if (!__debuglog_key_created)
+			__debuglog_key_created = pthread_key_create(&__debuglog_key, &__oscap_debuglog_thread_exit) == 0;
+		if (!__debuglog_registered) {
+			atexit(&__oscap_debuglog_close);
+			pthread_atfork(NULL, NULL, &__oscap_debuglog_atfork_child);
+			__debuglog_registered = true;
+		}
+
+		/* Signals are left to the other threads, e.g. the probes wait
+		 * for them in a dedicated thread. */
+		sigfillset(&sigmask);
+		pthread_sigmask(SIG_BLOCK, &sigmask, &sigmask_old);
+		__debuglog_flusher_running = pthread_create(&__debuglog_flusher, NULL, &__oscap_debuglog_flusher_fn, NULL) == 0;
+		pthread_sigmask(SIG_SETMASK, &sigmask_old, NULL);
+
+		__sync_synchronize();
+		__debuglog_state = 1;
 	}
-	if (__debuglog_pstrip != 0)
-		f = __oscap_path_rstrip(file, __debuglog_pstrip);
-	else
-		f = file;
-
-#if defined(__SVR4) && defined (__sun)
-	if (lockf(fileno(__debuglog_fp), F_LOCK, 0L) == -1) {
-#else
-	if (flock(fileno(__debuglog_fp), LOCK_EX) == -1) {
-#endif
-		__UNLOCK_FP;
-		return;
-	}
+	pthread_mutex_unlock(&__debuglog_mutex);
+
+	return __debuglog_state;
+}
 
-	switch (level) {
-	case DBG_E:
-		l = 'E';
-		break;
-	case DBG_W:
-		l = 'W';
-		break;
-	case DBG_I:
-		l = 'I';
-		break;
-	default:
-		l = '0';
+static struct debuglog_buffer *__oscap_debuglog_buffer(void)
+{
+	struct debuglog_buffer *buf = __debuglog_buffer;
+
+	if (buf != NULL)
+		return buf;
+
+	buf = calloc(1, sizeof(struct debuglog_buffer));
+	if (buf == NULL)
+		return NULL;
+	buf->data = malloc(OSCAP_DEBUG_BUFFER_SIZE);
+	if (buf->data == NULL) {
+		free(buf);
+		return NULL;
 	}
-#if defined(OSCAP_THREAD_SAFE)
 	/* XXX: non-portable usage of pthread_t */
-	fprintf(__debuglog_fp, "(%ld:%llx) [%c:%s:%zu:%s] ", (long) getpid(),
-		(unsigned long long) pthread_self(), l, f, line, fn);
-#else
-	fprintf(__debuglog_fp, "(%ld) [%c:%s:%zu:%s] ", (long) getpid(),
-		l, f, line, fn);
-#endif
-	vfprintf(__debuglog_fp, fmt, ap);
+	buf->thread = (uint64_t) pthread_self();
 
-#if defined(__SVR4) && defined (__sun)
-	if (lockf(fileno(__debuglog_fp), F_ULOCK, 0L) == -1) {
-#else
-	if (flock(fileno(__debuglog_fp), LOCK_UN) == -1) {
-#endif
-		/* __UNLOCK_FP; */
-		abort();
+	do {
+		buf->next = __debuglog_buffers;
+	} while (!__sync_bool_compare_and_swap(&__debuglog_buffers, buf->next, buf));
+
+	if (__debuglog_key_created)
+		pthread_setspecific(__debuglog_key, buf);
+	__debuglog_buffer = buf;
+
+	return buf;
+}
+
+/*
+ * Find a place for an entry with a message of at least `msg_size' bytes.
+ * The space available for the message is returned in `room'. Returns NULL
+ * if the buffer is full.
+ */
+static struct debuglog_entry *__oscap_debuglog_reserve(struct debuglog_buffer *buf, size_t msg_size, size_t *room)
+{
+	const size_t entry_size = DEBUGLOG_ALIGN(sizeof(struct debuglog_entry) + msg_size);
+	uint64_t head = buf->head;
+	uint64_t tail = buf->tail;
+	size_t offset, contiguous, free_space, available;
+
+	__sync_synchronize();
+
+	offset = head % OSCAP_DEBUG_BUFFER_SIZE;
+	contiguous = OSCAP_DEBUG_BUFFER_SIZE - offset;
+	free_space = OSCAP_DEBUG_BUFFER_SIZE - (head - tail);
+
+	if (entry_size > contiguous) {
+		struct debuglog_entry *pad;
+
+		/* The entry doesn't fit to the end of the ring,
+		 * skip the end and continue at its beginning. */
+		if (contiguous + entry_size > free_space)
+			return NULL;
+
+		pad = (struct debuglog_entry *) (buf->data + offset);
+		pad->size = contiguous;
+		pad->type = DEBUGLOG_PAD;
+		__sync_synchronize();
+		buf->head = head + contiguous;
+
+		offset = 0;
+		free_space -= contiguous;
+		contiguous = OSCAP_DEBUG_BUFFER_SIZE;
 	}
+	else if (entry_size > free_space) {
+		return NULL;
+	}
+
+	available = (contiguous < free_space ? contiguous : free_space) - sizeof(struct debuglog_entry);
+	*room = available < DEBUGLOG_MSG_MAX ? available : DEBUGLOG_MSG_MAX;
 
-	__UNLOCK_FP;
-	return;
+	return (struct debuglog_entry *) (buf->data + offset);
 }
 
-void __oscap_dlprintf(int level, const char *file, const char *fn, size_t line, const char *fmt, ...)
+/*
+ * Reserve like __oscap_debuglog_reserve(), if the buffer is full give the
+ * flusher a chance to drain it first.
+ */
+static struct debuglog_entry *__oscap_debuglog_reserve_wait(struct debuglog_buffer *buf, size_t msg_size, size_t *room)
 {
-	va_list ap;
+	struct debuglog_entry *entry;
+	int retries = DEBUGLOG_FULL_RETRIES;
 
-	va_start(ap, fmt);
-	__oscap_vdlprintf(level, file, fn, line, fmt, ap);
-	va_end(ap);
+	while ((entry = __oscap_debuglog_reserve(buf, msg_size, room)) == NULL) {
+		if (retries-- == 0 || !__debuglog_flusher_running) {
+			buf->lost++;
+			return NULL;
+		}
+		pthread_cond_signal(&__debuglog_flusher_cond);
+		sched_yield();
+	}
+
+	return entry;
 }
 
-void __oscap_debuglog_object (const char *file, const char *fn, size_t line, int objtype, void *obj)
+static void __oscap_debuglog_commit(struct debuglog_buffer *buf, struct debuglog_entry *entry,
+				    int type, int level, const char *file, const char *fn, size_t line, size_t msg_len)
 {
-        __LOCK_FP;
+	uint64_t used = buf->head - buf->tail;
+
+	entry->size = DEBUGLOG_ALIGN(sizeof(struct debuglog_entry) + msg_len);
+	entry->type = type;
+	entry->level = level;
+	entry->line = line;
+	entry->msg_len = msg_len;
+	entry->seq = __sync_fetch_and_add(&__debuglog_seq, 1);
+	entry->file = file;
+	entry->fn = fn;
+
+	__sync_synchronize();
+	buf->head += entry->size;
+
+	/* Don't wait for the flusher when the buffer gets half full. The
+	 * signal is lost if the flusher isn't waiting, it wakes up soon anyway. */
+	if (used < OSCAP_DEBUG_BUFFER_SIZE / 2 && used + entry->size >= OSCAP_DEBUG_BUFFER_SIZE / 2)
+		pthread_cond_signal(&__debuglog_flusher_cond);
+}
 
-        if (__debuglog_fp == NULL) {
-                char  *logfile, pathbuf[4096];
-                char  *st;
-                time_t ut;
+static void __oscap_debuglog_write(int type, int level, const char *file, const char *fn, size_t line, const char *fmt, va_list ap)
+{
+	struct debuglog_buffer *buf;
+	struct debuglog_entry *entry;
+	size_t room;
+	va_list aq;
+	int len;
+
+	buf = __oscap_debuglog_buffer();
+	if (buf == NULL)
+		return;
 
-                logfile = getenv (OSCAP_DEBUG_FILE_ENV);
+	if (buf->lost > 0) {
+		entry = __oscap_debuglog_reserve_wait(buf, 0, &room);
+		if (entry == NULL)
+			return;
+		__oscap_debuglog_commit(buf, entry, OSCAP_DEBUG_TRACE_LOST, DBG_W, NULL, NULL, buf->lost, 0);
+		buf->lost = 0;
+	}
 
-                if (logfile == NULL)
-                        logfile = OSCAP_DEBUG_FILE;
+	entry = __oscap_debuglog_reserve_wait(buf, 1, &room);
+	if (entry == NULL)
+		return;
 
-		if (snprintf(pathbuf, sizeof pathbuf, "%s.%ld",
-			     logfile, (long)getpid()) >= (signed int) sizeof pathbuf)
-		{
-                        __UNLOCK_FP;
+	va_copy(aq, ap);
+	len = vsnprintf(entry->msg, room, fmt, aq);
+	va_end(aq);
+	if (len < 0)
+		len = 0;
+
+	if ((size_t) len >= room && room < DEBUGLOG_MSG_MAX) {
+		/* There wasn't enough space at the end of the ring, longer
+		 * messages than DEBUGLOG_MSG_MAX are truncated. */
+		entry = __oscap_debuglog_reserve_wait(buf, (size_t) len < DEBUGLOG_MSG_MAX ? (size_t) len + 1 : DEBUGLOG_MSG_MAX, &room);
+		if (entry == NULL)
 			return;
-		}
+		len = vsnprintf(entry->msg, room, fmt, ap);
+		if (len < 0)
+			len = 0;
+	}
+	if ((size_t) len >= room)
+		len = room - 1;
 
-                __debuglog_fp = fopen (pathbuf, "w");
+	__oscap_debuglog_commit(buf, entry, type, level, file, fn, line, len);
+}
 
-                if (__debuglog_fp == NULL) {
-                        __UNLOCK_FP;
-                        return;
-                }
+static void __oscap_debuglog_printf(int type, int level, const char *file, const char *fn, size_t line, const char *fmt, ...)
+{
+	va_list ap;
 
-                setbuf (__debuglog_fp, NULL);
+	va_start(ap, fmt);
+	__oscap_debuglog_write(type, level, file, fn, line, fmt, ap);
+	va_end(ap);
+}
 
-                ut = time (NULL);
-                st = ctime (&ut);
+static void __oscap_vdlprintf(int level, const char *file, const char *fn, size_t line, const char *fmt, va_list ap)
+{
+	if (__debuglog_level == -1) {
+		char *env;
 
-                fprintf (__debuglog_fp, "=============== LOG: %.24s ===============\n", st);
-                atexit(&__oscap_debuglog_close);
-        }
-#if defined(__SVR4) && defined (__sun)
-        if (lockf (fileno (__debuglog_fp), F_LOCK, 0L) == -1) {
-#else
-        if (flock (fileno (__debuglog_fp), LOCK_EX | LOCK_NB) == -1) {
-#endif
-                __UNLOCK_FP;
-                return;
-        }
-
-#if defined(SEAP_THREAD_SAFE)
-        /* XXX: non-portable usage of pthread_t */
-	fprintf (__debuglog_fp, "(%ld:%llx) [%s:%zu:%s]\n------ \n", (long)getpid (), (unsigned long long)pthread_self(), file, line, fn);
-#else
-	fprintf (__debuglog_fp, "(%ld) [%s:%zu:%s]\n------\n ", (long)getpid (), file, line, fn);
-#endif
+		env = getenv(OSCAP_DEBUG_LEVEL_ENV);
+		if (env == NULL)
+			__debuglog_level = DBG_I;
+		else
+			__debuglog_level = atoi(env);
+	}
+	if (__debuglog_level < level)
+		return;
+	if (__oscap_debuglog_start() != 1)
+		return;
 
-        switch (objtype) {
-        case OSCAP_DEBUGOBJ_SEXP:
-                SEXP_fprintfa(__debuglog_fp, (SEXP_t *)obj);
-        }
+	__oscap_debuglog_write(OSCAP_DEBUG_TRACE_MSG, level, file, fn, line, fmt, ap);
+}
 
-        fprintf(__debuglog_fp, "\n-----------\n");
-#if defined(__SVR4) && defined (__sun)
-        if (lockf (fileno (__debuglog_fp), F_ULOCK, 0L) == -1) {
-#else
-        if (flock (fileno (__debuglog_fp), LOCK_UN | LOCK_NB) == -1) {
-#endif
-                /* __UNLOCK_FP; */
-                abort ();
-        }
+void __oscap_dlprintf(int level, const char *file, const char *fn, size_t line, const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	__oscap_vdlprintf(level, file, fn, line, fmt, ap);
+	va_end(ap);
+}
+
+void __oscap_debuglog_object (const char *file, const char *fn, size_t line, int objtype, void *obj)
+{
+	char *text = NULL;
+	size_t text_len = 0;
+	FILE *fp;
+
+	if (__oscap_debuglog_start() != 1)
+		return;
+
+	fp = open_memstream(&text, &text_len);
+	if (fp == NULL)
+		return;
+
+	switch (objtype) {
+	case OSCAP_DEBUGOBJ_SEXP:
+		SEXP_fprintfa(fp, (SEXP_t *)obj);
+	}
 
-        __UNLOCK_FP;
-        return;
+	fclose(fp);
+	__oscap_debuglog_printf(OSCAP_DEBUG_TRACE_OBJ, 0, file, fn, line, "%s", text);
+	free(text);
 }
 
 #endif
@@ -30,15 +30,7 @@
 #define OSCAP_DEBUG_PRIV_H_
 
 #include "util.h"
-
-/**
- * Hardcodede output filename. This is used as the default
- * filename if the variable specified by OSCAP_DEBUG_FILE_ENV
- * isn't defined.
- */
-#ifndef OSCAP_DEBUG_FILE
-# define OSCAP_DEBUG_FILE     "oscap_debug.log"
-#endif
+#include "debug_trace.h"
 
 /**
  * Name of the environment variable that can be used to change
@@ -70,6 +62,16 @@
 # define OSCAP_DEBUG_PATHSTRIP_ENV "OSCAP_DEBUG_PSTRIP"
 #endif
 
+/**
+ * Size of the buffer of each thread. The messages are formatted into the
+ * buffer of the calling thread and written to the file asynchronously.
+ * Messages logged when the buffer is full are dropped. The buffers are
+ * flushed every 10 ms and at exit, messages logged less than 10 ms before
+ * a crash are lost.
+ */
+#ifndef OSCAP_DEBUG_BUFFER_SIZE
+# define OSCAP_DEBUG_BUFFER_SIZE (128 * 1024)
+#endif
 
 #define OSCAP_DEBUGOBJ_SEXP 1
 
@@ -88,9 +90,9 @@
 # include <stdarg.h>
 
 enum {
-	DBG_E = 1,
-	DBG_W,
-	DBG_I
+	DBG_E = OSCAP_DEBUG_TRACE_ERROR,
+	DBG_W = OSCAP_DEBUG_TRACE_WARNING,
+	DBG_I = OSCAP_DEBUG_TRACE_INFO
 };
 
 # define __dlprintf_wrapper(l, ...) __oscap_dlprintf (l, __FILE__, __PRETTY_FUNCTION__, __LINE__, __VA_ARGS__)
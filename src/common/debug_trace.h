@@ -0,0 +1,81 @@
+/**
+ * @file debug_trace.h
+ * @brief Format of the binary debug trace files
+ */
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#pragma once
+#ifndef OSCAP_DEBUG_TRACE_H_
+#define OSCAP_DEBUG_TRACE_H_
+
+#include <stdint.h>
+
+/*
+ * The debug log of a process is written to OSCAP_DEBUG_FILE.<pid> as a binary
+ * trace. It starts with the header followed by records, each record is
+ * followed by its file name, function name and message. The records of
+ * different threads aren't ordered, they are ordered by their sequence
+ * numbers when decoded by oscap-debug-decode. Integers are in the byte
+ * order of the machine which wrote the trace.
+ */
+
+#define OSCAP_DEBUG_TRACE_MAGIC "OSCAPDT1"
+
+/**
+ * Default name of the traces, used if the variable named by
+ * OSCAP_DEBUG_FILE_ENV isn't set. The pid of the process is
+ * appended to it.
+ */
+#ifndef OSCAP_DEBUG_FILE
+# define OSCAP_DEBUG_FILE     "oscap_debug.log"
+#endif
+
+struct oscap_debug_trace_header {
+	char     magic[8];      ///< OSCAP_DEBUG_TRACE_MAGIC
+	int64_t  pid;           ///< process which wrote the trace
+	int64_t  time;          ///< time the log was started at
+};
+
+/* Levels of the messages, the values of DBG_E, DBG_W and DBG_I. */
+enum {
+	OSCAP_DEBUG_TRACE_ERROR = 1,
+	OSCAP_DEBUG_TRACE_WARNING,
+	OSCAP_DEBUG_TRACE_INFO
+};
+
+enum {
+	OSCAP_DEBUG_TRACE_MSG = 1,      ///< message of oscap_dlprintf()
+	OSCAP_DEBUG_TRACE_OBJ,          ///< object printed by dO()
+	OSCAP_DEBUG_TRACE_LOST          ///< records dropped because the thread's buffer was full
+};
+
+struct oscap_debug_trace_record {
+	uint8_t  type;
+	uint8_t  level;         ///< OSCAP_DEBUG_TRACE_ERROR, _WARNING or _INFO
+	uint16_t file_len;
+	uint32_t fn_len;
+	uint32_t line;          ///< number of dropped records for OSCAP_DEBUG_TRACE_LOST
+	uint32_t msg_len;
+	uint64_t seq;           ///< order of the record in the process
+	uint64_t thread;
+};
+
+#endif
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(OSCAP_THREAD_SAFE)
+# include <pthread.h>
+#endif
+
+#include "alloc.h"
+#include "intern.h"
+
+#define OSCAP_INTERN_INITIAL_BUCKETS 1024
+
+struct oscap_intern_entry {
+	struct oscap_intern_entry *next;
+	uint32_t hash;
+	uint32_t refs;
+	char str[];
+};
+
+/*
+ * Chained hash table of interned strings. Entries are unlinked and freed
+ * as soon as their last reference is released, the table only grows.
+ */
+static struct oscap_intern_entry **intern_buckets = NULL;
+static size_t intern_bucket_count = 0;
+static size_t intern_entry_count = 0;
+#if defined(OSCAP_THREAD_SAFE)
+static pthread_mutex_t intern_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void intern_lock_acquire(void)
+{
+#if defined(OSCAP_THREAD_SAFE)
+	if (pthread_mutex_lock(&intern_lock) != 0)
+		abort();
+#endif
+}
+
+static void intern_lock_release(void)
+{
+#if defined(OSCAP_THREAD_SAFE)
+	if (pthread_mutex_unlock(&intern_lock) != 0)
+		abort();
+#endif
+}
+
+/* FNV-1a */
+static uint32_t intern_hash(const char *str, size_t *len)
+{
+	const unsigned char *p = (const unsigned char *) str;
+	uint32_t hash = 2166136261u;
+
+	while (*p != '\0') {
+		hash ^= *p++;
+		hash *= 16777619u;
+	}
+	*len = (const char *) p - str;
+	return hash;
+}
+
+static void intern_grow(void)
+{
+	size_t count = intern_bucket_count ? intern_bucket_count * 2 : OSCAP_INTERN_INITIAL_BUCKETS;
+	struct oscap_intern_entry **buckets = oscap_calloc(count, sizeof(*buckets));
+
+	if (buckets == NULL)
+		return;
+
+	for (size_t i = 0; i < intern_bucket_count; ++i) {
+		struct oscap_intern_entry *entry = intern_buckets[i], *next;
+
+		for (; entry != NULL; entry = next) {
+			next = entry->next;
+			entry->next = buckets[entry->hash & (count - 1)];
+			buckets[entry->hash & (count - 1)] = entry;
+		}
+	}
+	oscap_free(intern_buckets);
+	intern_buckets = buckets;
+	intern_bucket_count = count;
+}
+
+char *oscap_intern(const char *str)
+{
+	struct oscap_intern_entry *entry;
+	uint32_t hash;
+	size_t len;
+
+	if (str == NULL)
+		return NULL;
+
+	hash = intern_hash(str, &len);
+
+	intern_lock_acquire();
+	if (intern_entry_count >= intern_bucket_count)
+		intern_grow();
+	if (intern_buckets == NULL) {
+		intern_lock_release();
+		return NULL;
+	}
+
+	for (entry = intern_buckets[hash & (intern_bucket_count - 1)]; entry != NULL; entry = entry->next) {
+		if (entry->hash == hash && strcmp(entry->str, str) == 0) {
+			++entry->refs;
+			intern_lock_release();
+			return entry->str;
+		}
+	}
+
+	entry = oscap_alloc(sizeof(*entry) + len + 1);
+	if (entry == NULL) {
+		intern_lock_release();
+		return NULL;
+	}
+	entry->hash = hash;
+	entry->refs = 1;
+	memcpy(entry->str, str, len + 1);
+	entry->next = intern_buckets[hash & (intern_bucket_count - 1)];
+	intern_buckets[hash & (intern_bucket_count - 1)] = entry;
+	++intern_entry_count;
+	intern_lock_release();
+
+	return entry->str;
+}
+
+char *oscap_intern_take(char *str)
+{
+	char *interned = oscap_intern(str);
+
+	oscap_free(str);
+	return interned;
+}
+
+void oscap_intern_release(const char *str)
+{
+	struct oscap_intern_entry *entry, **link;
+
+	if (str == NULL)
+		return;
+
+	entry = (struct oscap_intern_entry *) (str - offsetof(struct oscap_intern_entry, str));
+
+	intern_lock_acquire();
+	if (--entry->refs == 0) {
+		link = &intern_buckets[entry->hash & (intern_bucket_count - 1)];
+		while (*link != entry)
+			link = &(*link)->next;
+		*link = entry->next;
+		--intern_entry_count;
+		oscap_free(entry);
+	}
+	intern_lock_release();
+}
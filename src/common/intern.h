@@ -0,0 +1,54 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef OSCAP_INTERN_H_
+#define OSCAP_INTERN_H_
+
+/*
+ * Process-wide pool of shared, reference counted strings.
+ *
+ * Equal strings interned through the pool share a single copy, so two
+ * interned strings are equal if and only if their pointers are equal.
+ * Interned strings must never be modified or passed to oscap_free();
+ * every reference is dropped with oscap_intern_release() instead.
+ * The pool may be used from several threads at once.
+ */
+
+/**
+ * Get a shared copy of a string.
+ * @param str string to intern, may be NULL
+ * @return interned string or NULL if str is NULL
+ */
+char *oscap_intern(const char *str);
+
+/**
+ * Intern a string the caller owns and free the original.
+ * @param str string allocated by oscap_alloc() or libxml2, may be NULL
+ * @return interned string or NULL if str is NULL
+ */
+char *oscap_intern_take(char *str);
+
+/**
+ * Drop a reference obtained from oscap_intern() or oscap_intern_take().
+ * @param str interned string, may be NULL
+ */
+void oscap_intern_release(const char *str);
+
+#endif
@@ -110,6 +110,8 @@ void oscap_init(void)
 void oscap_cleanup(void)
 {
 	oscap_clearerr();
+	oscap_source_validate_cache_clear();
+	oscap_source_xslt_cache_clear();
 	xsltCleanupGlobals();
 	xmlCleanupParser();
 }
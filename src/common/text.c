@@ -46,8 +46,8 @@ const char * const OSCAP_LANG_DEFAULT    = "en-US";
 const struct oscap_text_traits OSCAP_TEXT_TRAITS_PLAIN = { .html = false };
 const struct oscap_text_traits OSCAP_TEXT_TRAITS_HTML  = { .html = true };
 
+static __thread bool oscap_text_lazy_parse = false;
 
-OSCAP_ACCESSOR_STRING(oscap_text, text)
 OSCAP_ACCESSOR_STRING(oscap_text, lang)
 OSCAP_GENERIC_GETTER(bool, oscap_text, is_html, traits.html)
 OSCAP_GENERIC_GETTER(bool, oscap_text, can_substitute, traits.can_substitute)
@@ -58,6 +58,63 @@ OSCAP_ITERATOR_GEN_T(struct oscap_text *, oscap_text)
 OSCAP_ITERATOR_REMOVE_T(struct oscap_text *, oscap_text, oscap_text_free)
 
 
+/*
+ * Serialize the content of the element the way xmlTextReaderReadInnerXml()
+ * does, so that a lazily parsed text is the same as the one parsed at once.
+ */
+static char *oscap_text_node_inner_xml(xmlNode *node)
+{
+	xmlBuffer *buff = xmlBufferCreate();
+	char *result;
+
+	if (buff == NULL)
+		return NULL;
+
+	for (xmlNode *cur = node->children; cur != NULL; cur = cur->next) {
+		xmlNode *copy = xmlDocCopyNode(cur, node->doc, 1);
+		xmlNodeDump(buff, node->doc, copy, 0, 0);
+		xmlFreeNode(copy);
+	}
+
+	result = (char *) buff->content;
+	buff->content = NULL;
+	xmlBufferFree(buff);
+	return result;
+}
+
+static inline void oscap_text_materialize(const struct oscap_text *text)
+{
+	struct oscap_text *t = (struct oscap_text *) text;
+
+	if (t->node != NULL) {
+		t->text = oscap_text_node_inner_xml(t->node);
+		t->node = NULL;
+	}
+}
+
+const char *oscap_text_get_text(const struct oscap_text *text)
+{
+	if (text == NULL)
+		return NULL;
+	oscap_text_materialize(text);
+	return text->text;
+}
+
+bool oscap_text_set_text(struct oscap_text *text, const char *string)
+{
+	text->node = NULL;
+	oscap_free(text->text);
+	text->text = oscap_strdup(string);
+	return true;
+}
+
+bool oscap_text_set_lazy_parse(bool lazy)
+{
+	bool previous = oscap_text_lazy_parse;
+	oscap_text_lazy_parse = lazy;
+	return previous;
+}
+
 bool oscap_text_set_overrides(struct oscap_text *text, bool overrides)
 {
 	text->traits.overrides = overrides;
@@ -90,7 +147,10 @@ struct oscap_text *oscap_text_new(void)
 
 struct oscap_text * oscap_text_clone(const struct oscap_text * text)
 {
-    return oscap_text_new_full(text->traits, text->text, text->lang);   
+    struct oscap_text *clone = oscap_text_new_full(text->traits, text->text, text->lang);
+    // a lazy text shares the element with its clone
+    clone->node = text->node;
+    return clone;
 }
 
 struct oscap_text *oscap_text_new_html(void)
@@ -119,8 +179,13 @@ struct oscap_text *oscap_text_new_parse(struct oscap_text_traits traits, xmlText
     xmlTextReaderMoveToElement(reader);
 
     // extract content
-    if (text->traits.html || text->traits.can_substitute)
-		text->text = oscap_get_xml(reader);
+    if (text->traits.html || text->traits.can_substitute) {
+		// lazy text is serialized on the first access
+		if (oscap_text_lazy_parse)
+			text->node = xmlTextReaderCurrentNode(reader);
+		if (text->node == NULL)
+			text->text = oscap_get_xml(reader);
+	}
     else text->text = oscap_element_string_copy(reader);
 
     return text;
@@ -130,6 +195,7 @@ xmlNode *oscap_text_to_dom(struct oscap_text *text, xmlNode *parent, const char
 {
 	if (!text) return NULL;
 
+	oscap_text_materialize(text);
 	xmlNode *text_node = NULL;
 
 	if (text->traits.html || text->traits.can_substitute) {
@@ -157,6 +223,7 @@ bool oscap_text_export(struct oscap_text *text, xmlTextWriter *writer, const cha
 {
 	if (text == NULL || writer == NULL) return false;
 
+	oscap_text_materialize(text);
 	if (elname) xmlTextWriterStartElement(writer, BAD_CAST elname);
 
 	if (text->lang)
@@ -200,6 +267,7 @@ char *oscap_text_get_plaintext(const struct oscap_text *text)
 {
     if (text == NULL) return NULL;
 
+    oscap_text_materialize(text);
     if (!text->traits.html) return oscap_strdup(text->text);
 
 	return _xhtml_to_plaintext(text->text);
@@ -47,6 +47,7 @@ struct oscap_text_traits {
 struct oscap_text {
 	char *lang;
 	char *text;
+	xmlNode *node;      ///< element the text is taken from on first access (lazy parsing)
     struct oscap_text_traits traits;
 };
 
@@ -70,6 +71,15 @@ struct oscap_text *oscap_text_new_full(struct oscap_text_traits traits, const ch
  */
 struct oscap_text *oscap_text_new_parse(struct oscap_text_traits traits, xmlTextReaderPtr reader);
 
+/**
+ * Switch lazy parsing of XHTML and substitution texts in the calling thread.
+ * While it is on, oscap_text_new_parse() only remembers the element of such
+ * a text and the content is serialized on its first access. The reader has to
+ * walk a document which outlives the parsed texts.
+ * @return previous setting
+ */
+bool oscap_text_set_lazy_parse(bool lazy);
+
 xmlNode *oscap_text_to_dom(struct oscap_text *text, xmlNode *parent, const char *elname);
 bool oscap_text_export(struct oscap_text *text, xmlTextWriter *writer, const char *elname);
 bool oscap_textlist_export(struct oscap_text_iterator *texts, xmlTextWriter *writer, const char *elname);
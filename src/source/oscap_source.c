@@ -24,6 +24,7 @@
 #include <config.h>
 #endif
 
+#include <stdint.h>
 #include <string.h>
 #include <fcntl.h>
 #include <unistd.h>
@@ -53,6 +54,7 @@ typedef enum oscap_source_type {
 	OSCAP_SRC_FROM_USER_XML_FILE = 1,               ///< The source originated from XML file supplied by user
 	OSCAP_SRC_FROM_USER_MEMORY,                     ///< The source originated from memory supplied by user
 	OSCAP_SRC_FROM_XML_DOM,                         ///< The source originated from XML DOM (most often from DataStream).
+	OSCAP_SRC_FROM_BORROWED_MEMORY,                 ///< The source originated from memory owned by somebody else (e.g. mmap-ed file)
 	// TODO: downloaded from an http address (XCCDF can refer to remote sources)
 } oscap_source_type_t;
 
@@ -111,6 +113,14 @@ struct oscap_source *oscap_source_new_take_memory(char *buffer, size_t size, con
 	return source;
 }
 
+struct oscap_source *oscap_source_new_borrow_memory(const char *buffer, size_t size, const char *filepath)
+{
+	struct oscap_source* source = _create_oscap_source(size, filepath);
+	source->origin.type = OSCAP_SRC_FROM_BORROWED_MEMORY;
+	source->origin.memory = (char *) buffer;
+	return source;
+}
+
 struct oscap_source *oscap_source_new_from_xmlDoc(xmlDoc *doc, const char *filepath)
 {
 	struct oscap_source *source = (struct oscap_source *) oscap_calloc(1, sizeof(struct oscap_source));
@@ -124,7 +134,8 @@ void oscap_source_free(struct oscap_source *source)
 {
 	if (source != NULL) {
 		oscap_free(source->origin.filepath);
-		oscap_free(source->origin.memory);
+		if (source->origin.type != OSCAP_SRC_FROM_BORROWED_MEMORY)
+			oscap_free(source->origin.memory);
 		if (source->xml.doc != NULL) {
 			xmlFreeDoc(source->xml.doc);
 		}
@@ -157,6 +168,64 @@ xmlTextReader *oscap_source_get_xmlTextReader(struct oscap_source *source)
 	return reader;
 }
 
+static int _xml_fd_read(void *context, char *buffer, int len)
+{
+	return read((int) (intptr_t) context, buffer, len);
+}
+
+static int _xml_fd_close(void *context)
+{
+	return close((int) (intptr_t) context);
+}
+
+bool oscap_source_has_xmlDoc(const struct oscap_source *source)
+{
+	return source->xml.doc != NULL;
+}
+
+bool oscap_source_is_file(const struct oscap_source *source)
+{
+	return source->origin.type == OSCAP_SRC_FROM_USER_XML_FILE;
+}
+
+xmlTextReader *oscap_source_get_streaming_xmlTextReader(struct oscap_source *source)
+{
+	if (source->xml.doc != NULL) {
+		return oscap_source_get_xmlTextReader(source);
+	}
+
+	xmlTextReader *reader = NULL;
+	if (source->origin.memory != NULL) {
+#ifdef HAVE_BZ2
+		if (bz2_memory_is_bzip(source->origin.memory, source->origin.memory_size)) {
+			return oscap_source_get_xmlTextReader(source);
+		}
+#endif
+		reader = xmlReaderForMemory(source->origin.memory, source->origin.memory_size, NULL, NULL, XML_PARSE_NOENT);
+	}
+	else {
+		int fd = open(source->origin.filepath, O_RDONLY);
+		if (fd == -1) {
+			oscap_seterr(OSCAP_EFAMILY_GLIBC, "Unable to open file: '%s'", oscap_source_readable_origin(source));
+			return NULL;
+		}
+#ifdef HAVE_BZ2
+		if (bz2_fd_is_bzip(fd)) {
+			close(fd);
+			return oscap_source_get_xmlTextReader(source);
+		}
+#endif
+		// the reader closes the file when it is freed
+		reader = xmlReaderForIO(_xml_fd_read, _xml_fd_close, (void *) (intptr_t) fd,
+				source->origin.filepath, NULL, XML_PARSE_NOENT);
+	}
+	if (reader == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_XML, "Unable to create xmlTextReader for %s", oscap_source_readable_origin(source));
+		oscap_setxmlerr(xmlGetLastError());
+	}
+	return reader;
+}
+
 oscap_document_type_t oscap_source_get_scap_type(struct oscap_source *source)
 {
 	if (source->scap_type == OSCAP_DOCUMENT_UNKNOWN) {
@@ -49,6 +49,17 @@ OSCAP_HIDDEN_START;
  */
 struct oscap_source *oscap_source_new_take_memory(char *buffer, size_t size, const char *filepath);
 
+/**
+ * Create new oscap_source from a memory buffer which stays owned by the
+ * caller (e.g. a region of a mapped file). The buffer must not be released
+ * before the oscap_source is disposed.
+ * @param buffer Memory buffer with raw data
+ * @param size size of the memory buffer
+ * @param filepath Suggested filename for the file or NULL
+ * @returns newly created oscap_source_structure
+ */
+struct oscap_source *oscap_source_new_borrow_memory(const char *buffer, size_t size, const char *filepath);
+
 /**
  * Build new oscap_source from existing xmlDoc. The xmlDoc becomes owned
  * by oscap_source.
@@ -68,6 +79,36 @@ struct oscap_source *oscap_source_new_from_xmlDoc(xmlDoc *doc, const char *filep
  */
 xmlTextReader *oscap_source_get_xmlTextReader(struct oscap_source *source);
 
+/**
+ * Get an xmlTextReader which reads this resource without building its DOM.
+ * When the DOM has been built already the reader walks it, as the one from
+ * oscap_source_get_xmlTextReader() does. Otherwise the raw file or memory
+ * is parsed as the reader advances, so the memory used doesn't depend on
+ * the size of the document. Bzip2 compressed content is read through the
+ * DOM. The reader needs to be disposed by caller.
+ * @memberof oscap_source
+ * @param source Resource to read the content
+ * @returns xmlTextReader structure to read the content
+ */
+xmlTextReader *oscap_source_get_streaming_xmlTextReader(struct oscap_source *source);
+
+/**
+ * Find out whether the DOM representation of this resource has been built.
+ * @memberof oscap_source
+ * @param source Resource to check
+ * @returns true if oscap_source_get_xmlDoc() won't parse the content
+ */
+bool oscap_source_has_xmlDoc(const struct oscap_source *source);
+
+/**
+ * Find out whether this resource is read from a file, as opposed to a memory
+ * buffer or a DOM.
+ * @memberof oscap_source
+ * @param source Resource to check
+ * @returns true if the content is read from the file given by the origin
+ */
+bool oscap_source_is_file(const struct oscap_source *source);
+
 /**
  * Get a DOM representation of this resource. The document ins still owned
  * by oscap_source.
@@ -27,8 +27,12 @@
 #include <libxml/xmlschemas.h>
 #include <string.h>
 #include <unistd.h>
+#if defined(OSCAP_THREAD_SAFE)
+# include <pthread.h>
+#endif
 
 #include "common/_error.h"
+#include "common/list.h"
 #include "common/util.h"
 #include "oscap.h"
 #include "oscap_source.h"
@@ -78,10 +82,84 @@ static void oscap_xml_validity_handler(void *user, xmlErrorPtr error)
 	context->reporter(file, error->line, error->message, context->arg);
 }
 
+/*
+ * Parsed schemas keyed by their absolute path. Schemas are immutable once
+ * parsed and libxml2 allows one xmlSchema to be shared by many validation
+ * contexts, so each XSD is parsed only once per process.
+ */
+static struct oscap_htable *schema_cache = NULL;
+#if defined(OSCAP_THREAD_SAFE)
+static pthread_mutex_t schema_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void schema_cache_lock_acquire(void)
+{
+#if defined(OSCAP_THREAD_SAFE)
+	if (pthread_mutex_lock(&schema_cache_lock) != 0)
+		abort();
+#endif
+}
+
+static void schema_cache_lock_release(void)
+{
+#if defined(OSCAP_THREAD_SAFE)
+	if (pthread_mutex_unlock(&schema_cache_lock) != 0)
+		abort();
+#endif
+}
+
+static xmlSchemaPtr oscap_schema_cache_get(const char *schemapath, struct ctxt *context)
+{
+	xmlSchemaParserCtxtPtr parser_ctxt = NULL;
+	xmlSchemaPtr schema = NULL;
+
+	schema_cache_lock_acquire();
+
+	if (schema_cache == NULL)
+		schema_cache = oscap_htable_new();
+	else
+		schema = oscap_htable_get(schema_cache, schemapath);
+
+	if (schema != NULL)
+		goto unlock;
+
+	parser_ctxt = xmlSchemaNewParserCtxt(schemapath);
+	if (parser_ctxt == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_XML, "Could not create parser context for validation");
+		goto unlock;
+	}
+
+	xmlSchemaSetParserStructuredErrors(parser_ctxt, oscap_xml_validity_handler, context);
+
+	schema = xmlSchemaParse(parser_ctxt);
+	xmlSchemaFreeParserCtxt(parser_ctxt);
+	if (schema == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_XML, "Could not parse XML schema");
+		goto unlock;
+	}
+
+	if (!oscap_htable_add(schema_cache, schemapath, schema)) {
+		/* Should not happen, the lookup above would have found it. */
+		xmlSchemaFree(schema);
+		schema = NULL;
+	}
+
+unlock:
+	schema_cache_lock_release();
+	return schema;
+}
+
+void oscap_source_validate_cache_clear(void)
+{
+	schema_cache_lock_acquire();
+	oscap_htable_free(schema_cache, (oscap_destruct_func) xmlSchemaFree);
+	schema_cache = NULL;
+	schema_cache_lock_release();
+}
+
 static inline int oscap_validate_xml(struct oscap_source *source, const char *schemafile, xml_reporter reporter, void *arg)
 {
 	int result = -1;
-	xmlSchemaParserCtxtPtr parser_ctxt = NULL;
 	xmlSchemaPtr schema = NULL;
 	xmlSchemaValidCtxtPtr ctxt = NULL;
 	xmlDocPtr doc = NULL;
@@ -100,19 +178,9 @@ static inline int oscap_validate_xml(struct oscap_source *source, const char *sc
 		goto cleanup;
 	}
 
-	parser_ctxt = xmlSchemaNewParserCtxt(schemapath);
-	if (parser_ctxt == NULL) {
-		oscap_seterr(OSCAP_EFAMILY_XML, "Could not create parser context for validation");
+	schema = oscap_schema_cache_get(schemapath, &context);
+	if (schema == NULL)
 		goto cleanup;
-	}
-
-	xmlSchemaSetParserStructuredErrors(parser_ctxt, oscap_xml_validity_handler, &context);
-
-	schema = xmlSchemaParse(parser_ctxt);
-	if (schema == NULL) {
-		oscap_seterr(OSCAP_EFAMILY_XML, "Could not parse XML schema");
-		goto cleanup;
-	}
 
 	ctxt = xmlSchemaNewValidCtxt(schema);
 	if (ctxt == NULL) {
@@ -143,10 +211,6 @@ static inline int oscap_validate_xml(struct oscap_source *source, const char *sc
 cleanup:
 	if (ctxt)
 		xmlSchemaFreeValidCtxt(ctxt);
-	if (schema)
-		xmlSchemaFree(schema);
-	if (parser_ctxt)
-		xmlSchemaFreeParserCtxt(parser_ctxt);
 	oscap_free(schemapath);
 
 	return result;
@@ -43,5 +43,10 @@ struct oscap_schema_table_entry {
  */
 int oscap_source_validate_priv(struct oscap_source *source, oscap_document_type_t doc_type, const char *version, xml_reporter reporter, void *user);
 
+/**
+ * Release all XML schemas parsed and cached by oscap_source_validate_priv.
+ */
+void oscap_source_validate_cache_clear(void);
+
 OSCAP_HIDDEN_END;
 #endif
@@ -30,8 +30,12 @@
 #include <libexslt/exslt.h>
 #include <string.h>
 #include <unistd.h>
+#if defined(OSCAP_THREAD_SAFE)
+# include <pthread.h>
+#endif
 
 #include "common/_error.h"
+#include "common/list.h"
 #include "common/util.h"
 #include "oscap.h"
 #include "oscap_source.h"
@@ -75,6 +79,64 @@ static int xccdf_ns_xslt_workaround(xmlDocPtr doc, xmlNodePtr node)
 	return 0;
 }
 
+/*
+ * Compiled stylesheets keyed by their path. A compiled xsltStylesheet is
+ * not modified by xsltApplyStylesheet, so one instance is shared by all
+ * transformations in the process and stays alive until
+ * oscap_source_xslt_cache_clear() is called.
+ */
+static struct oscap_htable *stylesheet_cache = NULL;
+#if defined(OSCAP_THREAD_SAFE)
+static pthread_mutex_t stylesheet_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void stylesheet_cache_lock_acquire(void)
+{
+#if defined(OSCAP_THREAD_SAFE)
+	if (pthread_mutex_lock(&stylesheet_cache_lock) != 0)
+		abort();
+#endif
+}
+
+static void stylesheet_cache_lock_release(void)
+{
+#if defined(OSCAP_THREAD_SAFE)
+	if (pthread_mutex_unlock(&stylesheet_cache_lock) != 0)
+		abort();
+#endif
+}
+
+static xsltStylesheet *stylesheet_cache_get(const char *xsltpath)
+{
+	xsltStylesheet *stylesheet = NULL;
+
+	stylesheet_cache_lock_acquire();
+
+	if (stylesheet_cache == NULL)
+		stylesheet_cache = oscap_htable_new();
+	else
+		stylesheet = oscap_htable_get(stylesheet_cache, xsltpath);
+
+	if (stylesheet == NULL) {
+		stylesheet = xsltParseStylesheetFile(BAD_CAST xsltpath);
+		if (stylesheet != NULL && !oscap_htable_add(stylesheet_cache, xsltpath, stylesheet)) {
+			xsltFreeStylesheet(stylesheet);
+			stylesheet = NULL;
+		}
+	}
+
+	stylesheet_cache_lock_release();
+	return stylesheet;
+}
+
+void oscap_source_xslt_cache_clear(void)
+{
+	stylesheet_cache_lock_acquire();
+	oscap_htable_free(stylesheet_cache, (oscap_destruct_func) xsltFreeStylesheet);
+	stylesheet_cache = NULL;
+	stylesheet_cache_lock_release();
+}
+
 static inline int save_stylesheet_result_to_file(xmlDoc *resulting_doc, xsltStylesheet *stylesheet, const char *outfile)
 {
 	FILE *f = NULL;
@@ -141,7 +203,7 @@ static xmlDoc *apply_xslt_path_internal(struct oscap_source *source, const char
 			ns_workaround = true;
 	}
 
-	*stylesheet = xsltParseStylesheetFile(BAD_CAST xsltpath);
+	*stylesheet = stylesheet_cache_get(xsltpath);
 	if (*stylesheet == NULL) {
 		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not parse XSLT file '%s'", xsltpath);
 		oscap_free(xsltpath);
@@ -153,7 +215,6 @@ static xmlDoc *apply_xslt_path_internal(struct oscap_source *source, const char
 			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Had problems employing XCCDF XSLT namespace workaround for XML document '%s'",
 				oscap_source_readable_origin(source));
 			oscap_free(xsltpath);
-			xsltFreeStylesheet(*stylesheet);
 			*stylesheet = NULL;
 			return NULL;
 		}
@@ -172,7 +233,6 @@ static xmlDoc *apply_xslt_path_internal(struct oscap_source *source, const char
 		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not apply XSLT %s to XML file: %s", xsltpath,
 			oscap_source_readable_origin(source));
 		oscap_free(xsltpath);
-		xsltFreeStylesheet(*stylesheet);
 		*stylesheet = NULL;
 		return NULL;
 	}
@@ -189,7 +249,6 @@ int oscap_source_apply_xslt_path(struct oscap_source *source, const char *xsltfi
 		return -1;
 	}
 	int ret = save_stylesheet_result_to_file(transformed, stylesheet, outfile);
-	xsltFreeStylesheet(stylesheet);
 	xmlFreeDoc(transformed);
 	return ret;
 }
@@ -209,5 +268,6 @@ char *oscap_source_apply_xslt_path_mem(struct oscap_source *source, const char *
 		oscap_free(result);
 		result = NULL;
 	}
+	xmlFreeDoc(transformed);
 	return (char *)result;
 }
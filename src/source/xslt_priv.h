@@ -56,5 +56,10 @@ int oscap_source_apply_xslt_path(struct oscap_source *source, const char *xsltfi
  */
 char *oscap_source_apply_xslt_path_mem(struct oscap_source *source, const char *xsltfile, const char **params, const char *path_to_xslt);
 
+/**
+ * Release all stylesheets compiled and cached by the functions above.
+ */
+void oscap_source_xslt_cache_clear(void);
+
 OSCAP_HIDDEN_END;
 #endif
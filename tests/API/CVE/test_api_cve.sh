@@ -31,8 +31,62 @@ function test_api_cve_export {
     return $ret_val
 }
 
+function test_api_cve_find {
+    local ret_val=0
+    local index=`mktemp -u`
+    local stream_out=`mktemp`
+    local index_out=`mktemp`
+
+    for name in CVE-2009-0860 CVE-2009-0870 cpe:/o:sun:opensolaris:snv_91::x86 CVE-2009-9999; do
+        $OSCAP cve find $name $srcdir/nvdcve-2.0-recent.xml > $stream_out
+        local stream_ret=$?
+        # the first lookup builds the index, the others use it
+        $OSCAP cve find --index $index $name $srcdir/nvdcve-2.0-recent.xml > $index_out
+        local index_ret=$?
+        if [ $stream_ret -ne $index_ret ] || ! diff $stream_out $index_out; then
+            echo "Lookup of $name in the index differs from the lookup in the feed!"
+            ret_val=1
+        fi
+    done
+    if [ ! -f $index ]; then
+        echo "The index was not created!"
+        ret_val=1
+    fi
+
+    $OSCAP cve find CVE-2009-0860 $srcdir/nvdcve-2.0-recent.xml | grep -q "cpe:/a:netcordia:netmri:3.0.1" || ret_val=1
+    $OSCAP cve find CVE-2009-9999 $srcdir/nvdcve-2.0-recent.xml
+    [ $? -eq 2 ] || ret_val=1
+    [ `$OSCAP cve find --index $index cpe:/o:sun:opensolaris:snv_91::x86 $srcdir/nvdcve-2.0-recent.xml | grep -c "^ID:"` -eq 9 ] || ret_val=1
+
+    rm -f $index $stream_out $index_out
+    return $ret_val
+}
+
+# An end tag of an element whose name starts with the name of the entry
+# element doesn't end the entry.
+function test_api_cve_find_prefixed_end_tag {
+    local ret_val=0
+    local feed=`mktemp`
+    local index=`mktemp -u`
+    local stream_out=`mktemp`
+    local index_out=`mktemp`
+
+    sed 's|<entry id="CVE-2009-0860">|&<!-- <entry-note>x</entry-note> -->|' \
+        $srcdir/nvdcve-2.0-recent.xml > $feed
+    $OSCAP cve find CVE-2009-0860 $feed > $stream_out || ret_val=1
+    $OSCAP cve find --index $index CVE-2009-0860 $feed > $index_out || ret_val=1
+    diff $stream_out $index_out || ret_val=1
+    grep -q "cpe:/a:netcordia:netmri:3.0.1" $index_out || ret_val=1
+    [ -f $index ] || ret_val=1
+
+    rm -f $feed $index $stream_out $index_out
+    return $ret_val
+}
+
 test_init "test_api_cve.log"
 test_run "test_api_cve_cvss" test_api_cve_cvss
 test_run "test_api_cve_export" test_api_cve_export
+test_run "test_api_cve_find" test_api_cve_find
+test_run "test_api_cve_find_prefixed_end_tag" test_api_cve_find_prefixed_end_tag
 test_exit
 
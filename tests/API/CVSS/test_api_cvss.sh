@@ -31,11 +31,17 @@ function test_api_cvss_vector {
     return $ret
 }
 
+# packed vectors are scored the same as cvss_impact
+function test_api_cvss_batch {
+    ./test_api_cvss_batch vectors.txt 1000
+}
+
 # Testing.
 
 test_init "test_api_cvss.log"
 
 test_run "test_api_cvss_vector" test_api_cvss_vector
+test_run "test_api_cvss_batch" test_api_cvss_batch
 
 test_exit 
 
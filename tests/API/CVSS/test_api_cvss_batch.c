@@ -0,0 +1,129 @@
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include <cvss_score.h>
+
+/*
+ * Checks that the packed vectors are scored the same way as cvss_impact
+ * and measures the throughput of both.
+ *
+ * Usage: test_api_cvss_batch vectors-file [iterations]
+ */
+
+#define MAX_VECTORS 4096
+
+static bool score_eq(float a, float b)
+{
+    return (isnan(a) && isnan(b)) || a == b;
+}
+
+static bool check_vector(const char *vector, cvss_packed_vector packed, bool packed_ok, const struct cvss_scores *s)
+{
+    struct cvss_impact *imp = cvss_impact_new_from_vector(vector);
+
+    if (imp == NULL) {
+        if (packed_ok || packed != CVSS_PACKED_INVALID) {
+            printf("%s: packed, but not parsed to impact\n", vector);
+            return false;
+        }
+        return true;
+    }
+
+    bool ok = packed_ok && packed == cvss_impact_pack(imp)
+        && score_eq(s->base_exploitability_subscore, cvss_impact_base_exploitability_subscore(imp))
+        && score_eq(s->base_impact_subscore, cvss_impact_base_impact_subscore(imp))
+        && score_eq(s->base, cvss_impact_base_score(imp))
+        && score_eq(s->temporal_multiplier, cvss_impact_temporal_multiplier(imp))
+        && score_eq(s->temporal, cvss_impact_temporal_score(imp))
+        && score_eq(s->base_adjusted_impact_subscore, cvss_impact_base_adjusted_impact_subscore(imp))
+        && score_eq(s->adjusted_base, cvss_impact_adjusted_base_score(imp))
+        && score_eq(s->adjusted_temporal, cvss_impact_adjusted_temporal_score(imp))
+        && score_eq(s->environmental, cvss_impact_environmental_score(imp));
+
+    if (!ok)
+        printf("%s: packed scores differ\n", vector);
+    cvss_impact_free(imp);
+    return ok;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+    static char *vectors[MAX_VECTORS];
+    static cvss_packed_vector packed[MAX_VECTORS];
+    static struct cvss_scores scores[MAX_VECTORS];
+    char line[256];
+    size_t count = 0, valid;
+    long iterations = 0;
+    int ret = 0;
+
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s vectors-file [iterations]\n", argv[0]);
+        return 1;
+    }
+    if (argc > 2)
+        iterations = atol(argv[2]);
+
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    // the first word of each line is a vector
+    while (count < MAX_VECTORS && fgets(line, sizeof(line), f) != NULL) {
+        line[strcspn(line, " \t\n")] = '\0';
+        vectors[count++] = strdup(line);
+    }
+    fclose(f);
+
+    valid = cvss_vectors_pack((const char *const *) vectors, count, packed);
+    cvss_packed_scores(packed, count, scores);
+
+    for (size_t i = 0; i < count; ++i) {
+        cvss_packed_vector p;
+        bool ok = cvss_vector_pack(vectors[i], &p);
+        if (p != packed[i] || !check_vector(vectors[i], packed[i], ok, &scores[i]))
+            ret = 1;
+    }
+    printf("%zu vectors, %zu valid\n", count, valid);
+
+    if (iterations > 0 && count > 0) {
+        volatile float sink = 0;
+        double start = now();
+        for (long it = 0; it < iterations; ++it)
+            for (size_t i = 0; i < count; ++i) {
+                struct cvss_impact *imp = cvss_impact_new_from_vector(vectors[i]);
+                if (imp == NULL) continue;
+                sink += cvss_impact_base_score(imp);
+                sink += cvss_impact_temporal_score(imp);
+                sink += cvss_impact_environmental_score(imp);
+                cvss_impact_free(imp);
+            }
+        double impact_time = now() - start;
+
+        start = now();
+        for (long it = 0; it < iterations; ++it) {
+            cvss_vectors_pack((const char *const *) vectors, count, packed);
+            cvss_packed_scores(packed, count, scores);
+            sink += scores[count - 1].base;
+        }
+        double packed_time = now() - start;
+
+        double total = (double) iterations * count;
+        printf("cvss_impact: %.0f vectors/s\n", total / impact_time);
+        printf("packed:      %.0f vectors/s\n", total / packed_time);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        free(vectors[i]);
+    return ret;
+}
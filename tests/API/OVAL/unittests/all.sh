@@ -28,4 +28,7 @@ test_run "textfilecontent: 'line' comparison" $srcdir/test_filecontent_line.sh
 test_run "anyxml element" $srcdir/test_anyxml.sh
 test_run "invalid regular expression" $srcdir/test_invalid_regex.sh
 test_run "glob to regex" $srcdir/test_glob_to_regex.sh
+test_run "parallel evaluation of definitions" $srcdir/test_parallel_eval.sh
+test_run "probe result cache size limit" $srcdir/test_rcache_limit.sh
+test_run "entity names of collected items" $srcdir/test_sysent_names.sh
 test_exit
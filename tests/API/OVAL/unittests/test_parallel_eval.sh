@@ -0,0 +1,32 @@
+#!/bin/bash
+
+# The definitions evaluated by several threads must give the same results,
+# reported in the same order, as the definitions evaluated one by one.
+
+seq_stdout=`mktemp`
+seq_result=`mktemp`
+par_stdout=`mktemp`
+par_result=`mktemp`
+
+set -e
+set -o pipefail
+
+OSCAP_OVAL_JOBS=1 $OSCAP oval eval --results $seq_result $srcdir/parallel_eval.xml > $seq_stdout
+OSCAP_OVAL_JOBS=4 $OSCAP oval eval --results $par_result $srcdir/parallel_eval.xml > $par_stdout
+
+diff $seq_stdout $par_stdout
+
+grep -q "oval:x:def:1: true" $par_stdout
+grep -q "oval:x:def:2: true" $par_stdout
+grep -q "oval:x:def:3: true" $par_stdout
+grep -q "oval:x:def:4: true" $par_stdout
+grep -q "oval:x:def:5: true" $par_stdout
+
+# item ids are assigned by the probes, compare the results only
+results() {
+	grep -o '<\(definition\|criterion\|extend_definition\|test\) [^>]*>' $1
+}
+
+diff <(results $seq_result) <(results $par_result)
+
+rm $seq_stdout $seq_result $par_stdout $par_result
@@ -0,0 +1,29 @@
+#!/bin/bash
+
+# A probe result cache limited to a single result must drop the older
+# results and give the same results as the unlimited cache.
+
+ref_stdout=`mktemp`
+lim_stdout=`mktemp`
+stats=`mktemp`
+
+set -e
+set -o pipefail
+
+OSCAP_PROBE_RCACHE_LIMIT=0 $OSCAP oval eval $srcdir/parallel_eval.xml > $ref_stdout
+OSCAP_PROBE_RCACHE_LIMIT=1 $OSCAP oval eval --collect-stats $stats $srcdir/parallel_eval.xml > $lim_stdout
+
+diff $ref_stdout $lim_stdout
+
+# three file objects were collected, the cache keeps only the last one
+grep -q "^# rcache file: .* evictions=2 entries=1 .* limit=1$" $stats
+
+# set objects get the results of the referenced objects even though
+# they were dropped from the cache
+OSCAP_PROBE_RCACHE_LIMIT=0 $OSCAP oval eval $srcdir/rcache_set.xml > $ref_stdout
+OSCAP_PROBE_RCACHE_LIMIT=1 $OSCAP oval eval $srcdir/rcache_set.xml > $lim_stdout
+
+diff $ref_stdout $lim_stdout
+grep -q "^Definition oval:x:def:1: true$" $lim_stdout
+
+rm $ref_stdout $lim_stdout $stats
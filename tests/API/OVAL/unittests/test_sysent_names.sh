@@ -0,0 +1,25 @@
+#!/bin/bash
+
+# Item entity names and values are interned when the probe results are
+# converted into the model. States must still find the entities of the
+# same name and the object's mask must still reach the right entity.
+
+dir=$(cd $srcdir && pwd)
+defs=`mktemp`
+stdout=`mktemp`
+result=`mktemp`
+
+set -e
+set -o pipefail
+
+sed "s|@DIR@|$dir|" $srcdir/test_sysent_names.xml > $defs
+$OSCAP oval eval --results $result $defs > $stdout
+
+grep -q "oval:x:def:1: true" $stdout
+grep -q "oval:x:def:2: false" $stdout
+
+# the masked filename is exported without its value, the path is not masked
+grep -q '<unix-sys:filename mask="true"></unix-sys:filename>' $result
+grep -q "<unix-sys:path>$dir</unix-sys:path>" $result
+
+rm $defs $stdout $result
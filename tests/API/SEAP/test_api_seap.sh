@@ -480,6 +480,12 @@ function test_api_strto {
     ./test_api_strto
 }
 
+# Replies passed through the shared ring: ring full, replies larger than
+# the ring, child dying in the middle of a reply.
+function test_api_seap_shm {
+    ./test_api_seap_shm "$(pwd)/test_api_seap_shm"
+}
+
 # Testing.
 
 test_init "test_api_seap.log"
@@ -494,5 +500,6 @@ test_run "test_api_seap_number_expression"    ./test_api_seap_number
 test_run "test_api_seap_string_expression"    ./test_api_seap_string
 test_run "test_api_SEXP_deepcmp"              ./test_api_SEXP_deepcmp
 test_run "test_api_strto"                     ./test_api_strto
+test_run "test_api_seap_shm"                  test_api_seap_shm
 
 test_exit
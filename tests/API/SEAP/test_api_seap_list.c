@@ -459,5 +459,66 @@ int main (void)
 		SEXP_vfree (r0, r1, r3, NULL);
         }
 
+        {
+                /* parsed lists are flattened, check nth & copy-on-write */
+                SEXP_psetup_t *psetup;
+                SEXP_pstate_t *pstate = NULL;
+                SEXP_t *parsed, *l1, *l2, *r0, *r1;
+                char     buffer[8192];
+                size_t   buflen;
+                uint32_t i;
+
+                buflen = snprintf(buffer, sizeof buffer, "(");
+                for (i = 0; i < 1000; ++i)
+                        buflen += snprintf(buffer + buflen, sizeof buffer - buflen, "%u ", i);
+                buflen += snprintf(buffer + buflen, sizeof buffer - buflen, ")");
+
+                psetup = SEXP_psetup_new();
+                parsed = SEXP_parse(psetup, buffer, buflen, &pstate);
+                SEXP_psetup_free(psetup);
+
+                if (parsed == NULL || pstate != NULL)
+                        return (1);
+
+                l1 = SEXP_list_first(parsed);
+                SEXP_free(parsed);
+
+                if (SEXP_list_length(l1) != 1000)
+                        return (1);
+
+                for (i = 1; i <= 1000; ++i) {
+                        r0 = SEXP_list_nth(l1, i);
+                        if (r0 == NULL || SEXP_number_getu_32(r0) != i - 1)
+                                return (1);
+                        SEXP_free(r0);
+                }
+
+                l2 = SEXP_ref(l1);
+                SEXP_list_add(l1, r1 = SEXP_number_newu_32(1000));
+                r0 = SEXP_list_replace(l1, 1, r1);
+                SEXP_vfree(r0, r1, NULL);
+
+                if (SEXP_list_length(l1) != 1001 || SEXP_list_length(l2) != 1000)
+                        return (1);
+
+                for (i = 1; i <= 1001; ++i) {
+                        r0 = SEXP_list_nth(l1, i);
+                        if (r0 == NULL || SEXP_number_getu_32(r0) != (i == 1 ? 1000 : i - 1))
+                                return (1);
+                        SEXP_free(r0);
+                }
+
+                r0 = SEXP_list_nth(l2, 1);
+                if (r0 == NULL || SEXP_number_getu_32(r0) != 0)
+                        return (1);
+                SEXP_free(r0);
+
+                r1 = SEXP_list_rest(l2);
+                r0 = SEXP_list_nth(r1, 999);
+                if (SEXP_list_length(r1) != 999 || r0 == NULL || SEXP_number_getu_32(r0) != 999)
+                        return (1);
+                SEXP_vfree(r0, r1, l1, l2, NULL);
+        }
+
         return (0);
 }
@@ -0,0 +1,193 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ * Replies of a child process sent through the "shm" SEAP scheme:
+ *
+ *   test_api_seap_shm <absolute path of this program>
+ *
+ * The program starts itself as the child which answers each request
+ * (count size crash) with `count' strings of `size' bytes. If `crash' is
+ * not zero, the child kills itself after sending `crash' of them.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <seap.h>
+
+#define TEST_CHILD_ENV "SEAP_TEST_CHILD"
+#define TEST_MB (1024 * 1024)
+
+/* the "shm" scheme uses a ring of 8MB */
+#define TEST_RING_SIZE (8 * TEST_MB)
+
+static char test_byte(uint32_t msg, size_t i)
+{
+	return 'a' + (msg + i) % 26;
+}
+
+static int child(void)
+{
+	SEAP_CTX_t *ctx = SEAP_CTX_new();
+	int sd = SEAP_openfd2(ctx, STDIN_FILENO, STDOUT_FILENO, 0);
+	SEXP_t *req;
+
+	if (sd < 0)
+		return 1;
+
+	while (SEAP_recvsexp(ctx, sd, &req) == 0) {
+		SEXP_t *s_count = SEXP_list_nth(req, 1);
+		SEXP_t *s_size = SEXP_list_nth(req, 2);
+		SEXP_t *s_crash = SEXP_list_nth(req, 3);
+		uint32_t count = SEXP_number_getu_32(s_count);
+		uint32_t size = SEXP_number_getu_32(s_size);
+		uint32_t crash = SEXP_number_getu_32(s_crash);
+		char *buf = malloc(size);
+
+		for (uint32_t msg = 0; msg < count; ++msg) {
+			SEXP_t *s_str;
+
+			if (crash != 0 && msg == crash)
+				kill(getpid(), SIGKILL);
+
+			for (size_t i = 0; i < size; ++i)
+				buf[i] = test_byte(msg, i);
+			s_str = SEXP_string_new(buf, size);
+			if (SEAP_sendsexp(ctx, sd, s_str) != 0)
+				return 1;
+			SEXP_free(s_str);
+		}
+		free(buf);
+		SEXP_vfree(req, s_count, s_size, s_crash, NULL);
+	}
+
+	SEAP_CTX_free(ctx);
+	return 0;
+}
+
+/*
+ * Ask the child for `count' strings of `size' bytes and check all of them
+ * were received. If `crash' is not zero, receiving has to fail after at
+ * most `crash' replies instead. The replies are read after `delay' seconds
+ * so that the child can fill the ring in the meantime.
+ */
+static int request(SEAP_CTX_t *ctx, int sd, uint32_t count, uint32_t size, uint32_t crash, unsigned int delay)
+{
+	SEXP_t *s_count = SEXP_number_newu_32(count);
+	SEXP_t *s_size = SEXP_number_newu_32(size);
+	SEXP_t *s_crash = SEXP_number_newu_32(crash);
+	SEXP_t *req = SEXP_list_new(s_count, s_size, s_crash, NULL);
+	int ret;
+
+	ret = SEAP_sendsexp(ctx, sd, req);
+	SEXP_vfree(req, s_count, s_size, s_crash, NULL);
+	if (ret != 0) {
+		fprintf(stderr, "Cannot send the request.\n");
+		return 1;
+	}
+
+	sleep(delay);
+
+	for (uint32_t msg = 0; msg < count; ++msg) {
+		SEXP_t *rep;
+		char *str;
+
+		if (SEAP_recvsexp(ctx, sd, &rep) != 0) {
+			if (crash != 0 && msg <= crash)
+				return 0;
+			fprintf(stderr, "Cannot receive reply %u of %u.\n", msg + 1, count);
+			return 1;
+		}
+		if (!SEXP_stringp(rep) || SEXP_string_length(rep) != size) {
+			fprintf(stderr, "Reply %u has wrong size.\n", msg + 1);
+			return 1;
+		}
+		str = SEXP_string_cstr(rep);
+		for (size_t i = 0; i < size; ++i) {
+			if (str[i] != test_byte(msg, i)) {
+				fprintf(stderr, "Reply %u differs at byte %zu.\n", msg + 1, i);
+				return 1;
+			}
+		}
+		free(str);
+		SEXP_free(rep);
+	}
+
+	if (crash != 0) {
+		fprintf(stderr, "Received all replies from a dead child.\n");
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	SEAP_CTX_t *ctx;
+	char uri[4096];
+	int sd;
+
+	if (getenv(TEST_CHILD_ENV) != NULL)
+		return child();
+
+	if (argc != 2)
+		return 1;
+
+	/* a test that hangs fails */
+	alarm(120);
+
+	setenv(TEST_CHILD_ENV, "1", 1);
+	snprintf(uri, sizeof(uri), "shm://%s", argv[1]);
+
+	ctx = SEAP_CTX_new();
+	sd = SEAP_connect(ctx, uri, 0);
+	if (sd < 0) {
+		fprintf(stderr, "Cannot connect to '%s'.\n", uri);
+		return 1;
+	}
+
+	/* small replies */
+	if (request(ctx, sd, 100, 16, 0, 0) != 0)
+		return 1;
+	/* replies filling the ring several times while the parent does not read */
+	if (request(ctx, sd, 40, TEST_MB, 0, 2) != 0)
+		return 1;
+	/* replies larger than half of the ring and larger than the ring */
+	if (request(ctx, sd, 2, TEST_RING_SIZE / 2 + 1, 0, 0) != 0)
+		return 1;
+	if (request(ctx, sd, 1, TEST_RING_SIZE + TEST_MB, 0, 0) != 0)
+		return 1;
+
+	/* the child dies in the middle of a reply filling the ring */
+	if (request(ctx, sd, 40, TEST_MB, 12, 1) != 0)
+		return 1;
+
+	SEAP_close(ctx, sd);
+	SEAP_CTX_free(ctx);
+
+	return 0;
+}
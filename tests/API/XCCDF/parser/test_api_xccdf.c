@@ -47,6 +47,20 @@ int main(int argc, char **argv)
 		oscap_cleanup();
 		return 0;
 	}
+	else if (strcmp(argv[1], "--export-lazy") == 0) {
+		if (argc != 4) return 1;
+		struct oscap_source *source = oscap_source_new_from_file(argv[2]);
+		struct xccdf_benchmark *bench = xccdf_benchmark_import_source_lazy(source);
+		if (bench == NULL) {
+			oscap_source_free(source);
+			return 1;
+		}
+		xccdf_benchmark_export(bench, argv[3]);
+		xccdf_benchmark_free(bench);
+		oscap_source_free(source);
+		oscap_cleanup();
+		return 0;
+	}
 	else if (strcmp(argv[1], "--validate") == 0) {
 		if (argc != 4) {
 			fprintf(stderr, "Usage: %s --validate ver xccdf\n", argv[0]);
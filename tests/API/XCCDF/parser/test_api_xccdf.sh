@@ -37,6 +37,24 @@ function test_api_xccdf_export {
 	return 0
 }
 
+function test_api_xccdf_export_lazy {
+	local INPUT=$srcdir/$1
+	local OUTPUT=$1.out
+
+	# The texts taken from the document on export must be the same
+	# as the texts parsed at once.
+	./test_api_xccdf --export $INPUT $OUTPUT.eager
+	./test_api_xccdf --export-lazy $INPUT $OUTPUT
+
+	if ! cmp $OUTPUT.eager $OUTPUT; then
+		echo "Lazily imported content differs from what is expected!"
+		return 1
+	fi
+
+	rm $OUTPUT $OUTPUT.eager
+	return 0
+}
+
 function test_api_xccdf_validate {
 	local INPUT=$1
 	local VER=$2
@@ -54,5 +72,7 @@ test_run "validate xccdf 1.1" test_api_xccdf_validate xccdf11.xml "1.1"
 test_run "export xccdf 1.2" test_api_xccdf_export xccdf12.xml
 test_run "validate xccdf 1.2" test_api_xccdf_validate xccdf12.xml "1.2"
 test_run "export xccdf results 1.1" test_api_xccdf_export xccdf11-results.xml
+test_run "lazy export xccdf 1.1" test_api_xccdf_export_lazy xccdf11.xml
+test_run "lazy export xccdf 1.2" test_api_xccdf_export_lazy xccdf12.xml
 
 test_exit
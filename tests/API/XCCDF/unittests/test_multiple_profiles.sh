@@ -0,0 +1,65 @@
+#!/bin/bash
+
+# Several profiles evaluated in one pass give the same results as the profiles
+# evaluated one by one, while each OVAL object is collected only once. The
+# common and strict profiles bind different values to the same external
+# variable, the object using it is collected once for each value.
+
+set -e
+set -o pipefail
+
+name=$(basename $0 .sh)
+xccdf=$srcdir/${name}.xccdf.xml
+prefix=xccdf_moc.elpmaxe.www_profile_
+
+workdir=$(mktemp -d -t ${name}.out.XXXXXX)
+stderr=$(mktemp -t ${name}.out.XXXXXX)
+echo "Work dir = $workdir"
+echo "Stderr file = $stderr"
+
+# TestResult id, rule id and result of each rule-result
+rule_results() {
+	awk '/<TestResult /{ match($0, /id="[^"]*"/); tr = substr($0, RSTART, RLENGTH) }
+		/<rule-result /{ match($0, /idref="[^"]*"/); rr = substr($0, RSTART, RLENGTH) }
+		/<result>/{ print tr, rr, $0 }' $1
+}
+
+for profile in minimal common strict; do
+	ret=0
+	$OSCAP xccdf eval --profile ${prefix}$profile --results $workdir/$profile.xml $xccdf \
+		> /dev/null 2> $stderr || ret=$?
+	[ $ret -eq 0 -o $ret -eq 2 ]
+	[ ! -s $stderr ]
+	rule_results $workdir/$profile.xml >> $workdir/separate
+done
+
+ret=0
+$OSCAP xccdf eval --profile ${prefix}minimal --profile ${prefix}common --profile ${prefix}strict \
+	--collect-stats $workdir/stats.csv --results $workdir/all.xml --results-arf $workdir/arf.xml $xccdf \
+	> $workdir/stdout 2> $stderr || ret=$?
+# the strict profile fails
+[ $ret -eq 2 ]
+[ ! -s $stderr ]
+
+# one TestResult per profile
+[ $(grep -c '<TestResult ' $workdir/all.xml) -eq 3 ]
+for profile in minimal common strict; do
+	grep -q "<profile idref=\"${prefix}$profile\"/>" $workdir/all.xml
+done
+rule_results $workdir/all.xml > $workdir/together
+diff <(sort $workdir/separate) <(sort $workdir/together)
+grep -q 'profile_common" idref="xccdf_moc.elpmaxe.www_rule_4" .*<result>pass<' $workdir/together
+grep -q 'profile_strict" idref="xccdf_moc.elpmaxe.www_rule_4" .*<result>fail<' $workdir/together
+
+$OSCAP ds rds-validate $workdir/arf.xml
+[ $(grep -c '<arf:report id="xccdf' $workdir/arf.xml) -eq 3 ]
+
+# each object was collected once, except the one using the variable
+[ $(grep -v '^#' $workdir/stats.csv | grep -c '^oval:moc.elpmaxe.www:obj:[123],') -eq 3 ]
+[ $(grep -v '^#' $workdir/stats.csv | grep -c '^oval:moc.elpmaxe.www:obj:4,') -eq 2 ]
+
+# unknown profile among the selected ones is reported
+! $OSCAP xccdf eval --profile ${prefix}minimal --profile ${prefix}unknown $xccdf > /dev/null 2> $stderr
+grep -q "${prefix}unknown" $stderr
+
+rm -r $workdir $stderr
@@ -0,0 +1,73 @@
+#!/bin/bash
+
+set -e
+set -o pipefail
+
+name=$(basename $0 .sh)
+
+# Probes need to chroot into the scanned roots
+[ $(id -u) -eq 0 ] || exit 255
+
+workdir=$(mktemp -d -t ${name}.out.XXXXXX)
+stdout=$(mktemp -t ${name}.out.XXXXXX)
+stderr=$(mktemp -t ${name}.out.XXXXXX)
+
+mkdir -p $workdir/root1/etc $workdir/root2/etc $workdir/root3 $workdir/arf
+echo "enabled=1" > $workdir/root1/etc/marker
+echo "enabled=0" > $workdir/root2/etc/marker
+cat > $workdir/roots <<EOR
+# scanned roots
+$workdir/root1
+
+$workdir/root2
+$workdir/root3
+EOR
+
+# system_info probe cannot inspect offline roots
+export OSCAP_PROBE_OS_NAME=Linux OSCAP_PROBE_OS_VERSION=1 \
+	OSCAP_PROBE_ARCHITECTURE=x86_64 OSCAP_PROBE_PRIMARY_HOST_NAME=image
+
+ret=0
+$OSCAP xccdf eval --roots $workdir/roots --results-arf-dir $workdir/arf --jobs 2 \
+	$srcdir/${name}.xccdf.xml > $stdout 2> $stderr || ret=$?
+
+echo "Stdout file = $stdout"
+echo "Stderr file = $stderr"
+[ $ret -eq 0 -o $ret -eq 2 ]
+[ -f $stderr ]; [ ! -s $stderr ]; rm $stderr
+
+# One summary line and one ARF per root
+[ $(wc -l < $stdout) -eq 3 ]
+for root in root1 root2 root3; do
+	grep -q "^$workdir/$root	" $stdout
+	arf=$(ls $workdir/arf/*_${root}.arf.xml)
+	$OSCAP ds rds-validate $arf
+	[ $(grep -c '<rule-result ' $arf) -eq 1 ]
+done
+rm $stdout
+
+# Roots whose paths differ only by '/' and '_' get ARFs of their own
+mkdir -p $workdir/a/b_c $workdir/a_b/c $workdir/arf2
+printf "$workdir/a/b_c\n$workdir/a_b/c\n" > $workdir/roots2
+ret=0
+$OSCAP xccdf eval --roots $workdir/roots2 --results-arf-dir $workdir/arf2 \
+	$srcdir/${name}.xccdf.xml > $stdout 2> /dev/null || ret=$?
+[ $ret -eq 0 -o $ret -eq 2 ]
+[ $(ls $workdir/arf2 | wc -l) -eq 2 ]
+ls $workdir/arf2/*_a_b+5Fc.arf.xml
+ls $workdir/arf2/*_a+5Fb_c.arf.xml
+rm $stdout
+
+# A root listed twice is refused before anything is scanned
+printf "$workdir/root1\n$workdir/root1/\n" > $workdir/roots3
+! $OSCAP xccdf eval --roots $workdir/roots3 --results-arf-dir $workdir/arf2 \
+	$srcdir/${name}.xccdf.xml > /dev/null 2> $stderr
+grep -q "would be written to the same file" $stderr
+rm $stderr
+
+# --roots produces ARFs only
+! $OSCAP xccdf eval --roots $workdir/roots $srcdir/${name}.xccdf.xml 2> /dev/null
+! $OSCAP xccdf eval --roots $workdir/roots --results-arf-dir $workdir/arf --report $workdir/r.html \
+	$srcdir/${name}.xccdf.xml 2> /dev/null
+
+rm -r $workdir
@@ -0,0 +1,35 @@
+#!/bin/bash
+
+set -e
+set -o pipefail
+
+name=$(basename $0 .sh)
+
+xslt_report=$(mktemp -t ${name}.out.XXXXXX)
+native_report=$(mktemp -t ${name}.out.XXXXXX)
+stderr=$(mktemp -t ${name}.out.XXXXXX)
+
+$OSCAP xccdf eval --report $xslt_report \
+	$srcdir/test_deriving_xccdf_result_from_oval.xccdf.xml 2> $stderr
+[ -f $stderr ]; [ ! -s $stderr ]
+$OSCAP xccdf eval --report-engine native --report $native_report \
+	$srcdir/test_deriving_xccdf_result_from_oval.xccdf.xml 2> $stderr
+
+echo "Stderr file = $stderr"
+echo "XSLT report file = $xslt_report"
+echo "Native report file = $native_report"
+[ -f $stderr ]; [ ! -s $stderr ]; rm $stderr
+
+# Both engines shall render the same rules with the same results
+grep -o 'class="rule-overview-leaf rule-overview-leaf-[a-z]*' $xslt_report | sort > $stderr
+grep -o 'class="rule-overview-leaf rule-overview-leaf-[a-z]*' $native_report | sort | diff $stderr -
+[ "$(grep -c 'class="panel panel-default rule-detail ' $native_report)" == \
+	"$(grep -c 'class="panel panel-default rule-detail ' $xslt_report)" ]
+grep -q 'OVAL details' $native_report
+grep -q '</html>' $native_report
+rm $stderr
+
+# Unknown engine is refused
+! $OSCAP xccdf eval --report-engine none --report $native_report \
+	$srcdir/test_deriving_xccdf_result_from_oval.xccdf.xml 2> /dev/null
+rm $xslt_report $native_report
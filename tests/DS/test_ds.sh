@@ -216,6 +216,66 @@ function test_eval_complex()
 	rm $arf
 }
 
+function test_eval_compiled {
+    local image=$(mktemp -t ${name}.image.XXXXXX)
+    local stale=$(mktemp -t ${name}.sds.XXXXXX)
+    local stderr=$(mktemp -t ${name}.err.XXXXXX)
+    local ret=0
+
+    $OSCAP ds sds-compile "${srcdir}/$1" $image || ret=1
+    $OSCAP xccdf eval "${srcdir}/$1" > $stale.expected
+    $OSCAP xccdf eval --compiled-content $image "${srcdir}/$1" > $stale.actual 2> $stderr || ret=1
+    diff /dev/null $stderr || ret=1
+    diff $stale.expected $stale.actual || ret=1
+
+    # the image is not used once the source datastream changes
+    cp "${srcdir}/$1" $stale; echo >> $stale
+    $OSCAP xccdf eval --compiled-content $image $stale > /dev/null 2> $stderr || ret=1
+    grep -q "out of date" $stderr || ret=1
+
+    rm -f $image $stale $stale.expected $stale.actual $stderr
+    return $ret
+}
+
+function test_eval_load_jobs {
+    local DS_FILE="$1"
+    local DS_TARGET_DIR="`mktemp -d`"
+    local stderr=$(mktemp -t ${name}.err.XXXXXX)
+    local ret=0
+
+    # The components loaded by several threads, which is the default, must
+    # be used just like the components loaded one by one. The rules may fail,
+    # hence no exit codes. The concurrent loading is repeated to catch races.
+    OSCAP_FULL_VALIDATION=1 OSCAP_LOAD_JOBS=1 $OSCAP xccdf eval "$DS_FILE" > $DS_TARGET_DIR/seq || true
+    [ "`grep -c '^Result' $DS_TARGET_DIR/seq`" == "$2" ] || ret=1
+    for i in 1 2 3 4 5; do
+        OSCAP_FULL_VALIDATION=1 OSCAP_LOAD_JOBS=4 $OSCAP xccdf eval "$DS_FILE" > $DS_TARGET_DIR/par 2> $stderr || true
+        diff /dev/null $stderr || ret=1
+        diff $DS_TARGET_DIR/seq $DS_TARGET_DIR/par || ret=1
+        OSCAP_FULL_VALIDATION=1 $OSCAP xccdf eval "$DS_FILE" > $DS_TARGET_DIR/par 2> $stderr || true
+        diff /dev/null $stderr || ret=1
+        diff $DS_TARGET_DIR/seq $DS_TARGET_DIR/par || ret=1
+    done
+
+    rm -r "$DS_TARGET_DIR" $stderr
+    return $ret
+}
+
+function test_eval_load_jobs_composed {
+    local DS_TARGET_DIR="`mktemp -d`"
+    local DS_FILE="$DS_TARGET_DIR/sds.xml"
+    local ret=0
+
+    pushd "${srcdir}/$1"
+    $OSCAP ds sds-compose "$2" "$DS_FILE"
+    popd
+
+    test_eval_load_jobs "$DS_FILE" $3 || ret=1
+
+    rm -r "$DS_TARGET_DIR"
+    return $ret
+}
+
 function test_oval_eval {
 
     $OSCAP oval eval "${srcdir}/$1"
@@ -357,10 +417,14 @@ test_run "eval_benchmark_id1" test_eval_benchmark_id eval_xccdf_id/sds.xml xccdf
 test_run "eval_benchmark_id2" test_eval_benchmark_id eval_xccdf_id/sds.xml xccdf_moc.elpmaxe.www_benchmark_second second
 test_run "eval_benchmark_id_conflict" test_eval_benchmark_id eval_benchmark_id_conflict/sds.xml xccdf_moc.elpmaxe.www_benchmark_first first
 test_run "eval_just_oval" test_oval_eval eval_just_oval/sds.xml
+test_run "eval_load_jobs" test_eval_load_jobs_composed sds_multiple_oval multiple-oval-xccdf.xml 2
+test_run "eval_load_jobs_cpe" test_eval_load_jobs "${srcdir}/eval_cpe/sds.xml" 1
 test_run "eval_oval_id1" test_oval_eval_id eval_oval_id/sds.xml scap_org.open-scap_datastream_just_oval scap_org.open-scap_cref_scap-oval1.xml "oval:x:def:1"
 test_run "eval_oval_id2" test_oval_eval_id eval_oval_id/sds.xml scap_org.open-scap_datastream_just_oval scap_org.open-scap_cref_scap-oval2.xml "oval:x:def:2"
 test_run "eval_cpe" test_eval eval_cpe/sds.xml
 test_run "generate_fix_cpe" test_generate_fix eval_cpe/sds.xml
+test_run "eval_compiled_cpe" test_eval_compiled eval_cpe/sds.xml
+test_run "eval_compiled_simple" test_eval_compiled eval_simple/sds.xml
 
 test_run "rds_simple" test_rds rds_simple/sds.xml rds_simple/results-xccdf.xml rds_simple/results-oval.xml
 test_run "rds_testresult" test_rds rds_testresult/sds.xml rds_testresult/results-xccdf.xml rds_testresult/results-oval.xml
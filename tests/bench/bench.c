@@ -0,0 +1,204 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ * Microbenchmarks of the SEXP/SEAP runtime and of the core containers.
+ *
+ * Usage: oscap_bench [-r REPETITIONS] [-o FILE] [-l] [FILTER...]
+ *
+ * Every case is run REPETITIONS times (5 by default) with a fixed number
+ * of iterations and fixed input. Results are written as a JSON document
+ * with the minimum, median and maximum time per operation. Only cases
+ * whose name contains one of the FILTERs are run if any is given.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "bench.h"
+
+volatile uintptr_t bench_sink;
+
+uint32_t bench_random(uint32_t *state)
+{
+	/* xorshift32 */
+	uint32_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+
+	return (*state = x);
+}
+
+static const struct bench_case *bench_suites[] = {
+	bench_sexp_cases,
+	bench_container_cases,
+	bench_seap_cases,
+	NULL
+};
+
+static bool bench_selected(const char *name, int argc, char *argv[])
+{
+	int i;
+
+	if (argc == 0)
+		return true;
+
+	for (i = 0; i < argc; ++i) {
+		if (strstr(name, argv[i]) != NULL)
+			return true;
+	}
+
+	return false;
+}
+
+static int bench_dblcmp(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+static double bench_sample(const struct bench_case *bc)
+{
+	struct timespec beg, end;
+	void *arg = NULL;
+
+	if (bc->setup != NULL)
+		arg = bc->setup(bc->iterations);
+
+	clock_gettime(CLOCK_MONOTONIC, &beg);
+	bc->run(arg, bc->iterations);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	if (bc->teardown != NULL)
+		bc->teardown(arg);
+
+	return ((double)(end.tv_sec - beg.tv_sec) * 1e9 + (double)(end.tv_nsec - beg.tv_nsec))
+		/ (double)bc->iterations;
+}
+
+static void bench_usage(FILE *fp)
+{
+	fprintf(fp, "Usage: oscap_bench [-r REPETITIONS] [-o FILE] [-l] [FILTER...]\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const struct bench_case **suite, *bc;
+	unsigned int repetitions = 5, r;
+	const char *output = NULL;
+	bool list = false, first = true;
+	double *samples;
+	FILE *fp;
+	int c;
+
+	if (getenv(BENCH_SEAP_PEER_ENV) != NULL)
+		return bench_seap_peer();
+
+	while ((c = getopt(argc, argv, "r:o:lh")) != -1) {
+		switch (c) {
+		case 'r':
+			repetitions = strtoul(optarg, NULL, 10);
+			if (repetitions == 0) {
+				bench_usage(stderr);
+				return 1;
+			}
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		case 'l':
+			list = true;
+			break;
+		case 'h':
+			bench_usage(stdout);
+			return 0;
+		default:
+			bench_usage(stderr);
+			return 1;
+		}
+	}
+
+	argc -= optind;
+	argv += optind;
+
+	if (list) {
+		for (suite = bench_suites; *suite != NULL; ++suite)
+			for (bc = *suite; bc->name != NULL; ++bc)
+				printf("%s\n", bc->name);
+		return 0;
+	}
+
+	if (output != NULL) {
+		fp = fopen(output, "w");
+		if (fp == NULL) {
+			perror(output);
+			return 1;
+		}
+	} else
+		fp = stdout;
+
+	samples = malloc(sizeof(double) * repetitions);
+
+	fprintf(fp, "{\n  \"suite\": \"%s\",\n  \"version\": \"%s\",\n  \"repetitions\": %u,\n  \"benchmarks\": [",
+		PACKAGE_NAME, PACKAGE_VERSION, repetitions);
+
+	for (suite = bench_suites; *suite != NULL; ++suite) {
+		for (bc = *suite; bc->name != NULL; ++bc) {
+			if (!bench_selected(bc->name, argc, argv))
+				continue;
+
+			/* warm up caches and allocators */
+			bench_sample(bc);
+
+			for (r = 0; r < repetitions; ++r)
+				samples[r] = bench_sample(bc);
+
+			qsort(samples, repetitions, sizeof(double), bench_dblcmp);
+
+			fprintf(fp, "%s\n    {\"name\": \"%s\", \"iterations\": %zu, "
+				"\"ns_per_op_min\": %.1f, \"ns_per_op_median\": %.1f, \"ns_per_op_max\": %.1f, "
+				"\"ops_per_sec\": %.0f}",
+				first ? "" : ",", bc->name, bc->iterations,
+				samples[0], samples[repetitions / 2], samples[repetitions - 1],
+				1e9 / samples[repetitions / 2]);
+			fflush(fp);
+			first = false;
+		}
+	}
+
+	fprintf(fp, "\n  ]\n}\n");
+	free(samples);
+
+	if (fp != stdout)
+		fclose(fp);
+
+	return 0;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef OSCAP_BENCH_H
+#define OSCAP_BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * A benchmark case. The setup function prepares the input of one sample
+ * and isn't measured, the run function performs `iterations' operations
+ * and is measured. Both setup and teardown are optional.
+ */
+struct bench_case {
+	const char *name;
+	size_t      iterations;
+	void     *(*setup)(size_t iterations);
+	void      (*run)(void *arg, size_t iterations);
+	void      (*teardown)(void *arg);
+};
+
+#define BENCH_END { NULL, 0, NULL, NULL, NULL }
+
+/* Results of the measured operations are stored here so that they aren't optimized out */
+extern volatile uintptr_t bench_sink;
+
+/* Deterministic pseudo-random numbers, the same sequence on every run */
+uint32_t bench_random(uint32_t *state);
+
+extern const struct bench_case bench_sexp_cases[];
+extern const struct bench_case bench_container_cases[];
+extern const struct bench_case bench_seap_cases[];
+
+/* Serve SEAP requests of bench_seap_cases on stdin/stdout */
+int bench_seap_peer(void);
+
+#define BENCH_SEAP_PEER_ENV "OSCAP_BENCH_SEAP_PEER"
+
+#endif
@@ -0,0 +1,310 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <rbt/rbt.h>
+
+#include "common/list.h"
+#include "OVAL/adt/oval_string_map_impl.h"
+#include "OVAL/results/oval_cmp_evr_string_impl.h"
+
+#include "bench.h"
+
+#define KEY_COUNT 65536
+
+/*
+ * Keys shaped like OVAL ids, inserted in a pseudo-random order.
+ */
+struct key_input {
+	int32_t *ikeys;
+	char   **skeys;
+	size_t   count;
+	void    *container;
+};
+
+static struct key_input *key_input_new(size_t count)
+{
+	struct key_input *in = malloc(sizeof *in);
+	uint32_t seed = 2463534242U;
+	char buffer[64];
+	size_t i;
+
+	in->count = count;
+	in->ikeys = malloc(sizeof(int32_t) * count);
+	in->skeys = malloc(sizeof(char *) * count);
+	in->container = NULL;
+
+	for (i = 0; i < count; ++i) {
+		in->ikeys[i] = (int32_t)bench_random(&seed);
+		snprintf(buffer, sizeof buffer, "oval:org.example.%u:obj:%u", in->ikeys[i] % 64, (unsigned int)i);
+		in->skeys[i] = strdup(buffer);
+	}
+
+	return in;
+}
+
+static void key_input_free(struct key_input *in)
+{
+	size_t i;
+
+	for (i = 0; i < in->count; ++i)
+		free(in->skeys[i]);
+
+	free(in->skeys);
+	free(in->ikeys);
+	free(in);
+}
+
+static void *keys_new(size_t iterations)
+{
+	return key_input_new(iterations);
+}
+
+static void *rbt_i32_filled(size_t iterations)
+{
+	struct key_input *in = key_input_new(KEY_COUNT);
+	size_t i;
+
+	(void)iterations;
+
+	in->container = rbt_i32_new();
+
+	for (i = 0; i < in->count; ++i)
+		rbt_i32_add(in->container, in->ikeys[i], in->skeys[i], NULL);
+
+	return in;
+}
+
+static void rbt_i32_teardown(void *arg)
+{
+	struct key_input *in = arg;
+
+	rbt_i32_free(in->container);
+	key_input_free(in);
+}
+
+static void rbt_i32_add_run(void *arg, size_t iterations)
+{
+	struct key_input *in = arg;
+	size_t i;
+
+	in->container = rbt_i32_new();
+
+	for (i = 0; i < iterations; ++i)
+		rbt_i32_add(in->container, in->ikeys[i], in->skeys[i], NULL);
+}
+
+static void rbt_i32_get_run(void *arg, size_t iterations)
+{
+	struct key_input *in = arg;
+	void *data;
+	size_t i;
+
+	for (i = 0; i < iterations; ++i) {
+		if (rbt_i32_get(in->container, in->ikeys[(i * 7919) % in->count], &data) == 0)
+			bench_sink += (uintptr_t)data;
+	}
+}
+
+static void rbt_str_node_free(struct rbt_str_node *n)
+{
+	/* keys are owned by the input */
+	(void)n;
+}
+
+static void *rbt_str_filled(size_t iterations)
+{
+	struct key_input *in = key_input_new(KEY_COUNT);
+	size_t i;
+
+	(void)iterations;
+
+	in->container = rbt_str_new();
+
+	for (i = 0; i < in->count; ++i)
+		rbt_str_add(in->container, in->skeys[i], in->skeys[i]);
+
+	return in;
+}
+
+static void rbt_str_teardown(void *arg)
+{
+	struct key_input *in = arg;
+
+	rbt_str_free_cb(in->container, rbt_str_node_free);
+	key_input_free(in);
+}
+
+static void rbt_str_add_run(void *arg, size_t iterations)
+{
+	struct key_input *in = arg;
+	size_t i;
+
+	in->container = rbt_str_new();
+
+	for (i = 0; i < iterations; ++i)
+		rbt_str_add(in->container, in->skeys[i], in->skeys[i]);
+}
+
+static void rbt_str_get_run(void *arg, size_t iterations)
+{
+	struct key_input *in = arg;
+	void *data;
+	size_t i;
+
+	for (i = 0; i < iterations; ++i) {
+		if (rbt_str_get(in->container, in->skeys[(i * 7919) % in->count], &data) == 0)
+			bench_sink += (uintptr_t)data;
+	}
+}
+
+static void *htable_filled(size_t iterations)
+{
+	struct key_input *in = key_input_new(KEY_COUNT);
+	size_t i;
+
+	(void)iterations;
+
+	in->container = oscap_htable_new();
+
+	for (i = 0; i < in->count; ++i)
+		oscap_htable_add(in->container, in->skeys[i], in->skeys[i]);
+
+	return in;
+}
+
+static void htable_teardown(void *arg)
+{
+	struct key_input *in = arg;
+
+	oscap_htable_free0(in->container);
+	key_input_free(in);
+}
+
+static void htable_add_run(void *arg, size_t iterations)
+{
+	struct key_input *in = arg;
+	size_t i;
+
+	in->container = oscap_htable_new();
+
+	for (i = 0; i < iterations; ++i)
+		oscap_htable_add(in->container, in->skeys[i], in->skeys[i]);
+}
+
+static void htable_get_run(void *arg, size_t iterations)
+{
+	struct key_input *in = arg;
+	size_t i;
+
+	for (i = 0; i < iterations; ++i)
+		bench_sink += (uintptr_t)oscap_htable_get(in->container, in->skeys[(i * 7919) % in->count]);
+}
+
+static void *string_map_filled(size_t iterations)
+{
+	struct key_input *in = key_input_new(KEY_COUNT);
+	size_t i;
+
+	(void)iterations;
+
+	in->container = oval_string_map_new();
+
+	for (i = 0; i < in->count; ++i)
+		oval_string_map_put(in->container, in->skeys[i], in->skeys[i]);
+
+	return in;
+}
+
+static void string_map_teardown(void *arg)
+{
+	struct key_input *in = arg;
+
+	oval_string_map_free0(in->container);
+	key_input_free(in);
+}
+
+static void string_map_put_run(void *arg, size_t iterations)
+{
+	struct key_input *in = arg;
+	size_t i;
+
+	in->container = oval_string_map_new();
+
+	for (i = 0; i < iterations; ++i)
+		oval_string_map_put(in->container, in->skeys[i], in->skeys[i]);
+}
+
+static void string_map_get_run(void *arg, size_t iterations)
+{
+	struct key_input *in = arg;
+	size_t i;
+
+	for (i = 0; i < iterations; ++i)
+		bench_sink += (uintptr_t)oval_string_map_get_value(in->container, in->skeys[(i * 7919) % in->count]);
+}
+
+/*
+ * EVR strings as they appear in rpminfo states and items.
+ */
+static const char *evr_pairs[][2] = {
+	{ "0:2.17-105.el7",          "0:2.17-106.el7_2.4"        },
+	{ "1:1.0.2k-8.el7",          "1:1.0.2k-16.el7_6.1"       },
+	{ "0:3.10.0-514.el7",        "0:3.10.0-1062.18.1.el7"    },
+	{ "0:7.4.1-24.el7",          "0:7.4.1-24.el7"            },
+	{ "2:7.4.160-1.el7",         "2:7.4.629-6.el7"           },
+	{ "0:1.8.3.1-6.el7_2.1",     "0:1.8.3.1-21.el7_7"        },
+	{ "0:5.16.3-291.el7",        "0:5.16.3-294.el7_6"        },
+	{ "0:2.4.6-45.el7.centos",   "0:2.4.6-45.el7.centos.4"   },
+};
+
+#define EVR_PAIR_COUNT (sizeof evr_pairs / sizeof evr_pairs[0])
+
+static void evr_cmp_run(void *arg, size_t iterations)
+{
+	size_t i;
+
+	(void)arg;
+
+	for (i = 0; i < iterations; ++i) {
+		const char **pair = evr_pairs[i % EVR_PAIR_COUNT];
+
+		bench_sink += oval_evr_string_cmp(pair[0], pair[1], OVAL_OPERATION_LESS_THAN);
+	}
+}
+
+const struct bench_case bench_container_cases[] = {
+	{ "rbt/i32_add",       KEY_COUNT, keys_new,          rbt_i32_add_run,    rbt_i32_teardown },
+	{ "rbt/i32_get",       1000000,   rbt_i32_filled,    rbt_i32_get_run,    rbt_i32_teardown },
+	{ "rbt/str_add",       KEY_COUNT, keys_new,          rbt_str_add_run,    rbt_str_teardown },
+	{ "rbt/str_get",       1000000,   rbt_str_filled,    rbt_str_get_run,    rbt_str_teardown },
+	{ "htable/add",        KEY_COUNT, keys_new,          htable_add_run,     htable_teardown },
+	{ "htable/get",        1000000,   htable_filled,     htable_get_run,     htable_teardown },
+	{ "string_map/put",    KEY_COUNT, keys_new,          string_map_put_run, string_map_teardown },
+	{ "string_map/get",    1000000,   string_map_filled, string_map_get_run, string_map_teardown },
+	{ "evr/string_cmp",    100000,    NULL,              evr_cmp_run,        NULL },
+	BENCH_END
+};
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <limits.h>
+#include <seap.h>
+
+#include "bench.h"
+
+/*
+ * Round trips of SEAP messages to a child process spawned by the pipe
+ * scheme, the same way the library talks to probes. The child is this
+ * program, switched to bench_seap_peer() by an environment variable.
+ */
+
+#define ITEM_COUNT 64
+
+struct seap_input {
+	SEAP_CTX_t *ctx;
+	int         sd;
+	SEXP_t     *small;
+	SEXP_t     *large;
+};
+
+int bench_seap_peer(void)
+{
+	SEAP_CTX_t *ctx = SEAP_CTX_new();
+	SEAP_msg_t *req, *rep;
+	SEXP_t *s_exp;
+	int sd;
+
+	sd = SEAP_openfd2(ctx, STDIN_FILENO, STDOUT_FILENO, 0);
+
+	if (sd < 0)
+		return 1;
+
+	while (SEAP_recvmsg(ctx, sd, &req) == 0) {
+		rep = SEAP_msg_new();
+		SEAP_msg_set(rep, s_exp = SEAP_msg_get(req));
+		SEXP_free(s_exp);
+
+		if (SEAP_reply(ctx, sd, rep, req) != 0)
+			break;
+
+		SEAP_msg_free(rep);
+		SEAP_msg_free(req);
+	}
+
+	SEAP_close(ctx, sd);
+	SEAP_CTX_free(ctx);
+
+	return 0;
+}
+
+static void *seap_input_new(size_t iterations)
+{
+	struct seap_input *in = malloc(sizeof *in);
+	char uri[PATH_MAX + 8];
+	char path[PATH_MAX];
+	ssize_t len;
+	SEXP_t *item;
+	int i;
+
+	(void)iterations;
+
+	len = readlink("/proc/self/exe", path, sizeof path - 1);
+
+	if (len < 0) {
+		perror("readlink");
+		abort();
+	}
+
+	path[len] = '\0';
+	snprintf(uri, sizeof uri, "pipe://%s", path);
+	setenv(BENCH_SEAP_PEER_ENV, "1", 1);
+
+	in->ctx = SEAP_CTX_new();
+	in->sd  = SEAP_connect(in->ctx, uri, 0);
+
+	unsetenv(BENCH_SEAP_PEER_ENV);
+
+	if (in->sd < 0) {
+		fprintf(stderr, "Can't connect to %s.\n", uri);
+		abort();
+	}
+
+	in->small = SEXP_list_new(NULL);
+	SEXP_list_add(in->small, item = SEXP_string_newf("oval:org.example:obj:1"));
+	SEXP_free(item);
+
+	in->large = SEXP_list_new(NULL);
+
+	for (i = 0; i < ITEM_COUNT; ++i) {
+		SEXP_t *r0, *r1, *r2, *r3, *r4;
+
+		item = SEXP_list_new(r0 = SEXP_string_newf("textfilecontent_item"),
+				     r1 = SEXP_string_newf("/etc/app%d/app.conf", i),
+				     r2 = SEXP_string_newf("^value=(.*)$"),
+				     r3 = SEXP_string_newf("value=%d", i),
+				     r4 = SEXP_number_newu_32(i),
+				     NULL);
+		SEXP_list_add(in->large, item);
+		SEXP_vfree(r0, r1, r2, r3, r4, item, NULL);
+	}
+
+	return in;
+}
+
+static void seap_input_free(void *arg)
+{
+	struct seap_input *in = arg;
+
+	SEXP_free(in->small);
+	SEXP_free(in->large);
+	SEAP_close(in->ctx, in->sd);
+	SEAP_CTX_free(in->ctx);
+	free(in);
+}
+
+static void seap_roundtrip(struct seap_input *in, SEXP_t *s_exp, size_t iterations)
+{
+	SEAP_msg_t *req, *rep;
+	size_t i;
+
+	for (i = 0; i < iterations; ++i) {
+		req = SEAP_msg_new();
+		SEAP_msg_set(req, s_exp);
+
+		if (SEAP_sendmsg(in->ctx, in->sd, req) != 0 ||
+		    SEAP_recvmsg(in->ctx, in->sd, &rep) != 0) {
+			fprintf(stderr, "SEAP round trip failed.\n");
+			abort();
+		}
+
+		bench_sink += (uintptr_t)rep;
+		SEAP_msg_free(rep);
+		SEAP_msg_free(req);
+	}
+}
+
+static void seap_small_run(void *arg, size_t iterations)
+{
+	struct seap_input *in = arg;
+
+	seap_roundtrip(in, in->small, iterations);
+}
+
+static void seap_large_run(void *arg, size_t iterations)
+{
+	struct seap_input *in = arg;
+
+	seap_roundtrip(in, in->large, iterations);
+}
+
+const struct bench_case bench_seap_cases[] = {
+	{ "seap/roundtrip_small", 2000, seap_input_new, seap_small_run, seap_input_free },
+	{ "seap/roundtrip_large", 500,  seap_input_new, seap_large_run, seap_input_free },
+	BENCH_END
+};
@@ -0,0 +1,269 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sexp.h>
+#include <sexp-ID.h>
+#include <sexp-output.h>
+#include <strbuf.h>
+
+#include "bench.h"
+
+#define OBJECT_COUNT 32
+#define LIST_LENGTH  4096
+#define SORT_LENGTH  1024
+
+struct sexp_input {
+	char   *text;
+	size_t  length;
+	SEXP_psetup_t *psetup;
+	SEXP_t *a;
+	SEXP_t *b;
+};
+
+/*
+ * A list of probe objects as they are sent to a textfilecontent54 probe.
+ */
+static char *sexp_object_text(size_t *length)
+{
+	size_t size = 512 * OBJECT_COUNT, len;
+	char *text = malloc(size);
+	int i;
+
+	len = snprintf(text, size, "(");
+
+	for (i = 0; i < OBJECT_COUNT; ++i) {
+		len += snprintf(text + len, size - len,
+				"((\"textfilecontent54_object\" \":id\" \"oval:org.example:obj:%d\" \":oval_version\" \"5.11\")"
+				" ((\"path\" \":operation\" 5) \"/etc/app%d\")"
+				" ((\"filename\" \":operation\" 11) \"^[a-z]+[.]conf$\")"
+				" ((\"pattern\" \":operation\" 11) \"^value=(.*)$\")"
+				" ((\"instance\" \":datatype\" \"int\" \":operation\" 7) 1)"
+				" ((\"behaviors\" \":max_depth\" \"-1\" \":recurse_direction\" \"none\")))", i, i);
+	}
+
+	len += snprintf(text + len, size - len, ")");
+	*length = len;
+
+	return text;
+}
+
+static void *sexp_input_new(size_t iterations)
+{
+	struct sexp_input *in = malloc(sizeof *in);
+	SEXP_pstate_t *pstate = NULL;
+
+	(void)iterations;
+
+	in->text   = sexp_object_text(&in->length);
+	in->psetup = SEXP_psetup_new();
+	in->a      = SEXP_parse(in->psetup, in->text, in->length, &pstate);
+	in->b      = SEXP_parse(in->psetup, in->text, in->length, &pstate);
+
+	if (in->a == NULL || in->b == NULL) {
+		fprintf(stderr, "Can't parse the benchmark input.\n");
+		abort();
+	}
+
+	return in;
+}
+
+static void sexp_input_free(void *arg)
+{
+	struct sexp_input *in = arg;
+
+	SEXP_free(in->a);
+	SEXP_free(in->b);
+	SEXP_psetup_free(in->psetup);
+	free(in->text);
+	free(in);
+}
+
+static void sexp_parse_run(void *arg, size_t iterations)
+{
+	struct sexp_input *in = arg;
+	SEXP_pstate_t *pstate = NULL;
+	SEXP_t *s_exp;
+	size_t i;
+
+	for (i = 0; i < iterations; ++i) {
+		s_exp = SEXP_parse(in->psetup, in->text, in->length, &pstate);
+		bench_sink += (uintptr_t)s_exp;
+		SEXP_free(s_exp);
+	}
+}
+
+static void sexp_print_run(void *arg, size_t iterations)
+{
+	struct sexp_input *in = arg;
+	strbuf_t *sb;
+	size_t i;
+
+	for (i = 0; i < iterations; ++i) {
+		sb = strbuf_new(in->length);
+		SEXP_sbprintf_t(in->a, sb);
+		bench_sink += strbuf_length(sb);
+		strbuf_free(sb);
+	}
+}
+
+static void sexp_deepcmp_run(void *arg, size_t iterations)
+{
+	struct sexp_input *in = arg;
+	size_t i;
+
+	for (i = 0; i < iterations; ++i)
+		bench_sink += SEXP_deepcmp(in->a, in->b);
+}
+
+static void sexp_ID_run(void *arg, size_t iterations)
+{
+	struct sexp_input *in = arg;
+	size_t i;
+
+	for (i = 0; i < iterations; ++i)
+		bench_sink += SEXP_ID_v(in->a);
+}
+
+static void sexp_list_build_run(void *arg, size_t iterations)
+{
+	SEXP_t *list, *num;
+	size_t i;
+
+	(void)arg;
+
+	list = SEXP_list_new(NULL);
+	num  = SEXP_number_newu_32(42);
+
+	for (i = 0; i < iterations; ++i)
+		SEXP_list_add(list, num);
+
+	bench_sink += SEXP_list_length(list);
+	SEXP_free(num);
+	SEXP_free(list);
+}
+
+/*
+ * Lists received from probes are parsed, build the input the same way.
+ */
+static void *sexp_list_new(size_t iterations)
+{
+	SEXP_psetup_t *psetup = SEXP_psetup_new();
+	SEXP_pstate_t *pstate = NULL;
+	size_t size = 8 * LIST_LENGTH, len;
+	char *text = malloc(size);
+	SEXP_t *list;
+	int i;
+
+	(void)iterations;
+
+	len = snprintf(text, size, "(");
+	for (i = 0; i < LIST_LENGTH; ++i)
+		len += snprintf(text + len, size - len, "%d ", i);
+	len += snprintf(text + len, size - len, ")");
+
+	list = SEXP_parse(psetup, text, len, &pstate);
+
+	SEXP_psetup_free(psetup);
+	free(text);
+
+	return list;
+}
+
+static void sexp_list_free(void *arg)
+{
+	SEXP_free((SEXP_t *)arg);
+}
+
+static void sexp_list_nth_run(void *arg, size_t iterations)
+{
+	SEXP_t *list = arg, *item;
+	size_t i;
+
+	for (i = 0; i < iterations; ++i) {
+		item = SEXP_list_nth(list, 1 + (i * 7919) % LIST_LENGTH);
+		bench_sink += (uintptr_t)item;
+		SEXP_free(item);
+	}
+}
+
+static void *sexp_sort_new(size_t iterations)
+{
+	SEXP_t **lists = malloc(sizeof(SEXP_t *) * (iterations + 1)), *num;
+	uint32_t seed = 2463534242U;
+	size_t i, j;
+
+	for (i = 0; i < iterations; ++i) {
+		lists[i] = SEXP_list_new(NULL);
+
+		for (j = 0; j < SORT_LENGTH; ++j) {
+			SEXP_list_add(lists[i], num = SEXP_number_newu_32(bench_random(&seed)));
+			SEXP_free(num);
+		}
+	}
+
+	lists[iterations] = NULL;
+
+	return lists;
+}
+
+static int sexp_sort_cmp(const SEXP_t *a, const SEXP_t *b)
+{
+	uint32_t x = SEXP_number_getu_32(a), y = SEXP_number_getu_32(b);
+
+	return (x > y) - (x < y);
+}
+
+static void sexp_sort_run(void *arg, size_t iterations)
+{
+	SEXP_t **lists = arg;
+	size_t i;
+
+	for (i = 0; i < iterations; ++i)
+		SEXP_list_sort(lists[i], sexp_sort_cmp);
+}
+
+static void sexp_sort_free(void *arg)
+{
+	SEXP_t **lists = arg;
+	size_t i;
+
+	for (i = 0; lists[i] != NULL; ++i)
+		SEXP_free(lists[i]);
+
+	free(lists);
+}
+
+const struct bench_case bench_sexp_cases[] = {
+	{ "sexp/parse",        200,     sexp_input_new, sexp_parse_run,      sexp_input_free },
+	{ "sexp/print",        200,     sexp_input_new, sexp_print_run,      sexp_input_free },
+	{ "sexp/deepcmp",      200,     sexp_input_new, sexp_deepcmp_run,    sexp_input_free },
+	{ "sexp/ID_v",         200,     sexp_input_new, sexp_ID_run,         sexp_input_free },
+	{ "sexp/list_build",   100000,  NULL,           sexp_list_build_run, NULL },
+	{ "sexp/list_nth",     1000000, sexp_list_new,  sexp_list_nth_run,   sexp_list_free },
+	{ "sexp/list_sort",    100,     sexp_sort_new,  sexp_sort_run,       sexp_sort_free },
+	BENCH_END
+};
@@ -55,6 +55,14 @@ $OSCAP xccdf eval --results-arf $arf "${sds}.bz2" 2> $stderr || ret=$?
 [ $ret -eq 2 ]
 [ ! -s $stderr ]
 
+#
+# A compressed DataStream can't be compiled
+#
+image=$dir/image
+if $OSCAP ds sds-compile "${sds}.bz2" $image 2> $stderr; then false; fi
+grep -q "is compressed" $stderr
+[ ! -f $image ]
+
 #
 # Generate report from ARF
 #
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <pthread.h>
+#include <stdio.h>
+#include "debug_priv.h"
+
+#define TEST_DEBUG_THREADS 4
+#define TEST_DEBUG_MESSAGES 500
+
+static pthread_mutex_t test_debug_mutex = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int test_debug_counter = 0;
+
+/* The counter is logged under the lock, the decoded trace has to list the
+ * messages of all threads in the order of the counter. */
+static void *test_thread(void *arg)
+{
+	for (int i = 0; i < TEST_DEBUG_MESSAGES; i++) {
+		pthread_mutex_lock(&test_debug_mutex);
+		dI("message %u\n", test_debug_counter++);
+		pthread_mutex_unlock(&test_debug_mutex);
+	}
+	return NULL;
+}
+
+int main (int argc, char *argv[])
+{
+	pthread_t threads[TEST_DEBUG_THREADS];
+
+	for (int i = 0; i < TEST_DEBUG_THREADS; i++) {
+		if (pthread_create(&threads[i], NULL, test_thread, NULL) != 0) {
+			fprintf(stderr, "Cannot create a thread.\n");
+			return 1;
+		}
+	}
+	for (int i = 0; i < TEST_DEBUG_THREADS; i++)
+		pthread_join(threads[i], NULL);
+
+	printf("%u\n", test_debug_counter);
+	return 0;
+}
@@ -0,0 +1,76 @@
+#!/usr/bin/env bash
+
+# Copyright 2015 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# OpenScap Test Suite
+
+. ${srcdir}/../test_common.sh
+
+OSCAP_DEBUG_DECODE=${builddir}/utils/oscap-debug-decode
+
+# Test cases.
+
+# The messages of several threads are decoded in the order they were logged.
+function test_debug_trace_order {
+    local DIR=$(mktemp -d -t test_debug_trace.XXXXXX)
+    local ret_val=0
+
+    OSCAP_DEBUG_FILE=$DIR/trace OSCAP_DEBUG_LEVEL=3 ./test_debug_trace > $DIR/count || ret_val=1
+    $OSCAP_DEBUG_DECODE $DIR/trace.* > $DIR/log || ret_val=1
+
+    grep -E '^\([0-9]+:[0-9a-f]+\) \[I:[^:]*test_debug_trace\.c:[0-9]+:test_thread\] message [0-9]+$' $DIR/log \
+        | sed 's/.* message //' > $DIR/order
+    if [ "$(wc -l < $DIR/order)" != "$(cat $DIR/count)" ]; then
+        echo "Not all messages were decoded." >&2
+        ret_val=1
+    fi
+    if ! seq 0 $(( $(cat $DIR/count) - 1 )) | cmp -s - $DIR/order; then
+        echo "The messages are not decoded in the order they were logged." >&2
+        ret_val=1
+    fi
+
+    rm -rf $DIR
+    return $ret_val
+}
+
+# The trace of oscap is named after its pid and decodes to the text log.
+function test_debug_trace_oscap {
+    local DIR=$(mktemp -d -t test_debug_trace.XXXXXX)
+    local ret_val=0
+    local pid
+
+    OSCAP_DEBUG_FILE=$DIR/trace OSCAP_DEBUG_LEVEL=3 $OSCAP oval eval ${srcdir}/test_debug_trace.xml > $DIR/out &
+    pid=$!
+    wait $pid || ret_val=1
+
+    if [ ! -f $DIR/trace.$pid ]; then
+        echo "Trace trace.$pid is missing." >&2
+        rm -rf $DIR
+        return 1
+    fi
+    $OSCAP_DEBUG_DECODE $DIR/trace.$pid > $DIR/log || ret_val=1
+
+    if ! grep -q '^=============== LOG: .* ===============$' $DIR/log; then
+        echo "The header of the log is missing." >&2
+        ret_val=1
+    fi
+    if ! grep -qE "^\\($pid:[0-9a-f]+\\) \\[[EWI]:[^:]*:[0-9]+:[^]]*\\] " $DIR/log; then
+        echo "No message of oscap is decoded." >&2
+        ret_val=1
+    fi
+    if grep -E '^\([0-9]+:[0-9a-f]+\) \[' $DIR/log | grep -vqE "^\\($pid:"; then
+        echo "The log contains messages of another process." >&2
+        ret_val=1
+    fi
+
+    rm -rf $DIR
+    return $ret_val
+}
+
+# Testing.
+
+test_init "test_debug_trace.log"
+test_run "test_debug_trace_order" test_debug_trace_order
+test_run "test_debug_trace_oscap" test_debug_trace_oscap
+test_exit
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common/intern.h"
+
+#define TEST_INTERN_MANY 5000
+#define TEST_INTERN_THREADS 4
+#define TEST_INTERN_ROUNDS 2000
+
+int test_equal_strings(void);
+int test_take(void);
+int test_many_strings(void);
+int test_threads(void);
+
+int test_equal_strings()
+{
+	char buf[] = "path";
+	char *a, *b, *c;
+
+	if (oscap_intern(NULL) != NULL) {
+		fprintf(stderr, "Interning NULL does not give NULL.\n");
+		return 1;
+	}
+
+	a = oscap_intern("path");
+	b = oscap_intern(buf);
+	c = oscap_intern("filename");
+	if (a == NULL || a != b || a == buf || strcmp(a, "path") != 0) {
+		fprintf(stderr, "Equal strings are not shared.\n");
+		return 1;
+	}
+	if (c == a || strcmp(c, "filename") != 0) {
+		fprintf(stderr, "Different strings are shared.\n");
+		return 1;
+	}
+
+	/* the string lives as long as any reference does */
+	oscap_intern_release(b);
+	if (strcmp(a, "path") != 0) {
+		fprintf(stderr, "Released string is gone while still referenced.\n");
+		return 1;
+	}
+	oscap_intern_release(a);
+	oscap_intern_release(c);
+	oscap_intern_release(NULL);
+	return 0;
+}
+
+int test_take()
+{
+	char *a = oscap_intern("user_id");
+	char *b = oscap_intern_take(strdup("user_id"));
+
+	if (a != b) {
+		fprintf(stderr, "Taken string is not shared.\n");
+		return 1;
+	}
+	if (oscap_intern_take(NULL) != NULL) {
+		fprintf(stderr, "Taking NULL does not give NULL.\n");
+		return 1;
+	}
+	oscap_intern_release(a);
+	oscap_intern_release(b);
+	return 0;
+}
+
+int test_many_strings()
+{
+	char buf[32];
+	char **strs = calloc(TEST_INTERN_MANY, sizeof(char *));
+	int retval = 0;
+
+	for (int i = 0; i < TEST_INTERN_MANY; i++) {
+		snprintf(buf, sizeof(buf), "oval:x:obj:%d", i);
+		strs[i] = oscap_intern(buf);
+	}
+	for (int i = 0; i < TEST_INTERN_MANY; i++) {
+		char *s;
+
+		snprintf(buf, sizeof(buf), "oval:x:obj:%d", i);
+		s = oscap_intern(buf);
+		if (s != strs[i] || strcmp(s, buf) != 0) {
+			fprintf(stderr, "String '%s' changed while the pool grew.\n", buf);
+			retval = 1;
+		}
+		oscap_intern_release(s);
+	}
+	for (int i = 0; i < TEST_INTERN_MANY; i++)
+		oscap_intern_release(strs[i]);
+	free(strs);
+	return retval;
+}
+
+static const char *test_intern_names[] = {
+	"path", "filename", "user_id", "group_id", "type", "size", "root", "true", "false"
+};
+#define TEST_INTERN_NAME_COUNT (sizeof(test_intern_names) / sizeof(test_intern_names[0]))
+
+static void *test_thread(void *arg)
+{
+	char **expected = arg;
+
+	for (int round = 0; round < TEST_INTERN_ROUNDS; round++) {
+		for (size_t i = 0; i < TEST_INTERN_NAME_COUNT; i++) {
+			char buf[32];
+			char *s;
+
+			/* strings only this thread uses come and go while others look up */
+			snprintf(buf, sizeof(buf), "%s-%p-%d", test_intern_names[i], (void *) &buf, round);
+			oscap_intern_release(oscap_intern(buf));
+
+			s = oscap_intern(test_intern_names[i]);
+			if (s != expected[i])
+				return (void *) 1;
+			oscap_intern_release(s);
+		}
+	}
+	return NULL;
+}
+
+int test_threads()
+{
+	pthread_t threads[TEST_INTERN_THREADS];
+	char *expected[TEST_INTERN_NAME_COUNT];
+	int retval = 0;
+
+	for (size_t i = 0; i < TEST_INTERN_NAME_COUNT; i++)
+		expected[i] = oscap_intern(test_intern_names[i]);
+
+	for (int i = 0; i < TEST_INTERN_THREADS; i++) {
+		if (pthread_create(&threads[i], NULL, test_thread, expected) != 0) {
+			fprintf(stderr, "Cannot create a thread.\n");
+			return 1;
+		}
+	}
+	for (int i = 0; i < TEST_INTERN_THREADS; i++) {
+		void *ret;
+
+		pthread_join(threads[i], &ret);
+		if (ret != NULL) {
+			fprintf(stderr, "Thread %d got a different copy of a string.\n", i);
+			retval = 1;
+		}
+	}
+
+	for (size_t i = 0; i < TEST_INTERN_NAME_COUNT; i++)
+		oscap_intern_release(expected[i]);
+	return retval;
+}
+
+int main (int argc, char *argv[])
+{
+	int retval = 0;
+	if ((retval = test_equal_strings()) != 0 ) {
+		return retval;
+	}
+
+	if ((retval = test_take()) != 0 ) {
+		return retval;
+	}
+
+	if ((retval = test_many_strings()) != 0 ) {
+		return retval;
+	}
+
+	if ((retval = test_threads()) != 0 ) {
+		return retval;
+	}
+
+	return retval;
+}
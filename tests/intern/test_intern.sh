@@ -0,0 +1,20 @@
+#!/usr/bin/env bash
+
+# Copyright 2015 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# OpenScap Test Suite
+
+. ${srcdir}/../test_common.sh
+
+# Test cases.
+
+function test_intern {
+    ./test_intern
+}
+
+# Testing.
+
+test_init "test_intern.log"
+test_run "test_intern" test_intern
+test_exit
@@ -4,5 +4,6 @@
 
 test_init "test_probes_systemdunitdependency.log"
 test_run "systemdunitdependency general functionality" $srcdir/test_probes_systemdunitdependency.sh
+test_run "systemd probes on a stub bus" $srcdir/test_probes_systemd_stub_bus.sh
 test_run "OVAL 5.11 validation" $srcdir/test_validation.sh
 test_exit
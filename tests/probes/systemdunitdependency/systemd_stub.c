@@ -0,0 +1,211 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ * Minimal org.freedesktop.systemd1 service for testing the systemd probes
+ * on a private system bus (DBUS_SYSTEM_BUS_ADDRESS). It answers ListUnits,
+ * LoadUnit and the Get/GetAll calls of org.freedesktop.DBus.Properties for
+ * a fixed set of units and prints the number of calls of each method to
+ * stderr after every call.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <dbus/dbus.h>
+
+struct stub_unit {
+	const char *name;
+	const char *path;
+	const char *requires[3];
+	const char *wants[3];
+	int listed;
+};
+
+/* not sorted by name on purpose, ListUnits returns them in this order */
+static const struct stub_unit stub_units[] = {
+	{ "multi-user.target", "/stub/multi_user", { "a.target", NULL }, { NULL }, 1 },
+	{ "c.service", "/stub/c", { "b.service", NULL }, { NULL }, 1 },
+	{ "a.target", "/stub/a", { "b.service", NULL }, { "c.service", "x.target", NULL }, 1 },
+	{ "b.service", "/stub/b", { NULL }, { NULL }, 1 },
+	/* loaded but not listed, found through LoadUnit only */
+	{ "x.target", "/stub/x", { "d.service", NULL }, { NULL }, 0 },
+};
+
+#define STUB_UNIT_COUNT (sizeof(stub_units) / sizeof(stub_units[0]))
+
+enum { CALL_LISTUNITS, CALL_LOADUNIT, CALL_GETALL, CALL_GET, CALL_COUNT };
+static unsigned int stub_calls[CALL_COUNT];
+
+static const struct stub_unit *stub_unit_find(const char *path, const char *name)
+{
+	for (size_t i = 0; i < STUB_UNIT_COUNT; ++i) {
+		if (path != NULL && strcmp(stub_units[i].path, path) == 0)
+			return &stub_units[i];
+		if (name != NULL && strcmp(stub_units[i].name, name) == 0)
+			return &stub_units[i];
+	}
+	return NULL;
+}
+
+static void append_strv(DBusMessageIter *iter, const char * const *strv)
+{
+	DBusMessageIter var, arr;
+
+	dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT, "as", &var);
+	dbus_message_iter_open_container(&var, DBUS_TYPE_ARRAY, "s", &arr);
+	for (; *strv != NULL; ++strv)
+		dbus_message_iter_append_basic(&arr, DBUS_TYPE_STRING, strv);
+	dbus_message_iter_close_container(&var, &arr);
+	dbus_message_iter_close_container(iter, &var);
+}
+
+static void append_property(DBusMessageIter *dict, const char *name, const char *str, const char * const *strv)
+{
+	DBusMessageIter entry, var;
+
+	dbus_message_iter_open_container(dict, DBUS_TYPE_DICT_ENTRY, NULL, &entry);
+	dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &name);
+	if (strv != NULL) {
+		append_strv(&entry, strv);
+	} else {
+		dbus_message_iter_open_container(&entry, DBUS_TYPE_VARIANT, "s", &var);
+		dbus_message_iter_append_basic(&var, DBUS_TYPE_STRING, &str);
+		dbus_message_iter_close_container(&entry, &var);
+	}
+	dbus_message_iter_close_container(dict, &entry);
+}
+
+static void reply_list_units(DBusMessageIter *iter)
+{
+	DBusMessageIter arr, unit;
+	const char *empty = "", *root = "/";
+	dbus_uint32_t zero = 0;
+
+	dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY, "(ssssssouso)", &arr);
+	for (size_t i = 0; i < STUB_UNIT_COUNT; ++i) {
+		if (!stub_units[i].listed)
+			continue;
+		dbus_message_iter_open_container(&arr, DBUS_TYPE_STRUCT, NULL, &unit);
+		dbus_message_iter_append_basic(&unit, DBUS_TYPE_STRING, &stub_units[i].name);
+		for (int j = 0; j < 5; ++j)
+			dbus_message_iter_append_basic(&unit, DBUS_TYPE_STRING, &empty);
+		dbus_message_iter_append_basic(&unit, DBUS_TYPE_OBJECT_PATH, &stub_units[i].path);
+		dbus_message_iter_append_basic(&unit, DBUS_TYPE_UINT32, &zero);
+		dbus_message_iter_append_basic(&unit, DBUS_TYPE_STRING, &empty);
+		dbus_message_iter_append_basic(&unit, DBUS_TYPE_OBJECT_PATH, &root);
+		dbus_message_iter_close_container(&arr, &unit);
+	}
+	dbus_message_iter_close_container(iter, &arr);
+}
+
+static void reply_get_all(DBusMessageIter *iter, const struct stub_unit *unit)
+{
+	DBusMessageIter dict;
+
+	dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY, "{sv}", &dict);
+	if (unit != NULL) {
+		append_property(&dict, "Id", unit->name, NULL);
+		append_property(&dict, "Description", "stub unit", NULL);
+		append_property(&dict, "Requires", NULL, unit->requires);
+		append_property(&dict, "Wants", NULL, unit->wants);
+	}
+	dbus_message_iter_close_container(iter, &dict);
+}
+
+int main(void)
+{
+	static const char * const none[] = { NULL };
+	DBusConnection *conn;
+	DBusError err;
+
+	dbus_error_init(&err);
+	conn = dbus_bus_get(DBUS_BUS_SYSTEM, &err);
+	if (conn == NULL) {
+		fprintf(stderr, "Cannot connect to the bus: %s\n", err.message);
+		return 1;
+	}
+	if (dbus_bus_request_name(conn, "org.freedesktop.systemd1", 0, &err) != DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER) {
+		fprintf(stderr, "Cannot own org.freedesktop.systemd1.\n");
+		return 1;
+	}
+	printf("ready\n");
+	fflush(stdout);
+
+	while (dbus_connection_read_write(conn, -1)) {
+		DBusMessage *msg, *reply;
+		DBusMessageIter iter;
+		const char *member, *arg0, *arg1;
+
+		while ((msg = dbus_connection_pop_message(conn)) != NULL) {
+			if (dbus_message_get_type(msg) != DBUS_MESSAGE_TYPE_METHOD_CALL) {
+				dbus_message_unref(msg);
+				continue;
+			}
+
+			member = dbus_message_get_member(msg);
+			reply = dbus_message_new_method_return(msg);
+			dbus_message_iter_init_append(reply, &iter);
+
+			if (strcmp(member, "ListUnits") == 0) {
+				++stub_calls[CALL_LISTUNITS];
+				reply_list_units(&iter);
+			} else if (strcmp(member, "LoadUnit") == 0) {
+				const struct stub_unit *unit;
+				const char *path;
+
+				++stub_calls[CALL_LOADUNIT];
+				dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &arg0, DBUS_TYPE_INVALID);
+				unit = stub_unit_find(NULL, arg0);
+				path = unit != NULL ? unit->path : "/stub/none";
+				dbus_message_iter_append_basic(&iter, DBUS_TYPE_OBJECT_PATH, &path);
+			} else if (strcmp(member, "GetAll") == 0) {
+				++stub_calls[CALL_GETALL];
+				reply_get_all(&iter, stub_unit_find(dbus_message_get_path(msg), NULL));
+			} else if (strcmp(member, "Get") == 0) {
+				const struct stub_unit *unit;
+
+				++stub_calls[CALL_GET];
+				dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &arg0,
+						      DBUS_TYPE_STRING, &arg1, DBUS_TYPE_INVALID);
+				unit = stub_unit_find(dbus_message_get_path(msg), NULL);
+				if (unit == NULL)
+					append_strv(&iter, none);
+				else if (strcmp(arg1, "Requires") == 0)
+					append_strv(&iter, unit->requires);
+				else
+					append_strv(&iter, unit->wants);
+			}
+
+			dbus_connection_send(conn, reply, NULL);
+			dbus_message_unref(reply);
+			dbus_message_unref(msg);
+
+			fprintf(stderr, "ListUnits=%u LoadUnit=%u GetAll=%u Get=%u\n",
+				stub_calls[CALL_LISTUNITS], stub_calls[CALL_LOADUNIT],
+				stub_calls[CALL_GETALL], stub_calls[CALL_GET]);
+		}
+	}
+
+	return 0;
+}
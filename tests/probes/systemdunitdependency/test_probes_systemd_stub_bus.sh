@@ -0,0 +1,77 @@
+#!/usr/bin/env bash
+
+# Copyright 2015 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# OpenScap Probes Test Suite.
+#
+# Runs both systemd probes against systemd_stub on a private system bus,
+# so the test doesn't depend on the units of the running system.
+
+. ../../test_common.sh
+
+function test_probes_systemd_stub_bus {
+    probecheck "systemdunitproperty" || return 255
+    probecheck "systemdunitdependency" || return 255
+    require "dbus-daemon" || return 255
+
+    local DF="${srcdir}/test_probes_systemd_stub_bus.xml"
+    local RF="stub_bus_results.xml"
+    local WD=$(mktemp -d -t test_probes_systemd_stub_bus.XXXXXX)
+    local ret_val=0
+
+    [ -f $RF ] && rm -f $RF
+
+    cat > $WD/bus.conf <<EOF
+<!DOCTYPE busconfig PUBLIC "-//freedesktop//DTD D-Bus Bus Configuration 1.0//EN"
+ "http://www.freedesktop.org/standards/dbus/1.0/busconfig.dtd">
+<busconfig>
+  <type>custom</type>
+  <listen>unix:path=$WD/bus</listen>
+  <auth>EXTERNAL</auth>
+  <policy context="default">
+    <allow user="*"/>
+    <allow own="*"/>
+    <allow send_destination="*" eavesdrop="true"/>
+    <allow eavesdrop="true"/>
+  </policy>
+</busconfig>
+EOF
+    dbus-daemon --config-file=$WD/bus.conf --fork --print-pid > $WD/bus.pid || return 1
+    export DBUS_SYSTEM_BUS_ADDRESS=unix:path=$WD/bus
+
+    ./systemd_stub > $WD/stub.out 2> $WD/stub.err &
+    local STUB=$!
+    for i in $(seq 50); do
+        grep -q "^ready" $WD/stub.out && break
+        sleep 0.1
+    done
+
+    $OSCAP oval eval --results $RF $DF || ret_val=1
+
+    kill $STUB
+    kill $(cat $WD/bus.pid)
+
+    if [ $ret_val -eq 0 -a -f $RF ]; then
+        verify_results "def" $DF $RF 1 && verify_results "tst" $DF $RF 3 || ret_val=1
+
+        # items are collected in the order of ListUnits, not sorted by name
+        local UNITS=$(awk -F '[<>"]' '/systemdunitproperty_item id=/ { id = $3 }
+                                       /<lin-sys:unit>/ { unit = $3 }
+                                       /<lin-sys:property>Requires</ { print id, unit }' $RF \
+                      | sort -n | cut -d " " -f 2 | tr '\n' ' ')
+        echo "Units with Requires: $UNITS"
+        [ "$UNITS" == "multi-user.target c.service a.target " ] || ret_val=1
+
+        # every probe lists the units once for all of its objects
+        tail -n 1 $WD/stub.err
+        tail -n 1 $WD/stub.err | grep -q "^ListUnits=2 " || ret_val=1
+    else
+        ret_val=1
+    fi
+
+    rm -rf $WD
+    return $ret_val
+}
+
+test_probes_systemd_stub_bus
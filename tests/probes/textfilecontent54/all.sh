@@ -6,4 +6,7 @@ test_init "test_probes_textfilecontent54.log"
 test_run "textfilecontent54 general functionality" $srcdir/test_probes_textfilecontent54.sh
 test_run "validate OVAL definitions of various schema versions" $srcdir/test_validation_of_various_oval_versions.sh
 test_run "test behavior on symlinks" $srcdir/test_symlinks.sh
+test_run "scanning of OCI image layers" $srcdir/test_oci_layers.sh
+test_run "collection cache" $srcdir/test_collection_cache.sh
+test_run "collection statistics" $srcdir/test_collect_stats.sh
 test_exit
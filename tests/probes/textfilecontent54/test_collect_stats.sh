@@ -0,0 +1,33 @@
+#!/bin/bash
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+tmpdir=$(mktemp -t -d "${name}.XXXXXX")
+tpl=${srcdir}/test_collection_cache.xml.tpl
+input=${tmpdir}/${name}.xml
+stats=${tmpdir}/${name}.csv
+echo "Temp dir: $tmpdir"
+
+sed "s@%PATH%@${tmpdir}@" $tpl > $input
+mkdir $tmpdir/etc
+echo "value=1" > $tmpdir/etc/a.conf
+echo "value=2" > $tmpdir/etc/b.conf
+
+$OSCAP oval eval --collect-stats $stats $input || [ $? == 2 ]
+
+cat $stats
+[ "$(head -n 1 $stats)" == "object_id,type,wall_us,cpu_us,items,bytes_sent,bytes_received,icache_hits,icache_hit_ratio,rcache_hit,ccache_hit" ]
+[ "$(grep -vc '^#' $stats)" == "3" ]
+# result cache statistics of the probe follow the records
+grep -q "^# rcache textfilecontent54: hits=[0-9]* misses=[0-9]* evictions=0 entries=2 " $stats
+for obj in oval:x:obj:1:1 oval:x:obj:2:2; do
+	line=$(grep "^${obj%:*},textfilecontent54," $stats)
+	[ "$(echo $line | awk -F, '{print NF}')" == "11" ]
+	[ "$(echo $line | cut -d, -f5)" == "${obj##*:}" ]
+	# something was exchanged with the probe
+	[ "$(echo $line | cut -d, -f6)" -gt 0 ]
+	[ "$(echo $line | cut -d, -f7)" -gt 0 ]
+done
+
+rm -rf $tmpdir
@@ -0,0 +1,48 @@
+#!/bin/bash
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+tmpdir=$(mktemp -t -d "${name}.XXXXXX")
+tpl=${srcdir}/${name}.xml.tpl
+input=${tmpdir}/${name}.xml
+result=${tmpdir}/${name}.results.xml
+echo "Temp dir: $tmpdir"
+
+# prepare the environment
+sed "s@%PATH%@${tmpdir}@" $tpl > $input
+mkdir $tmpdir/etc
+echo "value=1" > $tmpdir/etc/a.conf
+
+export OSCAP_COLLECTION_CACHE=$tmpdir/cache
+
+function eval_and_count() {
+	$OSCAP oval eval --results $result $input || [ $? == 2 ]
+	$OSCAP oval validate-xml --results $result
+	[ "$($XPATH $result 'count(//*[local-name()="textfilecontent_item"])')" == "$1" ]
+	[ "$($XPATH $result 'string(//*[local-name()="textfilecontent_item"][*[local-name()="filename"]="a.conf"]/*[local-name()="subexpression"])')" == "$2" ]
+}
+
+echo "Evaluating content, empty cache."
+eval_and_count 1 1
+[ -s $tmpdir/cache ]
+inode=$(stat -c %i $tmpdir/cache)
+
+echo "Evaluating content, cached results."
+eval_and_count 1 1
+# nothing was collected, the cache wasn't rewritten
+[ "$(stat -c %i $tmpdir/cache)" == "$inode" ]
+
+echo "Evaluating content, modified file."
+echo "value=2" > $tmpdir/etc/a.conf
+eval_and_count 1 2
+
+echo "Evaluating content, new file in the directory."
+echo "value=3" > $tmpdir/etc/b.conf
+eval_and_count 2 2
+
+echo "Evaluating content, corrupted cache."
+echo "garbage" > $tmpdir/cache
+eval_and_count 2 2
+
+rm -rf $tmpdir
@@ -0,0 +1,48 @@
+#!/bin/bash
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+tmpdir=$(mktemp -t -d "${name}.XXXXXX")
+input=${srcdir}/${name}.xml
+result=${tmpdir}/${name}.results.xml
+echo "Temp dir: $tmpdir"
+
+# prepare two image layers, the upper one overrides and whiteouts files
+mkdir -p $tmpdir/l1/etc/conf.d $tmpdir/l1/usr/lib
+echo "NAME=base" > $tmpdir/l1/etc/os-release
+echo "removed=1" > $tmpdir/l1/etc/removed.conf
+echo "a=1" > $tmpdir/l1/etc/conf.d/a.conf
+echo "b=1" > $tmpdir/l1/etc/conf.d/b.conf
+echo "deep=1" > $tmpdir/l1/usr/lib/deep.conf
+ln -s usr/lib $tmpdir/l1/lib
+tar -C $tmpdir/l1 -cf $tmpdir/layer1.tar .
+
+mkdir -p $tmpdir/l2/etc/conf.d
+echo "NAME=top" > $tmpdir/l2/etc/os-release
+touch $tmpdir/l2/etc/.wh.removed.conf
+touch $tmpdir/l2/etc/conf.d/.wh..wh..opq
+echo "c=1" > $tmpdir/l2/etc/conf.d/c.conf
+tar -C $tmpdir/l2 -cf $tmpdir/layer2.tar .
+
+export OSCAP_PROBE_OCI_LAYERS="$tmpdir/layer1.tar:$tmpdir/layer2.tar"
+export OSCAP_PROBE_OS_NAME="Linux"
+export OSCAP_PROBE_OS_VERSION="1"
+export OSCAP_PROBE_ARCHITECTURE="x86_64"
+export OSCAP_PROBE_PRIMARY_HOST_NAME="image"
+
+echo "Evaluating content."
+$OSCAP oval eval --results $result $input || [ $? == 2 ]
+echo "Validating results."
+$OSCAP oval validate-xml --results $result
+echo "Testing results."
+for t in 1 3 4; do
+	[ "$($XPATH $result 'string(//*[local-name()="test"][@test_id="oval:x:tst:'$t'"]/@result)')" == "true" ]
+done
+[ "$($XPATH $result 'string(//*[local-name()="test"][@test_id="oval:x:tst:2"]/@result)')" == "false" ]
+echo "Testing syschar values."
+[ "$($XPATH $result 'string(//*[local-name()="object"][@id="oval:x:obj:2"]/@flag)')" == "does not exist" ]
+[ "$($XPATH $result 'count(//*[local-name()="object"][@id="oval:x:obj:3"]/*[local-name()="reference"])')" == "1" ]
+[ "$($XPATH $result 'string(//*[*[local-name()="filename"]="c.conf"]/*[local-name()="text"])')" == "c=1" ]
+
+rm -rf $tmpdir
@@ -0,0 +1,11 @@
+#!/usr/bin/env bash
+
+# Prints the number it has been given and passes for even numbers only.
+echo "script $XCCDF_VALUE_number"
+sleep 0.$(( XCCDF_VALUE_number % 3 ))
+
+if [[ $(( XCCDF_VALUE_number % 2 )) == 0 ]] ; then
+    exit $XCCDF_RESULT_PASS
+else
+    exit $XCCDF_RESULT_FAIL
+fi
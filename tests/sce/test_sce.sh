@@ -42,10 +42,36 @@ function test_sce {
     fi
 }
 
+# The scripts run concurrently must give the same results, in the same
+# order, as the scripts run one by one.
+function test_sce_parallel {
+
+    local seq_stdout=`mktemp`
+    local seq_results=`mktemp`
+    local par_stdout=`mktemp`
+    local par_results=`mktemp`
+
+    OSCAP_SCE_JOBS=1 $OSCAP xccdf eval --results "$seq_results" "${srcdir}/sce_parallel.xml" > "$seq_stdout"
+    [ $? -eq 2 ] || return 1
+    OSCAP_SCE_JOBS=4 $OSCAP xccdf eval --results "$par_results" "${srcdir}/sce_parallel.xml" > "$par_stdout"
+    [ $? -eq 2 ] || return 1
+
+    diff "$seq_stdout" "$par_stdout" || return 1
+    diff <(grep -o '<rule-result idref="[^"]*"\|<result>[^<]*</result>\|script [0-9]' "$seq_results") \
+        <(grep -o '<rule-result idref="[^"]*"\|<result>[^<]*</result>\|script [0-9]' "$par_results") || return 1
+
+    grep -q "script 8" "$par_results" || return 1
+    # the script of the unselected rule must not run at all
+    grep -q "script 7" "$par_results" && return 1
+
+    rm "$seq_stdout" "$seq_results" "$par_stdout" "$par_results"
+}
+
 # Testing.
 test_init "test_sce.log"
 
 test_run "sce" test_sce sce_xccdf.xml 
+test_run "sce parallel" test_sce_parallel
 
 test_exit
 
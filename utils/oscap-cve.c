@@ -64,8 +64,13 @@ static struct oscap_module CVE_FIND_MODULE = {
     .name = "find",
     .parent = &OSCAP_CVE_MODULE,
     .summary = "Find particular CVE in CVE NVD feed",
-    .usage = "CVE nvd-feed.xml",
-    .help = "Find particular CVE in CVE NVD feed.",
+    .usage = "[options] CVE|CPE nvd-feed.xml",
+    .help = "Find particular CVE in CVE NVD feed, or all CVEs listing the CPE\n"
+            "as vulnerable software.\n"
+            "\n"
+            "Options:\n"
+            "   --index <file>\r\t\t\t\t - Look the CVE up in the index of the feed. The index\n"
+            "\t\t\t\t   is (re)built if it doesn't exist or it is out of date.\n",
     .opt_parser = getopt_cve,
     .func = app_cve_find
 };
@@ -102,39 +107,15 @@ cleanup:
         return result;
 }
 
-static int app_cve_find(const struct oscap_action *action)
+static void cve_entry_print(const struct cve_entry *entry)
 {
-        struct cve_model *model = NULL;
-        struct cve_entry *entry = NULL;
-	struct cve_entry_iterator *entry_it;
 	const struct cvss_impact *cvss;
-        struct cvss_metrics *metrics;
-        float base_score;
+	struct cvss_metrics *metrics;
+	float base_score;
 	char * vector;
-	int result;
 	struct cve_product_iterator *prod_it;
 	struct cve_product *product;
 
-	model = cve_model_import(action->cve_action->file);
-	if(!model) {
-		result=OSCAP_ERROR;
-		goto cleanup;
-	}
-
-	entry_it = cve_model_get_entries(model);
-	while (cve_entry_iterator_has_more(entry_it)) {
-		entry = cve_entry_iterator_next(entry_it);
-		if (!strcmp(cve_entry_get_id(entry), action->cve_action->cve))
-			break;
-		entry = NULL;
-	}
-	cve_entry_iterator_free(entry_it);
-
-	if (!entry) {
-		result=OSCAP_FAIL;
-		goto cleanup;
-	}
-
 	printf("ID: %s\n", cve_entry_get_id(entry));
 
 	/* cvss content */
@@ -156,19 +137,98 @@ static int app_cve_find(const struct oscap_action *action)
 		printf("\t%s\n", cve_product_get_value(product));
 	}
 	cve_product_iterator_free(prod_it);
+}
+
+struct cve_find_ctx {
+	const char *name;
+	bool by_product;
+	int found;
+};
+
+static int cve_find_consumer(struct cve_entry *entry, void *arg)
+{
+	struct cve_find_ctx *ctx = (struct cve_find_ctx *) arg;
+	bool match = false;
 
-	result=OSCAP_OK;
+	if (ctx->by_product) {
+		struct cve_product_iterator *prod_it = cve_entry_get_products(entry);
+		while (!match && cve_product_iterator_has_more(prod_it))
+			match = !strcmp(cve_product_get_value(cve_product_iterator_next(prod_it)), ctx->name);
+		cve_product_iterator_free(prod_it);
+	}
+	else
+		match = !strcmp(cve_entry_get_id(entry), ctx->name);
+
+	if (match) {
+		if (ctx->found++ > 0)
+			printf("\n");
+		cve_entry_print(entry);
+	}
+	cve_entry_free(entry);
+
+	/* CVE ids are unique, stop at the first one */
+	return match && !ctx->by_product;
+}
+
+static struct cve_index *cve_find_open_index(const char *feed, const char *index_file)
+{
+	struct cve_index *index = cve_index_open(feed, index_file);
+
+	if (index == NULL) {
+		/* missing or out of date, build it */
+		oscap_clearerr();
+		if (cve_index_build(feed, index_file) == 0)
+			index = cve_index_open(feed, index_file);
+	}
+	return index;
+}
+
+static int app_cve_find(const struct oscap_action *action)
+{
+	struct cve_find_ctx ctx = {
+		.name = action->cve_action->cve,
+		.by_product = !strncmp(action->cve_action->cve, "cpe:", 4),
+		.found = 0
+	};
+	int result;
+	int ret;
+
+	if (action->cve_action->index) {
+		struct cve_index *index = cve_find_open_index(action->cve_action->file, action->cve_action->index);
+		if (index == NULL) {
+			result=OSCAP_ERROR;
+			goto cleanup;
+		}
+		if (ctx.by_product)
+			ret = cve_index_find_product(index, ctx.name, cve_find_consumer, &ctx);
+		else {
+			struct cve_entry *entry = cve_index_find_entry(index, ctx.name);
+			ret = entry ? cve_find_consumer(entry, &ctx) : 0;
+		}
+		cve_index_free(index);
+	}
+	else
+		ret = cve_model_import_entries(action->cve_action->file, cve_find_consumer, &ctx);
+
+	if (ret == -1)
+		result=OSCAP_ERROR;
+	else if (ctx.found == 0)
+		result=OSCAP_FAIL;
+	else
+		result=OSCAP_OK;
 
 cleanup:
         if (oscap_err())
                 fprintf(stderr, "%s %s\n", OSCAP_ERR_MSG, oscap_err_desc());
 
-        if (model)
-		cve_model_free(model);
         free(action->cve_action);
         return result;
 }
 
+enum cve_opt {
+	CVE_OPT_INDEX = 1
+};
+
 bool getopt_cve(int argc, char **argv, struct oscap_action *action)
 {
         if( (action->module == &CVE_VALIDATE_MODULE)) {
@@ -179,18 +239,32 @@ bool getopt_cve(int argc, char **argv, struct oscap_action *action)
                 action->doctype = OSCAP_DOCUMENT_CVE_FEED;
                 action->cve_action = malloc(sizeof(struct cve_action));
                 action->cve_action->file=argv[3];
+                action->cve_action->index=NULL;
         }
 	else if (action->module == &CVE_FIND_MODULE) {
-	        if( argc != 5 ) {
+		const struct option long_options[] = {
+			{"index",	required_argument, NULL, CVE_OPT_INDEX},
+			{0, 0, 0, 0}
+		};
+		char *index = NULL;
+		int c;
+
+		while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+			switch (c) {
+			case CVE_OPT_INDEX: index = optarg; break;
+			default: return oscap_module_usage(action->module, stderr, NULL);
+			}
+		}
+	        if( optind + 2 != argc ) {
                         oscap_module_usage(action->module, stderr, "Wrong number of parameters.\n");
                         return false;
                 }
 		action->doctype = OSCAP_DOCUMENT_CVE_FEED;
 		action->cve_action = malloc(sizeof(struct cve_action));
-		action->cve_action->cve=argv[3];
-		action->cve_action->file=argv[4];
+		action->cve_action->cve=argv[optind];
+		action->cve_action->file=argv[optind + 1];
+		action->cve_action->index=index;
 	}
 
 	return true;
 }
-
@@ -53,9 +53,11 @@ static struct oscap_module CVSS_SCORE_MODULE = {
     .name = "score",
     .parent = &OSCAP_CVSS_MODULE,
     .summary = "CVSS score from a CVSS vector",
-    .usage = "vector",
+    .usage = "vector|-",
     .help = "Calculates CVSS score\n"
-            "(base / temporal / environmental, depends on supplied metrics).",
+            "(base / temporal / environmental, depends on supplied metrics).\n"
+            "If the vector is '-', vectors are read from the standard input, one per line,\n"
+            "and each is printed followed by its base, temporal and environmental score.",
     .opt_parser = getopt_cvss,
     .func = app_cvss_score
 };
@@ -85,10 +87,70 @@ static inline bool print_score(const char *type, float score)
     else return false;
 }
 
+static void print_stream_score(float score)
+{
+    if (score >= 0.0 && score <= 10.0)
+        printf(" %.1f", score);
+    else
+        printf(" -");
+}
+
+#define CVSS_STREAM_CHUNK 1024
+
+static int app_cvss_score_stream(void)
+{
+    static char *lines[CVSS_STREAM_CHUNK];
+    static size_t line_sizes[CVSS_STREAM_CHUNK];
+    static cvss_packed_vector packed[CVSS_STREAM_CHUNK];
+    static struct cvss_scores scores[CVSS_STREAM_CHUNK];
+    int ret = OSCAP_OK;
+    bool eof = false;
+
+    while (!eof) {
+        size_t count = 0;
+
+        // the line buffers are reused by getline for the following chunks
+        while (count < CVSS_STREAM_CHUNK) {
+            ssize_t len = getline(&lines[count], &line_sizes[count], stdin);
+            if (len < 0) {
+                eof = true;
+                break;
+            }
+            while (len > 0 && strchr(" \t\r\n", lines[count][len - 1]))
+                lines[count][--len] = '\0';
+            if (len > 0)
+                ++count;
+        }
+
+        cvss_vectors_pack((const char *const *) lines, count, packed);
+        cvss_packed_scores(packed, count, scores);
+
+        for (size_t i = 0; i < count; ++i) {
+            if (packed[i] == CVSS_PACKED_INVALID || isnan(scores[i].base)) {
+                fprintf(stderr, "Invalid input CVSS vector: %s\n", lines[i]);
+                ret = OSCAP_ERROR;
+                continue;
+            }
+            printf("%s", lines[i]);
+            print_stream_score(scores[i].base);
+            print_stream_score(scores[i].temporal);
+            print_stream_score(scores[i].environmental);
+            printf("\n");
+        }
+    }
+
+    for (size_t i = 0; i < CVSS_STREAM_CHUNK; ++i)
+        free(lines[i]);
+    return ret;
+}
+
 int app_cvss_score(const struct oscap_action *action)
 {
     assert(action->cvss_vector);
 
+    if (strcmp(action->cvss_vector, "-") == 0)
+        return app_cvss_score_stream();
+
     bool ok = false;
     struct cvss_impact *impact = cvss_impact_new_from_vector(action->cvss_vector);
 
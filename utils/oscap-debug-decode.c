@@ -0,0 +1,216 @@
+/*
+ * Copyright 2015 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ * Turns the binary debug traces written by the library built with
+ * --enable-debug to the text log. The records of each trace are printed
+ * in the order they were logged in.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* only the trace format, the tool doesn't link the library */
+#include "debug_trace.h"
+
+struct trace_record {
+	struct oscap_debug_trace_record rec;
+	const char *file;
+	const char *fn;
+	const char *msg;
+};
+
+static char *read_file(const char *path, size_t *size)
+{
+	FILE *fp;
+	char *data = NULL;
+	size_t len = 0, allocated = 0;
+
+	fp = fopen(path, "rb");
+	if (fp == NULL) {
+		perror(path);
+		return NULL;
+	}
+
+	for (;;) {
+		if (len == allocated) {
+			allocated = allocated ? allocated * 2 : 65536;
+			data = realloc(data, allocated);
+			if (data == NULL) {
+				perror(path);
+				fclose(fp);
+				return NULL;
+			}
+		}
+		size_t n = fread(data + len, 1, allocated - len, fp);
+		if (n == 0)
+			break;
+		len += n;
+	}
+	if (ferror(fp)) {
+		perror(path);
+		free(data);
+		data = NULL;
+	}
+	fclose(fp);
+
+	*size = len;
+	return data;
+}
+
+static int record_cmp(const void *a, const void *b)
+{
+	const struct trace_record *r1 = a, *r2 = b;
+
+	if (r1->rec.seq < r2->rec.seq)
+		return -1;
+	return r1->rec.seq > r2->rec.seq;
+}
+
+static char level_char(int level)
+{
+	switch (level) {
+	case OSCAP_DEBUG_TRACE_ERROR:
+		return 'E';
+	case OSCAP_DEBUG_TRACE_WARNING:
+		return 'W';
+	case OSCAP_DEBUG_TRACE_INFO:
+		return 'I';
+	default:
+		return '0';
+	}
+}
+
+static void print_record(long pid, const struct trace_record *r)
+{
+	switch (r->rec.type) {
+	case OSCAP_DEBUG_TRACE_MSG:
+		printf("(%ld:%llx) [%c:%.*s:%u:%.*s] %.*s", pid, (unsigned long long) r->rec.thread,
+		       level_char(r->rec.level), (int) r->rec.file_len, r->file, r->rec.line,
+		       (int) r->rec.fn_len, r->fn, (int) r->rec.msg_len, r->msg);
+		break;
+	case OSCAP_DEBUG_TRACE_OBJ:
+		printf("(%ld) [%.*s:%u:%.*s]\n------\n %.*s\n-----------\n", pid,
+		       (int) r->rec.file_len, r->file, r->rec.line,
+		       (int) r->rec.fn_len, r->fn, (int) r->rec.msg_len, r->msg);
+		break;
+	case OSCAP_DEBUG_TRACE_LOST:
+		printf("(%ld:%llx) [W] %u messages were dropped, the buffer of the thread was full\n",
+		       pid, (unsigned long long) r->rec.thread, r->rec.line);
+		break;
+	}
+}
+
+static int decode(const char *path)
+{
+	struct oscap_debug_trace_header header;
+	struct trace_record *records = NULL;
+	size_t count = 0, allocated = 0;
+	size_t size, pos;
+	char *data;
+	time_t started;
+	int ret = 0;
+
+	data = read_file(path, &size);
+	if (data == NULL)
+		return 1;
+
+	if (size < sizeof header) {
+		fprintf(stderr, "%s: Not a debug trace.\n", path);
+		free(data);
+		return 1;
+	}
+	memcpy(&header, data, sizeof header);
+	if (memcmp(header.magic, OSCAP_DEBUG_TRACE_MAGIC, sizeof header.magic) != 0) {
+		fprintf(stderr, "%s: Not a debug trace.\n", path);
+		free(data);
+		return 1;
+	}
+
+	for (pos = sizeof header; pos < size; ) {
+		struct trace_record r;
+
+		if (size - pos < sizeof r.rec) {
+			fprintf(stderr, "%s: Truncated record at offset %zu.\n", path, pos);
+			ret = 1;
+			break;
+		}
+		memcpy(&r.rec, data + pos, sizeof r.rec);
+		pos += sizeof r.rec;
+
+		if (size - pos < (size_t) r.rec.file_len + r.rec.fn_len + r.rec.msg_len) {
+			fprintf(stderr, "%s: Truncated record at offset %zu.\n", path, pos - sizeof r.rec);
+			ret = 1;
+			break;
+		}
+		r.file = data + pos;
+		pos += r.rec.file_len;
+		r.fn = data + pos;
+		pos += r.rec.fn_len;
+		r.msg = data + pos;
+		pos += r.rec.msg_len;
+
+		if (count == allocated) {
+			allocated = allocated ? allocated * 2 : 1024;
+			records = realloc(records, allocated * sizeof(struct trace_record));
+			if (records == NULL) {
+				perror(path);
+				free(data);
+				return 1;
+			}
+		}
+		records[count++] = r;
+	}
+
+	/* Each thread wrote its own records, put them back to order. */
+	qsort(records, count, sizeof(struct trace_record), record_cmp);
+
+	started = header.time;
+	printf("\n=============== LOG: %.24s ===============\n", ctime(&started));
+	for (size_t i = 0; i < count; ++i)
+		print_record((long) header.pid, &records[i]);
+
+	free(records);
+	free(data);
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	int ret = 0;
+
+	if (argc < 2 || !strcmp(argv[1], "-h") || !strcmp(argv[1], "--help")) {
+		fprintf(argc < 2 ? stderr : stdout,
+			"Usage: %s TRACE...\n\n"
+			"Prints the debug traces (" OSCAP_DEBUG_FILE ".<pid> files) as text.\n", argv[0]);
+		return argc < 2 ? 1 : 0;
+	}
+
+	for (int i = 1; i < argc; ++i)
+		ret |= decode(argv[i]);
+
+	return ret;
+}
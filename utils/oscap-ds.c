@@ -42,6 +42,7 @@
 static struct oscap_module* DS_SUBMODULES[];
 bool getopt_ds(int argc, char **argv, struct oscap_action *action);
 int app_ds_sds_split(const struct oscap_action *action);
+int app_ds_sds_compile(const struct oscap_action *action);
 int app_ds_sds_compose(const struct oscap_action *action);
 int app_ds_sds_add(const struct oscap_action *action);
 int app_ds_sds_validate(const struct oscap_action *action);
@@ -73,6 +74,23 @@ static struct oscap_module DS_SDS_SPLIT_MODULE = {
 	.func = app_ds_sds_split
 };
 
+static struct oscap_module DS_SDS_COMPILE_MODULE = {
+	.name = "sds-compile",
+	.parent = &OSCAP_DS_MODULE,
+	.summary = "Compile given SourceDataStream into an image for faster evaluation",
+	.usage = "[options] SDS TARGET_IMAGE",
+	.help =
+		"SDS - Source data stream that will be compiled.\n"
+		"TARGET_IMAGE - Resulting image, use it with 'oscap xccdf eval --compiled-content'.\n"
+		"\n"
+		"Options:\n"
+		"   --datastream-id <id> \r\t\t\t\t - ID of the datastream in the collection to use.\n"
+		"   --xccdf-id <id> \r\t\t\t\t - ID of XCCDF in the datastream that should be evaluated.\n"
+		"   --skip-valid \r\t\t\t\t - Skips validating of given SDS.\n",
+	.opt_parser = getopt_ds,
+	.func = app_ds_sds_compile
+};
+
 static struct oscap_module DS_SDS_COMPOSE_MODULE = {
 	.name = "sds-compose",
 	.parent = &OSCAP_DS_MODULE,
@@ -141,6 +159,7 @@ static struct oscap_module DS_RDS_VALIDATE_MODULE = {
 
 static struct oscap_module* DS_SUBMODULES[] = {
 	&DS_SDS_SPLIT_MODULE,
+	&DS_SDS_COMPILE_MODULE,
 	&DS_SDS_COMPOSE_MODULE,
 	&DS_SDS_ADD_MODULE,
 	&DS_SDS_VALIDATE_MODULE,
@@ -191,6 +210,15 @@ bool getopt_ds(int argc, char **argv, struct oscap_action *action) {
 		action->ds_action->file = argv[optind];
 		action->ds_action->target = argv[optind + 1];
 	}
+	else if (action->module == &DS_SDS_COMPILE_MODULE) {
+		if (optind + 2 != argc) {
+			oscap_module_usage(action->module, stderr, "Wrong number of parameters.\n");
+			return false;
+		}
+		action->ds_action = malloc(sizeof(struct ds_action));
+		action->ds_action->file = argv[optind];
+		action->ds_action->target = argv[optind + 1];
+	}
 	else if (action->module == &DS_SDS_COMPOSE_MODULE) {
 		if(optind + 2 != argc) {
 			oscap_module_usage(action->module, stderr, "Wrong number of parameters.\n");
@@ -308,6 +336,41 @@ cleanup:
 	return ret;
 }
 
+int app_ds_sds_compile(const struct oscap_action *action) {
+	int ret = OSCAP_ERROR;
+	struct ds_sds_session *session = NULL;
+
+	struct oscap_source *source = oscap_source_new_from_file(action->ds_action->file);
+	if (action->validate)
+	{
+		if (oscap_source_validate(source, reporter, (void *) action) != 0) {
+			goto cleanup;
+		}
+	}
+
+	session = ds_sds_session_new_from_source(source);
+	if (session == NULL) {
+		goto cleanup;
+	}
+	if (ds_sds_session_select_checklist(session, action->f_datastream_id, action->f_xccdf_id, NULL) == NULL) {
+		goto cleanup;
+	}
+	if (ds_sds_session_compile(session, action->ds_action->target) != 0) {
+		goto cleanup;
+	}
+
+	ret = OSCAP_OK;
+
+cleanup:
+	oscap_print_error();
+
+	ds_sds_session_free(session);
+	oscap_source_free(source);
+	free(action->ds_action);
+
+	return ret;
+}
+
 int app_ds_sds_compose(const struct oscap_action *action) {
 	int ret = OSCAP_ERROR;
 
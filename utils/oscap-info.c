@@ -149,7 +149,7 @@ static int app_info(const struct oscap_action *action)
 	break;
 	case OSCAP_DOCUMENT_XCCDF: {
 		printf("Document type: XCCDF Checklist\n");
-		struct xccdf_benchmark* bench = xccdf_benchmark_import_source(source);
+		struct xccdf_benchmark* bench = xccdf_benchmark_import_source_lazy(source);
 		if(!bench)
 			goto cleanup;
 		printf("Checklist version: %s\n", oscap_source_get_schema_version(source));
@@ -266,14 +266,13 @@ static int app_info(const struct oscap_action *action)
 
 				/* import xccdf */
 				struct xccdf_benchmark* bench = NULL;
-		                bench = xccdf_benchmark_import_source(xccdf_source);
+		                bench = xccdf_benchmark_import_source_lazy(xccdf_source);
 				if(!bench) {
 					oscap_string_iterator_free(checklist_it);
 					ds_stream_index_iterator_free(sds_it);
 					ds_sds_session_free(session);
 					goto cleanup;
 				}
-				ds_sds_session_reset(session);
 
 				/* print profiles */
 				struct xccdf_profile_iterator * prof_it = xccdf_benchmark_get_profiles(bench);
@@ -312,6 +311,7 @@ static int app_info(const struct oscap_action *action)
 				xccdf_policy_model_free(policy_model);
 				// already freed by policy!
 				//xccdf_benchmark_free(bench);
+				ds_sds_session_reset(session);
 
 				if (oscap_err()) {
 					/* This might have set error, when some of the removals failed.
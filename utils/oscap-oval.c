@@ -115,7 +115,8 @@ static struct oscap_module OVAL_EVAL = {
         "                        \r\t\t\t\t   (only applicable for source datastreams)\n"
         "   --oval-id <id> \r\t\t\t\t - ID of the OVAL component ref in the datastream to use.\n"
         "                  \r\t\t\t\t   (only applicable for source datastreams)\n"
-	"   --probe-root <dir>\r\t\t\t\t - Change the root directory before scanning the system.\n",
+	"   --probe-root <dir>\r\t\t\t\t - Change the root directory before scanning the system.\n"
+	"   --collect-stats <file>\r\t\t\t\t - Write collection statistics of every object into CSV file.\n",
     .opt_parser = getopt_oval_eval,
     .func = app_evaluate_oval
 };
@@ -361,6 +362,9 @@ int app_evaluate_oval(const struct oscap_action *action)
 	if ((oval_session_load(session)) != 0)
 		goto cleanup;
 
+	if (action->f_stats != NULL && oval_probe_stats_open(action->f_stats) != 0)
+		goto cleanup;
+
 	/* evaluation */
 	if (action->id) {
 		if ((oval_session_evaluate_id(session, action->probe_root, action->id, &eval_result)) != 0)
@@ -385,6 +389,8 @@ int app_evaluate_oval(const struct oscap_action *action)
 cleanup:
 	oscap_print_error();
 	oval_session_free(session);
+	/* the probes report their result cache statistics when the session is freed */
+	oval_probe_stats_close();
 	return ret;
 }
 
@@ -523,7 +529,8 @@ enum oval_opt {
     OVAL_OPT_DATASTREAM_ID,
     OVAL_OPT_OVAL_ID,
     OVAL_OPT_OUTPUT = 'o',
-    OVAL_OPT_PROBE_ROOT
+    OVAL_OPT_PROBE_ROOT,
+    OVAL_OPT_COLLECT_STATS
 };
 
 bool getopt_oval_eval(int argc, char **argv, struct oscap_action *action)
@@ -542,6 +549,7 @@ bool getopt_oval_eval(int argc, char **argv, struct oscap_action *action)
 		{ "oval-id",    required_argument, NULL, OVAL_OPT_OVAL_ID},
 		{ "skip-valid",	no_argument, &action->validate, 0 },
 		{ "probe-root", required_argument, NULL, OVAL_OPT_PROBE_ROOT},
+		{ "collect-stats", required_argument, NULL, OVAL_OPT_COLLECT_STATS},
 		{ 0, 0, 0, 0 }
 	};
 
@@ -556,6 +564,7 @@ bool getopt_oval_eval(int argc, char **argv, struct oscap_action *action)
 		case OVAL_OPT_DATASTREAM_ID: action->f_datastream_id = optarg;	break;
 		case OVAL_OPT_OVAL_ID: action->f_oval_id = optarg;	break;
 		case OVAL_OPT_PROBE_ROOT: action->probe_root = optarg; break;
+		case OVAL_OPT_COLLECT_STATS: action->f_stats = optarg; break;
 		case 0: break;
 		default: return oscap_module_usage(action->module, stderr, NULL);
 		}
@@ -56,6 +56,7 @@ static void oscap_action_release(struct oscap_action *action)
 {
 	assert(action != NULL);
 	free(action->f_ovals);
+	free(action->profiles);
 	cvss_impact_free(action->cvss_impact);
 }
 
@@ -96,6 +96,7 @@ struct cpe_action {
 struct cve_action {
         char * file;
         char * cve;
+        char * index;
 };
 
 struct oscap_action {
@@ -113,10 +114,16 @@ struct oscap_action {
 	char *f_directives;
         char *f_results;
 	char *f_results_arf;
+	char *f_results_arf_dir;
+	char *f_roots;
+	char *f_compiled;
+	char *f_stats;
         char *f_report;
+	char *report_engine;
 	char *f_variables;
 	/* others */
         char *profile;
+	char **profiles;
         char *show;
         char *format;
         const char *tmpl;
@@ -149,6 +156,7 @@ struct oscap_action {
 	int export_variables;
         int list_dynamic;
 	char *probe_root;
+	int jobs;
 };
 
 int app_xslt(const char *infile, const char *xsltfile, const char *outfile, const char **params);
@@ -37,6 +37,7 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <assert.h>
@@ -136,9 +137,12 @@ static struct oscap_module XCCDF_EVAL = {
     .help =
 		"INPUT_FILE - XCCDF file or a source data stream file\n\n"
         "Options:\n"
-        "   --profile <name>\r\t\t\t\t - The name of Profile to be evaluated.\n"
+        "   --profile <name>\r\t\t\t\t - The name of Profile to be evaluated. Repeat the option\n"
+        "                   \r\t\t\t\t   to evaluate several profiles in one pass.\n"
         "   --tailoring-file <file>\r\t\t\t\t - Use given XCCDF Tailoring file.\n"
         "   --tailoring-id <component-id>\r\t\t\t\t - Use given DS component as XCCDF Tailoring file.\n"
+        "   --compiled-content <file>\r\t\t\t\t - Load components from an image created by 'oscap ds sds-compile'\n"
+        "                            \r\t\t\t\t   if it matches the source data stream.\n"
         "   --cpe <name>\r\t\t\t\t - Use given CPE dictionary or language (autodetected)\n"
         "               \r\t\t\t\t   for applicability checks.\n"
         "   --oval-results\r\t\t\t\t - Save OVAL results as well.\n"
@@ -148,6 +152,12 @@ static struct oscap_module XCCDF_EVAL = {
         "   --results <file>\r\t\t\t\t - Write XCCDF Results into file.\n"
         "   --results-arf <file>\r\t\t\t\t - Write ARF (result data stream) into file.\n"
         "   --report <file>\r\t\t\t\t - Write HTML report into file.\n"
+        "   --report-engine <xslt|native>\r\t\t\t\t - Generate HTML report by XSLT (default) or natively.\n"
+        "   --roots <file>\r\t\t\t\t - Scan every root directory listed in the file (one per line)\n"
+        "                 \r\t\t\t\t   instead of the running system.\n"
+        "   --results-arf-dir <dir>\r\t\t\t\t - Write one ARF per root into directory (required by --roots).\n"
+        "   --jobs <n>\r\t\t\t\t - Scan at most n roots concurrently (default: number of CPUs).\n"
+        "   --collect-stats <file>\r\t\t\t\t - Write collection statistics of every OVAL object into CSV file.\n"
         "   --skip-valid \r\t\t\t\t - Skip validation.\n"
 	"   --fetch-remote-resources \r\t\t\t\t - Download remote content referenced by XCCDF.\n"
 	"   --progress \r\t\t\t\t - Switch to sparse output suitable for progress reporting.\n"
@@ -180,6 +190,7 @@ static struct oscap_module XCCDF_REMEDIATE = {
 			"  --results <file>\r\t\t\t\t - Write XCCDF Results into file.\n"
 			"  --results-arf <file>\r\t\t\t\t - Write ARF (result data stream) into file.\n"
 			"  --report <file>\r\t\t\t\t - Write HTML report into file.\n"
+			"  --report-engine <xslt|native>\r\t\t\t\t - Generate HTML report by XSLT (default) or natively.\n"
 			"  --oval-results\r\t\t\t\t - Save OVAL results.\n"
 			"  --export-variables\r\t\t\t\t - Export OVAL external variables provided by XCCDF.\n"
 			"  --sce-results\r\t\t\t\t - Save SCE results. (DEPRECATED! use --check-engine-results)\n"
@@ -433,11 +444,202 @@ static void _register_progress_callback(struct xccdf_session *session, bool prog
 	/* xccdf_policy_model_register_output_callback(policy_model, callback_syslog_result, NULL); */
 }
 
-static void report_missing_profile(const struct oscap_action *action)
+static void report_missing_profile(const struct oscap_action *action, const char *profile)
 {
 	fprintf(stderr,
 		"Profile \"%s\" was not found. Get available profiles using:\n"
-		"$ oscap info \"%s\"\n", action->profile, action->f_xccdf);
+		"$ oscap info \"%s\"\n", profile, action->f_xccdf);
+}
+
+static char **_read_roots(const char *filename)
+{
+	FILE *fp = fopen(filename, "r");
+	if (fp == NULL) {
+		fprintf(stderr, "Could not open '%s': %s\n", filename, strerror(errno));
+		return NULL;
+	}
+
+	char **roots = calloc(1, sizeof(char *));
+	size_t count = 0;
+	char *line = NULL;
+	size_t line_size = 0;
+	ssize_t len;
+	while ((len = getline(&line, &line_size, fp)) != -1) {
+		while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+			line[--len] = '\0';
+		if (len == 0 || line[0] == '#')
+			continue;
+		roots = realloc(roots, (count + 2) * sizeof(char *));
+		roots[count++] = strdup(line);
+		roots[count] = NULL;
+	}
+	free(line);
+	fclose(fp);
+	return roots;
+}
+
+static char *_root_arf_path(const char *directory, const char *root)
+{
+	/*
+	 * /var/lib/images/foo -> <directory>/var_lib_images_foo.arf.xml
+	 * Slashes become '_', a literal '_' or '+' is escaped as +5F or +2B, so
+	 * different roots never share a file name (/a/b_c -> a_b+5Fc.arf.xml,
+	 * /a_b/c -> a+5Fb_c.arf.xml). '%' is not used, libxml2 would unescape it.
+	 */
+	while (*root == '/')
+		++root;
+	size_t len = strlen(root);
+	while (len > 0 && root[len - 1] == '/')
+		--len;
+	if (len == 0) {
+		root = "root";
+		len = strlen(root);
+	}
+
+	size_t size = strlen(directory) + 3 * len + sizeof("/.arf.xml");
+	char *path = malloc(size);
+	char *c = path + sprintf(path, "%s/", directory);
+	for (const char *end = root + len; root < end; ++root) {
+		if (*root == '/')
+			*c++ = '_';
+		else if (*root == '_' || *root == '+')
+			c += sprintf(c, "+%02X", (unsigned char) *root);
+		else
+			*c++ = *root;
+	}
+	strcpy(c, ".arf.xml");
+	return path;
+}
+
+/*
+ * Evaluate a single root. This runs in a forked process which got its own
+ * copy-on-write view of the content loaded by the parent.
+ */
+static int _evaluate_root(struct xccdf_session *session, const char *root, const char *arf_path)
+{
+	int result = OSCAP_ERROR;
+
+	if (!xccdf_session_set_probe_root(session, root))
+		goto cleanup;
+	if (xccdf_session_evaluate(session) != 0)
+		goto cleanup;
+
+	xccdf_session_set_arf_export(session, arf_path);
+	if (xccdf_session_export_oval(session) != 0)
+		goto cleanup;
+	if (xccdf_session_export_check_engine_plugins(session) != 0)
+		goto cleanup;
+	if (xccdf_session_export_xccdf(session) != 0)
+		goto cleanup;
+	if (xccdf_session_export_arf(session) != 0)
+		goto cleanup;
+
+	result = xccdf_session_contains_fail_result(session) ? OSCAP_FAIL : OSCAP_OK;
+
+cleanup:
+	if (result == OSCAP_ERROR) {
+		fprintf(stderr, "Scan of '%s' failed.\n", root);
+		oscap_print_error();
+	}
+	return result;
+}
+
+/*
+ * Scan every root listed in action->f_roots by a separate process, at most
+ * action->jobs of them at once. The content is loaded only once by the parent.
+ */
+static int app_evaluate_xccdf_roots(const struct oscap_action *action, struct xccdf_session *session)
+{
+	char **roots = _read_roots(action->f_roots);
+	if (roots == NULL)
+		return OSCAP_ERROR;
+
+	long jobs = action->jobs;
+	if (jobs < 1)
+		jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	if (jobs < 1)
+		jobs = 1;
+
+	/* Terminate probes started while loading the content, every scan starts its own */
+	xccdf_session_set_probe_root(session, NULL);
+
+	size_t count = 0;
+	while (roots[count] != NULL)
+		++count;
+
+	/* A root listed twice would have its ARF overwritten by the second scan */
+	char **arf_paths = calloc(count + 1, sizeof(char *));
+	bool error = false, fail = false, fork_failed = false;
+	for (size_t i = 0; i < count; ++i) {
+		arf_paths[i] = _root_arf_path(action->f_results_arf_dir, roots[i]);
+		for (size_t j = 0; j < i; ++j) {
+			if (strcmp(arf_paths[i], arf_paths[j]) == 0) {
+				fprintf(stderr, "Roots '%s' and '%s' would be written to the same file '%s'.\n",
+					roots[j], roots[i], arf_paths[i]);
+				error = true;
+			}
+		}
+	}
+
+	pid_t *pids = calloc(count + 1, sizeof(pid_t));
+
+	long running = 0;
+	size_t next = error ? count : 0;
+	while (next < count || running > 0) {
+		if (next < count && running < jobs && !fork_failed) {
+			/* Do not let children flush our buffered output again */
+			fflush(stdout);
+			fflush(stderr);
+			pid_t pid = fork();
+			if (pid == 0) {
+				/* The session is shared with the parent, it is not freed here. Probes spawned
+				 * by this scan terminate as soon as their pipes get closed on exit. */
+				exit(_evaluate_root(session, roots[next], arf_paths[next]));
+			}
+			if (pid < 0) {
+				fprintf(stderr, "Could not fork scan of '%s': %s\n", roots[next], strerror(errno));
+				error = fork_failed = true;
+				continue;
+			}
+			pids[next++] = pid;
+			++running;
+			continue;
+		}
+		if (running == 0)
+			break;
+
+		int status;
+		pid_t pid = waitpid(-1, &status, 0);
+		if (pid < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		size_t i = 0;
+		while (i < next && pids[i] != pid)
+			++i;
+		if (i == next)
+			continue;
+		--running;
+
+		int ret = WIFEXITED(status) ? WEXITSTATUS(status) : OSCAP_ERROR;
+		if (ret == OSCAP_FAIL)
+			fail = true;
+		else if (ret != OSCAP_OK)
+			error = true;
+		printf("%s\t%s\t%s\n", roots[i], ret == OSCAP_OK ? "pass" : (ret == OSCAP_FAIL ? "fail" : "error"), arf_paths[i]);
+		fflush(stdout);
+	}
+
+	for (size_t i = 0; i < count; ++i) {
+		free(roots[i]);
+		free(arf_paths[i]);
+	}
+	free(roots);
+	free(arf_paths);
+	free(pids);
+
+	return error ? OSCAP_ERROR : (fail ? OSCAP_FAIL : OSCAP_OK);
 }
 
 /**
@@ -464,6 +666,8 @@ int app_evaluate_xccdf(const struct oscap_action *action)
 		xccdf_session_set_datastream_id(session, action->f_datastream_id);
 		xccdf_session_set_component_id(session, action->f_xccdf_id);
 		xccdf_session_set_benchmark_id(session, action->f_benchmark_id);
+		if (action->f_compiled != NULL)
+			xccdf_session_set_compiled_content(session, action->f_compiled);
 	}
 	xccdf_session_set_user_cpe(session, action->cpe);
 	// The tailoring_file may be NULL but the tailoring file may have been
@@ -479,14 +683,33 @@ int app_evaluate_xccdf(const struct oscap_action *action)
 		goto cleanup;
 
 	/* Select profile */
-	if (!xccdf_session_set_profile_id(session, action->profile)) {
+	if (action->profiles != NULL && action->profiles[1] != NULL) {
+		/* several profiles are evaluated in one pass */
+		for (int i = 0; action->profiles[i] != NULL; ++i) {
+			if (xccdf_policy_model_get_policy_by_id(xccdf_session_get_policy_model(session), action->profiles[i]) == NULL) {
+				report_missing_profile(action, action->profiles[i]);
+				goto cleanup;
+			}
+		}
+		if (!xccdf_session_set_profile_ids(session, (const char **) action->profiles))
+			goto cleanup;
+	}
+	else if (!xccdf_session_set_profile_id(session, action->profile)) {
 		if (action->profile != NULL)
-			report_missing_profile(action);
+			report_missing_profile(action, action->profile);
 		else
 			fprintf(stderr, "No Policy was found for default profile.\n");
 		goto cleanup;
 	}
 
+	if (action->f_stats != NULL && oval_probe_stats_open(action->f_stats) != 0)
+		goto cleanup;
+
+	if (action->f_roots != NULL) {
+		result = app_evaluate_xccdf_roots(action, session);
+		goto cleanup;
+	}
+
 	_register_progress_callback(session, action->progress);
 
 	/* Perform evaluation */
@@ -515,6 +738,7 @@ int app_evaluate_xccdf(const struct oscap_action *action)
 
 	xccdf_session_set_xccdf_export(session, action->f_results);
 	xccdf_session_set_report_export(session, action->f_report);
+	xccdf_session_set_report_engine(session, action->report_engine);
 	if (xccdf_session_export_xccdf(session) != 0)
 		goto cleanup;
 	else if (action->validate && getenv("OSCAP_FULL_VALIDATION") != NULL &&
@@ -538,6 +762,8 @@ cleanup:
 
 	if (session != NULL)
 		xccdf_session_free(session);
+	/* the probes report their result cache statistics when the session is freed */
+	oval_probe_stats_close();
 
 	return result;
 }
@@ -582,7 +808,7 @@ static int app_xccdf_export_oval_variables(const struct oscap_action *action)
 	policy = xccdf_policy_model_get_policy_by_id(xccdf_session_get_policy_model(session), action->profile);
 	if (policy == NULL) {
 		if (action->profile != NULL)
-			report_missing_profile(action);
+			report_missing_profile(action, action->profile);
 		else
 			fprintf(stderr, "No Policy was found for default profile.\n");
 		goto cleanup;
@@ -632,6 +858,7 @@ int app_xccdf_remediate(const struct oscap_action *action)
 	xccdf_session_set_arf_export(session, action->f_results_arf);
 	xccdf_session_set_xccdf_export(session, action->f_results);
 	xccdf_session_set_report_export(session, action->f_report);
+	xccdf_session_set_report_engine(session, action->report_engine);
 
 	if (xccdf_session_export_oval(session) != 0)
 		goto cleanup;
@@ -804,7 +1031,7 @@ int app_generate_fix(const struct oscap_action *action)
 		goto cleanup;
 
 	if (!xccdf_session_set_profile_id(session, action->profile)) {
-		report_missing_profile(action);
+		report_missing_profile(action, action->profile);
 		goto cleanup;
 	}
 
@@ -888,6 +1115,12 @@ enum oval_opt {
     XCCDF_OPT_BENCHMARK_ID,
     XCCDF_OPT_PROFILE,
     XCCDF_OPT_REPORT_FILE,
+    XCCDF_OPT_REPORT_ENGINE,
+    XCCDF_OPT_ROOTS,
+    XCCDF_OPT_RESULT_DIR_ARF,
+    XCCDF_OPT_JOBS,
+    XCCDF_OPT_COMPILED_CONTENT,
+    XCCDF_OPT_COLLECT_STATS,
     XCCDF_OPT_SHOW,
     XCCDF_OPT_TEMPLATE,
     XCCDF_OPT_FORMAT,
@@ -921,6 +1154,12 @@ bool getopt_xccdf(int argc, char **argv, struct oscap_action *action)
 		{"profile", 		required_argument, NULL, XCCDF_OPT_PROFILE},
 		{"result-id",		required_argument, NULL, XCCDF_OPT_RESULT_ID},
 		{"report", 		required_argument, NULL, XCCDF_OPT_REPORT_FILE},
+		{"report-engine",	required_argument, NULL, XCCDF_OPT_REPORT_ENGINE},
+		{"roots",		required_argument, NULL, XCCDF_OPT_ROOTS},
+		{"results-arf-dir",	required_argument, NULL, XCCDF_OPT_RESULT_DIR_ARF},
+		{"jobs",		required_argument, NULL, XCCDF_OPT_JOBS},
+		{"compiled-content",	required_argument, NULL, XCCDF_OPT_COMPILED_CONTENT},
+		{"collect-stats",	required_argument, NULL, XCCDF_OPT_COLLECT_STATS},
 		{"show", 		required_argument, NULL, XCCDF_OPT_SHOW},
 		{"template", 		required_argument, NULL, XCCDF_OPT_TEMPLATE},
 		{"oval-template", 	required_argument, NULL, XCCDF_OPT_OVAL_TEMPLATE},
@@ -956,9 +1195,33 @@ bool getopt_xccdf(int argc, char **argv, struct oscap_action *action)
 		case XCCDF_OPT_DATASTREAM_ID:	action->f_datastream_id = optarg;	break;
 		case XCCDF_OPT_XCCDF_ID:	action->f_xccdf_id = optarg; break;
 		case XCCDF_OPT_BENCHMARK_ID:	action->f_benchmark_id = optarg; break;
-		case XCCDF_OPT_PROFILE:		action->profile = optarg;	break;
+		case XCCDF_OPT_PROFILE:
+			{
+				size_t count = 0;
+				while (action->profiles != NULL && action->profiles[count] != NULL)
+					++count;
+				action->profiles = realloc(action->profiles, (count + 2) * sizeof(char *));
+				action->profiles[count] = optarg;
+				action->profiles[count + 1] = NULL;
+				action->profile = optarg;
+				break;
+			}
 		case XCCDF_OPT_RESULT_ID:	action->id = optarg;		break;
 		case XCCDF_OPT_REPORT_FILE:	action->f_report = optarg; 	break;
+		case XCCDF_OPT_REPORT_ENGINE:
+			if (strcmp(optarg, "xslt") != 0 && strcmp(optarg, "native") != 0)
+				return oscap_module_usage(action->module, stderr, "Report engine needs to be either 'xslt' or 'native'!");
+			action->report_engine = optarg;
+			break;
+		case XCCDF_OPT_ROOTS:		action->f_roots = optarg;	break;
+		case XCCDF_OPT_RESULT_DIR_ARF:	action->f_results_arf_dir = optarg;	break;
+		case XCCDF_OPT_JOBS:
+			action->jobs = atoi(optarg);
+			if (action->jobs < 1)
+				return oscap_module_usage(action->module, stderr, "Number of jobs needs to be a positive number!");
+			break;
+		case XCCDF_OPT_COMPILED_CONTENT:	action->f_compiled = optarg;	break;
+		case XCCDF_OPT_COLLECT_STATS:	action->f_stats = optarg;	break;
 		case XCCDF_OPT_SHOW:		action->show = optarg;		break;
 		case XCCDF_OPT_TEMPLATE:	action->tmpl = optarg;		break;
 		case XCCDF_OPT_OVAL_TEMPLATE:	action->oval_template = optarg; break;
@@ -980,6 +1243,13 @@ bool getopt_xccdf(int argc, char **argv, struct oscap_action *action)
 	}
 
 	if (action->module == &XCCDF_EVAL) {
+		if (action->f_roots != NULL) {
+			if (action->f_results_arf_dir == NULL)
+				return oscap_module_usage(action->module, stderr, "Option --roots requires --results-arf-dir!");
+			if (action->f_results || action->f_results_arf || action->f_report || action->remediate ||
+					action->oval_results || action->check_engine_results || action->export_variables)
+				return oscap_module_usage(action->module, stderr, "Option --roots can be combined only with --results-arf-dir output!");
+		}
 		/* We should have XCCDF file here */
 		if (optind >= argc) {
 			/* TODO */